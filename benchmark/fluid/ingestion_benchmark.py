@@ -0,0 +1,96 @@
+# Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Measures the throughput of feeding numpy arrays into LoDTensors and the
+queue of py_reader, with and without copying the arrays.
+
+    python ingestion_benchmark.py --batch_size 64 --shape 3,224,224
+"""
+
+from __future__ import print_function
+
+import argparse
+import time
+
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+def parse_args():
+    parser = argparse.ArgumentParser('Numpy ingestion benchmark.')
+    parser.add_argument(
+        '--batch_size', type=int, default=64, help='The minibatch size.')
+    parser.add_argument(
+        '--shape',
+        type=str,
+        default='3,224,224',
+        help='The shape of one sample, separated by comma.')
+    parser.add_argument(
+        '--dtype', type=str, default='float32', help='The data type.')
+    parser.add_argument(
+        '--iterations', type=int, default=100, help='The number of batches.')
+    return parser.parse_args()
+
+
+def to_tensor(array, zero_copy):
+    tensor = core.LoDTensor()
+    if zero_copy:
+        tensor._share_data_with_numpy(array)
+    else:
+        tensor.set(array, core.CPUPlace())
+    return tensor
+
+
+def bench_tensor(batches, zero_copy):
+    start = time.time()
+    for array in batches:
+        to_tensor(array, zero_copy)
+    return time.time() - start
+
+
+def bench_queue(batches, zero_copy):
+    scope = core.Scope()
+    var = scope.var('ingestion_benchmark_queue')
+    queue = core.init_lod_tensor_blocking_queue(var, len(batches))
+    start = time.time()
+    for array in batches:
+        tensors = core.LoDTensorArray()
+        tensors.append(to_tensor(array, zero_copy))
+        queue.push(tensors)
+    elapsed = time.time() - start
+    queue.close()
+    return elapsed
+
+
+def main():
+    args = parse_args()
+    shape = [args.batch_size] + [int(s) for s in args.shape.split(',')]
+    batches = [
+        np.random.random(shape).astype(args.dtype)
+        for _ in range(args.iterations)
+    ]
+    total_bytes = sum(array.nbytes for array in batches)
+    print('batch shape: %s, dtype: %s, %.2f MB per batch' %
+          (shape, args.dtype, batches[0].nbytes / 1e6))
+    for name, bench in [('LoDTensor.set', bench_tensor),
+                        ('py_reader queue push', bench_queue)]:
+        for zero_copy in [False, True]:
+            elapsed = bench(batches, zero_copy)
+            print('%-22s zero_copy=%-5s %8.3f ms/batch %8.2f GB/s' %
+                  (name, zero_copy, elapsed * 1e3 / len(batches),
+                   total_bytes / elapsed / 1e9))
+
+
+if __name__ == '__main__':
+    main()
@@ -24,6 +24,11 @@ TEST(DataTypeTransform, CPUTransform) {
       paddle::framework::DataLayout::kAnyLayout,
       paddle::framework::LibraryType::kPlain);
 
+  auto kernel_bf16 = paddle::framework::OpKernelType(
+      paddle::framework::proto::VarType::BF16, place,
+      paddle::framework::DataLayout::kAnyLayout,
+      paddle::framework::LibraryType::kPlain);
+
   auto kernel_fp32 = paddle::framework::OpKernelType(
       paddle::framework::proto::VarType::FP32, place,
       paddle::framework::DataLayout::kAnyLayout,
@@ -189,4 +194,57 @@ TEST(DataTypeTransform, CPUTransform) {
                 static_cast<paddle::platform::float16>(in_data_bool[i]).x);
     }
   }
+
+  // data type transform from/to bfloat16
+  {
+    paddle::framework::Tensor in;
+    paddle::framework::Tensor out;
+
+    float* in_data_float =
+        in.mutable_data<float>(paddle::framework::make_ddim({2, 3}), place);
+    int data_number = 2 * 3;
+    for (int i = 0; i < data_number; ++i) {
+      in_data_float[i] = i * 1.1f;
+    }
+
+    // transform float to bfloat16
+    paddle::framework::TransDataType(kernel_fp32, kernel_bf16, in, &out);
+    paddle::platform::bfloat16* ptr = out.data<paddle::platform::bfloat16>();
+    for (int i = 0; i < data_number; ++i) {
+      EXPECT_EQ(ptr[i].x,
+                static_cast<paddle::platform::bfloat16>(in_data_float[i]).x);
+    }
+
+    // transform bfloat16 to float, the error is within bfloat16 precision
+    in.ShareDataWith(out);
+    paddle::framework::Tensor out_float;
+    paddle::framework::TransDataType(kernel_bf16, kernel_fp32, in, &out_float);
+    float* out_data_float = out_float.data<float>();
+    for (int i = 0; i < data_number; ++i) {
+      EXPECT_NEAR(out_data_float[i], i * 1.1f, i * 1.1f / 128);
+    }
+
+    // transform bfloat16 to float16
+    paddle::framework::Tensor out_fp16;
+    paddle::framework::TransDataType(kernel_bf16, kernel_fp16, in, &out_fp16);
+    paddle::platform::float16* out_data_fp16 =
+        out_fp16.data<paddle::platform::float16>();
+    for (int i = 0; i < data_number; ++i) {
+      EXPECT_EQ(out_data_fp16[i].x,
+                static_cast<paddle::platform::float16>(
+                    static_cast<float>(ptr[i])).x);
+    }
+
+    // transform int to bfloat16
+    int* in_data_int =
+        in.mutable_data<int>(paddle::framework::make_ddim({2, 3}), place);
+    for (int i = 0; i < data_number; ++i) {
+      in_data_int[i] = i;
+    }
+    paddle::framework::TransDataType(kernel_int32, kernel_bf16, in, &out);
+    ptr = out.data<paddle::platform::bfloat16>();
+    for (int i = 0; i < data_number; ++i) {
+      EXPECT_EQ(static_cast<float>(ptr[i]), static_cast<float>(i));
+    }
+  }
 }
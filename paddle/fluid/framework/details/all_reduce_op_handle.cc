@@ -58,52 +58,52 @@ void AllReduceOpHandle::RunImpl() {
   WaitInputVarGenerated();
   auto in_var_handles = DynamicCast<VarHandle>(this->Inputs());
   auto out_var_handles = DynamicCast<VarHandle>(this->Outputs());
+  // Several variables may be all-reduced together, the i-th input belongs to
+  // the (i % places_.size())-th place.
   PADDLE_ENFORCE_EQ(
-      in_var_handles.size(), places_.size(),
-      "The NoDummyInputSize should be equal to the number of places.");
+      in_var_handles.size() % places_.size(), 0,
+      "The NoDummyInputSize should be a multiple of the number of places.");
   PADDLE_ENFORCE_EQ(
       in_var_handles.size(), out_var_handles.size(),
       "The NoDummyInputSize and NoDummyOutputSize should be equal.");
-
-  std::vector<const LoDTensor *> lod_tensors;
-  for (size_t i = 0; i < local_scopes_.size(); ++i) {
-    auto *s = local_scopes_[i];
+  const size_t num_places = places_.size();
+  const size_t num_vars = in_var_handles.size() / num_places;
+
+  // [place][var]
+  std::vector<std::vector<LoDTensor *>> lod_tensors(num_places);
+  bool all_on_cpu = true;
+  for (size_t i = 0; i < in_var_handles.size(); ++i) {
+    auto *s = local_scopes_[i % num_places];
     auto &local_scope = *s->FindVar(kLocalExecScopeName)->Get<Scope *>();
-    auto &lod_tensor =
-        local_scope.FindVar(in_var_handles[i]->name())->Get<LoDTensor>();
-    lod_tensors.emplace_back(&lod_tensor);
+    auto *lod_tensor = local_scope.FindVar(in_var_handles[i]->name())
+                           ->GetMutable<LoDTensor>();
+    lod_tensors[i % num_places].emplace_back(lod_tensor);
+    all_on_cpu = all_on_cpu && platform::is_cpu_place(lod_tensor->place()) &&
+                 platform::is_cpu_place(places_[i % num_places]);
     PADDLE_ENFORCE_EQ(in_var_handles[i]->name(), out_var_handles[i]->name(),
                       "The name of input and output should be equal.");
   }
 
-  if (platform::is_gpu_place(lod_tensors[0]->place())) {
+  if (platform::is_gpu_place(lod_tensors[0][0]->place())) {
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
     PADDLE_ENFORCE(nccl_ctxs_, "nccl_ctxs should not be nullptr.");
-    int dtype = -1;
-    size_t numel = 0;
     std::vector<std::function<void()>> all_reduce_calls;
     for (size_t i = 0; i < local_scopes_.size(); ++i) {
       auto &p = places_[i];
-      auto &lod_tensor = *lod_tensors[i];
-      void *buffer = const_cast<void *>(lod_tensor.data<void>());
-
-      if (dtype == -1) {
-        dtype = platform::ToNCCLDataType(lod_tensor.type());
-      }
-
-      if (numel == 0) {
-        numel = static_cast<size_t>(lod_tensor.numel());
-      }
-
       int dev_id = boost::get<platform::CUDAPlace>(p).device;
       auto &nccl_ctx = nccl_ctxs_->at(dev_id);
       auto stream = nccl_ctx.stream();
       auto comm = nccl_ctx.comm_;
-      all_reduce_calls.emplace_back([=] {
-        PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
-            buffer, buffer, numel, static_cast<ncclDataType_t>(dtype), ncclSum,
-            comm, stream));
-      });
+      for (auto *lod_tensor : lod_tensors[i]) {
+        void *buffer = const_cast<void *>(lod_tensor->data<void>());
+        int dtype = platform::ToNCCLDataType(lod_tensor->type());
+        size_t numel = static_cast<size_t>(lod_tensor->numel());
+        all_reduce_calls.emplace_back([=] {
+          PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
+              buffer, buffer, numel, static_cast<ncclDataType_t>(dtype),
+              ncclSum, comm, stream));
+        });
+      }
     }
 
     this->RunAndRecordEvent([&] {
@@ -130,29 +130,32 @@ void AllReduceOpHandle::RunImpl() {
 #else
     PADDLE_THROW("Not compiled with CUDA");
 #endif
+  } else if (all_on_cpu) {
+    // Every place takes part in reducing and broadcasting a chunk.
+    AllReduceCPUTensors func(lod_tensors);
+    VisitDataType(lod_tensors[0][0]->type(), func);
   } else {  // Special handle CPU only Operator's gradient. Like CRF
-    auto &trg = *this->local_scopes_[0]
-                     ->FindVar(kLocalExecScopeName)
-                     ->Get<Scope *>()
-                     ->FindVar(out_var_handles[0]->name())
-                     ->GetMutable<framework::LoDTensor>();
+    for (size_t v = 0; v < num_vars; ++v) {
+      std::vector<const LoDTensor *> src_tensors;
+      for (size_t i = 0; i < num_places; ++i) {
+        src_tensors.emplace_back(lod_tensors[i][v]);
+      }
+      auto &trg = *lod_tensors[0][v];
 
-    // Reduce All Tensor to trg in CPU
-    ReduceLoDTensor func(lod_tensors, &trg);
-    VisitDataType(lod_tensors[0]->type(), func);
+      // Reduce All Tensor to trg in CPU
+      ReduceLoDTensor func(src_tensors, &trg);
+      VisitDataType(src_tensors[0]->type(), func);
 
-    for (size_t i = 1; i < local_scopes_.size(); ++i) {
-      auto &scope =
-          *local_scopes_[i]->FindVar(kLocalExecScopeName)->Get<Scope *>();
-      auto &p = places_[i];
-      auto *var = scope.FindVar(out_var_handles[i]->name());
-      auto *dev_ctx = dev_ctxes_.at(p);
+      for (size_t i = 1; i < num_places; ++i) {
+        auto &p = places_[i];
+        auto *tensor = lod_tensors[i][v];
+        auto *dev_ctx = dev_ctxes_.at(p);
 
-      RunAndRecordEvent(p, [&trg, var, dev_ctx, p] {
-        auto &tensor_gpu = *var->GetMutable<framework::LoDTensor>();
-        auto &tensor_cpu = trg;
-        TensorCopy(tensor_cpu, p, *dev_ctx, &tensor_gpu);
-      });
+        RunAndRecordEvent(p, [&trg, tensor, dev_ctx, p] {
+          auto &tensor_cpu = trg;
+          TensorCopy(tensor_cpu, p, *dev_ctx, tensor);
+        });
+      }
     }
   }
 }
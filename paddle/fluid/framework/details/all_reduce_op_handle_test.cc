@@ -0,0 +1,86 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/details/reduce_and_gather.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+TEST(AllReduceTester, TestCPUAllReduceTensors) {
+  const size_t num_places = 3;
+  // A large var is split into several chunks, the small one lies in the last.
+  const std::vector<int64_t> sizes = {50000, 7};
+  std::vector<std::unique_ptr<LoDTensor>> holders;
+  std::vector<std::vector<LoDTensor *>> tensors(num_places);
+  for (size_t p = 0; p < num_places; ++p) {
+    for (auto size : sizes) {
+      holders.emplace_back(new LoDTensor);
+      auto *tensor = holders.back().get();
+      tensor->Resize({size});
+      float *data = tensor->mutable_data<float>(platform::CPUPlace());
+      for (int64_t i = 0; i < size; ++i) {
+        data[i] = static_cast<float>(p + 1) * (i % 17);
+      }
+      tensors[p].push_back(tensor);
+    }
+  }
+
+  AllReduceCPUTensors func(tensors);
+  VisitDataType(proto::VarType::FP32, func);
+
+  // (1 + 2 + 3) * (i % 17) on every place
+  for (size_t p = 0; p < num_places; ++p) {
+    for (size_t v = 0; v < sizes.size(); ++v) {
+      const float *data = tensors[p][v]->data<float>();
+      for (int64_t i = 0; i < sizes[v]; ++i) {
+        ASSERT_EQ(data[i], 6.f * (i % 17));
+      }
+    }
+  }
+}
+
+TEST(AllReduceTester, TestCPUAllReduceMixedTypes) {
+  // The second var of the second place is double.
+  std::vector<std::unique_ptr<LoDTensor>> holders;
+  std::vector<std::vector<LoDTensor *>> tensors(2);
+  for (size_t p = 0; p < tensors.size(); ++p) {
+    for (size_t v = 0; v < 2; ++v) {
+      holders.emplace_back(new LoDTensor);
+      auto *tensor = holders.back().get();
+      tensor->Resize({4});
+      if (p == 1 && v == 1) {
+        tensor->mutable_data<double>(platform::CPUPlace());
+      } else {
+        tensor->mutable_data<float>(platform::CPUPlace());
+      }
+      tensors[p].push_back(tensor);
+    }
+  }
+
+  AllReduceCPUTensors func(tensors);
+  ASSERT_THROW(VisitDataType(proto::VarType::FP32, func),
+               platform::EnforceNotMet);
+  // Nothing is reallocated.
+  EXPECT_EQ(tensors[1][1]->type(), proto::VarType::FP64);
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
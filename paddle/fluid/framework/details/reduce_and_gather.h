@@ -14,11 +14,14 @@
 
 #pragma once
 #include <algorithm>
+#include <future>  // NOLINT
 #include <map>
 #include <vector>
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/details/reduce_and_gather.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/threadpool.h"
 namespace paddle {
 namespace framework {
 namespace details {
@@ -53,6 +56,90 @@ struct ReduceLoDTensor {
   }
 };
 
+// All-reduce the tensors of several places in place. The tensors of one
+// place are taken as one buffer, so that many small gradients are reduced
+// together. The buffer is split into a chunk per place, and every chunk is
+// summed into one place and copied to the others by its own thread, like a
+// reduce-scatter followed by an all-gather.
+struct AllReduceCPUTensors {
+  // [place][var]
+  const std::vector<std::vector<LoDTensor *>> &tensors_;
+
+  explicit AllReduceCPUTensors(
+      const std::vector<std::vector<LoDTensor *>> &tensors)
+      : tensors_(tensors) {}
+
+  template <typename T>
+  void apply() const {
+    PADDLE_ENFORCE(!tensors_.empty());
+    const size_t num_places = tensors_.size();
+    const size_t num_vars = tensors_[0].size();
+    // All the vars are taken as one buffer of T, so they must share the type
+    // before any of them is touched.
+    const auto type = DataTypeTrait<T>::DataType;
+    for (auto &place_tensors : tensors_) {
+      PADDLE_ENFORCE_EQ(place_tensors.size(), num_vars);
+      for (auto *t : place_tensors) {
+        PADDLE_ENFORCE(t->IsInitialized() && t->type() == type,
+                       "The tensors all-reduced together should all be %s.",
+                       DataTypeToString(type));
+      }
+    }
+    // The offsets of the vars in the buffer.
+    std::vector<int64_t> offsets(num_vars + 1, 0);
+    std::vector<std::vector<T *>> data(num_places, std::vector<T *>(num_vars));
+    for (size_t v = 0; v < num_vars; ++v) {
+      auto &t0 = *tensors_[0][v];
+      PADDLE_ENFORCE_NE(t0.numel(), 0);
+      offsets[v + 1] = offsets[v] + t0.numel();
+      for (size_t p = 0; p < num_places; ++p) {
+        auto &t = *tensors_[p][v];
+        PADDLE_ENFORCE_EQ(t.dims(), t0.dims());
+        data[p][v] = t.data<T>();
+      }
+    }
+
+    // Too small chunks are not worth a thread.
+    constexpr int64_t kMinChunkNumel = 1 << 14;
+    const int64_t numel = offsets.back();
+    const int64_t num_chunks = std::max<int64_t>(
+        1, std::min<int64_t>(num_places, numel / kMinChunkNumel));
+    const int64_t chunk_numel = (numel + num_chunks - 1) / num_chunks;
+
+    auto reduce_chunk = [&](int64_t c) {
+      const int64_t begin = c * chunk_numel;
+      const int64_t end = std::min(numel, begin + chunk_numel);
+      for (size_t v = 0; v < num_vars; ++v) {
+        const int64_t lo = std::max(begin, offsets[v]) - offsets[v];
+        const int64_t hi = std::min(end, offsets[v + 1]) - offsets[v];
+        if (lo >= hi) continue;
+        T *dst = data[c][v];
+        for (size_t p = 0; p < num_places; ++p) {
+          if (p == static_cast<size_t>(c)) continue;
+          const T *src = data[p][v];
+          std::transform(src + lo, src + hi, dst + lo, dst + lo,
+                         [](T a, T b) -> T { return a + b; });
+        }
+        for (size_t p = 0; p < num_places; ++p) {
+          if (p == static_cast<size_t>(c)) continue;
+          std::copy(dst + lo, dst + hi, data[p][v] + lo);
+        }
+      }
+    };
+
+    std::vector<std::future<void>> futures;
+    for (int64_t c = 1; c < num_chunks; ++c) {
+      futures.emplace_back(framework::Async([&reduce_chunk, c] {
+        reduce_chunk(c);
+      }));
+    }
+    reduce_chunk(0);
+    for (auto &f : futures) {
+      f.get();
+    }
+  }
+};
+
 inline void GatherLocalSelectedRows(
     const std::vector<const SelectedRows *> &src_selecte_rows_,
     const std::vector<platform::Place> &in_places,
@@ -26,6 +26,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/distributed/distributed.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_tracer.h"
 
 #ifdef PADDLE_WITH_NGRAPH
 #include "paddle/fluid/operators/ngraph/ngraph_engine.h"
@@ -403,6 +404,7 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
                                   bool create_local_scope, bool create_vars,
                                   bool keep_kids) {
   PADDLE_ENFORCE_NOT_NULL(scope);
+  platform::TraceIteration trace_iteration;
   Scope* local_scope = scope;
   if (create_vars) {
     if (create_local_scope) {
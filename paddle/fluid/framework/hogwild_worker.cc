@@ -12,14 +12,40 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include "gflags/gflags.h"
 #include "paddle/fluid/framework/device_worker.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
+#include "paddle/fluid/framework/metric_accumulator.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/memory/allocation/thread_cached_allocator.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/lodtensor_printer.h"
+#include "paddle/fluid/platform/sampling_tracer.h"
+
+DEFINE_bool(hogwild_cache_thread_buffers, false,
+            "Whether every Hogwild worker keeps the CPU buffers freed in a "
+            "batch, e.g. the activations, to reuse them in the next batches "
+            "instead of allocating them again.");
 
 namespace paddle {
 namespace framework {
 
+static std::string BufferCacheStatString(
+    memory::allocation::ThreadCachedAllocator* buffer_cache, int batch_cnt) {
+  auto stat = buffer_cache->GetStat();
+  double batches = std::max(batch_cnt, 1);
+  std::ostringstream os;
+  os << batch_cnt << " batches, " << stat.allocs / batches
+     << " CPU buffers allocated per batch, "
+     << stat.underlying_allocs / batches
+     << " of them allocated by the underlying allocator, "
+     << stat.cached_bytes << " bytes cached";
+  return os.str();
+}
+
 void HogwildWorker::Initialize(const TrainerDesc& desc) {
   fetch_var_names_.resize(desc.fetch_var_names_size());
   for (size_t i = 0; i < desc.fetch_var_names_size(); ++i) {
@@ -119,22 +145,49 @@ void HogwildWorker::TrainFilesWithProfiler() {
     }
     timeline.Start();
   }
+  FlushThreadMetrics();
 }
 
 void HogwildWorker::TrainFiles() {
   platform::SetNumThreads(1);
 
+  std::shared_ptr<memory::allocation::ThreadCachedAllocator> buffer_cache;
+  std::unique_ptr<memory::allocation::ThreadCachedAllocatorGuard>
+      buffer_cache_guard;
+  if (FLAGS_hogwild_cache_thread_buffers && platform::is_cpu_place(place_)) {
+    buffer_cache = std::make_shared<memory::allocation::ThreadCachedAllocator>(
+        memory::allocation::AllocatorFacade::Instance().GetAllocator(
+            platform::CPUPlace()));
+    buffer_cache_guard.reset(
+        new memory::allocation::ThreadCachedAllocatorGuard(
+            buffer_cache.get()));
+  }
+
   // how to accumulate fetched values here
   device_reader_->Start();
   int cur_batch;
   int batch_cnt = 0;
   while ((cur_batch = device_reader_->Next()) > 0) {
+    platform::TraceIteration trace_iteration;
     for (auto& op : ops_) {
       op->Run(*thread_scope_, place_);
     }
 
     ++batch_cnt;
     thread_scope_->DropKids();
+    if (buffer_cache) {
+      buffer_cache->Trim();
+      if (batch_cnt % 1000 == 0) {
+        VLOG(3) << "Hogwild worker " << thread_id_ << ": "
+                << BufferCacheStatString(buffer_cache.get(), batch_cnt);
+      }
+    }
+  }
+  // merge the metric stats pending in this thread
+  FlushThreadMetrics();
+  if (buffer_cache) {
+    VLOG(1) << "Hogwild worker " << thread_id_ << ": "
+            << BufferCacheStatString(buffer_cache.get(), batch_cnt);
   }
 }
 
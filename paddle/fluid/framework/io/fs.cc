@@ -13,6 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/io/fs.h"
+#include <zlib.h>
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 
 namespace paddle {
 namespace framework {
@@ -75,6 +82,183 @@ static std::shared_ptr<FILE> fs_open_internal(const std::string& path,
   return fp;
 }
 
+// Inflates a gzip file in a background thread, which reads and decompresses
+// ahead into a pool of blocks while the caller consumes the earlier ones.
+// Concatenated gzip members are inflated one after another, like zcat.
+class FsInflateReaderInternal {
+ public:
+  FsInflateReaderInternal(std::shared_ptr<FILE> file, size_t block_size,
+                          size_t num_blocks)
+      : file_(std::move(file)), blocks_(num_blocks) {
+    for (size_t i = 0; i < num_blocks; ++i) {
+      blocks_[i].resize(block_size);
+      free_.push_back(i);
+    }
+    thread_ = std::thread([this] { InflateLoop(); });
+  }
+
+  ~FsInflateReaderInternal() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  // Returns the number of bytes read, 0 at the end and -1 on error.
+  ssize_t Read(char* buf, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+      if (cur_pos_ == cur_size_) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (cur_ >= 0) {
+          free_.push_back(cur_);
+          cur_ = -1;
+          cv_.notify_all();
+        }
+        if (total > 0 && ready_.empty()) break;
+        cv_.wait(lock, [this] { return !ready_.empty() || done_; });
+        if (ready_.empty()) {
+          if (error_) return total > 0 ? total : -1;
+          break;
+        }
+        cur_ = ready_.front().first;
+        cur_size_ = ready_.front().second;
+        cur_pos_ = 0;
+        ready_.pop_front();
+      }
+      size_t n = std::min(size - total, cur_size_ - cur_pos_);
+      memcpy(buf + total, blocks_[cur_].data() + cur_pos_, n);
+      cur_pos_ += n;
+      total += n;
+    }
+    return total;
+  }
+
+ private:
+  void InflateLoop() {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // 15 window bits, +16 to decode the gzip format.
+    CHECK_EQ(inflateInit2(&zs, 15 + 16), Z_OK);
+    std::vector<unsigned char> in(blocks_[0].size());
+    bool member_start = true;
+    // Whether a member has been fully decoded, only then the data that is
+    // not a gzip member is trailing garbage, as zcat has it.
+    bool member_decoded = false;
+    bool end = false;
+    bool error = false;
+    while (!end) {
+      int idx;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !free_.empty() || stop_; });
+        if (stop_) break;
+        idx = free_.front();
+        free_.pop_front();
+      }
+      auto& block = blocks_[idx];
+      size_t filled = 0;
+      while (filled < block.size()) {
+        if (zs.avail_in == 0) {
+          size_t n = fread(in.data(), 1, in.size(), &*file_);
+          if (n == 0) {
+            error = ferror(&*file_) || !member_start;
+            if (error) LOG(ERROR) << "The gzip file is truncated";
+            end = true;
+            break;
+          }
+          zs.next_in = in.data();
+          zs.avail_in = static_cast<uInt>(n);
+        }
+        zs.next_out = reinterpret_cast<Bytef*>(&block[filled]);
+        zs.avail_out = static_cast<uInt>(block.size() - filled);
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        size_t produced = block.size() - filled - zs.avail_out;
+        filled += produced;
+        if (ret == Z_STREAM_END) {
+          // The next member, if any.
+          CHECK_EQ(inflateReset(&zs), Z_OK);
+          member_start = true;
+          member_decoded = true;
+        } else if (ret == Z_OK || ret == Z_BUF_ERROR) {
+          member_start = member_start && produced == 0 && zs.avail_in != 0;
+        } else if (member_start && member_decoded && ret == Z_DATA_ERROR) {
+          LOG(WARNING) << "Trailing garbage ignored in the gzip file";
+          end = true;
+          break;
+        } else {
+          LOG(ERROR) << "Failed to inflate the gzip file: "
+                     << (zs.msg ? zs.msg : "unknown error");
+          error = true;
+          end = true;
+          break;
+        }
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (filled > 0) {
+        ready_.emplace_back(idx, filled);
+      } else {
+        free_.push_back(idx);
+      }
+      done_ = end;
+      error_ = error;
+      cv_.notify_all();
+    }
+    inflateEnd(&zs);
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+    cv_.notify_all();
+  }
+
+  std::shared_ptr<FILE> file_;
+  std::vector<std::vector<char>> blocks_;
+  std::deque<int> free_;
+  std::deque<std::pair<int, size_t>> ready_;
+  // The block being read by the caller.
+  int cur_{-1};
+  size_t cur_pos_{0};
+  size_t cur_size_{0};
+  bool stop_{false};
+  bool done_{false};
+  bool error_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+};
+
+static std::shared_ptr<FILE> fs_open_inflate_internal(const std::string& path,
+                                                      size_t buffer_size) {
+  constexpr size_t kBlockSize = 1 << 20;
+  constexpr size_t kNumBlocks = 4;
+  auto* reader = new FsInflateReaderInternal(shell_fopen(path, "r"),
+                                             kBlockSize, kNumBlocks);
+  cookie_io_functions_t funcs;
+  memset(&funcs, 0, sizeof(funcs));
+  funcs.read = [](void* cookie, char* buf, size_t size) -> ssize_t {
+    return static_cast<FsInflateReaderInternal*>(cookie)->Read(buf, size);
+  };
+  funcs.close = [](void* cookie) -> int {
+    delete static_cast<FsInflateReaderInternal*>(cookie);
+    return 0;
+  };
+  FILE* fp = fopencookie(reader, "r", funcs);
+  CHECK(fp != nullptr) << "fopencookie fail, path[" << path << "]";
+
+  char* buffer = nullptr;
+  if (buffer_size > 0) {
+    buffer = new char[buffer_size];
+    CHECK_EQ(0, setvbuf(fp, buffer, _IOFBF, buffer_size));
+  }
+  return {fp, [path, buffer](FILE* fp) {
+            if (0 != fclose(fp)) {
+              LOG(FATAL) << "fclose fail, path[" << path << "]";
+            }
+            delete[] buffer;
+          }};
+}
+
 static bool fs_begin_with_internal(const std::string& path,
                                    const std::string& str) {
   return strncmp(path.c_str(), str.c_str(), str.length()) == 0;
@@ -96,11 +280,23 @@ size_t localfs_buffer_size() { return localfs_buffer_size_internal(); }
 
 void localfs_set_buffer_size(size_t x) { localfs_buffer_size_internal() = x; }
 
+static bool& localfs_native_gzip_internal() {
+  static bool x = true;
+  return x;
+}
+
+bool localfs_native_gzip() { return localfs_native_gzip_internal(); }
+
+void localfs_set_native_gzip(bool x) { localfs_native_gzip_internal() = x; }
+
 std::shared_ptr<FILE> localfs_open_read(std::string path,
                                         const std::string& converter) {
   bool is_pipe = false;
 
   if (fs_end_with_internal(path, ".gz")) {
+    if (localfs_native_gzip() && converter == "") {
+      return fs_open_inflate_internal(path, localfs_buffer_size());
+    }
     fs_add_read_converter_internal(path, is_pipe, "zcat");
   }
 
@@ -31,6 +31,12 @@ extern size_t localfs_buffer_size();
 
 extern void localfs_set_buffer_size(size_t x);
 
+// Whether the .gz files are inflated in process instead of by a zcat pipe,
+// true by default. A converter still makes it a pipe.
+extern bool localfs_native_gzip();
+
+extern void localfs_set_native_gzip(bool x);
+
 extern std::shared_ptr<FILE> localfs_open_read(std::string path,
                                                const std::string& converter);
 
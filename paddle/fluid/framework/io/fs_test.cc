@@ -0,0 +1,187 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/fs.h"
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+// Lines in the MultiSlot format: <num> <id>... for every slot.
+static std::string MakeMultiSlotData(int num_lines) {
+  std::string data;
+  for (int i = 0; i < num_lines; ++i) {
+    for (int slot = 0; slot < 4; ++slot) {
+      int num = 1 + (i + slot) % 5;
+      data += std::to_string(num);
+      for (int j = 0; j < num; ++j) {
+        data += " " + std::to_string((i * 131 + slot * 17 + j) % 100003);
+      }
+      data += slot == 3 ? "\n" : " ";
+    }
+  }
+  return data;
+}
+
+// Writes every part as a separate gzip member, as `cat a.gz b.gz` does.
+static void WriteGzip(const std::string& path,
+                      const std::vector<std::string>& parts) {
+  for (size_t i = 0; i < parts.size(); ++i) {
+    gzFile gz = gzopen(path.c_str(), i == 0 ? "wb" : "ab");
+    ASSERT_TRUE(gz != nullptr);
+    ASSERT_EQ(gzwrite(gz, parts[i].data(), parts[i].size()),
+              static_cast<int>(parts[i].size()));
+    ASSERT_EQ(gzclose(gz), Z_OK);
+  }
+}
+
+static std::string ReadAll(const std::string& path, double* seconds,
+                           bool* error = nullptr) {
+  auto start = std::chrono::steady_clock::now();
+  int err_no = 0;
+  std::shared_ptr<FILE> fp = fs_open_read(path, &err_no, "");
+  std::string data;
+  char buf[64 * 1024];
+  size_t n = 0;
+  while ((n = fread(buf, 1, sizeof(buf), &*fp)) > 0) {
+    data.append(buf, n);
+  }
+  if (error) {
+    *error = ferror(&*fp) != 0;
+  }
+  fp = nullptr;
+  *seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start)
+                 .count();
+  return data;
+}
+
+TEST(localfs, native_gzip_read) {
+  std::string part = MakeMultiSlotData(200000);
+  std::string expected = part + part + part;
+  std::string gz_path = "fs_test_multi_slot.gz";
+  WriteGzip(gz_path, {part, part, part});
+
+  double native_seconds = 0;
+  double zcat_seconds = 0;
+  localfs_set_native_gzip(true);
+  EXPECT_EQ(ReadAll(gz_path, &native_seconds), expected);
+  localfs_set_native_gzip(false);
+  EXPECT_EQ(ReadAll(gz_path, &zcat_seconds), expected);
+  localfs_set_native_gzip(true);
+
+  double mb = expected.size() / 1e6;
+  VLOG(1) << "read " << mb << " MB of gzip, native " << mb / native_seconds
+          << " MB/s, zcat " << mb / zcat_seconds << " MB/s";
+  localfs_remove(gz_path);
+}
+
+TEST(localfs, native_gzip_empty) {
+  std::string gz_path = "fs_test_empty.gz";
+  WriteGzip(gz_path, {""});
+  double seconds = 0;
+  EXPECT_EQ(ReadAll(gz_path, &seconds), "");
+  localfs_remove(gz_path);
+}
+
+// Rewrites the file with the given bytes of it.
+static void RewriteFile(const std::string& path,
+                        const std::function<void(std::string*)>& edit) {
+  std::string bytes;
+  {
+    std::ifstream fin(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(fin),
+                 std::istreambuf_iterator<char>());
+  }
+  edit(&bytes);
+  std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+  fout.write(bytes.data(), bytes.size());
+}
+
+TEST(localfs, native_gzip_truncated) {
+  std::string part = MakeMultiSlotData(100000);
+  std::string gz_path = "fs_test_truncated.gz";
+  WriteGzip(gz_path, {part});
+  RewriteFile(gz_path, [](std::string* bytes) {
+    bytes->resize(bytes->size() * 2 / 3);
+  });
+
+  double seconds = 0;
+  bool error = false;
+  std::string data = ReadAll(gz_path, &seconds, &error);
+  EXPECT_TRUE(error);
+  // what is inflated before the end is still returned
+  EXPECT_LT(data.size(), part.size());
+  EXPECT_EQ(data, part.substr(0, data.size()));
+  localfs_remove(gz_path);
+}
+
+TEST(localfs, native_gzip_corrupt) {
+  std::string part = MakeMultiSlotData(100000);
+  std::string gz_path = "fs_test_corrupt.gz";
+  WriteGzip(gz_path, {part});
+  RewriteFile(gz_path, [](std::string* bytes) {
+    for (size_t i = bytes->size() / 2; i < bytes->size() / 2 + 64; ++i) {
+      (*bytes)[i] = static_cast<char>(~(*bytes)[i]);
+    }
+  });
+
+  double seconds = 0;
+  bool error = false;
+  std::string data = ReadAll(gz_path, &seconds, &error);
+  // the corrupt data is inflated to garbage until the crc check fails
+  EXPECT_TRUE(error);
+  EXPECT_NE(data, part);
+  localfs_remove(gz_path);
+}
+
+TEST(localfs, native_gzip_trailing_garbage) {
+  std::string part = MakeMultiSlotData(1000);
+  std::string gz_path = "fs_test_trailing_garbage.gz";
+  WriteGzip(gz_path, {part});
+  RewriteFile(gz_path, [](std::string* bytes) {
+    bytes->append("not a gzip member");
+  });
+
+  double seconds = 0;
+  bool error = true;
+  EXPECT_EQ(ReadAll(gz_path, &seconds, &error), part);
+  EXPECT_FALSE(error);
+  localfs_remove(gz_path);
+}
+
+TEST(localfs, native_gzip_not_gzip) {
+  std::string gz_path = "fs_test_plain_text.gz";
+  {
+    std::ofstream fout(gz_path, std::ios::binary | std::ios::trunc);
+    fout << MakeMultiSlotData(10);
+  }
+
+  // a file which is not gzip at all fails, as with zcat
+  double seconds = 0;
+  bool error = false;
+  EXPECT_EQ(ReadAll(gz_path, &seconds, &error), "");
+  EXPECT_TRUE(error);
+  localfs_remove(gz_path);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,219 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/common_subexpression_elimination_pass.h"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+const std::unordered_set<std::string>&
+CommonSubexpressionEliminationPass::DeterministicOpTypes() {
+  static std::unordered_set<std::string> ops = {
+      "shape",           "cast",           "sequence_mask",
+      "lookup_table",    "transpose",      "transpose2",
+      "reshape",         "reshape2",       "squeeze",
+      "squeeze2",        "unsqueeze",      "unsqueeze2",
+      "flatten",         "flatten2",       "scale",
+      "elementwise_add", "elementwise_sub", "elementwise_mul",
+      "elementwise_div", "matmul",         "mul",
+      "fc",              "softmax",        "relu",
+      "sigmoid",         "tanh",           "slice",
+      "concat",          "split",          "stack",
+      "gather",          "expand",         "fill_constant",
+      "fill_constant_batch_size_like",     "sequence_expand",
+      "layer_norm",      "reduce_sum",     "reduce_mean",
+  };
+  return ops;
+}
+
+namespace {
+
+bool IsIgnoredAttr(const std::string& name) {
+  return name == OpProtoAndCheckerMaker::OpRoleAttrName() ||
+         name == OpProtoAndCheckerMaker::OpRoleVarAttrName() ||
+         name == OpProtoAndCheckerMaker::OpNamescopeAttrName() ||
+         name == OpProtoAndCheckerMaker::OpCreationCallstackAttrName();
+}
+
+bool SameAttrs(const OpDesc& a, const OpDesc& b) {
+  size_t count = 0;
+  for (auto& attr : a.GetAttrMap()) {
+    if (IsIgnoredAttr(attr.first)) continue;
+    if (!b.HasAttr(attr.first) || !(b.GetAttr(attr.first) == attr.second)) {
+      return false;
+    }
+    ++count;
+  }
+  for (auto& attr : b.GetAttrMap()) {
+    if (!IsIgnoredAttr(attr.first)) --count;
+  }
+  return count == 0;
+}
+
+bool HasSubBlock(const OpDesc& op) {
+  for (auto& attr : op.GetAttrMap()) {
+    auto type = op.GetAttrType(attr.first);
+    if (type == proto::AttrType::BLOCK || type == proto::AttrType::BLOCKS) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Besides the type, the desc itself must not make the op stateful: a random
+// seed, a sub-block, or an output written in place of an input.
+bool IsStateful(const OpDesc& op) {
+  if (op.HasAttr("seed") || op.HasAttr("fix_seed") || HasSubBlock(op)) {
+    return true;
+  }
+  auto inputs = op.InputArgumentNames();
+  for (auto& name : op.OutputArgumentNames()) {
+    if (std::find(inputs.begin(), inputs.end(), name) != inputs.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Node* FindVarNode(const std::vector<Node*>& nodes, const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+// The type and the input nodes of every input slot, the attributes are
+// compared only when the keys are the same.
+std::string OpKey(const Node& node) {
+  auto* op = node.Op();
+  std::string key = op->Type();
+  std::map<std::string, std::vector<std::string>> inputs(
+      op->Inputs().begin(), op->Inputs().end());
+  for (auto& slot : inputs) {
+    key += ";" + slot.first + ":";
+    for (auto& name : slot.second) {
+      auto* in = FindVarNode(node.inputs, name);
+      key += std::to_string(in ? in->id() : -1) + ",";
+    }
+  }
+  std::map<std::string, std::vector<std::string>> outputs(
+      op->Outputs().begin(), op->Outputs().end());
+  for (auto& slot : outputs) {
+    key += ";" + slot.first + ":" + std::to_string(slot.second.size());
+  }
+  return key;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> CommonSubexpressionEliminationPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("common_subexpression_elimination", graph.get());
+
+  std::unordered_map<std::string, int> var_count;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) ++var_count[node->Name()];
+  }
+  // The outputs are renamed in the consumers, so they must be the only
+  // version of their names, and must not be persistable, fetched, or read
+  // by a sub-block, whose ops are not renamed.
+  auto used_by_other_blocks = VarsUsedByOtherBlocks(*graph);
+  auto can_merge = [&](const Node& op) {
+    if (!DeterministicOpTypes().count(op.Op()->Type())) return false;
+    if (IsStateful(*op.Op())) return false;
+    if (op.inputs.empty() && op.Op()->Type() != "fill_constant") {
+      return false;
+    }
+    for (auto* in : op.inputs) {
+      if (!in->IsVar() || !in->Var()) return false;
+    }
+    for (auto* out : op.outputs) {
+      if (!out->Var() || out->Var()->Persistable() ||
+          var_count.at(out->Name()) != 1 ||
+          used_by_other_blocks.count(out->Name())) {
+        return false;
+      }
+      for (auto* consumer : out->outputs) {
+        if (consumer->IsOp() && (consumer->Op()->Type() == "fetch" ||
+                                 HasSubBlock(*consumer->Op()))) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  std::unordered_map<std::string, std::vector<Node*>> kept_ops;
+  std::unordered_set<const Node*> to_remove;
+  int merged_count = 0;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (!can_merge(*node)) continue;
+    auto& candidates = kept_ops[OpKey(*node)];
+    Node* same = nullptr;
+    for (auto* candidate : candidates) {
+      if (SameAttrs(*candidate->Op(), *node->Op())) {
+        same = candidate;
+        break;
+      }
+    }
+    if (!same) {
+      candidates.push_back(node);
+      continue;
+    }
+
+    VLOG(4) << "merge duplicated " << node->Op()->Type();
+    for (auto& slot : node->Op()->Outputs()) {
+      auto& kept_names = same->Op()->Output(slot.first);
+      for (size_t i = 0; i < slot.second.size(); ++i) {
+        Node* old_var = FindVarNode(node->outputs, slot.second[i]);
+        Node* new_var = FindVarNode(same->outputs, kept_names[i]);
+        PADDLE_ENFORCE(old_var && new_var);
+        for (auto* consumer : old_var->outputs) {
+          consumer->Op()->RenameInput(old_var->Name(), new_var->Name());
+          std::replace(consumer->inputs.begin(), consumer->inputs.end(),
+                       old_var, new_var);
+          if (std::find(new_var->outputs.begin(), new_var->outputs.end(),
+                        consumer) == new_var->outputs.end()) {
+            new_var->outputs.push_back(consumer);
+          }
+        }
+        old_var->outputs.clear();
+        to_remove.insert(old_var);
+      }
+    }
+    to_remove.insert(node);
+    ++merged_count;
+  }
+
+  GraphSafeRemoveNodes(graph.get(), to_remove);
+  AddStatis(merged_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(common_subexpression_elimination_pass,
+              paddle::framework::ir::CommonSubexpressionEliminationPass);
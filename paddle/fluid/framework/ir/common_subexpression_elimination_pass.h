@@ -0,0 +1,49 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Merges the operators of the same type and attributes reading the same
+ * input variables, e.g. the shape or cast of one variable computed several
+ * times, and lets the consumers of the removed duplicates read the outputs
+ * of the one kept. Only the deterministic operators without side effects in
+ * DeterministicOpTypes() are merged, and only if their descs have no seed,
+ * no sub-block and no in-place output. The outputs read by a sub-block are
+ * never renamed.
+ */
+class CommonSubexpressionEliminationPass : public FusePassBase {
+ public:
+  virtual ~CommonSubexpressionEliminationPass() {}
+
+  // The operators whose outputs only depend on their inputs and attributes.
+  static const std::unordered_set<std::string>& DeterministicOpTypes();
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,154 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/common_subexpression_elimination_pass.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <unordered_map>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+OpDesc* AppendOp(ProgramDesc* prog, const std::string& type,
+                 const std::vector<std::string>& inputs,
+                 const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetInput("X", inputs);
+  op->SetOutput("Out", outputs);
+  return op;
+}
+
+// x->shape->s1->cast->c1
+// x->shape->s2->cast->c2
+// (c1, c2)->elementwise_add->d
+// x->scale(2)->e1, x->scale(2)->e2, x->scale(3)->e3
+// x->dropout->f1, x->dropout->f2
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>({"x", "s1", "s2", "c1", "c2", "d",
+                                           "e1", "e2", "e3", "f1", "f2"})) {
+    prog.MutableBlock(0)->Var(v)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  AppendOp(&prog, "shape", {"x"}, {"s1"});
+  AppendOp(&prog, "shape", {"x"}, {"s2"});
+  AppendOp(&prog, "cast", {"s1"}, {"c1"})->SetAttr("out_dtype", 5);
+  AppendOp(&prog, "cast", {"s2"}, {"c2"})->SetAttr("out_dtype", 5);
+  auto* add = AppendOp(&prog, "elementwise_add", {"c1"}, {"d"});
+  add->SetInput("Y", {"c2"});
+  AppendOp(&prog, "scale", {"x"}, {"e1"})->SetAttr("scale", 2.0f);
+  AppendOp(&prog, "scale", {"x"}, {"e2"})->SetAttr("scale", 2.0f);
+  AppendOp(&prog, "scale", {"x"}, {"e3"})->SetAttr("scale", 3.0f);
+  AppendOp(&prog, "dropout", {"x"}, {"f1"});
+  AppendOp(&prog, "dropout", {"x"}, {"f2"});
+  return prog;
+}
+
+TEST(CommonSubexpressionEliminationPass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+
+  auto pass =
+      PassRegistry::Instance().Get("common_subexpression_elimination_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, int> op_count;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    ++op_count[op->Type()];
+    if (op->Type() == "elementwise_add") {
+      EXPECT_EQ(op->Input("X")[0], "c1");
+      EXPECT_EQ(op->Input("Y")[0], "c1");
+      ASSERT_EQ(node->inputs.size(), 2UL);
+      EXPECT_EQ(node->inputs[0]->Name(), "c1");
+      EXPECT_EQ(node->inputs[1]->Name(), "c1");
+    }
+  }
+  EXPECT_EQ(op_count["shape"], 1);
+  EXPECT_EQ(op_count["cast"], 1);
+  EXPECT_EQ(op_count["elementwise_add"], 1);
+  // the attributes are different
+  EXPECT_EQ(op_count["scale"], 2);
+  // random operators are never merged
+  EXPECT_EQ(op_count["dropout"], 2);
+
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) {
+      EXPECT_NE(node->Name(), "s2");
+      EXPECT_NE(node->Name(), "c2");
+      EXPECT_NE(node->Name(), "e2");
+    }
+  }
+  auto& statis =
+      graph->Get<std::unordered_map<std::string, int>>(kFuseStatisAttr);
+  EXPECT_EQ(statis.at("common_subexpression_elimination"), 3);
+}
+
+TEST(CommonSubexpressionEliminationPass, keep_read_by_sub_block) {
+  auto prog = BuildProgramDesc();
+  for (auto& v : std::vector<std::string>({"g1", "g2", "h1", "h2", "y"})) {
+    prog.MutableBlock(0)->Var(v)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  // g2 is read by an op of the sub-block
+  AppendOp(&prog, "transpose", {"x"}, {"g1"});
+  AppendOp(&prog, "transpose", {"x"}, {"g2"});
+  // h2 is an input of the op owning the sub-block
+  AppendOp(&prog, "reshape", {"x"}, {"h1"});
+  AppendOp(&prog, "reshape", {"x"}, {"h2"});
+  auto* sub_block = prog.AppendBlock(prog.Block(0));
+  auto* cond = AppendOp(&prog, "conditional_block", {"h2"}, {"y"});
+  cond->SetBlockAttr("sub_block", sub_block);
+  auto* op = sub_block->AppendOp();
+  op->SetType("scale");
+  op->SetInput("X", {"g2"});
+  op->SetOutput("Out", {"y"});
+  // an op with a seed is stateful whatever its type
+  AppendOp(&prog, "scale", {"x"}, {"e4"})->SetAttr("seed", 1);
+  AppendOp(&prog, "scale", {"x"}, {"e5"})->SetAttr("seed", 1);
+  for (auto& v : std::vector<std::string>({"e4", "e5"})) {
+    prog.MutableBlock(0)->Var(v)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+
+  auto pass =
+      PassRegistry::Instance().Get("common_subexpression_elimination_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::map<std::string, int> op_count;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp()) {
+      ++op_count[node->Op()->Type()];
+      if (node->Op()->Type() == "conditional_block") {
+        EXPECT_EQ(node->Op()->Input("X")[0], "h2");
+      }
+    }
+  }
+  EXPECT_EQ(op_count["transpose"], 2);
+  EXPECT_EQ(op_count["reshape"], 2);
+  // scale(2) is still merged, the seeded ones are not
+  EXPECT_EQ(op_count["scale"], 4);
+  EXPECT_EQ(prog.Block(1).Op(0)->Input("X")[0], "g2");
+  auto& statis =
+      graph->Get<std::unordered_map<std::string, int>>(kFuseStatisAttr);
+  EXPECT_EQ(statis.at("common_subexpression_elimination"), 3);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(common_subexpression_elimination_pass);
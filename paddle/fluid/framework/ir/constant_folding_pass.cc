@@ -0,0 +1,225 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+#include <exception>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The operators whose results are not fixed before running, because they are
+// random, have side effects or depend on the runtime states.
+const std::unordered_set<std::string>& UnfoldableOps() {
+  static std::unordered_set<std::string> ops = {
+      "feed",
+      "fetch",
+      "read",
+      "print",
+      "save",
+      "load",
+      "save_combine",
+      "load_combine",
+      "uniform_random",
+      "uniform_random_batch_size_like",
+      "gaussian_random",
+      "gaussian_random_batch_size_like",
+      "truncated_gaussian_random",
+      "sampling_id",
+      "random_crop",
+      "dropout",
+      "while",
+      "conditional_block",
+      "recurrent",
+      "send",
+      "recv",
+      "py_func",
+      "delete_var",
+  };
+  return ops;
+}
+
+// The operators without inputs whose outputs are constants.
+const std::unordered_set<std::string>& ConstantSourceOps() {
+  static std::unordered_set<std::string> ops = {"fill_constant",
+                                                "assign_value"};
+  return ops;
+}
+
+bool IsInitializedParam(const Node& node, const Scope& scope) {
+  if (!node.IsVar() || !node.Var() || !node.Var()->Persistable() ||
+      !node.inputs.empty()) {
+    return false;
+  }
+  auto* var = scope.FindVar(node.Name());
+  return var && var->IsType<LoDTensor>() &&
+         var->Get<LoDTensor>().IsInitialized();
+}
+
+bool IsFoldable(const Node& node,
+                const std::unordered_set<const Node*>& constants,
+                const std::unordered_map<std::string, int>& var_count) {
+  auto* op = node.Op();
+  if (!op || UnfoldableOps().count(op->Type()) || op->HasAttr("sub_block")) {
+    return false;
+  }
+  if (node.inputs.empty() && !ConstantSourceOps().count(op->Type())) {
+    return false;
+  }
+  for (auto* in : node.inputs) {
+    if (!constants.count(in)) {
+      return false;
+    }
+  }
+  if (node.outputs.empty()) {
+    return false;
+  }
+  // The outputs become persistable, so they must not be written by others.
+  for (auto* out : node.outputs) {
+    if (!out->Var() || out->Var()->Persistable() ||
+        out->Var()->GetType() != proto::VarType::LOD_TENSOR ||
+        var_count.at(out->Name()) != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Runs the operator in a temporary child scope, and moves its outputs into
+// the scope if it succeeds. Returns false if the operator could not be run on
+// CPU, in which case nothing is left in the scope.
+bool RunOp(const Node& node, Scope* scope) {
+  OpDesc desc(*node.Op(), nullptr);
+  if (desc.HasAttr("is_test")) {
+    desc.SetAttr("is_test", true);
+  }
+  Scope& run_scope = scope->NewScope();
+  bool success = true;
+  try {
+    auto op = OpRegistry::CreateOp(desc);
+    for (auto* out : node.outputs) {
+      run_scope.Var(out->Name())->GetMutable<LoDTensor>();
+    }
+    op->Run(run_scope, platform::CPUPlace());
+  } catch (std::exception& e) {
+    VLOG(3) << "Cannot fold " << desc.Type() << ": " << e.what();
+    success = false;
+  }
+  if (success) {
+    for (auto* out : node.outputs) {
+      *scope->Var(out->Name())->GetMutable<LoDTensor>() =
+          run_scope.FindLocalVar(out->Name())->Get<LoDTensor>();
+    }
+  }
+  scope->DeleteScope(&run_scope);
+  return success;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> ConstantFoldingPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("constant_folding", graph.get());
+  auto* scope = param_scope();
+  PADDLE_ENFORCE(scope);
+
+  std::unordered_set<const Node*> constants;
+  std::unordered_map<std::string, int> var_count;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsVar()) continue;
+    ++var_count[node->Name()];
+    if (IsInitializedParam(*node, *scope)) {
+      constants.insert(node);
+    }
+  }
+
+  std::vector<Node*> folded_ops;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (IsFoldable(*node, constants, var_count) && RunOp(*node, scope)) {
+      VLOG(4) << "fold " << node->Op()->Type();
+      folded_ops.push_back(node);
+      constants.insert(node->outputs.begin(), node->outputs.end());
+    }
+  }
+  if (folded_ops.empty()) {
+    AddStatis(0);
+    return graph;
+  }
+
+  // The constants used by the remaining operators are kept as persistable
+  // variables, the others are removed along with the folded operators.
+  std::unordered_set<const Node*> to_remove(folded_ops.begin(),
+                                            folded_ops.end());
+  auto is_used = [&](const Node* var) {
+    for (auto* op : var->outputs) {
+      if (!to_remove.count(op)) return true;
+    }
+    return false;
+  };
+  for (auto* op : folded_ops) {
+    for (auto* in : op->inputs) {
+      if (!is_used(in)) {
+        to_remove.insert(in);
+      }
+    }
+    for (auto* out : op->outputs) {
+      if (!is_used(out)) {
+        to_remove.insert(out);
+        continue;
+      }
+      auto& tensor = scope->FindVar(out->Name())->Get<LoDTensor>();
+      out->Var()->SetPersistable(true);
+      out->Var()->SetShape(framework::vectorize(tensor.dims()));
+      out->Var()->SetDataType(tensor.type());
+    }
+  }
+
+  // A variable is only erased from the scope when nothing consumes it, i.e.
+  // it is not kept in the graph or read by any other block.
+  std::unordered_set<std::string> kept_vars = VarsUsedByOtherBlocks(*graph);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && !to_remove.count(node)) {
+      kept_vars.insert(node->Name());
+    }
+  }
+  std::vector<std::string> erased_vars;
+  for (auto* node : to_remove) {
+    if (node->IsVar() && !kept_vars.count(node->Name())) {
+      erased_vars.push_back(node->Name());
+    }
+  }
+  GraphSafeRemoveNodes(graph.get(), to_remove);
+  scope->EraseVars(erased_vars);
+
+  AddStatis(folded_ops.size());
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(constant_folding_pass,
+              paddle::framework::ir::ConstantFoldingPass);
@@ -0,0 +1,162 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+OpDesc* AppendOp(ProgramDesc* prog, const std::string& type,
+                 const std::vector<std::string>& x,
+                 const std::vector<std::string>& y,
+                 const std::vector<std::string>& out) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (!x.empty()) op->SetInput("X", x);
+  if (!y.empty()) op->SetInput("Y", y);
+  op->SetOutput("Out", out);
+  return op;
+}
+
+// w->scale->w_scaled
+// fill_constant->ones
+// (w_scaled, ones)->elementwise_add->w_sum
+// (x, w_sum)->elementwise_add->y
+// (x, bias)->elementwise_add->z
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"x", "w", "w_scaled", "ones", "w_sum", "y", "bias", "z"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    if (v == "w" || v == "bias") {
+      var->SetPersistable(true);
+    }
+  }
+
+  AppendOp(&prog, "scale", {"w"}, {}, {"w_scaled"})->SetAttr("scale", 2.0f);
+  auto* fill = AppendOp(&prog, "fill_constant", {}, {}, {"ones"});
+  fill->SetAttr("shape", std::vector<int64_t>({2, 3}));
+  fill->SetAttr("value", 1.0f);
+  fill->SetAttr("dtype", static_cast<int>(proto::VarType::FP32));
+  AppendOp(&prog, "elementwise_add", {"w_scaled"}, {"ones"}, {"w_sum"});
+  AppendOp(&prog, "elementwise_add", {"x"}, {"w_sum"}, {"y"});
+  AppendOp(&prog, "elementwise_add", {"x"}, {"bias"}, {"z"});
+  return prog;
+}
+
+void InitTensor(Scope* scope, const std::string& name, float start) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  auto* data =
+      tensor->mutable_data<float>(make_ddim({2, 3}), platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) {
+    data[i] = start + i;
+  }
+}
+
+TEST(ConstantFoldingPass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  Scope scope;
+  InitTensor(&scope, "w", 0.0f);
+  InitTensor(&scope, "bias", 1.0f);
+  graph->Set(kParamScopeAttr, new framework::Scope*(&scope));
+
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int op_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp()) {
+      ++op_count;
+      EXPECT_EQ(node->Op()->Type(), "elementwise_add");
+    } else if (node->IsVar()) {
+      // the intermediate constants and the unused weight are removed
+      EXPECT_NE(node->Name(), "w");
+      EXPECT_NE(node->Name(), "w_scaled");
+      EXPECT_NE(node->Name(), "ones");
+      if (node->Name() == "w_sum") {
+        EXPECT_TRUE(node->Var()->Persistable());
+      }
+    }
+  }
+  EXPECT_EQ(op_count, 2);
+
+  EXPECT_EQ(scope.FindVar("w"), nullptr);
+  EXPECT_EQ(scope.FindVar("w_scaled"), nullptr);
+  EXPECT_NE(scope.FindVar("bias"), nullptr);
+  auto& w_sum = scope.FindVar("w_sum")->Get<LoDTensor>();
+  ASSERT_EQ(w_sum.dims(), make_ddim({2, 3}));
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_FLOAT_EQ(w_sum.data<float>()[i], 2.0f * i + 1.0f);
+  }
+}
+
+TEST(ConstantFoldingPass, keep_consumed_and_failed) {
+  auto prog = BuildProgramDesc();
+  // v cannot be added to w_sum, so the op is not folded
+  for (auto& v : std::vector<std::string>({"v", "bad"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetPersistable(v == "v");
+  }
+  AppendOp(&prog, "elementwise_add", {"w_sum"}, {"v"}, {"bad"});
+  // w is still read by a sub-block
+  auto* sub_block = prog.AppendBlock(prog.Block(0));
+  auto* op = sub_block->AppendOp();
+  op->SetType("scale");
+  op->SetInput("X", {"w"});
+  op->SetOutput("Out", {"w_sub"});
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  Scope scope;
+  InitTensor(&scope, "w", 0.0f);
+  InitTensor(&scope, "bias", 1.0f);
+  auto* v = scope.Var("v")->GetMutable<LoDTensor>();
+  v->mutable_data<float>(make_ddim({4, 5}), platform::CPUPlace());
+  graph->Set(kParamScopeAttr, new framework::Scope*(&scope));
+
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int op_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp()) {
+      ++op_count;
+    }
+  }
+  EXPECT_EQ(op_count, 3);
+  EXPECT_NE(scope.FindVar("w"), nullptr);
+  EXPECT_EQ(scope.FindVar("w_scaled"), nullptr);
+  EXPECT_NE(scope.FindVar("w_sum"), nullptr);
+  // nothing is left by the failed op
+  EXPECT_EQ(scope.FindVar("bad"), nullptr);
+  EXPECT_TRUE(scope.kids().empty());
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(constant_folding_pass);
+USE_OP(scale);
+USE_OP(fill_constant);
+USE_OP(elementwise_add);
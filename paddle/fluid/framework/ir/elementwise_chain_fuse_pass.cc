@@ -0,0 +1,268 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/elementwise_chain_fuse_pass.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/operators/jit/kernel_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+namespace jit = paddle::operators::jit;
+
+// the op of the chain and its reversed one, which takes Y as the first
+// operand, in the chain_ops attribute of fusion_elementwise_chain
+struct BinaryChainOp {
+  std::string op;
+  std::string reversed_op;
+};
+
+const std::unordered_map<std::string, BinaryChainOp>& BinaryOps() {
+  static std::unordered_map<std::string, BinaryChainOp> ops = {
+      {"elementwise_add", {"add", "add"}}, {"elementwise_sub", {"sub", "rsub"}},
+      {"elementwise_mul", {"mul", "mul"}}, {"elementwise_div", {"div", "rdiv"}},
+      {"elementwise_max", {"max", "max"}}, {"elementwise_min", {"min", "min"}}};
+  return ops;
+}
+
+// named the same in chain_ops
+const std::unordered_set<std::string>& UnaryOps() {
+  static std::unordered_set<std::string> ops = {"relu", "sigmoid", "tanh",
+                                                "exp",  "square",  "scale"};
+  return ops;
+}
+
+jit::ChainOpType ToChainOpType(const std::string& op) {
+  static std::unordered_map<std::string, jit::ChainOpType> types = {
+      {"add", jit::kChainAdd},         {"sub", jit::kChainSub},
+      {"rsub", jit::kChainRSub},       {"mul", jit::kChainMul},
+      {"div", jit::kChainDiv},         {"rdiv", jit::kChainRDiv},
+      {"max", jit::kChainMax},         {"min", jit::kChainMin},
+      {"scale", jit::kChainScale},     {"relu", jit::kChainRelu},
+      {"sigmoid", jit::kChainSigmoid}, {"tanh", jit::kChainTanh},
+      {"exp", jit::kChainExp},         {"square", jit::kChainSquare}};
+  return types.at(op);
+}
+
+bool IsFP32Var(const Node* var) {
+  return var && var->IsVar() && var->Var() &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         var->Var()->GetDataType() == proto::VarType::FP32;
+}
+
+Node* FindInput(const Node* op, const std::string& slot) {
+  auto& names = op->Op()->Input(slot);
+  if (names.size() != 1) return nullptr;
+  for (auto* in : op->inputs) {
+    if (in->Name() == names[0]) return in;
+  }
+  return nullptr;
+}
+
+Node* SingleOutput(const Node* op) {
+  auto& names = op->Op()->Output("Out");
+  if (names.size() != 1 || op->outputs.size() != 1 ||
+      op->outputs[0]->Name() != names[0]) {
+    return nullptr;
+  }
+  return op->outputs[0];
+}
+
+// y can be read along with x in the chain if it has the shape of x, or of the
+// trailing dims of x, which is what the axis of the elementwise op means.
+bool CanBroadcastTo(const Node* y, const std::vector<int64_t>& x_dims,
+                    int axis) {
+  auto y_dims = y->Var()->GetShape();
+  if (y_dims.empty() || y_dims.size() > x_dims.size()) return false;
+  int trailing = static_cast<int>(x_dims.size() - y_dims.size());
+  if (axis != -1 && axis != trailing) return false;
+  for (size_t i = 0; i < y_dims.size(); ++i) {
+    if (y_dims[i] != x_dims[trailing + i]) return false;
+    // the number of repeats of y is only known at runtime
+    if (trailing > 0 && y_dims[i] < 0) return false;
+  }
+  return true;
+}
+
+struct Chain {
+  Node* x{nullptr};
+  std::vector<Node*> ys;
+  std::vector<std::string> ops;
+  std::vector<float> scales;
+  std::vector<float> biases;
+  std::vector<Node*> nodes;  // the ops and the intermediate vars
+  Node* out{nullptr};
+  jit::elementwise_chain_attr_t attr;
+};
+
+// Appends the op to the chain if it reads the running value, returns false
+// otherwise.
+bool AppendToChain(Node* op, Node* running, Chain* chain) {
+  auto* desc = op->Op();
+  const std::string& type = desc->Type();
+  if (desc->HasAttr("use_mkldnn") &&
+      boost::get<bool>(desc->GetAttr("use_mkldnn"))) {
+    return false;
+  }
+  Node* out = SingleOutput(op);
+  if (!IsFP32Var(out)) return false;
+  auto x_dims = running->Var()->GetShape();
+
+  auto binary = BinaryOps().find(type);
+  if (binary != BinaryOps().end()) {
+    Node* x = FindInput(op, "X");
+    Node* y = FindInput(op, "Y");
+    if (!IsFP32Var(x) || !IsFP32Var(y) || x == y) return false;
+    int axis = boost::get<int>(desc->GetAttr("axis"));
+    Node* other = nullptr;
+    std::string chain_op;
+    if (x == running && CanBroadcastTo(y, x_dims, axis)) {
+      other = y;
+      chain_op = binary->second.op;
+    } else if (y == running && x->Var()->GetShape() == x_dims) {
+      other = x;
+      chain_op = binary->second.reversed_op;
+    } else {
+      return false;
+    }
+    if (!chain->attr.Append(ToChainOpType(chain_op))) return false;
+    chain->ys.push_back(other);
+    chain->ops.push_back(chain_op);
+    chain->scales.push_back(1.f);
+    chain->biases.push_back(0.f);
+  } else if (UnaryOps().count(type)) {
+    if (FindInput(op, "X") != running || op->inputs.size() != 1) {
+      return false;
+    }
+    float scale = 1.f;
+    float bias = 0.f;
+    if (type == "scale") {
+      scale = boost::get<float>(desc->GetAttr("scale"));
+      bias = boost::get<float>(desc->GetAttr("bias"));
+      if (!boost::get<bool>(desc->GetAttr("bias_after_scale"))) {
+        bias *= scale;
+      }
+    }
+    if (!chain->attr.Append(ToChainOpType(type), scale, bias)) {
+      return false;
+    }
+    chain->ops.push_back(type);
+    chain->scales.push_back(scale);
+    chain->biases.push_back(bias);
+  } else {
+    return false;
+  }
+  if (out->Var()->GetShape() != x_dims) {
+    // should not happen since the op is elementwise, but be conservative
+    return false;
+  }
+  if (chain->x == nullptr) {
+    chain->x = running;
+  } else {
+    chain->nodes.push_back(running);
+  }
+  chain->nodes.push_back(op);
+  chain->out = out;
+  return true;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> ElementwiseChainFusePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init(name_scope_, graph.get());
+
+  std::unordered_map<std::string, int> var_count;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) ++var_count[node->Name()];
+  }
+  // the intermediate outputs are removed, so they must be only read by the
+  // next op of the chain
+  auto is_intermediate = [&](const Node* var) {
+    if (var->Var()->Persistable() || var_count.at(var->Name()) != 1 ||
+        var->outputs.size() != 1) {
+      return false;
+    }
+    return var->outputs[0]->IsOp() && var->outputs[0]->Op()->Type() != "fetch";
+  };
+
+  std::unordered_set<const Node*> fused;
+  std::unordered_set<const Node*> to_remove;
+  int fusion_count = 0;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (fused.count(node)) continue;
+    Node* head_x = FindInput(node, "X");
+    if (!IsFP32Var(head_x)) continue;
+    Chain chain;
+    // a failed append could have changed the attr, so try on a copy
+    Chain trial = chain;
+    if (!AppendToChain(node, head_x, &trial)) continue;
+    chain = trial;
+    while (is_intermediate(chain.out)) {
+      trial = chain;
+      Node* next = chain.out->outputs[0];
+      if (fused.count(next) || !AppendToChain(next, chain.out, &trial)) {
+        break;
+      }
+      chain = trial;
+    }
+    if (chain.ops.size() < 2) continue;
+
+    VLOG(4) << "fuse a chain of " << chain.ops.size() << " elementwise ops";
+    OpDesc desc;
+    desc.SetType("fusion_elementwise_chain");
+    desc.SetInput("X", {chain.x->Name()});
+    std::vector<std::string> ys_names;
+    for (auto* y : chain.ys) {
+      ys_names.push_back(y->Name());
+    }
+    desc.SetInput("Ys", ys_names);
+    desc.SetOutput("Out", {chain.out->Name()});
+    desc.SetAttr("chain_ops", chain.ops);
+    desc.SetAttr("scales", chain.scales);
+    desc.SetAttr("biases", chain.biases);
+    auto* fused_node = graph->CreateOpNode(&desc);
+
+    for (auto* n : chain.nodes) {
+      if (n->IsOp()) fused.insert(n);
+      to_remove.insert(n);
+    }
+    IR_NODE_LINK_TO(chain.x, fused_node);
+    for (auto* y : chain.ys) {
+      IR_NODE_LINK_TO(y, fused_node);
+    }
+    IR_NODE_LINK_TO(fused_node, chain.out);
+    ++fusion_count;
+  }
+
+  GraphSafeRemoveNodes(graph.get(), to_remove);
+  AddStatis(fusion_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(elementwise_chain_fuse_pass,
+              paddle::framework::ir::ElementwiseChainFusePass);
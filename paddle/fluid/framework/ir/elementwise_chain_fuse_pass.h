@@ -0,0 +1,46 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuses the longest chains of FP32 elementwise_add/sub/mul/div/max/min,
+ * scale and relu/sigmoid/tanh/exp/square into one fusion_elementwise_chain,
+ * e.g. sigmoid(elementwise_add(elementwise_mul(X, Y0), Y1)). Each
+ * intermediate output must be read only by the next op of the chain, and the
+ * other operands must have the shape of X or of its trailing dims.
+ */
+class ElementwiseChainFusePass : public FusePassBase {
+ public:
+  virtual ~ElementwiseChainFusePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+  const std::string name_scope_{"elementwise_chain_fuse"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
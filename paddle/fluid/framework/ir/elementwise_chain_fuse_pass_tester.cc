@@ -0,0 +1,119 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/elementwise_chain_fuse_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& x,
+           const std::vector<std::string>& y,
+           const std::vector<std::string>& out) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetInput("X", x);
+  if (!y.empty()) {
+    op->SetInput("Y", y);
+    op->SetAttr("axis", -1);
+  }
+  op->SetOutput("Out", out);
+  if (type == "scale") {
+    op->SetAttr("scale", 2.0f);
+    op->SetAttr("bias", 1.0f);
+    op->SetAttr("bias_after_scale", false);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// (x, y0)->elementwise_mul->a
+// (a, bias)->elementwise_add->b, bias is broadcast
+// b->sigmoid->c
+// (y0, c)->elementwise_sub->d
+// d->scale->e
+// e->relu->f, f is read by two ops so the chain stops here
+// (f, y0)->elementwise_add->g
+// (f, y1)->elementwise_mul->h
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"x", "y0", "y1", "bias", "a", "b", "c", "d", "e", "f", "g",
+            "h"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    if (v == "bias") {
+      var->SetShape({16});
+      var->SetPersistable(true);
+    } else {
+      var->SetShape({-1, 16});
+    }
+  }
+
+  SetOp(&prog, "elementwise_mul", {"x"}, {"y0"}, {"a"});
+  SetOp(&prog, "elementwise_add", {"a"}, {"bias"}, {"b"});
+  SetOp(&prog, "sigmoid", {"b"}, {}, {"c"});
+  SetOp(&prog, "elementwise_sub", {"y0"}, {"c"}, {"d"});
+  SetOp(&prog, "scale", {"d"}, {}, {"e"});
+  SetOp(&prog, "relu", {"e"}, {}, {"f"});
+  SetOp(&prog, "elementwise_add", {"f"}, {"y0"}, {"g"});
+  SetOp(&prog, "elementwise_mul", {"f"}, {"y1"}, {"h"});
+  return prog;
+}
+
+TEST(ElementwiseChainFusePass, basic) {
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("elementwise_chain_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+
+  int fused_count = 0;
+  int op_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) {
+      for (auto& name : {"a", "b", "c", "d", "e"}) {
+        EXPECT_NE(node->Name(), name);
+      }
+      continue;
+    }
+    ++op_count;
+    auto* op = node->Op();
+    if (op->Type() != "fusion_elementwise_chain") continue;
+    ++fused_count;
+    EXPECT_EQ(op->Input("X"), std::vector<std::string>({"x"}));
+    EXPECT_EQ(op->Input("Ys"),
+              std::vector<std::string>({"y0", "bias", "y0"}));
+    EXPECT_EQ(op->Output("Out"), std::vector<std::string>({"f"}));
+    EXPECT_EQ(boost::get<std::vector<std::string>>(op->GetAttr("chain_ops")),
+              std::vector<std::string>(
+                  {"mul", "add", "sigmoid", "rsub", "scale", "relu"}));
+    auto biases = boost::get<std::vector<float>>(op->GetAttr("biases"));
+    // the bias before scale
+    EXPECT_FLOAT_EQ(biases[4], 2.0f);
+  }
+  EXPECT_EQ(fused_count, 1);
+  // the fused op and the two ops reading f
+  EXPECT_EQ(op_count, 3);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(elementwise_chain_fuse_pass);
@@ -19,6 +19,7 @@ limitations under the License. */
 #include <iosfwd>
 #include <ostream>
 #include <stack>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include "paddle/fluid/framework/ir/graph_traits.h"
@@ -351,6 +352,19 @@ void CleanIndividualNodes(Graph *graph) {
   }
 }
 
+std::unordered_set<std::string> VarsUsedByOtherBlocks(const Graph &graph) {
+  std::unordered_set<std::string> used;
+  auto &program = graph.OriginProgram();
+  for (size_t i = 1; i < program.Size(); ++i) {
+    for (auto *op : program.Block(i).AllOps()) {
+      for (auto &name : op->InputArgumentNames()) {
+        used.insert(name);
+      }
+    }
+  }
+  return used;
+}
+
 std::vector<Node *> TopologyVarientSort(const Graph &graph,
                                         SortKind sort_kind) {
   switch (sort_kind) {
@@ -16,6 +16,8 @@ limitations under the License. */
 
 #include <map>
 #include <memory>
+#include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "paddle/fluid/framework/ir/graph.h"
@@ -56,6 +58,10 @@ std::vector<Node *> TopologyVarientSort(const Graph &graph, SortKind sort_kind);
 // Clean the nodes that doesn't connect to others.
 void CleanIndividualNodes(Graph *graph);
 
+// The variables read by the operators of the blocks other than the main one,
+// e.g. the sub-blocks of while, which are not nodes of the graph.
+std::unordered_set<std::string> VarsUsedByOtherBlocks(const Graph &graph);
+
 // Build an adjacency list of operations for the `graph`.
 std::map<ir::Node *, std::unordered_set<ir::Node *>> BuildOperationAdjList(
     const Graph &graph);
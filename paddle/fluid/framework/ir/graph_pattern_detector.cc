@@ -102,11 +102,32 @@ bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   VLOG(3) << "mark pdnodes in graph";
   if (graph.Nodes().empty()) return false;
 
-  for (auto &node : GraphTraits::DFS(graph)) {
-    for (const auto &pdnode : pattern_.nodes()) {
-      if (pdnode->Tell(&node)) {
-        VLOG(4) << "Node " << node.Name() << " marked as " << pdnode->name();
-        pdnodes2nodes_[pdnode.get()].insert(&node);
+  std::unordered_map<std::string, std::vector<Node *>> ops_by_type;
+  for (auto *node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()) {
+      ops_by_type[node->Op()->Type()].push_back(node);
+    }
+  }
+  // A node should have at least as many inputs and outputs as the PDNode has
+  // distinct ones in the pattern.
+  std::unordered_map<const PDNode *, std::unordered_set<const PDNode *>>
+      pattern_inputs, pattern_outputs;
+  for (auto &edge : pattern_.edges()) {
+    pattern_outputs[edge.first].insert(edge.second);
+    pattern_inputs[edge.second].insert(edge.first);
+  }
+
+  for (const auto &pdnode : pattern_.nodes()) {
+    const size_t min_inputs = pattern_inputs[pdnode.get()].size();
+    const size_t min_outputs = pattern_outputs[pdnode.get()].size();
+    for (auto *node : CandidateNodes(*pdnode, graph, ops_by_type)) {
+      if (node->inputs.size() < min_inputs ||
+          node->outputs.size() < min_outputs) {
+        continue;
+      }
+      if (pdnode->Tell(node)) {
+        VLOG(4) << "Node " << node->Name() << " marked as " << pdnode->name();
+        pdnodes2nodes_[pdnode.get()].insert(node);
       }
     }
   }
@@ -122,6 +143,46 @@ bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   return !pdnodes2nodes_.empty();
 }
 
+std::vector<Node *> GraphPatternDetector::CandidateNodes(
+    const PDNode &pdnode, const ir::Graph &graph,
+    const std::unordered_map<std::string, std::vector<Node *>> &ops_by_type)
+    const {
+  // the asserts are not told if there is a teller
+  if (pdnode.teller_) {
+    return std::vector<Node *>(graph.Nodes().begin(), graph.Nodes().end());
+  }
+  std::vector<Node *> candidates;
+  auto ops_of = [&](const std::unordered_set<std::string> &op_types,
+                    std::function<void(Node *)> visit) {
+    for (auto &op_type : op_types) {
+      auto it = ops_by_type.find(op_type);
+      if (it == ops_by_type.end()) continue;
+      for (auto *op : it->second) {
+        visit(op);
+      }
+    }
+  };
+  if (!pdnode.op_types_.empty()) {
+    ops_of(pdnode.op_types_, [&](Node *op) { candidates.push_back(op); });
+  } else if (!pdnode.consumer_op_types_.empty() ||
+             !pdnode.producer_op_types_.empty()) {
+    std::unordered_set<Node *> vars;
+    if (!pdnode.consumer_op_types_.empty()) {
+      ops_of(pdnode.consumer_op_types_, [&](Node *op) {
+        vars.insert(op->inputs.begin(), op->inputs.end());
+      });
+    } else {
+      ops_of(pdnode.producer_op_types_, [&](Node *op) {
+        vars.insert(op->outputs.begin(), op->outputs.end());
+      });
+    }
+    candidates.assign(vars.begin(), vars.end());
+  } else {
+    candidates.assign(graph.Nodes().begin(), graph.Nodes().end());
+  }
+  return candidates;
+}
+
 // The intermediate Nodes can only link to the nodes inside the pattern, or this
 // subgraph will be droped.
 void GraphPatternDetector::ValidateByNodeRole(
@@ -190,14 +251,70 @@ bool IsNodesLink(Node *a, Node *b) {
   return false;
 }
 
+// The distinct nodes in nodes, in their order.
+static std::vector<Node *> UniqueNodes(const std::vector<Node *> &nodes) {
+  std::vector<Node *> result;
+  std::unordered_set<Node *> visited;
+  for (auto *node : nodes) {
+    if (visited.insert(node).second) {
+      result.push_back(node);
+    }
+  }
+  return result;
+}
+
+std::vector<const PDPattern::edge_t *> GraphPatternDetector::SortedEdges(
+    PDNode **anchor) {
+  std::vector<const PDPattern::edge_t *> sorted;
+  auto &edges = pattern_.edges();
+  if (edges.empty()) {
+    *anchor = pattern_.nodes().front().get();
+    return sorted;
+  }
+  // Start from the most selective PDNode.
+  *anchor = edges.front().first;
+  auto num_marked = [&](const PDNode *pdnode) -> size_t {
+    auto it = pdnodes2nodes_.find(pdnode);
+    return it == pdnodes2nodes_.end() ? 0 : it->second.size();
+  };
+  for (auto &edge : edges) {
+    for (auto *pdnode : {edge.first, edge.second}) {
+      if (num_marked(pdnode) < num_marked(*anchor)) *anchor = pdnode;
+    }
+  }
+
+  std::unordered_set<const PDNode *> visited({*anchor});
+  std::vector<bool> used(edges.size(), false);
+  for (size_t n = 0; n < edges.size(); ++n) {
+    // Take the first edge linking a visited PDNode, or the first unused one
+    // if the pattern is not connected.
+    size_t next = edges.size();
+    for (size_t i = 0; i < edges.size(); ++i) {
+      if (used[i]) continue;
+      if (next == edges.size()) next = i;
+      if (visited.count(edges[i].first) || visited.count(edges[i].second)) {
+        next = i;
+        break;
+      }
+    }
+    used[next] = true;
+    visited.insert(edges[next].first);
+    visited.insert(edges[next].second);
+    sorted.push_back(&edges[next]);
+  }
+  return sorted;
+}
+
 std::vector<GraphPatternDetector::subgraph_t>
 GraphPatternDetector::DetectPatterns() {
   // Init empty subgraphs.
   std::vector<GraphPatternDetector::subgraph_t> result;
   std::vector<HitGroup> init_groups;
   std::array<std::vector<HitGroup>, 2> bi_records;
-  auto *first_pnode = pattern_.edges().empty() ? pattern().nodes().front().get()
-                                               : pattern_.edges().front().first;
+  // The groups are seeded with the nodes of the anchor, every PDNode of the
+  // pattern has to be marked for a match.
+  PDNode *first_pnode = nullptr;
+  auto edges = SortedEdges(&first_pnode);
   if (!pdnodes2nodes_.count(first_pnode)) return result;
   for (auto *node : pdnodes2nodes_[first_pnode]) {
     HitGroup group;
@@ -210,31 +327,49 @@ GraphPatternDetector::DetectPatterns() {
 
   // Extend a PDNode to subgraphs by deducing the connection relations defined
   // in edges of PDNodes.
-  for (const auto &edge : pattern_.edges()) {
-    VLOG(4) << "check " << edge.first->name() << " -> " << edge.second->name();
-    // TODO(Superjomn) Fix bug here, the groups might be duplicate here.
+  for (const auto *edge : edges) {
+    VLOG(4) << "check " << edge->first->name() << " -> "
+            << edge->second->name();
     // Each role has two PDNodes, which indicates two roles.
     // Detect two Nodes that can match these two roles and they are connected.
     auto &pre_groups = bi_records[step % 2];
     auto &cur_groups = bi_records[1 - (step++ % 2)];
     cur_groups.clear();
     if (pre_groups.empty()) break;
+    auto &sources = pdnodes2nodes_[edge->first];
+    auto &targets = pdnodes2nodes_[edge->second];
     // source -> target
-    for (Node *source : pdnodes2nodes_[edge.first]) {
-      for (Node *target : pdnodes2nodes_[edge.second]) {
+    for (const auto &group : pre_groups) {
+      auto extend = [&](Node *source, Node *target) {
         VLOG(8) << "check " << source->id() << " -- " << target->id();
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
-            }
+        HitGroup new_group = group;
+        bool flag = new_group.Match(source, edge->first) &&
+                    new_group.Match(target, edge->second);
+        if (flag) {
+          new_group.Register(source, edge->first);
+          new_group.Register(target, edge->second);
+          cur_groups.push_back(std::move(new_group));
+        }
+      };
+      // Only the neighbours of the matched node are checked.
+      auto source_it = group.roles.find(edge->first);
+      auto target_it = group.roles.find(edge->second);
+      if (source_it != group.roles.end()) {
+        Node *source = source_it->second;
+        for (Node *target : UniqueNodes(source->outputs)) {
+          if (targets.count(target)) extend(source, target);
+        }
+      } else if (target_it != group.roles.end()) {
+        Node *target = target_it->second;
+        for (Node *source : UniqueNodes(target->inputs)) {
+          if (sources.count(source) && IsNodesLink(source, target)) {
+            extend(source, target);
+          }
+        }
+      } else {
+        for (Node *source : sources) {
+          for (Node *target : UniqueNodes(source->outputs)) {
+            if (targets.count(target)) extend(source, target);
           }
         }
       }
@@ -364,6 +499,7 @@ PDNode *PDNode::assert_is_op() {
 }
 
 PDNode *PDNode::assert_is_op(const std::string &op_type) {
+  AddOpTypesHint(&op_types_, {op_type});
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() == op_type;
   });
@@ -409,6 +545,7 @@ PDNode *PDNode::assert_is_op_nth_input(const std::string &op_type,
 
 PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
                                         const std::string &argument, int nth) {
+  AddOpTypesHint(&producer_op_types_, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -422,6 +559,7 @@ PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
 }
 
 PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
+  AddOpTypesHint(&consumer_op_types_, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -436,6 +574,7 @@ PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
 }
 
 PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
+  AddOpTypesHint(&producer_op_types_, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -450,6 +589,7 @@ PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
 }
 
 PDNode *PDNode::assert_is_op_output(const std::string &op_type) {
+  AddOpTypesHint(&producer_op_types_, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -469,6 +609,7 @@ PDNode *PDNode::assert_is_op_output(const std::string &op_type,
   return this;
 }
 PDNode *PDNode::assert_is_op_input(const std::string &op_type) {
+  AddOpTypesHint(&consumer_op_types_, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -506,6 +647,7 @@ PDNode *PDNode::assert_more(PDNode::teller_t &&teller) {
 }
 
 PDNode *PDNode::assert_is_ops(const std::unordered_set<std::string> &op_types) {
+  AddOpTypesHint(&op_types_, op_types);
   asserts_.emplace_back([op_types](Node *x) {
     return x && x->IsOp() && op_types.count(x->Op()->Type());
   });
@@ -531,6 +673,7 @@ PDNode *PDNode::assert_is_ops_nth_input(
 PDNode *PDNode::assert_is_ops_nth_output(
     const std::unordered_set<std::string> &op_types,
     const std::string &argument, int nth) {
+  AddOpTypesHint(&producer_op_types_, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -544,6 +687,7 @@ PDNode *PDNode::assert_is_ops_nth_output(
 }
 PDNode *PDNode::assert_is_ops_output(
     const std::unordered_set<std::string> &op_types) {
+  AddOpTypesHint(&producer_op_types_, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -566,6 +710,7 @@ PDNode *PDNode::assert_is_ops_output(
 
 PDNode *PDNode::assert_is_ops_input(
     const std::unordered_set<std::string> &op_types) {
+  AddOpTypesHint(&consumer_op_types_, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
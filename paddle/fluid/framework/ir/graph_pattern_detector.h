@@ -20,6 +20,8 @@
 
 #include <numeric>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/ir/graph.h"
@@ -153,10 +155,23 @@ struct PDNode {
   PDNode(PDNode&& other) = default;
 
   friend class PDPattern;
+  friend class GraphPatternDetector;
+
+  // Records the op types of an assertion as a hint, the first one is kept
+  // since every one of them is a superset of the matched types.
+  void AddOpTypesHint(std::unordered_set<std::string>* hint,
+                      const std::unordered_set<std::string>& op_types) {
+    if (hint->empty()) *hint = op_types;
+  }
 
   // Will removed latter.
   teller_t teller_;
   std::vector<teller_t> asserts_;
+  // The hints derived from the asserts, which let the detector only tell the
+  // ops of the types, or the vars read or written by them. Empty if unknown.
+  std::unordered_set<std::string> op_types_;
+  std::unordered_set<std::string> consumer_op_types_;
+  std::unordered_set<std::string> producer_op_types_;
   PDPattern* pattern_;
   std::string name_;
   Type type_;
@@ -265,6 +280,18 @@ class GraphPatternDetector {
   // Mark the nodes that fits the pattern.
   bool MarkPDNodesInGraph(const ir::Graph& graph);
 
+  // The nodes of the graph that could match pdnode by its hints, all the
+  // nodes if there is no hint.
+  std::vector<Node*> CandidateNodes(
+      const PDNode& pdnode, const ir::Graph& graph,
+      const std::unordered_map<std::string, std::vector<Node*>>& ops_by_type)
+      const;
+
+  // The edges sorted from the PDNode with the fewest marked nodes, which is
+  // returned in *anchor, so that each edge links a PDNode which has been
+  // matched, if the pattern is connected.
+  std::vector<const PDPattern::edge_t*> SortedEdges(PDNode** anchor);
+
   // Detect all the pattern and output the hit records.
   std::vector<subgraph_t> DetectPatterns();
 
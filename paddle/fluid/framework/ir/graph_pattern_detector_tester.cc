@@ -201,6 +201,47 @@ TEST(GraphPatternDetector, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+TEST(GraphPatternDetector, OpTypeHints) {
+  // mul(a, w0) -> b -> relu -> c -> mul(c, w1) -> d
+  ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  auto add_op = [&](const std::string& type,
+                    const std::vector<std::string>& inputs,
+                    const std::string& output) {
+    auto* op = block->AppendOp();
+    op->SetType(type);
+    op->SetInput("X", {inputs[0]});
+    if (inputs.size() > 1) op->SetInput("Y", {inputs[1]});
+    op->SetOutput("Out", {output});
+  };
+  for (auto& name : {"a", "b", "c", "d", "w0", "w1"}) {
+    block->Var(name);
+  }
+  add_op("mul", {"a", "w0"}, "b");
+  add_op("relu", {"b"}, "c");
+  add_op("mul", {"c", "w1"}, "d");
+  Graph graph(program);
+
+  // mul -> out -> relu, only the first mul should match.
+  GraphPatternDetector detector;
+  auto* pattern = detector.mutable_pattern();
+  auto* mul = pattern->NewNode("mul")->assert_is_op("mul");
+  auto* mul_out = pattern->NewNode("mul_out")
+                      ->assert_is_op_output("mul")
+                      ->assert_is_op_input("relu")
+                      ->AsIntermediate();
+  auto* relu = pattern->NewNode("relu")->assert_is_op("relu");
+  mul_out->LinksFrom({mul}).LinksTo({relu});
+
+  int count = 0;
+  detector(&graph, [&](const GraphPatternDetector::subgraph_t& subgraph,
+                       Graph* g) {
+    EXPECT_EQ(subgraph.at(mul_out)->Name(), "b");
+    ++count;
+  });
+  ASSERT_EQ(count, 1);
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
@@ -0,0 +1,357 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/multihead_attention_fuse_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+bool IsOpType(const Node* node, const std::string& type) {
+  return node && node->IsOp() && node->Op()->Type() == type;
+}
+
+template <typename T>
+T OpAttr(const Node* op, const std::string& name) {
+  return boost::get<T>(op->Op()->GetAttr(name));
+}
+
+Node* FindVar(const std::vector<Node*>& vars, const std::string& name) {
+  for (auto* var : vars) {
+    if (var->IsVar() && var->Name() == name) return var;
+  }
+  return nullptr;
+}
+
+Node* OpInput(const Node* op, const std::string& slot) {
+  auto& names = op->Op()->Input(slot);
+  return names.size() == 1 ? FindVar(op->inputs, names[0]) : nullptr;
+}
+
+Node* OpOutput(const Node* op, const std::string& slot) {
+  auto& names = op->Op()->Output(slot);
+  return names.size() == 1 ? FindVar(op->outputs, names[0]) : nullptr;
+}
+
+Node* Producer(const Node* var) {
+  return var && var->inputs.size() == 1 ? var->inputs[0] : nullptr;
+}
+
+// The only op reading the output of op.
+Node* NextOp(const Node* op) {
+  Node* out = OpOutput(op, "Out");
+  return out && out->outputs.size() == 1 ? out->outputs[0] : nullptr;
+}
+
+bool IsHeadsTranspose(const Node* op) {
+  return IsOpType(op, "transpose2") &&
+         OpAttr<std::vector<int>>(op, "axis") == std::vector<int>({0, 2, 1, 3});
+}
+
+// One of the q, k and v projections.
+struct Projection {
+  Node* x{nullptr};
+  Node* w{nullptr};
+  Node* bias{nullptr};
+  int head_number{0};
+  int head_size{0};
+  float scale{1.f};
+};
+
+// Matches x -> mul -> elementwise_add -> reshape2 -> transpose2 [-> scale]
+// -> heads backwards from heads, and appends the ops to *ops.
+bool MatchProjection(Node* heads, bool with_scale, Projection* proj,
+                     std::vector<Node*>* ops) {
+  Node* op = Producer(heads);
+  if (with_scale && IsOpType(op, "scale")) {
+    if (OpAttr<float>(op, "bias") != 0.f) return false;
+    proj->scale = OpAttr<float>(op, "scale");
+    ops->push_back(op);
+    op = Producer(OpInput(op, "X"));
+  }
+  if (!IsHeadsTranspose(op)) return false;
+  ops->push_back(op);
+
+  op = Producer(OpInput(op, "X"));
+  if (!IsOpType(op, "reshape2") || OpInput(op, "Shape")) return false;
+  auto shape = OpAttr<std::vector<int>>(op, "shape");
+  if (shape.size() != 4 || shape[2] <= 0 || shape[3] <= 0) return false;
+  proj->head_number = shape[2];
+  proj->head_size = shape[3];
+  ops->push_back(op);
+
+  op = Producer(OpInput(op, "X"));
+  if (!IsOpType(op, "elementwise_add")) return false;
+  int axis = OpAttr<int>(op, "axis");
+  proj->bias = OpInput(op, "Y");
+  if ((axis != -1 && axis != 2) || !proj->bias || !proj->bias->Var() ||
+      !proj->bias->Var()->Persistable()) {
+    return false;
+  }
+  ops->push_back(op);
+
+  op = Producer(OpInput(op, "X"));
+  if (!IsOpType(op, "mul") || OpAttr<int>(op, "x_num_col_dims") != 2 ||
+      OpAttr<int>(op, "y_num_col_dims") != 1) {
+    return false;
+  }
+  proj->x = OpInput(op, "X");
+  proj->w = OpInput(op, "Y");
+  if (!proj->x || !proj->w || !proj->w->Var() ||
+      !proj->w->Var()->Persistable()) {
+    return false;
+  }
+  ops->push_back(op);
+  return true;
+}
+
+// multihead_attention only accepts a BiasQK of [batch_size, head_number,
+// seq_len, seq_len], or [batch_size, 1, seq_len, seq_len] shared by the heads,
+// so the other broadcasts of the scores add are not fused.
+bool IsFusibleBiasQK(const Node* add, const Node* qk, const Node* bias_qk) {
+  Node* scores = OpOutput(qk, "Out");
+  if (!scores || !scores->Var()) return false;
+  int axis = OpAttr<int>(add, "axis");
+  auto scores_shape = scores->Var()->GetShape();
+  auto bias_shape = bias_qk->Var()->GetShape();
+  if ((axis != -1 && axis != 0) || scores_shape.size() != 4 ||
+      bias_shape.size() != 4) {
+    return false;
+  }
+  for (int i : {0, 2, 3}) {
+    if (bias_shape[i] != scores_shape[i]) return false;
+  }
+  return bias_shape[1] == 1 || bias_shape[1] == scores_shape[1];
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> MultiheadAttentionFusePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init(name_scope_, graph.get());
+  auto* scope = param_scope();
+  PADDLE_ENFORCE(scope);
+
+  std::unordered_map<std::string, int> var_count;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) ++var_count[node->Name()];
+  }
+
+  // the parameters read by the other blocks are kept in the scope
+  auto used_by_other_blocks = VarsUsedByOtherBlocks(*graph);
+  std::unordered_set<const Node*> to_remove;
+  std::vector<std::string> erased_params;
+  int fusion_count = 0;
+  for (auto* softmax : TopologySortOperations(*graph)) {
+    if (!IsOpType(softmax, "softmax") || to_remove.count(softmax) ||
+        (softmax->Op()->HasAttr("use_mkldnn") &&
+         OpAttr<bool>(softmax, "use_mkldnn"))) {
+      continue;
+    }
+    std::vector<Node*> ops = {softmax};
+
+    // scores = matmul(q, k^T) [+ BiasQK]
+    Node* qk = Producer(OpInput(softmax, "X"));
+    Node* qk_add = nullptr;
+    Node* bias_qk = nullptr;
+    if (IsOpType(qk, "elementwise_add")) {
+      qk_add = qk;
+      bias_qk = OpInput(qk, "Y");
+      if (!bias_qk || !bias_qk->Var()) continue;
+      ops.push_back(qk);
+      qk = Producer(OpInput(qk, "X"));
+    }
+    if (!IsOpType(qk, "matmul") || OpAttr<bool>(qk, "transpose_X") ||
+        !OpAttr<bool>(qk, "transpose_Y")) {
+      continue;
+    }
+    ops.push_back(qk);
+    if (bias_qk && !IsFusibleBiasQK(qk_add, qk, bias_qk)) continue;
+
+    // [dropout ->] matmul(weights, v) -> transpose2 -> reshape2
+    Node* av = NextOp(softmax);
+    if (IsOpType(av, "dropout")) {
+      if (!OpAttr<bool>(av, "is_test") ||
+          (OpAttr<std::string>(av, "dropout_implementation") !=
+               "upscale_in_train" &&
+           OpAttr<float>(av, "dropout_prob") != 0.f)) {
+        continue;
+      }
+      ops.push_back(av);
+      av = NextOp(av);
+    }
+    if (!IsOpType(av, "matmul") || OpAttr<bool>(av, "transpose_X") ||
+        OpAttr<bool>(av, "transpose_Y") || OpAttr<float>(av, "alpha") != 1.f) {
+      continue;
+    }
+    ops.push_back(av);
+    Node* combine = NextOp(av);
+    if (!IsHeadsTranspose(combine)) continue;
+    ops.push_back(combine);
+    Node* reshape = NextOp(combine);
+    if (!IsOpType(reshape, "reshape2") || OpInput(reshape, "Shape")) continue;
+    ops.push_back(reshape);
+    Node* out = OpOutput(reshape, "Out");
+    if (!out) continue;
+
+    Projection q, k, v;
+    if (!MatchProjection(OpInput(qk, "X"), true, &q, &ops) ||
+        !MatchProjection(OpInput(qk, "Y"), false, &k, &ops) ||
+        !MatchProjection(OpInput(av, "Y"), false, &v, &ops)) {
+      continue;
+    }
+    // self attention only, the projections share the input
+    const int head_number = q.head_number;
+    const int hidden = head_number * q.head_size;
+    if (q.x != k.x || q.x != v.x || k.head_number != head_number ||
+        v.head_number != head_number || k.head_size != q.head_size ||
+        v.head_size != q.head_size ||
+        OpAttr<std::vector<int>>(reshape, "shape") !=
+            std::vector<int>({0, 0, hidden})) {
+      continue;
+    }
+
+    // All the outputs of the matched ops, except out, are removed, so they
+    // must only be read by the matched ops.
+    std::unordered_set<Node*> op_set(ops.begin(), ops.end());
+    bool removable = op_set.size() == ops.size();
+    std::vector<Node*> intermediates;
+    for (auto* op : ops) {
+      for (auto* var : op->outputs) {
+        if (var == out) continue;
+        if (!var->Var() || var->Var()->Persistable() ||
+            var_count.at(var->Name()) != 1) {
+          removable = false;
+        }
+        for (auto* consumer : var->outputs) {
+          if (!op_set.count(consumer)) removable = false;
+        }
+        intermediates.push_back(var);
+      }
+    }
+    if (!removable) continue;
+
+    // concatenate the weights [in, hidden] and the biases [hidden] of q, k
+    // and v along the width
+    std::vector<const LoDTensor*> ws, biases;
+    for (auto* proj : {&q, &k, &v}) {
+      auto* w_var = scope->FindVar(proj->w->Name());
+      auto* b_var = scope->FindVar(proj->bias->Name());
+      PADDLE_ENFORCE(w_var && b_var, "The parameters of %s are not found.",
+                     proj->w->Name());
+      ws.push_back(&w_var->Get<LoDTensor>());
+      biases.push_back(&b_var->Get<LoDTensor>());
+    }
+    auto w_dims = ws[0]->dims();
+    bool params_match = w_dims.size() == 2 && w_dims[1] == hidden;
+    for (int i = 0; i < 3; ++i) {
+      params_match = params_match && ws[i]->dims() == w_dims &&
+                     biases[i]->numel() == hidden &&
+                     ws[i]->type() == proto::VarType::FP32 &&
+                     biases[i]->type() == proto::VarType::FP32;
+    }
+    if (!params_match) continue;
+    const int in_width = w_dims[0];
+
+    VLOG(4) << "fuse multihead attention of " << head_number << " heads";
+    VarDesc qkv_w_desc(patterns::PDNodeName(name_scope_, "qkv_w"));
+    qkv_w_desc.SetShape({in_width, 3 * hidden});
+    qkv_w_desc.SetDataType(proto::VarType::FP32);
+    qkv_w_desc.SetPersistable(true);
+    auto* qkv_w = graph->CreateVarNode(&qkv_w_desc);
+    auto* qkv_w_tensor = scope->Var(qkv_w->Name())->GetMutable<LoDTensor>();
+    float* qkv_w_data = qkv_w_tensor->mutable_data<float>(
+        {in_width, 3 * hidden}, platform::CPUPlace());
+
+    VarDesc qkv_b_desc(patterns::PDNodeName(name_scope_, "qkv_b"));
+    qkv_b_desc.SetShape({3 * hidden});
+    qkv_b_desc.SetDataType(proto::VarType::FP32);
+    qkv_b_desc.SetPersistable(true);
+    auto* qkv_b = graph->CreateVarNode(&qkv_b_desc);
+    auto* qkv_b_tensor = scope->Var(qkv_b->Name())->GetMutable<LoDTensor>();
+    float* qkv_b_data =
+        qkv_b_tensor->mutable_data<float>({3 * hidden}, platform::CPUPlace());
+
+    for (int i = 0; i < 3; ++i) {
+      const float* w_data = ws[i]->data<float>();
+      for (int r = 0; r < in_width; ++r) {
+        std::copy_n(w_data + r * hidden, hidden,
+                    qkv_w_data + r * 3 * hidden + i * hidden);
+      }
+      std::copy_n(biases[i]->data<float>(), hidden, qkv_b_data + i * hidden);
+    }
+
+    OpDesc desc;
+    desc.SetType("multihead_attention");
+    desc.SetInput("X", {q.x->Name()});
+    desc.SetInput("W", {qkv_w->Name()});
+    desc.SetInput("Bias", {qkv_b->Name()});
+    if (bias_qk) {
+      desc.SetInput("BiasQK", {bias_qk->Name()});
+    }
+    desc.SetOutput("Out", {out->Name()});
+    desc.SetAttr("head_number", head_number);
+    desc.SetAttr("alpha", OpAttr<float>(qk, "alpha") * q.scale);
+    auto* fused = graph->CreateOpNode(&desc);
+
+    IR_NODE_LINK_TO(q.x, fused);
+    IR_NODE_LINK_TO(qkv_w, fused);
+    IR_NODE_LINK_TO(qkv_b, fused);
+    if (bias_qk) {
+      IR_NODE_LINK_TO(bias_qk, fused);
+    }
+    IR_NODE_LINK_TO(fused, out);
+
+    to_remove.insert(ops.begin(), ops.end());
+    to_remove.insert(intermediates.begin(), intermediates.end());
+    // the old parameters only read by the matched ops are not needed anymore
+    for (auto* proj : {&q, &k, &v}) {
+      for (auto* param : {proj->w, proj->bias}) {
+        bool unused = var_count.at(param->Name()) == 1 &&
+                      !used_by_other_blocks.count(param->Name());
+        for (auto* consumer : param->outputs) {
+          if (!op_set.count(consumer)) unused = false;
+        }
+        if (unused && !to_remove.count(param)) {
+          to_remove.insert(param);
+          erased_params.push_back(param->Name());
+        }
+      }
+    }
+    ++fusion_count;
+  }
+
+  GraphSafeRemoveNodes(graph.get(), to_remove);
+  scope->EraseVars(erased_params);
+  AddStatis(fusion_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(multihead_attention_fuse_pass,
+              paddle::framework::ir::MultiheadAttentionFusePass);
@@ -0,0 +1,51 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuses the self attention of the transformer models like BERT into one
+ * multihead_attention:
+ *
+ *   q, k, v = reshape2(mul(X, W) + B) -> transpose2   (one for each of them)
+ *   scores = matmul(scale(q), k, transpose_Y=true) + BiasQK
+ *   out = matmul(dropout(softmax(scores)), v) -> transpose2 -> reshape2
+ *
+ * The scale, the BiasQK and the dropout at inference are optional. The
+ * weights and the biases of q, k and v are concatenated into new parameters,
+ * so that the projections are one GEMM.
+ */
+class MultiheadAttentionFusePass : public FusePassBase {
+ public:
+  virtual ~MultiheadAttentionFusePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+  const std::string name_scope_{"multihead_attention_fuse"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,222 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/multihead_attention_fuse_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+constexpr int kInWidth = 4;
+constexpr int kHeadNumber = 2;
+constexpr int kHeadSize = 3;
+constexpr int kHidden = kHeadNumber * kHeadSize;
+
+class AttentionProgramBuilder {
+ public:
+  AttentionProgramBuilder() {
+    for (auto& v : std::vector<std::string>({"x", "bias_qk"})) {
+      NewVar(v, false);
+    }
+  }
+
+  OpDesc* AppendOp(const std::string& type,
+                   const std::vector<std::pair<std::string, std::string>>& in,
+                   const std::string& out, bool with_xshape = false) {
+    auto* op = prog_.MutableBlock(0)->AppendOp();
+    op->SetType(type);
+    for (auto& slot : in) {
+      op->SetInput(slot.first, {slot.second});
+    }
+    NewVar(out, false);
+    op->SetOutput("Out", {out});
+    if (with_xshape) {
+      NewVar(out + "_xshape", false);
+      op->SetOutput("XShape", {out + "_xshape"});
+    }
+    return op;
+  }
+
+  // x -> mul -> elementwise_add -> reshape2 -> transpose2 -> name
+  void AppendProjection(const std::string& name) {
+    NewVar(name + "_w", true);
+    NewVar(name + "_b", true);
+    auto* mul = AppendOp("mul", {{"X", "x"}, {"Y", name + "_w"}}, name + "_0");
+    mul->SetAttr("x_num_col_dims", 2);
+    mul->SetAttr("y_num_col_dims", 1);
+    AppendOp("elementwise_add", {{"X", name + "_0"}, {"Y", name + "_b"}},
+             name + "_1")
+        ->SetAttr("axis", 2);
+    AppendOp("reshape2", {{"X", name + "_1"}}, name + "_2", true)
+        ->SetAttr("shape", std::vector<int>({0, 0, kHeadNumber, kHeadSize}));
+    AppendOp("transpose2", {{"X", name + "_2"}}, name, true)
+        ->SetAttr("axis", std::vector<int>({0, 2, 1, 3}));
+  }
+
+  void SetShape(const std::string& name, const std::vector<int64_t>& shape) {
+    prog_.MutableBlock(0)->Var(name)->SetShape(shape);
+  }
+
+  ProgramDesc* prog() { return &prog_; }
+
+ private:
+  void NewVar(const std::string& name, bool persistable) {
+    auto* var = prog_.MutableBlock(0)->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetPersistable(persistable);
+  }
+
+  ProgramDesc prog_;
+};
+
+void SetMatMulAttrs(OpDesc* op, bool transpose_y, float alpha) {
+  op->SetAttr("transpose_X", false);
+  op->SetAttr("transpose_Y", transpose_y);
+  op->SetAttr("alpha", alpha);
+}
+
+ProgramDesc BuildProgramDesc(
+    const std::vector<int64_t>& bias_qk_shape = {-1, kHeadNumber, -1, -1}) {
+  AttentionProgramBuilder builder;
+  builder.AppendProjection("q");
+  builder.AppendProjection("k");
+  builder.AppendProjection("v");
+  auto* scale = builder.AppendOp("scale", {{"X", "q"}}, "scaled_q");
+  scale->SetAttr("scale", 0.5f);
+  scale->SetAttr("bias", 0.f);
+  SetMatMulAttrs(builder.AppendOp("matmul", {{"X", "scaled_q"}, {"Y", "k"}},
+                                  "qk"),
+                 true, 2.f);
+  builder.SetShape("qk", {-1, kHeadNumber, -1, -1});
+  builder.SetShape("bias_qk", bias_qk_shape);
+  builder.AppendOp("elementwise_add", {{"X", "qk"}, {"Y", "bias_qk"}},
+                   "scores")
+      ->SetAttr("axis", -1);
+  builder.AppendOp("softmax", {{"X", "scores"}}, "weights");
+  auto* dropout = builder.AppendOp("dropout", {{"X", "weights"}}, "dropped");
+  dropout->SetAttr("is_test", true);
+  dropout->SetAttr("dropout_prob", 0.1f);
+  dropout->SetAttr("dropout_implementation",
+                   std::string("upscale_in_train"));
+  SetMatMulAttrs(builder.AppendOp("matmul", {{"X", "dropped"}, {"Y", "v"}},
+                                  "context"),
+                 false, 1.f);
+  builder.AppendOp("transpose2", {{"X", "context"}}, "context_t", true)
+      ->SetAttr("axis", std::vector<int>({0, 2, 1, 3}));
+  builder.AppendOp("reshape2", {{"X", "context_t"}}, "out", true)
+      ->SetAttr("shape", std::vector<int>({0, 0, kHidden}));
+  return *builder.prog();
+}
+
+void InitParam(Scope* scope, const std::string& name, const DDim& dims,
+               float value) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  float* data = tensor->mutable_data<float>(dims, platform::CPUPlace());
+  std::fill_n(data, tensor->numel(), value);
+}
+
+std::unique_ptr<ir::Graph> ApplyPass(const ProgramDesc& prog, Scope* scope) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  float value = 1.f;
+  for (auto& name : {"q", "k", "v"}) {
+    InitParam(scope, std::string(name) + "_w", {kInWidth, kHidden}, value);
+    InitParam(scope, std::string(name) + "_b", {kHidden}, -value);
+    value += 1.f;
+  }
+  graph->Set(kParamScopeAttr, new framework::Scope*(scope));
+
+  auto pass = PassRegistry::Instance().Get("multihead_attention_fuse_pass");
+  return pass->Apply(std::move(graph));
+}
+
+int CountOps(const ir::Graph& graph, const std::string& type) {
+  int count = 0;
+  for (auto* node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == type) ++count;
+  }
+  return count;
+}
+
+TEST(MultiheadAttentionFusePass, basic) {
+  Scope scope;
+  auto graph = ApplyPass(BuildProgramDesc(), &scope);
+
+  int op_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    ++op_count;
+    auto* op = node->Op();
+    ASSERT_EQ(op->Type(), "multihead_attention");
+    EXPECT_EQ(op->Input("X"), std::vector<std::string>({"x"}));
+    EXPECT_EQ(op->Input("BiasQK"), std::vector<std::string>({"bias_qk"}));
+    EXPECT_EQ(op->Output("Out"), std::vector<std::string>({"out"}));
+    EXPECT_EQ(boost::get<int>(op->GetAttr("head_number")), kHeadNumber);
+    EXPECT_FLOAT_EQ(boost::get<float>(op->GetAttr("alpha")), 1.f);
+
+    auto& w = scope.FindVar(op->Input("W")[0])->Get<LoDTensor>();
+    ASSERT_EQ(w.dims(), make_ddim({kInWidth, 3 * kHidden}));
+    auto& b = scope.FindVar(op->Input("Bias")[0])->Get<LoDTensor>();
+    ASSERT_EQ(b.dims(), make_ddim({3 * kHidden}));
+    for (int i = 0; i < 3 * kHidden; ++i) {
+      // the columns of q, k and v are 1, 2 and 3
+      float expected = static_cast<float>(i / kHidden + 1);
+      EXPECT_FLOAT_EQ(w.data<float>()[kHidden * 3 + i], expected);
+      EXPECT_FLOAT_EQ(b.data<float>()[i], -expected);
+    }
+  }
+  EXPECT_EQ(op_count, 1);
+  // the parameters of the projections are replaced
+  EXPECT_EQ(scope.FindVar("q_w"), nullptr);
+  EXPECT_EQ(scope.FindVar("v_b"), nullptr);
+}
+
+TEST(MultiheadAttentionFusePass, bias_qk_shared_by_heads) {
+  Scope scope;
+  auto graph = ApplyPass(BuildProgramDesc({-1, 1, -1, -1}), &scope);
+  EXPECT_EQ(CountOps(*graph, "multihead_attention"), 1);
+}
+
+TEST(MultiheadAttentionFusePass, unsupported_bias_qk) {
+  // a mask broadcast along the rows of the scores is not supported by
+  // multihead_attention
+  Scope scope;
+  auto graph = ApplyPass(BuildProgramDesc({-1, kHeadNumber, 1, -1}), &scope);
+  EXPECT_EQ(CountOps(*graph, "multihead_attention"), 0);
+  EXPECT_EQ(CountOps(*graph, "softmax"), 1);
+  EXPECT_NE(scope.FindVar("q_w"), nullptr);
+}
+
+TEST(MultiheadAttentionFusePass, keep_params_used_by_sub_block) {
+  auto prog = BuildProgramDesc();
+  auto* op = prog.AppendBlock(prog.Block(0))->AppendOp();
+  op->SetType("scale");
+  op->SetInput("X", {"q_w"});
+  op->SetOutput("Out", {"q_w_scaled"});
+
+  Scope scope;
+  auto graph = ApplyPass(prog, &scope);
+  EXPECT_EQ(CountOps(*graph, "multihead_attention"), 1);
+  EXPECT_NE(scope.FindVar("q_w"), nullptr);
+  EXPECT_EQ(scope.FindVar("k_w"), nullptr);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(multihead_attention_fuse_pass);
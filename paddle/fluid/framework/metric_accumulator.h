@@ -0,0 +1,237 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+class MetricAccumulatorBase {
+ public:
+  virtual ~MetricAccumulatorBase() {}
+
+  // Merges the pending statistics of the calling thread.
+  virtual void Flush() = 0;
+};
+
+// The accumulators which have been updated by the calling thread.
+inline std::vector<std::weak_ptr<MetricAccumulatorBase>>&
+ThreadMetricAccumulators() {
+  static thread_local std::vector<std::weak_ptr<MetricAccumulatorBase>>
+      accumulators;
+  return accumulators;
+}
+
+// Merges the pending statistics of all the metrics updated by the calling
+// thread, it should be called before the thread stops training.
+inline void FlushThreadMetrics() {
+  for (auto& weak : ThreadMetricAccumulators()) {
+    if (auto accumulator = weak.lock()) {
+      accumulator->Flush();
+    }
+  }
+}
+
+/*
+ * Accumulates the statistics of a metric, e.g. the buckets of AUC, into the
+ * global statistics shared by several threads, like the persistable states
+ * updated by all the Hogwild workers.
+ *
+ * Every thread adds its batches to its own pending statistics, which are
+ * merged into the global ones under a lock every `merge_steps` batches, so
+ * the threads neither race on nor bounce the cache lines of the global
+ * statistics. The global statistics are either accumulated without limit
+ * (window = 0), or kept as a ring of the last `window` merges whose rows are
+ * overwritten in turn instead of being shifted.
+ *
+ * An accumulator lives as long as the memory of its statistics, e.g. the
+ * holder of the stats tensor. A new holder, even at the address of a freed
+ * one, gets a new accumulator, and the accumulators and the per-thread
+ * buffers of the freed holders are released.
+ */
+template <typename T>
+class MetricAccumulator
+    : public MetricAccumulatorBase,
+      public std::enable_shared_from_this<MetricAccumulator<T>> {
+ public:
+  // Gets the accumulator of the global statistics `stats` owned by `owner`,
+  // whose shape is [max(window, 1), size].
+  static std::shared_ptr<MetricAccumulator> Get(
+      const std::shared_ptr<void>& owner, T* stats, int64_t size,
+      int window) {
+    using Key = std::tuple<T*, int64_t, int>;
+    Key key(stats, size, window);
+    static thread_local std::map<Key, Entry> cache;
+    auto it = cache.find(key);
+    if (it != cache.end() && SameOwner(it->second.owner, owner)) {
+      if (auto accumulator = it->second.accumulator.lock()) {
+        return accumulator;
+      }
+    }
+
+    // The global map keeps the accumulators alive, the caches of the threads
+    // only refer to them.
+    static std::mutex mutex;
+    static std::map<Key, std::pair<std::weak_ptr<void>,
+                                   std::shared_ptr<MetricAccumulator>>>
+        accumulators;
+    std::lock_guard<std::mutex> guard(mutex);
+    // Release the accumulators of the freed statistics.
+    for (auto entry = accumulators.begin(); entry != accumulators.end();) {
+      if (entry->second.first.expired()) {
+        entry = accumulators.erase(entry);
+      } else {
+        ++entry;
+      }
+    }
+    for (auto entry = cache.begin(); entry != cache.end();) {
+      if (entry->second.owner.expired()) {
+        entry = cache.erase(entry);
+      } else {
+        ++entry;
+      }
+    }
+    auto& entry = accumulators[key];
+    if (!entry.second || !SameOwner(entry.first, owner)) {
+      entry.first = owner;
+      entry.second.reset(new MetricAccumulator(stats, size, window));
+    }
+    cache[key] = Entry{owner, entry.second};
+    return entry.second;
+  }
+
+  // Adds the statistics of a batch and returns the global statistics seen by
+  // the calling thread, which is valid until its next call. Between two
+  // merges, they are the ones of the last merge plus the pending ones.
+  const T* Add(const T* batch, int merge_steps) {
+    Local& local = GetLocal();
+    for (int64_t i = 0; i < size_; ++i) {
+      local.pending[i] += batch[i];
+    }
+    if (++local.steps >= merge_steps) {
+      Merge(&local);
+      return local.merged.data();
+    }
+    for (int64_t i = 0; i < size_; ++i) {
+      local.view[i] = local.merged[i] + local.pending[i];
+    }
+    return local.view.data();
+  }
+
+  void Flush() override {
+    Local& local = GetLocal();
+    if (local.steps > 0) {
+      Merge(&local);
+    }
+  }
+
+ private:
+  struct Entry {
+    std::weak_ptr<void> owner;
+    std::weak_ptr<MetricAccumulator> accumulator;
+  };
+
+  struct Local {
+    explicit Local(int64_t size) : pending(size), merged(size), view(size) {}
+
+    std::vector<T> pending;
+    std::vector<T> merged;
+    std::vector<T> view;
+    int steps{0};
+  };
+
+  static bool SameOwner(const std::weak_ptr<void>& a,
+                        const std::shared_ptr<void>& b) {
+    return !a.owner_before(b) && !b.owner_before(a);
+  }
+
+  MetricAccumulator(T* stats, int64_t size, int window)
+      : stats_(stats), size_(size), window_(window) {}
+
+  Local& GetLocal() {
+    // Keyed by the accumulator, whose address may be reused once it is
+    // released, so the buffers of the released ones are dropped first.
+    static thread_local std::map<const MetricAccumulator*,
+                                 std::pair<std::weak_ptr<MetricAccumulator>,
+                                           std::unique_ptr<Local>>>
+        locals;
+    auto it = locals.find(this);
+    if (it != locals.end() && !it->second.first.expired()) {
+      return *it->second.second;
+    }
+    for (auto local = locals.begin(); local != locals.end();) {
+      if (local->second.first.expired()) {
+        local = locals.erase(local);
+      } else {
+        ++local;
+      }
+    }
+    auto& accumulators = ThreadMetricAccumulators();
+    accumulators.erase(
+        std::remove_if(accumulators.begin(), accumulators.end(),
+                       [](const std::weak_ptr<MetricAccumulatorBase>& weak) {
+                         return weak.expired();
+                       }),
+        accumulators.end());
+    auto self = this->shared_from_this();
+    auto& local = locals[this];
+    local.first = self;
+    local.second.reset(new Local(size_));
+    accumulators.push_back(self);
+    return *local.second;
+  }
+
+  void Merge(Local* local) {
+    T* merged = local->merged.data();
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (window_ == 0) {
+        for (int64_t i = 0; i < size_; ++i) {
+          stats_[i] += local->pending[i];
+        }
+        std::copy(stats_, stats_ + size_, merged);
+      } else {
+        std::copy(local->pending.begin(), local->pending.end(),
+                  stats_ + cursor_ * size_);
+        cursor_ = (cursor_ + 1) % window_;
+        std::copy(stats_, stats_ + size_, merged);
+        for (int w = 1; w < window_; ++w) {
+          const T* row = stats_ + w * size_;
+          for (int64_t i = 0; i < size_; ++i) {
+            merged[i] += row[i];
+          }
+        }
+      }
+    }
+    std::fill(local->pending.begin(), local->pending.end(), static_cast<T>(0));
+    local->steps = 0;
+  }
+
+  std::mutex mutex_;
+  T* stats_;
+  const int64_t size_;
+  const int window_;
+  int cursor_{0};
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,122 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/metric_accumulator.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+TEST(MetricAccumulator, Unlimited) {
+  auto owner = std::make_shared<std::vector<int64_t>>(4, 0);
+  auto& stats = *owner;
+  auto accumulator =
+      MetricAccumulator<int64_t>::Get(owner, stats.data(), 4, 0);
+  EXPECT_EQ(accumulator,
+            MetricAccumulator<int64_t>::Get(owner, stats.data(), 4, 0));
+
+  std::vector<int64_t> batch = {1, 2, 3, 4};
+  const int64_t* view = accumulator->Add(batch.data(), 2);
+  // pending, not merged yet
+  EXPECT_EQ(stats[3], 0);
+  EXPECT_EQ(view[3], 4);
+  view = accumulator->Add(batch.data(), 2);
+  EXPECT_EQ(stats[3], 8);
+  EXPECT_EQ(view[3], 8);
+
+  accumulator->Add(batch.data(), 2);
+  FlushThreadMetrics();
+  EXPECT_EQ(stats[0], 3);
+  EXPECT_EQ(stats[3], 12);
+}
+
+TEST(MetricAccumulator, Window) {
+  const int window = 3;
+  auto owner = std::make_shared<std::vector<int64_t>>(window * 2, 0);
+  auto accumulator =
+      MetricAccumulator<int64_t>::Get(owner, owner->data(), 2, window);
+  for (int64_t step = 1; step <= 5; ++step) {
+    std::vector<int64_t> batch = {step, 1};
+    const int64_t* view = accumulator->Add(batch.data(), 1);
+    // the sum of the last `window` steps
+    int64_t expected = 0;
+    for (int64_t s = std::max<int64_t>(1, step - window + 1); s <= step; ++s) {
+      expected += s;
+    }
+    EXPECT_EQ(view[0], expected);
+    EXPECT_EQ(view[1], std::min<int64_t>(step, window));
+  }
+}
+
+TEST(MetricAccumulator, Threads) {
+  const int num_threads = 8;
+  const int num_batches = 1001;
+  auto owner = std::make_shared<std::vector<int64_t>>(16, 0);
+  auto& stats = *owner;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&owner, &stats]() {
+      auto accumulator = MetricAccumulator<int64_t>::Get(owner, stats.data(),
+                                                         stats.size(), 0);
+      std::vector<int64_t> batch(stats.size(), 1);
+      for (int i = 0; i < num_batches; ++i) {
+        accumulator->Add(batch.data(), 10);
+      }
+      FlushThreadMetrics();
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (auto s : stats) {
+    EXPECT_EQ(s, num_threads * num_batches);
+  }
+}
+
+TEST(MetricAccumulator, NewOwner) {
+  const int window = 2;
+  std::vector<int64_t> stats(window * 2, 0);
+  auto owner = std::make_shared<int>(0);
+  std::weak_ptr<MetricAccumulator<int64_t>> released;
+  {
+    auto accumulator =
+        MetricAccumulator<int64_t>::Get(owner, stats.data(), 2, window);
+    std::vector<int64_t> batch = {1, 1};
+    accumulator->Add(batch.data(), 1);
+    // pending, not merged yet
+    accumulator->Add(batch.data(), 2);
+    released = accumulator;
+  }
+
+  // The statistics are freed, and new ones come at the same address.
+  owner = std::make_shared<int>(0);
+  std::fill(stats.begin(), stats.end(), 0);
+  auto accumulator =
+      MetricAccumulator<int64_t>::Get(owner, stats.data(), 2, window);
+  EXPECT_TRUE(released.expired());
+  std::vector<int64_t> batch = {5, 1};
+  const int64_t* view = accumulator->Add(batch.data(), 1);
+  // nothing is inherited, neither the pending batch nor the cursor
+  EXPECT_EQ(view[0], 5);
+  EXPECT_EQ(view[1], 1);
+  EXPECT_EQ(stats[0], 5);
+  EXPECT_EQ(stats[2], 0);
+}
+
+}  // namespace framework
+}  // namespace paddle
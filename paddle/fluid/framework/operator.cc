@@ -28,6 +28,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/transfer_scope_cache.h"
 #include "paddle/fluid/framework/var_type.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_tracer.h"
 
 DECLARE_bool(benchmark);
 DEFINE_bool(check_nan_inf, false,
@@ -179,6 +180,9 @@ void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
     if (platform::IsProfileEnabled()) {
       platform::RecordEvent record_event(Type());
       RunImpl(scope, place);
+    } else if (platform::IsTraceSampled()) {
+      platform::RecordTrace record_trace(Type());
+      RunImpl(scope, place);
     } else {
       RunImpl(scope, place);
     }
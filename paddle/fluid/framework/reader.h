@@ -33,6 +33,12 @@ class ReaderBase {
 
   virtual void Start();
 
+  // Unblocks a ReadNext waiting for data without taking mu_, which the
+  // blocked ReadNext holds, so that a reader reading this one in another
+  // thread can stop that thread before calling Shutdown. The interrupted
+  // reads return no data.
+  virtual void Interrupt() {}
+
   // Return the readers which are the end of decorating chain. Basically
   // they are readers just before read op.
   std::unordered_set<ReaderBase*> GetEndPoints();
@@ -74,6 +80,8 @@ class DecoratedReader : public ReaderBase,
     reader_->InsertDecoratedReader(shared_from_this());
   }
 
+  void Interrupt() override { reader_->Interrupt(); }
+
   ~DecoratedReader();
 
  protected:
@@ -111,5 +111,15 @@ void Tensor::ResetHolder(std::shared_ptr<memory::Allocation> holder) {
   holder_ = holder;
 }
 
+void Tensor::ResetHolderWithType(std::shared_ptr<memory::Allocation> holder,
+                                 proto::VarType::Type type) {
+  PADDLE_ENFORCE_NOT_NULL(holder);
+  PADDLE_ENFORCE_LE(numel() * SizeOfType(type), holder->size(),
+                    "The holder is too small for the tensor.");
+  holder_ = std::move(holder);
+  type_ = type;
+  offset_ = 0;
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -191,6 +191,11 @@ class Tensor {
 
   void ResetHolder(std::shared_ptr<memory::Allocation> holder);
 
+  // Shares the memory of holder from its beginning as the data of type, the
+  // dims must have been set and fit in the holder.
+  void ResetHolderWithType(std::shared_ptr<memory::Allocation> holder,
+                           proto::VarType::Type type);
+
  private:
   /*! holds the memory block if allocated. */
   std::shared_ptr<memory::Allocation> holder_;
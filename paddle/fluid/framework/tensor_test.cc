@@ -14,7 +14,9 @@
 
 #include "paddle/fluid/framework/tensor.h"
 #include <gtest/gtest.h>
+#include <memory>
 #include <string>
+#include <vector>
 #include "paddle/fluid/platform/float16.h"
 
 namespace framework = paddle::framework;
@@ -172,6 +174,35 @@ TEST(Tensor, ShareDataWith) {
 #endif
 }
 
+TEST(Tensor, ResetHolderWithType) {
+  std::vector<int64_t> buffer(24);
+  std::shared_ptr<paddle::memory::Allocation> holder(
+      new paddle::memory::Allocation(buffer.data(),
+                                     buffer.size() * sizeof(int64_t),
+                                     platform::CPUPlace()));
+  framework::Tensor src_tensor;
+  src_tensor.Resize(framework::make_ddim({2, 3, 4}));
+  src_tensor.ResetHolderWithType(holder, framework::proto::VarType::INT64);
+  ASSERT_EQ(src_tensor.type(), framework::proto::VarType::INT64);
+  ASSERT_EQ(src_tensor.data<int64_t>(), buffer.data());
+
+  // the same memory could be viewed as a smaller tensor of another type
+  framework::Tensor dst_tensor;
+  dst_tensor.Resize(framework::make_ddim({4, 5}));
+  dst_tensor.ResetHolderWithType(holder, framework::proto::VarType::FP32);
+  ASSERT_EQ(dst_tensor.data<float>(),
+            reinterpret_cast<float*>(buffer.data()));
+
+  dst_tensor.Resize(framework::make_ddim({5, 5}));
+  bool caught = false;
+  try {
+    dst_tensor.ResetHolderWithType(holder, framework::proto::VarType::INT64);
+  } catch (paddle::platform::EnforceNotMet err) {
+    caught = true;
+  }
+  ASSERT_TRUE(caught);
+}
+
 TEST(Tensor, Slice) {
   {
     framework::Tensor src_tensor;
@@ -199,6 +199,28 @@ static std::string GetTrtCalibPath(const std::string &model_root,
   return model_root + "/trt_calib_" + engine_key;
 }
 
+static std::string GetOptimCachePath(const std::string &model_opt_cache_dir,
+                                     const std::string &cache_key) {
+  return model_opt_cache_dir + "/optim_" + cache_key;
+}
+
+// The size and the modification time of a file in nanoseconds, "" if it
+// doesn't exist.
+static std::string GetFileStamp(const std::string &path) {
+  struct stat statbuf;
+  if (stat(path.c_str(), &statbuf) == -1) return "";
+#if defined(_WIN32)
+  int64_t mtime_nsec = 0;
+#elif defined(__APPLE__)
+  int64_t mtime_nsec = statbuf.st_mtimespec.tv_nsec;
+#else
+  int64_t mtime_nsec = statbuf.st_mtim.tv_nsec;
+#endif
+  return std::to_string(statbuf.st_size) + ":" +
+         std::to_string(static_cast<int64_t>(statbuf.st_mtime)) + "." +
+         std::to_string(mtime_nsec);
+}
+
 // If there is no calib table data file in model_opt_cache_dir, return "".
 static std::string GetTrtCalibTableData(const std::string &model_opt_cache_dir,
                                         const std::string &engine_key,
@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/analysis/ir_pass_manager.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <string>
+#include <tuple>
 #include <vector>
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
 #include "paddle/fluid/framework/ir/graph.h"
@@ -94,12 +97,39 @@ std::unique_ptr<Graph> IRPassManager::Apply(std::unique_ptr<Graph> graph) {
     return graph;
   }
   PADDLE_ENFORCE(graph.get());
+  // The time and the node counts before and after of every pass.
+  std::vector<std::tuple<double, std::string, size_t, size_t>> costs;
+  double total_ms = 0.;
   // Apply all the passes
   for (const auto &pass : passes_) {
     if (pass->Type() != "graph_viz_pass") {
       PrettyLogEndl(Style::H2(), "--- Running IR pass [%s]", pass->Type());
     }
+    const size_t nodes_before = graph->Nodes().size();
+    auto start = std::chrono::steady_clock::now();
     graph = pass->Apply(std::move(graph));
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    total_ms += ms;
+    costs.emplace_back(ms, pass->Type(), nodes_before, graph->Nodes().size());
+  }
+
+  // The passes sorted by cost are only reported with --v=1 or more.
+  if (VLOG_IS_ON(1)) {
+    std::sort(costs.begin(), costs.end(),
+              [](const std::tuple<double, std::string, size_t, size_t> &a,
+                 const std::tuple<double, std::string, size_t, size_t> &b) {
+                return std::get<0>(a) > std::get<0>(b);
+              });
+    VLOG(1) << "IR passes took " << total_ms << " ms";
+    for (auto &cost : costs) {
+      VLOG(1) << string::Sprintf(
+          "    %-45s %10.3f ms %6.2f%%  nodes %d -> %d", std::get<1>(cost),
+          std::get<0>(cost),
+          total_ms > 0. ? std::get<0>(cost) * 100. / total_ms : 0.,
+          std::get<2>(cost), std::get<3>(cost));
+    }
   }
   return graph;
 }
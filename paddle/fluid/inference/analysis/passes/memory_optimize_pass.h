@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -97,6 +98,10 @@ class MemoryOptimizePass : public AnalysisPass {
   mutable int max_lifecycle_{-1};
 };
 
+// Deserialize the batch var shapes from the memory cache file.
+std::vector<std::map<std::string, std::vector<int>>> DeseralizeBatchVarShapes(
+    const std::string &path);
+
 static std::string GetMemoryCachePath(const std::string &model_path,
                                       const std::string &prog_path) {
   auto path = model_path.empty() ? prog_path : model_path;
@@ -97,6 +97,9 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(enable_memory_optim_);
   CP_MEMBER(static_memory_optim_);
   CP_MEMBER(static_memory_optim_force_update_);
+  CP_MEMBER(use_memory_arena_);
+  CP_MEMBER(enable_optim_cache_);
+  CP_MEMBER(optim_cache_dir_);
   // TensorRT related.
   CP_MEMBER(use_tensorrt_);
   CP_MEMBER(tensorrt_workspace_size_);
@@ -243,6 +246,9 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << enable_memory_optim_;
   ss << static_memory_optim_;
   ss << static_memory_optim_force_update_;
+  ss << use_memory_arena_;
+  ss << enable_optim_cache_;
+  ss << optim_cache_dir_;
 
   ss << use_mkldnn_;
   for (auto &item : mkldnn_enabled_op_types_) ss << item;
@@ -295,6 +301,23 @@ bool AnalysisConfig::enable_memory_optim() const {
   return enable_memory_optim_;
 }
 
+void AnalysisConfig::EnableMemoryArena() {
+  if (enable_memory_optim_) {
+    LOG(WARNING) << "The memory arena replaces the memory optimize";
+    enable_memory_optim_ = false;
+  }
+  use_memory_arena_ = true;
+
+  Update();
+}
+
+void AnalysisConfig::EnableOptimCache(const std::string &cache_dir) {
+  enable_optim_cache_ = true;
+  optim_cache_dir_ = cache_dir;
+
+  Update();
+}
+
 void AnalysisConfig::SetModelBuffer(const char *prog_buffer,
                                     size_t prog_buffer_size,
                                     const char *param_buffer,
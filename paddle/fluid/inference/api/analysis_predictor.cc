@@ -14,10 +14,16 @@
 
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
+#include <xxhash.h>
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <fstream>
+#include <iomanip>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
@@ -34,6 +40,7 @@
 #include "paddle/fluid/inference/utils/singleton.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/gpu_info.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -45,6 +52,13 @@
 
 DECLARE_bool(profile);
 
+// Set by the build, see inference/api/CMakeLists.txt. A build out of a git
+// tree is told by its compile time instead.
+#ifndef PADDLE_GIT_COMMIT
+#define PADDLE_BUILD_VERSION ""
+#define PADDLE_GIT_COMMIT __DATE__ " " __TIME__
+#endif
+
 namespace paddle {
 
 using inference::Singleton;
@@ -137,7 +151,10 @@ bool AnalysisPredictor::PrepareProgram(
     // This will change the scope_ address.
     if (config_.ir_optim()) {
       status_ir_optim_enabled_ = true;
-      OptimizeInferenceProgram();
+      if (!LoadOptimCache()) {
+        OptimizeInferenceProgram();
+        SaveOptimCache();
+      }
     } else {
       // Load parameters
       LOG(INFO) << "load parameters ";
@@ -169,6 +186,22 @@ bool AnalysisPredictor::PrepareExecutor() {
 
   PADDLE_ENFORCE_NOT_NULL(sub_scope_);
 
+  if (config_.memory_arena_enabled()) {
+    std::string path = inference::analysis::GetMemoryCachePath(
+        config_.model_dir(), config_.prog_file());
+    if (inference::IsFileExists(path)) {
+      memory_arena_.Plan(
+          *inference_program_,
+          inference::analysis::DeseralizeBatchVarShapes(path));
+      LOG(INFO) << "Place " << memory_arena_.slots().size()
+                << " temporary tensors in a memory arena of "
+                << memory_arena_.size() / 1024. / 1024. << " MB";
+    } else {
+      LOG(INFO) << "No memory cache at " << path
+                << ", collect the var shapes to plan the memory arena";
+    }
+  }
+
   return true;
 }
 
@@ -195,7 +228,9 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
 
   // Run the inference program
   // if share variables, we need not create variables
+  memory_arena_.Bind(sub_scope_, place_);
   executor_->Run();
+  memory_arena_.Verify(sub_scope_);
 
   // get fetch variable
   if (!GetFetch(output_data, scope)) {
@@ -474,7 +509,12 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
 }
 
 bool AnalysisPredictor::ZeroCopyRun() {
+  memory_arena_.Bind(sub_scope_, place_);
   executor_->Run();
+  memory_arena_.Verify(sub_scope_);
+  if (need_collect_var_shapes_for_memory_optim()) {
+    CollectVarShapes();
+  }
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(sub_scope_);
   tensor_array_batch_cleaner_.ResetTensorArray();
@@ -582,6 +622,178 @@ bool AnalysisPredictor::LoadParameters() {
   return true;
 }
 
+std::string AnalysisPredictor::OptimCacheKey() {
+  std::stringstream ss;
+  // The cache is only valid for the build that wrote it.
+  ss << "version:" << PADDLE_BUILD_VERSION << ";commit:" << PADDLE_GIT_COMMIT
+     << ";";
+  ss << inference_program_->Proto()->SerializeAsString();
+  // The parameters are told by their sizes and modification times.
+  if (!config_.params_file().empty()) {
+    ss << inference::analysis::GetFileStamp(config_.params_file());
+  } else {
+    for (auto *var : inference_program_->Block(0).AllVars()) {
+      if (IsPersistable(var)) {
+        ss << var->Name() << inference::analysis::GetFileStamp(
+                                 config_.model_dir() + "/" + var->Name());
+      }
+    }
+  }
+  // The static memory optim plans with the var shapes collected by former
+  // runs, so a new shape cache invalidates the optimized program.
+  if (config_.enable_memory_optim() && config_.static_memory_optim_) {
+    ss << "memory_cache:"
+       << inference::analysis::GetFileStamp(
+              inference::analysis::GetMemoryCachePath(config_.model_dir(),
+                                                      config_.prog_file()))
+       << ";";
+  }
+  ss << config_.SerializeInfoCache();
+  for (auto &pass : config_.pass_builder()->AllPasses()) ss << pass << ";";
+  for (auto &pass : config_.pass_builder()->AnalysisPasses()) ss << pass << ";";
+  // The jit kernels and so the fused ops depend on the instruction sets.
+  for (auto isa : {platform::sse42, platform::avx, platform::avx2,
+                   platform::avx512f, platform::avx512_core,
+                   platform::avx512_core_vnni}) {
+    ss << platform::MayIUse(isa);
+  }
+  return ss.str();
+}
+
+bool AnalysisPredictor::LoadOptimCache() {
+  if (!config_.optim_cache_enabled()) return false;
+  if (config_.model_from_memory() || config_.tensorrt_engine_enabled()) {
+    LOG(WARNING) << "The optimized program cache is not supported for the "
+                    "models from memory or with TensorRT";
+    return false;
+  }
+  std::string cache_dir = config_.optim_cache_dir();
+  if (cache_dir.empty()) {
+    std::string model_root =
+        config_.model_dir().empty()
+            ? inference::analysis::GetDirRoot(config_.prog_file())
+            : config_.model_dir();
+    cache_dir = model_root + "/_opt_cache";
+  }
+  // The files are named by the digest of the key, and the key itself is
+  // saved beside them to tell the collisions.
+  optim_cache_key_ = OptimCacheKey();
+  std::stringstream digest;
+  digest << std::hex << std::setw(16) << std::setfill('0')
+         << XXH64(optim_cache_key_.data(), optim_cache_key_.size(), 0);
+  optim_cache_path_ =
+      inference::analysis::GetOptimCachePath(cache_dir, digest.str());
+  // The key is written after the program and the parameters.
+  std::string prog_path = optim_cache_path_ + ".model";
+  std::string params_path = optim_cache_path_ + ".params";
+  std::string key_path = optim_cache_path_ + ".key";
+  if (!inference::IsFileExists(key_path) ||
+      !inference::IsFileExists(prog_path) ||
+      !inference::IsFileExists(params_path)) {
+    LOG(INFO) << "No optimized program cached at " << optim_cache_path_;
+    return false;
+  }
+  {
+    std::ifstream fin(key_path, std::ios::in | std::ios::binary);
+    std::stringstream stored_key;
+    stored_key << fin.rdbuf();
+    if (stored_key.str() != optim_cache_key_) {
+      LOG(WARNING) << "The optimized program cached at " << optim_cache_path_
+                   << " is for another model or build, it is replaced";
+      return false;
+    }
+  }
+
+  inference_program_.reset(new framework::ProgramDesc(
+      inference::analysis::LoadProgramDesc(prog_path)));
+  executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
+  std::vector<std::string> params;
+  for (auto *var : inference_program_->Block(0).AllVars()) {
+    if (IsPersistable(var)) params.push_back(var->Name());
+  }
+  std::sort(params.begin(), params.end());
+  framework::ProgramDesc load_program;
+  framework::OpDesc *op = load_program.MutableBlock(0)->AppendOp();
+  op->SetType("load_combine");
+  op->SetOutput("Out", params);
+  op->SetAttr("file_path", {params_path});
+  op->CheckAttrs();
+  framework::NaiveExecutor e(place_);
+  e.Prepare(scope_.get(), load_program, 0, false);
+  e.Run();
+
+  status_program_optimized_ = true;
+  LOG(INFO) << "Load the optimized program from " << prog_path
+            << ", the analysis is skipped";
+  return true;
+}
+
+void AnalysisPredictor::SaveOptimCache() {
+  if (optim_cache_path_.empty()) return;
+  std::string cache_dir = inference::analysis::GetDirRoot(optim_cache_path_);
+  if (!inference::analysis::PathExists(cache_dir) &&
+      MKDIR(cache_dir.c_str()) == -1) {
+    LOG(WARNING) << "Can not create the optimized program cache directory "
+                 << cache_dir;
+    return;
+  }
+  // Other processes may save the same cache concurrently, so the files are
+  // written aside and renamed.
+  std::string suffix =
+      ".tmp" + std::to_string(std::chrono::steady_clock::now()
+                                  .time_since_epoch()
+                                  .count());
+  std::string prog_path = optim_cache_path_ + ".model";
+  std::string params_path = optim_cache_path_ + ".params";
+  std::string key_path = optim_cache_path_ + ".key";
+
+  std::vector<std::string> params;
+  for (auto *var : inference_program_->Block(0).AllVars()) {
+    if (!IsPersistable(var)) continue;
+    auto *param = scope_->FindVar(var->Name());
+    if (!param || !param->IsType<framework::LoDTensor>() ||
+        !param->Get<framework::LoDTensor>().IsInitialized()) {
+      LOG(WARNING) << "The optimized program is not cached, for the "
+                      "persistable variable "
+                   << var->Name() << " is not an initialized tensor";
+      return;
+    }
+    params.push_back(var->Name());
+  }
+  std::sort(params.begin(), params.end());
+  framework::ProgramDesc save_program;
+  framework::OpDesc *op = save_program.MutableBlock(0)->AppendOp();
+  op->SetType("save_combine");
+  op->SetInput("X", params);
+  op->SetAttr("file_path", {params_path + suffix});
+  op->CheckAttrs();
+  framework::NaiveExecutor e(place_);
+  e.Prepare(scope_.get(), save_program, 0, false);
+  e.Run();
+
+  std::vector<std::pair<std::string, std::string>> files = {
+      {prog_path, inference_program_->Proto()->SerializeAsString()},
+      {key_path, optim_cache_key_}};
+  for (auto &file : files) {
+    std::ofstream fout(file.first + suffix, std::ios::out | std::ios::binary);
+    if (!fout.is_open()) {
+      LOG(WARNING) << "Can not write the optimized program to " << file.first;
+      std::remove((params_path + suffix).c_str());
+      std::remove((prog_path + suffix).c_str());
+      return;
+    }
+    fout << file.second;
+  }
+  // The key is renamed last, so a partially saved cache is never loaded.
+  if (std::rename((params_path + suffix).c_str(), params_path.c_str()) != 0 ||
+      std::rename((prog_path + suffix).c_str(), prog_path.c_str()) != 0 ||
+      std::rename((key_path + suffix).c_str(), key_path.c_str()) != 0) {
+    LOG(WARNING) << "Can not save the optimized program to " << prog_path;
+    return;
+  }
+  LOG(INFO) << "Save the optimized program to " << prog_path;
+}
+
 #if PADDLE_WITH_TENSORRT
 bool AnalysisPredictor::SaveTrtCalibToDisk() {
   PADDLE_ENFORCE(config_.tensorrt_engine_enabled(),
@@ -711,7 +923,10 @@ bool AnalysisPredictor::need_collect_var_shapes_for_memory_optim() {
   if (need_collect_var_shapes_ >= 0) return need_collect_var_shapes_;
   bool need = false;
   // check if the cache exists
-  if (!config_.enable_memory_optim()) {
+  if (config_.memory_arena_enabled()) {
+    need = !inference::IsFileExists(inference::analysis::GetMemoryCachePath(
+        config_.model_dir(), config_.prog_file()));
+  } else if (!config_.enable_memory_optim()) {
     need = false;
   } else if (config_.static_memory_optim_ &&
              !inference::IsFileExists(inference::analysis::GetMemoryCachePath(
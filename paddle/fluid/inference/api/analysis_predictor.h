@@ -20,6 +20,7 @@
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include "paddle/fluid/inference/api/api_impl.h"
+#include "paddle/fluid/inference/api/details/memory_arena.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/string/printf.h"
@@ -90,6 +91,13 @@ class AnalysisPredictor : public PaddlePredictor {
   bool LoadProgramDesc();
   bool LoadParameters();
 
+  // The optimized program cache, see AnalysisConfig::EnableOptimCache.
+  // The key covers the build, the program, the stamps of the parameter files,
+  // the config and the passes.
+  std::string OptimCacheKey();
+  bool LoadOptimCache();
+  void SaveOptimCache();
+
   bool SetFeed(const std::vector<PaddleTensor> &input_datas,
                framework::Scope *scope);
   bool GetFetch(std::vector<PaddleTensor> *output_data,
@@ -119,6 +127,7 @@ class AnalysisPredictor : public PaddlePredictor {
   FRIEND_TEST(AnalysisPredictor, analysis_off);
   FRIEND_TEST(AnalysisPredictor, analysis_on);
   FRIEND_TEST(AnalysisPredictor, with_gpu);
+  FRIEND_TEST(AnalysisPredictor, optim_cache);
 #endif
 
  private:
@@ -136,6 +145,7 @@ class AnalysisPredictor : public PaddlePredictor {
   // concurrency problems, wrong results and memory leak, so cache them.
   std::vector<framework::LoDTensor> feed_tensors_;
   details::TensorArrayBatchCleaner tensor_array_batch_cleaner_;
+  details::MemoryArena memory_arena_;
   // A mutex help to make Clone thread safe.
   std::mutex clone_mutex_;
 
@@ -144,6 +154,10 @@ class AnalysisPredictor : public PaddlePredictor {
   int need_collect_var_shapes_{-1};  // -1 for default, 0 for false, 1 for true.
   std::vector<std::map<std::string, std::vector<int>>> batch_var_shapes_;
 
+  // The path prefix of the optimized program cache, empty if not used.
+  std::string optim_cache_key_;
+  std::string optim_cache_path_;
+
  private:
   // Some status here that help to determine the status inside the predictor.
   bool status_program_optimized_{false};
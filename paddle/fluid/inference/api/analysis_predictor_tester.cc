@@ -15,7 +15,10 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
 #include <thread>  // NOLINT
+#include "paddle/fluid/framework/io/fs.h"
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
@@ -98,6 +101,58 @@ TEST(AnalysisPredictor, analysis_on) {
   inference::CompareTensor(outputs.front(), naive_outputs.front());
 }
 
+TEST(AnalysisPredictor, optim_cache) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.EnableOptimCache();
+  // not to load the cache of a former run
+  framework::localfs_remove(FLAGS_dirname + "/_opt_cache");
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  // The first predictor analyzes the model and saves the cache, the second
+  // loads it.
+  auto predictor0 = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* cached = static_cast<AnalysisPredictor*>(predictor0.get());
+  ASSERT_TRUE(cached->status_program_optimized_);
+  ASSERT_FALSE(cached->optim_cache_path_.empty());
+  ASSERT_TRUE(inference::IsFileExists(cached->optim_cache_path_ + ".model"));
+  ASSERT_TRUE(inference::IsFileExists(cached->optim_cache_path_ + ".params"));
+  ASSERT_TRUE(inference::IsFileExists(cached->optim_cache_path_ + ".key"));
+  std::vector<PaddleTensor> outputs0;
+  ASSERT_TRUE(predictor0->Run(inputs, &outputs0));
+
+  auto predictor1 = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* loaded = static_cast<AnalysisPredictor*>(predictor1.get());
+  ASSERT_TRUE(loaded->status_program_optimized_);
+  ASSERT_EQ(loaded->optim_cache_path_, cached->optim_cache_path_);
+  ASSERT_EQ(loaded->GetSerializedProgram(), cached->GetSerializedProgram());
+  std::vector<PaddleTensor> outputs1;
+  ASSERT_TRUE(predictor1->Run(inputs, &outputs1));
+  ASSERT_EQ(outputs0.size(), outputs1.size());
+  inference::CompareTensor(outputs0.front(), outputs1.front());
+
+  // A cache with another key is not loaded, but analyzed and saved again.
+  std::string key_path = cached->optim_cache_path_ + ".key";
+  {
+    std::ofstream fout(key_path, std::ios::out | std::ios::binary);
+    fout << "another key";
+  }
+  auto predictor2 = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* replaced = static_cast<AnalysisPredictor*>(predictor2.get());
+  ASSERT_EQ(replaced->optim_cache_path_, cached->optim_cache_path_);
+  std::ifstream fin(key_path, std::ios::in | std::ios::binary);
+  std::stringstream key;
+  key << fin.rdbuf();
+  ASSERT_EQ(key.str(), replaced->optim_cache_key_);
+}
+
 TEST(AnalysisPredictor, ZeroCopy) {
   AnalysisConfig config;
   config.SetModel(FLAGS_dirname);
@@ -0,0 +1,207 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/memory_arena.h"
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace details {
+
+namespace {
+constexpr size_t kSlotAlignment = 64;
+
+// The outputs of these ops are known to share the memory of their inputs, or
+// the ops run sub-blocks that use the variables, so the variables they touch
+// are not planned. The other ops sharing memory are found by Verify.
+const std::unordered_set<std::string> &OpsNotPlanned() {
+  static std::unordered_set<std::string> ops(
+      {"feed", "fetch", "lod_reset", "split_lod_tensor", "merge_lod_tensor",
+       "tensor_array_to_tensor", "while", "recurrent", "conditional_block",
+       "py_func", "print", "share_data"});
+  return ops;
+}
+}  // namespace
+
+void MemoryArena::Plan(
+    const framework::ProgramDesc &program,
+    const std::vector<std::map<std::string, std::vector<int>>>
+        &batch_var_shapes) {
+  program_ = &program;
+  batch_var_shapes_ = batch_var_shapes;
+  aliased_.clear();
+  verified_ = false;
+  Replan();
+}
+
+void MemoryArena::Replan() {
+  slots_.clear();
+  size_ = 0;
+  arena_.reset();
+
+  auto &block = program_->Block(0);
+  auto ops = block.AllOps();
+  std::unordered_map<std::string, std::pair<int, int>> lifetimes;
+  std::unordered_set<std::string> written, read, excluded;
+  for (int i = 0; i < static_cast<int>(ops.size()); ++i) {
+    auto *op = ops[i];
+    bool exclude =
+        OpsNotPlanned().count(op->Type()) || op->HasAttr("sub_block");
+    auto use = [&](const std::string &name) {
+      auto it = lifetimes.find(name);
+      if (it == lifetimes.end()) {
+        lifetimes.emplace(name, std::make_pair(i, i));
+      } else {
+        it->second.second = i;
+      }
+      if (exclude) excluded.insert(name);
+    };
+    for (auto &name : op->InputArgumentNames()) {
+      use(name);
+      read.insert(name);
+    }
+    for (auto &name : op->OutputArgumentNames()) {
+      use(name);
+      written.insert(name);
+    }
+  }
+
+  for (auto &item : lifetimes) {
+    auto &name = item.first;
+    auto *var = block.FindVar(name);
+    if (!var || var->Persistable() ||
+        var->GetType() != framework::proto::VarType::LOD_TENSOR ||
+        !written.count(name) || !read.count(name) || excluded.count(name) ||
+        aliased_.count(name)) {
+      continue;
+    }
+    int64_t numel = -1;
+    for (auto &batch : batch_var_shapes_) {
+      auto it = batch.find(name);
+      if (it == batch.end()) continue;
+      int64_t cur = 1;
+      for (int d : it->second) cur *= d;
+      numel = std::max(numel, cur);
+    }
+    if (numel <= 0) continue;
+    size_t size = numel * framework::SizeOfType(var->GetDataType());
+    size = (size + kSlotAlignment - 1) / kSlotAlignment * kSlotAlignment;
+    slots_.push_back(Slot{name, var->GetDataType(), 0, size, item.second.first,
+                          item.second.second, nullptr});
+  }
+
+  // Place the larger tensors first, each at the lowest offset among the gaps
+  // left by the placed tensors alive at the same time that fits it best.
+  std::sort(slots_.begin(), slots_.end(), [](const Slot &a, const Slot &b) {
+    return a.size != b.size ? a.size > b.size
+                            : (a.first_use != b.first_use
+                                   ? a.first_use < b.first_use
+                                   : a.name < b.name);
+  });
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    auto &slot = slots_[i];
+    std::vector<std::pair<size_t, size_t>> busy;
+    for (size_t j = 0; j < i; ++j) {
+      auto &placed = slots_[j];
+      if (placed.first_use <= slot.last_use &&
+          slot.first_use <= placed.last_use) {
+        busy.emplace_back(placed.offset, placed.offset + placed.size);
+      }
+    }
+    std::sort(busy.begin(), busy.end());
+    size_t best_offset = 0;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t end = 0;
+    for (auto &range : busy) {
+      if (range.first > end) {
+        size_t gap = range.first - end;
+        if (gap >= slot.size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = end;
+        }
+      }
+      end = std::max(end, range.second);
+    }
+    slot.offset = best_gap == std::numeric_limits<size_t>::max() ? end
+                                                                 : best_offset;
+    size_ = std::max(size_, slot.offset + slot.size);
+  }
+  VLOG(3) << "Plan " << slots_.size() << " tensors in an arena of " << size_
+          << " bytes";
+}
+
+void MemoryArena::Bind(framework::Scope *scope,
+                       const platform::Place &place) {
+  if (slots_.empty()) return;
+  if (!arena_) {
+    arena_ = memory::Alloc(place, size_);
+    auto *base = reinterpret_cast<uint8_t *>(arena_->ptr());
+    for (auto &slot : slots_) {
+      slot.slice = std::make_shared<memory::Allocation>(base + slot.offset,
+                                                        slot.size, place);
+    }
+  }
+  for (auto &slot : slots_) {
+    auto *var = scope->FindVar(slot.name);
+    if (!var) continue;
+    auto *tensor = var->GetMutable<framework::LoDTensor>();
+    if (tensor->Holder() == slot.slice) continue;
+    auto type = tensor->IsInitialized() ? tensor->type() : slot.type;
+    if (tensor->numel() * framework::SizeOfType(type) > slot.size) continue;
+    tensor->ResetHolderWithType(slot.slice, type);
+  }
+}
+
+bool MemoryArena::Verify(framework::Scope *scope) {
+  if (verified_ || !arena_) return false;
+  std::unordered_map<const memory::Allocation *, const Slot *> owners;
+  for (auto &slot : slots_) {
+    owners.emplace(slot.slice.get(), &slot);
+  }
+  std::vector<framework::LoDTensor *> bound;
+  std::vector<std::string> aliased;
+  for (auto &name : scope->LocalVarNames()) {
+    auto *var = scope->FindLocalVar(name);
+    if (!var || !var->IsType<framework::LoDTensor>()) continue;
+    auto *tensor = var->GetMutable<framework::LoDTensor>();
+    auto it = owners.find(tensor->Holder().get());
+    if (it == owners.end()) continue;
+    bound.push_back(tensor);
+    if (it->second->name != name) {
+      VLOG(3) << name << " shares the slice of " << it->second->name
+              << ", they are not planned";
+      aliased.push_back(name);
+      aliased.push_back(it->second->name);
+    }
+  }
+  if (aliased.empty()) {
+    verified_ = true;
+    return false;
+  }
+
+  aliased_.insert(aliased.begin(), aliased.end());
+  // The old arena is freed, so no tensor should keep a slice of it.
+  for (auto *tensor : bound) {
+    tensor->clear();
+  }
+  Replan();
+  return true;
+}
+
+}  // namespace details
+}  // namespace paddle
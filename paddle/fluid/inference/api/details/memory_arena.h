@@ -0,0 +1,87 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace details {
+
+// A static memory plan of the temporary variables of an inference program.
+// Every temporary tensor gets a slice of one pre-sized arena, the slices of
+// the tensors whose lifetimes don't overlap may overlap.
+//
+// The lifetime of a variable is the range of the ops in block 0 that use it,
+// and its size is the largest one recorded in the batch var shapes. Only the
+// LoDTensors both written and read by the ops are planned, so the feeds, the
+// fetches and the persistable variables keep their own memory. The tensors
+// found sharing memory with each other after a run are not planned either,
+// see Verify.
+class MemoryArena {
+ public:
+  struct Slot {
+    std::string name;
+    framework::proto::VarType::Type type;
+    size_t offset;
+    size_t size;
+    int first_use;
+    int last_use;
+    std::shared_ptr<memory::Allocation> slice;
+  };
+
+  void Plan(const framework::ProgramDesc &program,
+            const std::vector<std::map<std::string, std::vector<int>>>
+                &batch_var_shapes);
+
+  // Point the planned tensors in scope to their slices, it should be called
+  // before every run. A tensor that has outgrown its slice keeps the memory
+  // the operator allocated.
+  void Bind(framework::Scope *scope, const platform::Place &place);
+
+  // Finds the tensors in scope holding the slice of another planned tensor
+  // after a run, e.g. through ShareDataWith, which may outlive the slice.
+  // They and the tensors they alias are excluded, and the arena is planned
+  // again. It should be called after every run, and only checks until a run
+  // finds no alias. Returns whether the plan changed.
+  bool Verify(framework::Scope *scope);
+
+  // The size of the arena in bytes.
+  size_t size() const { return size_; }
+  const std::vector<Slot> &slots() const { return slots_; }
+
+ private:
+  void Replan();
+
+  const framework::ProgramDesc *program_{nullptr};
+  std::vector<std::map<std::string, std::vector<int>>> batch_var_shapes_;
+  // The variables found sharing memory by Verify.
+  std::unordered_set<std::string> aliased_;
+  bool verified_{false};
+
+  std::vector<Slot> slots_;
+  size_t size_{0};
+  memory::AllocationPtr arena_;
+};
+
+}  // namespace details
+}  // namespace paddle
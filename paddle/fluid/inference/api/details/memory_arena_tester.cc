@@ -0,0 +1,136 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/memory_arena.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <unordered_map>
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace details {
+
+// a -> op0 -> b -> op1 -> c -> op2 -> d -> op3 -> e
+static void BuildProgram(framework::ProgramDesc *program) {
+  auto *block = program->MutableBlock(0);
+  for (auto name : {"a", "b", "c", "d", "e"}) {
+    auto *var = block->Var(name);
+    var->SetType(framework::proto::VarType::LOD_TENSOR);
+    var->SetDataType(framework::proto::VarType::FP32);
+  }
+  const char *names[] = {"a", "b", "c", "d", "e"};
+  for (int i = 0; i < 4; ++i) {
+    auto *op = block->AppendOp();
+    op->SetType("relu");
+    op->SetInput("X", {names[i]});
+    op->SetOutput("Out", {names[i + 1]});
+  }
+}
+
+TEST(MemoryArena, Plan) {
+  framework::ProgramDesc program;
+  BuildProgram(&program);
+  std::vector<std::map<std::string, std::vector<int>>> shapes(2);
+  for (auto name : {"a", "b", "c", "d", "e"}) {
+    shapes[0][name] = {2, 32};
+    shapes[1][name] = {4, 32};
+  }
+
+  MemoryArena arena;
+  arena.Plan(program, shapes);
+  // a is only read and e is only written.
+  ASSERT_EQ(arena.slots().size(), 3UL);
+  std::unordered_map<std::string, const MemoryArena::Slot *> slots;
+  for (auto &slot : arena.slots()) {
+    // The largest batch is planned.
+    ASSERT_EQ(slot.size, 4 * 32 * sizeof(float));
+    slots[slot.name] = &slot;
+  }
+  // b and d are not alive at the same time.
+  ASSERT_EQ(slots["b"]->offset, slots["d"]->offset);
+  ASSERT_NE(slots["b"]->offset, slots["c"]->offset);
+  ASSERT_EQ(arena.size(), 2 * 4 * 32 * sizeof(float));
+
+  framework::Scope scope;
+  for (auto name : {"a", "b", "c", "d", "e"}) {
+    scope.Var(name)->GetMutable<framework::LoDTensor>();
+  }
+  platform::CPUPlace place;
+  arena.Bind(&scope, place);
+  auto &b = *scope.FindVar("b")->GetMutable<framework::LoDTensor>();
+  auto &c = *scope.FindVar("c")->GetMutable<framework::LoDTensor>();
+  auto &d = *scope.FindVar("d")->GetMutable<framework::LoDTensor>();
+  b.Resize({4, 32});
+  c.Resize({3, 32});
+  d.Resize({4, 32});
+  float *b_data = b.mutable_data<float>(place);
+  float *c_data = c.mutable_data<float>(place);
+  ASSERT_EQ(b_data, d.mutable_data<float>(place));
+  ASSERT_NE(b_data, c_data);
+
+  // A tensor larger than its slice gets its own memory, and is bound again
+  // when it fits.
+  c.Resize({8, 32});
+  ASSERT_NE(c.mutable_data<float>(place), c_data);
+  arena.Bind(&scope, place);
+  ASSERT_NE(c.data<float>(), c_data);
+  c.Resize({2, 32});
+  arena.Bind(&scope, place);
+  ASSERT_EQ(c.mutable_data<float>(place), c_data);
+}
+
+TEST(MemoryArena, Verify) {
+  framework::ProgramDesc program;
+  BuildProgram(&program);
+  std::vector<std::map<std::string, std::vector<int>>> shapes(1);
+  for (auto name : {"a", "b", "c", "d", "e"}) {
+    shapes[0][name] = {4, 32};
+  }
+  MemoryArena arena;
+  arena.Plan(program, shapes);
+  ASSERT_EQ(arena.slots().size(), 3UL);
+
+  framework::Scope scope;
+  for (auto name : {"a", "b", "c", "d", "e"}) {
+    scope.Var(name)->GetMutable<framework::LoDTensor>();
+  }
+  platform::CPUPlace place;
+  auto &b = *scope.FindVar("b")->GetMutable<framework::LoDTensor>();
+  auto &c = *scope.FindVar("c")->GetMutable<framework::LoDTensor>();
+  auto &d = *scope.FindVar("d")->GetMutable<framework::LoDTensor>();
+  arena.Bind(&scope, place);
+  b.Resize({4, 32});
+  b.mutable_data<float>(place);
+  // c shares the memory of b, like a reshape in place.
+  c.ShareDataWith(b);
+  d.Resize({4, 32});
+  d.mutable_data<float>(place);
+
+  ASSERT_TRUE(arena.Verify(&scope));
+  ASSERT_EQ(arena.slots().size(), 1UL);
+  ASSERT_EQ(arena.slots()[0].name, "d");
+  // The tensors don't keep the memory of the old arena.
+  ASSERT_EQ(b.Holder(), nullptr);
+  ASSERT_EQ(c.Holder(), nullptr);
+  ASSERT_EQ(d.Holder(), nullptr);
+
+  arena.Bind(&scope, place);
+  float *d_data = d.mutable_data<float>(place);
+  ASSERT_FALSE(arena.Verify(&scope));
+  arena.Bind(&scope, place);
+  ASSERT_EQ(d.mutable_data<float>(place), d_data);
+}
+
+}  // namespace details
+}  // namespace paddle
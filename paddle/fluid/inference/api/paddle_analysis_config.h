@@ -193,6 +193,33 @@ struct AnalysisConfig {
   /** Tell whether the memory optimization is activated. */
   bool enable_memory_optim() const;
 
+  /** \brief Place the temporary tensors in one pre-sized memory arena.
+   *
+   * The lifetimes of the temporary tensors are analyzed, and their largest
+   * shapes are recorded by running the predictor with some batches first, the
+   * same as the static memory optimize. Then every tensor is bound to a slice
+   * of the arena before each run, so that no memory is allocated in the
+   * runs. It replaces EnableMemoryOptim.
+   */
+  void EnableMemoryArena();
+  /** A boolean state telling whether the memory arena is used. */
+  bool memory_arena_enabled() const { return use_memory_arena_; }
+
+  /** \brief Cache the optimized program and parameters.
+   *
+   * After the first analysis, the optimized program and the transformed
+   * parameters are saved, keyed by the model, the config and the CPU
+   * instruction sets. The later predictors of the same model load them and
+   * skip the analysis.
+   * @param cache_dir the directory of the cache, `_opt_cache` under the model
+   * directory by default.
+   */
+  void EnableOptimCache(const std::string& cache_dir = "");
+  /** A boolean state telling whether the optimized program cache is used. */
+  bool optim_cache_enabled() const { return enable_optim_cache_; }
+  /** The directory of the optimized program cache, empty for the default. */
+  const std::string& optim_cache_dir() const { return optim_cache_dir_; }
+
   friend class ::paddle::AnalysisPredictor;
 
   /** NOTE just for developer, not an official API, easily to be broken.
@@ -239,6 +266,11 @@ struct AnalysisConfig {
   bool static_memory_optim_{false};
   bool static_memory_optim_force_update_{false};
 
+  bool use_memory_arena_{false};
+
+  bool enable_optim_cache_{false};
+  std::string optim_cache_dir_;
+
   bool use_mkldnn_{false};
   std::unordered_set<std::string> mkldnn_enabled_op_types_;
 
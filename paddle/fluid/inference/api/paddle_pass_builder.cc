@@ -98,10 +98,13 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
   // NOTE the large fusions should be located in the front, so that they will
   // not be damaged by smaller ones.
   passes_.assign({
-      "infer_clean_graph_pass",         //
-      "attention_lstm_fuse_pass",       //
-      "seqpool_concat_fuse_pass",       //
-      "seqconv_eltadd_relu_fuse_pass",  //
+      "infer_clean_graph_pass",                 //
+      "constant_folding_pass",                  //
+      "common_subexpression_elimination_pass",  //
+      "multihead_attention_fuse_pass",          //
+      "attention_lstm_fuse_pass",               //
+      "seqpool_concat_fuse_pass",               //
+      "seqconv_eltadd_relu_fuse_pass",          //
       // "embedding_fc_lstm_fuse_pass", //
       "fc_lstm_fuse_pass",             //
       "mul_lstm_fuse_pass",            //
@@ -115,6 +118,7 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
       "conv_eltwiseadd_bn_fuse_pass",  //
       "is_test_pass",                  //
       "identity_scale_op_clean_pass",  //
+      "elementwise_chain_fuse_pass",   //
   });
   use_gpu_ = false;
 }
@@ -190,6 +190,27 @@ TEST(Analyzer_bert, fuse_statis) {
   LOG(INFO) << "num_ops: " << num_ops;
 }
 
+// Compare the operators and the latency with and without CSE
+TEST(Analyzer_bert, common_subexpression_elimination) {
+  AnalysisConfig cfg;
+  SetConfig(&cfg);
+
+  std::vector<std::vector<PaddleTensor>> inputs;
+  LoadInputData(&inputs);
+  CompareWithAndWithoutPass(cfg, "common_subexpression_elimination_pass",
+                            inputs);
+}
+
+// Compare the operators and the latency with and without the fused attention
+TEST(Analyzer_bert, multihead_attention) {
+  AnalysisConfig cfg;
+  SetConfig(&cfg);
+
+  std::vector<std::vector<PaddleTensor>> inputs;
+  LoadInputData(&inputs);
+  CompareWithAndWithoutPass(cfg, "multihead_attention_fuse_pass", inputs);
+}
+
 // Compare result of NativeConfig and AnalysisConfig
 void compare(bool use_mkldnn = false) {
   AnalysisConfig cfg;
@@ -232,6 +232,17 @@ TEST(Analyzer_dam, fuse_statis) {
   ASSERT_TRUE(fuse_statis.count("fc_fuse"));
 }
 
+// Compare the operators and the latency with and without CSE
+TEST(Analyzer_dam, common_subexpression_elimination) {
+  AnalysisConfig cfg;
+  SetConfig(&cfg);
+
+  std::vector<std::vector<PaddleTensor>> inputs;
+  SetInput(&inputs);
+  CompareWithAndWithoutPass(cfg, "common_subexpression_elimination_pass",
+                            inputs);
+}
+
 // Compare result of NativeConfig and AnalysisConfig
 void compare(bool use_mkldnn = false) {
   AnalysisConfig cfg;
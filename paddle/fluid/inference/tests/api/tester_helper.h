@@ -356,6 +356,36 @@ void CompareNativeAndAnalysis(
   CompareResult(analysis_outputs, native_outputs);
 }
 
+// Reports the numbers of operators and the latencies with and without the
+// pass, and checks the pass does not change the results.
+void CompareWithAndWithoutPass(
+    const AnalysisConfig &config, const std::string &pass,
+    const std::vector<std::vector<PaddleTensor>> &inputs) {
+  AnalysisConfig config_without_pass(config);
+  config_without_pass.pass_builder()->DeletePass(pass);
+  auto *base_config =
+      reinterpret_cast<const PaddlePredictor::Config *>(&config);
+  auto *base_config_without_pass =
+      reinterpret_cast<const PaddlePredictor::Config *>(&config_without_pass);
+
+  int num_ops = 0;
+  int num_ops_without_pass = 0;
+  GetFuseStatis(CreateTestPredictor(base_config, true).get(), &num_ops);
+  GetFuseStatis(CreateTestPredictor(base_config_without_pass, true).get(),
+                &num_ops_without_pass);
+  VLOG(1) << "num_ops: " << num_ops << " with " << pass << ", "
+          << num_ops_without_pass << " without it";
+  EXPECT_LE(num_ops, num_ops_without_pass);
+
+  std::vector<PaddleTensor> outputs, outputs_without_pass;
+  VLOG(1) << "Run without " << pass;
+  TestOneThreadPrediction(base_config_without_pass, inputs,
+                          &outputs_without_pass, true);
+  VLOG(1) << "Run with " << pass;
+  TestOneThreadPrediction(base_config, inputs, &outputs, true);
+  CompareResult(outputs, outputs_without_pass);
+}
+
 template <typename T>
 std::string LoDTensorSummary(const framework::LoDTensor &tensor) {
   std::stringstream ss;
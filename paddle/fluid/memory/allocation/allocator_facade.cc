@@ -28,6 +28,7 @@
 #include "paddle/fluid/memory/allocation/legacy_allocator.h"
 #include "paddle/fluid/memory/allocation/locked_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
+#include "paddle/fluid/memory/allocation/thread_cached_allocator.h"
 #include "paddle/fluid/memory/allocation/zero_size_allocator.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/place.h"
@@ -258,12 +259,23 @@ std::shared_ptr<Allocation> AllocatorFacade::AllocShared(
 
 AllocationPtr AllocatorFacade::Alloc(const platform::Place& place, size_t size,
                                      Allocator::Attr attr) {
+  if (size > 0 && platform::is_cpu_place(place)) {
+    auto* thread_cached_allocator = ThreadCachedAllocator::Current();
+    if (thread_cached_allocator) {
+      return thread_cached_allocator->Allocate(size, attr);
+    }
+  }
+  return GetAllocator(place)->Allocate(size, attr);
+}
+
+std::shared_ptr<Allocator> AllocatorFacade::GetAllocator(
+    const platform::Place& place) {
   auto it = m_->allocators_.find(place);
   if (it == m_->allocators_.end()) {
     throw BadAlloc(
         string::Sprintf("No such allocator for the place, %s", place));
   }
-  return m_->allocators_.at(place)->Allocate(size, attr);
+  return it->second;
 }
 
 }  // namespace allocation
@@ -46,6 +46,10 @@ class AllocatorFacade {
   AllocationPtr Alloc(const platform::Place& place, size_t size,
                       Allocator::Attr attr = Allocator::kDefault);
 
+  // Get the allocator of the place, it is not affected by the
+  // ThreadCachedAllocator of the calling thread.
+  std::shared_ptr<Allocator> GetAllocator(const platform::Place& place);
+
   // TODO(yy): Allocate a Copy-On-Write allocation?
  private:
   AllocatorFacade();
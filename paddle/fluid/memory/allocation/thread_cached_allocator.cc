@@ -0,0 +1,158 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_cached_allocator.h"
+#include <algorithm>
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+namespace {
+
+thread_local ThreadCachedAllocator* g_current_allocator = nullptr;
+
+class ThreadCachedAllocation : public Allocation {
+ public:
+  ThreadCachedAllocation(AllocationPtr allocation, size_t size_class,
+                         std::shared_ptr<ThreadCachedAllocator> owner)
+      : Allocation(allocation->ptr(), allocation->size(),
+                   allocation->place()),
+        allocation_(std::move(allocation)),
+        size_class_(size_class),
+        owner_(std::move(owner)) {}
+
+  AllocationPtr allocation_;
+  size_t size_class_;
+  std::shared_ptr<ThreadCachedAllocator> owner_;
+};
+
+}  // namespace
+
+ThreadCachedAllocator::ThreadCachedAllocator(
+    std::shared_ptr<Allocator> underlying)
+    : underlying_allocator_(std::move(underlying)) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      "Underlying allocator of ThreadCachedAllocator must not be null");
+}
+
+size_t ThreadCachedAllocator::SizeClass(size_t size) {
+  constexpr size_t kMinSizeClass = 256;
+  if (size <= kMinSizeClass) return kMinSizeClass;
+  // size is in (2^b, 2^(b+1)], rounded up to a multiple of 2^(b-2)
+  size_t b = 0;
+  while ((static_cast<size_t>(2) << b) < size) ++b;
+  size_t step = static_cast<size_t>(1) << (b - 2);
+  return (size + step - 1) / step * step;
+}
+
+ThreadCachedAllocator* ThreadCachedAllocator::Current() {
+  return g_current_allocator;
+}
+
+Allocation* ThreadCachedAllocator::AllocateImpl(size_t size,
+                                                Allocator::Attr attr) {
+  size_t size_class = SizeClass(size);
+  AllocationPtr allocation;
+  {
+    std::lock_guard<std::mutex> guard(mtx_);
+    ++stat_.allocs;
+    auto& bucket = buckets_[size_class];
+    if (!bucket.cached.empty()) {
+      allocation = std::move(bucket.cached.back());
+      bucket.cached.pop_back();
+      stat_.cached_bytes -= size_class;
+    } else {
+      ++stat_.underlying_allocs;
+    }
+    ++bucket.used;
+    bucket.batch_high_water = std::max(bucket.batch_high_water, bucket.used);
+    stat_.used_bytes += size_class;
+  }
+  if (!allocation) {
+    try {
+      allocation = underlying_allocator_->Allocate(size_class, attr);
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(mtx_);
+      --buckets_[size_class].used;
+      stat_.used_bytes -= size_class;
+      throw;
+    }
+  }
+  return new ThreadCachedAllocation(std::move(allocation), size_class,
+                                    shared_from_this());
+}
+
+void ThreadCachedAllocator::Free(Allocation* allocation) {
+  auto* cached = static_cast<ThreadCachedAllocation*>(allocation);
+  // The allocation may be the last owner of the allocator, which must be
+  // destroyed after the lock is released.
+  auto owner = std::move(cached->owner_);
+  {
+    std::lock_guard<std::mutex> guard(mtx_);
+    auto& bucket = buckets_[cached->size_class_];
+    --bucket.used;
+    bucket.cached.emplace_back(std::move(cached->allocation_));
+    stat_.used_bytes -= cached->size_class_;
+    stat_.cached_bytes += cached->size_class_;
+  }
+  delete cached;
+}
+
+void ThreadCachedAllocator::Trim() {
+  std::vector<AllocationPtr> trimmed;
+  {
+    std::lock_guard<std::mutex> guard(mtx_);
+    for (auto& pair : buckets_) {
+      auto& bucket = pair.second;
+      bucket.high_waters.push_back(bucket.batch_high_water);
+      if (bucket.high_waters.size() > kHighWaterWindow) {
+        bucket.high_waters.pop_front();
+      }
+      bucket.batch_high_water = bucket.used;
+      size_t high_water = *std::max_element(bucket.high_waters.begin(),
+                                            bucket.high_waters.end());
+      while (!bucket.cached.empty() &&
+             bucket.used + bucket.cached.size() > high_water) {
+        trimmed.emplace_back(std::move(bucket.cached.back()));
+        bucket.cached.pop_back();
+        stat_.cached_bytes -= pair.first;
+        ++stat_.underlying_frees;
+      }
+    }
+  }
+  // the trimmed allocations are freed out of the lock
+}
+
+ThreadCachedAllocator::Stat ThreadCachedAllocator::GetStat() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  return stat_;
+}
+
+ThreadCachedAllocatorGuard::ThreadCachedAllocatorGuard(
+    ThreadCachedAllocator* allocator)
+    : prev_(g_current_allocator) {
+  g_current_allocator = allocator;
+}
+
+ThreadCachedAllocatorGuard::~ThreadCachedAllocatorGuard() {
+  g_current_allocator = prev_;
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,107 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// ThreadCachedAllocator caches the CPU allocations of one thread, e.g. the
+// intermediate tensors of a Hogwild worker whose shapes vary batch after
+// batch with LoD. The sizes are rounded up to geometric size classes, four
+// classes per power of 2, so that a tensor keeps its capacity while it grows
+// a little, and the freed allocations are kept in the buckets of their
+// classes instead of being returned to the underlying allocator.
+//
+// Trim() should be called after every batch. It frees the cached allocations
+// of a class beyond the high water of the class in the recent batches, i.e.
+// the most allocations of the class in use at the same time.
+//
+// The allocations may be freed by any thread, and they keep the allocator
+// alive until they are freed. The underlying allocator is shared by all the
+// threads, so it must be thread safe, like the CPU allocator of the facade.
+class ThreadCachedAllocator
+    : public Allocator,
+      public std::enable_shared_from_this<ThreadCachedAllocator> {
+ public:
+  struct Stat {
+    // the allocations requested by the users
+    size_t allocs{0};
+    // the allocations and the frees passed to the underlying allocator
+    size_t underlying_allocs{0};
+    size_t underlying_frees{0};
+    size_t used_bytes{0};
+    size_t cached_bytes{0};
+  };
+
+  explicit ThreadCachedAllocator(std::shared_ptr<Allocator> underlying);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  void Trim();
+
+  Stat GetStat();
+
+  static size_t SizeClass(size_t size);
+
+  // The allocator used by the CPU allocations of the calling thread, which is
+  // set by ThreadCachedAllocatorGuard.
+  static ThreadCachedAllocator* Current();
+
+ protected:
+  Allocation* AllocateImpl(size_t size, Allocator::Attr attr) override;
+  void Free(Allocation* allocation) override;
+
+ private:
+  friend class ThreadCachedAllocatorGuard;
+
+  // The number of the recent batches whose high water limits the cache.
+  static constexpr size_t kHighWaterWindow = 8;
+
+  struct Bucket {
+    std::vector<AllocationPtr> cached;
+    size_t used{0};
+    // the high water of the current batch and of the recent batches
+    size_t batch_high_water{0};
+    std::deque<size_t> high_waters;
+  };
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  std::map<size_t, Bucket> buckets_;
+  Stat stat_;
+  std::mutex mtx_;
+};
+
+// Uses the allocator for the CPU allocations of the calling thread in the
+// scope of the guard.
+class ThreadCachedAllocatorGuard {
+ public:
+  explicit ThreadCachedAllocatorGuard(ThreadCachedAllocator* allocator);
+  ~ThreadCachedAllocatorGuard();
+
+ private:
+  ThreadCachedAllocator* prev_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,160 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_cached_allocator.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/allocation/locked_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(thread_cached_allocator, size_class) {
+  EXPECT_EQ(ThreadCachedAllocator::SizeClass(1), 256);
+  EXPECT_EQ(ThreadCachedAllocator::SizeClass(256), 256);
+  EXPECT_EQ(ThreadCachedAllocator::SizeClass(257), 320);
+  EXPECT_EQ(ThreadCachedAllocator::SizeClass(1000), 1024);
+  EXPECT_EQ(ThreadCachedAllocator::SizeClass(1025), 1280);
+  for (size_t size = 1; size < (1 << 20); size = size * 3 / 2 + 1) {
+    size_t size_class = ThreadCachedAllocator::SizeClass(size);
+    EXPECT_GE(size_class, size);
+    // no more than 25% is wasted
+    EXPECT_LE(size_class, std::max<size_t>(256, size + size / 4));
+    EXPECT_EQ(ThreadCachedAllocator::SizeClass(size_class), size_class);
+  }
+}
+
+// Simulates the batches whose tensor sizes vary with the sequence lengths.
+static void RunBatch(ThreadCachedAllocator* allocator, std::mt19937* engine,
+                     size_t min_seq_len = 20, size_t max_seq_len = 30) {
+  std::uniform_int_distribution<size_t> seq_len(min_seq_len, max_seq_len);
+  std::vector<AllocationPtr> tensors;
+  for (int layer = 0; layer < 16; ++layer) {
+    size_t size = seq_len(*engine) * 128 * sizeof(float);
+    tensors.emplace_back(allocator->Allocate(size, allocator->kDefault));
+    ASSERT_GE(tensors.back()->size(), size);
+    // the temporaries of the layer
+    allocator->Allocate(size / 2, allocator->kDefault);
+  }
+}
+
+TEST(thread_cached_allocator, fixed_shapes) {
+  auto allocator = std::make_shared<ThreadCachedAllocator>(
+      std::make_shared<CPUAllocator>());
+  std::mt19937 engine(0);
+  RunBatch(allocator.get(), &engine, 25, 25);
+  allocator->Trim();
+  auto first = allocator->GetStat();
+  // the tensors and one temporary
+  EXPECT_EQ(first.underlying_allocs, 17);
+  for (int i = 0; i < 100; ++i) {
+    RunBatch(allocator.get(), &engine, 25, 25);
+    allocator->Trim();
+  }
+  auto stat = allocator->GetStat();
+  EXPECT_EQ(stat.allocs, 101 * 32);
+  EXPECT_EQ(stat.underlying_allocs, first.underlying_allocs);
+  EXPECT_EQ(stat.underlying_frees, 0);
+}
+
+TEST(thread_cached_allocator, varying_shapes) {
+  auto allocator = std::make_shared<ThreadCachedAllocator>(
+      std::make_shared<CPUAllocator>());
+  std::mt19937 engine(0);
+  const int warmup_batches = 10;
+  const int num_batches = 100;
+  for (int i = 0; i < warmup_batches; ++i) {
+    RunBatch(allocator.get(), &engine);
+    allocator->Trim();
+  }
+  auto warm = allocator->GetStat();
+  for (int i = 0; i < num_batches; ++i) {
+    RunBatch(allocator.get(), &engine);
+    allocator->Trim();
+  }
+  auto stat = allocator->GetStat();
+  EXPECT_EQ(stat.allocs - warm.allocs, num_batches * 32);
+  // Almost all the 32 allocations of a batch are served by the cache after
+  // the warmup. The misses are the batches using more allocations of a size
+  // class than the recent batches.
+  EXPECT_LT(stat.underlying_allocs - warm.underlying_allocs, num_batches);
+  EXPECT_EQ(stat.used_bytes, 0);
+}
+
+TEST(thread_cached_allocator, trim) {
+  auto allocator = std::make_shared<ThreadCachedAllocator>(
+      std::make_shared<CPUAllocator>());
+  {
+    // a spike
+    std::vector<AllocationPtr> tensors;
+    for (int i = 0; i < 8; ++i) {
+      tensors.emplace_back(allocator->Allocate(1 << 20, allocator->kDefault));
+    }
+  }
+  allocator->Trim();
+  EXPECT_EQ(allocator->GetStat().cached_bytes, 8 << 20);
+  EXPECT_EQ(allocator->GetStat().underlying_frees, 0);
+
+  // the spike is freed after it slides out of the window
+  for (int i = 0; i < 8; ++i) {
+    allocator->Allocate(4096, allocator->kDefault);
+    allocator->Trim();
+  }
+  auto stat = allocator->GetStat();
+  EXPECT_EQ(stat.underlying_frees, 8);
+  EXPECT_EQ(stat.cached_bytes, 4096);
+}
+
+TEST(thread_cached_allocator, guard_and_threads) {
+  std::shared_ptr<Allocator> underlying(
+      new LockedAllocator(std::unique_ptr<Allocator>(new CPUAllocator())));
+  EXPECT_EQ(ThreadCachedAllocator::Current(), nullptr);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([underlying, t]() {
+      auto allocator = std::make_shared<ThreadCachedAllocator>(underlying);
+      ThreadCachedAllocatorGuard guard(allocator.get());
+      EXPECT_EQ(ThreadCachedAllocator::Current(), allocator.get());
+      std::mt19937 engine(t);
+      for (int i = 0; i < 100; ++i) {
+        RunBatch(ThreadCachedAllocator::Current(), &engine);
+        ThreadCachedAllocator::Current()->Trim();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(ThreadCachedAllocator::Current(), nullptr);
+}
+
+TEST(thread_cached_allocator, outlive) {
+  AllocationPtr allocation;
+  {
+    auto allocator = std::make_shared<ThreadCachedAllocator>(
+        std::make_shared<CPUAllocator>());
+    allocation = allocator->Allocate(1024, allocator->kDefault);
+  }
+  // the allocation keeps the allocator alive
+  reinterpret_cast<char*>(allocation->ptr())[1023] = 0;
+  allocation.reset();
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
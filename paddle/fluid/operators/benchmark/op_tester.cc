@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/benchmark/op_tester.h"
+#include <dirent.h>
+#include <algorithm>
 #include <fstream>
+#include <unordered_set>
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/op_info.h"
@@ -30,6 +33,15 @@ namespace benchmark {
 
 DEFINE_string(op_config_list, "", "Path of op config file.");
 DEFINE_int32(specified_config_id, -1, "Test the specified op config.");
+DEFINE_string(op_config_dir, "",
+              "Directory of op config files, all the configs in which are run "
+              "as a benchmark suite.");
+DEFINE_string(op_result_json, "", "Path to write the results in JSON.");
+DEFINE_string(op_baseline_json, "",
+              "Results in JSON to compare with, the test fails if any op is "
+              "slower than its baseline by more than regression_threshold.");
+DEFINE_double(regression_threshold, 0.1,
+              "The allowed slowdown of the median time, 0.1 for 10%.");
 
 void OpTester::Init(const std::string &filename) {
   Init(OpTesterConfig(filename));
@@ -46,6 +58,7 @@ void OpTester::Init(const OpTesterConfig &config) {
 
     CreateInputVarDesc();
     CreateOutputVarDesc();
+    CreateOpAttrs();
   } else {
     LOG(FATAL) << "Op \"" << config_.op_type << "\" is not registered.";
   }
@@ -69,9 +82,10 @@ void OpTester::Run() {
   }
 
   // Warm up
-  RunImpl();
+  for (int i = config_.warmup; i > 0; --i) {
+    RunImpl();
+  }
 
-  platform::Timer timer;
   if (config_.profile) {
     if (platform::is_cpu_place(place_)) {
       platform::EnableProfiler(platform::ProfilerState::kCPU);
@@ -83,24 +97,37 @@ void OpTester::Run() {
       PADDLE_THROW("'CUDAPlace' is not supported in CPU only device.");
 #endif
     }
+  }
 
+  // Every run is timed, so that the median and the tail are reported
+  // besides the average.
+  platform::Timer timer;
+  std::vector<double> times;
+  times.reserve(config_.repeat);
+  for (int i = config_.repeat; i > 0; --i) {
+    timer.Reset();
     timer.Start();
-    for (int i = config_.repeat; i > 0; --i) {
-      RunImpl();
-    }
+    RunImpl();
     timer.Pause();
+    times.push_back(timer.ElapsedMS());
+  }
+
+  if (config_.profile) {
     platform::DisableProfiler(platform::EventSortingKey::kDefault,
                               "op_tester_profiler");
-  } else {
-    timer.Start();
-    for (int i = config_.repeat; i > 0; --i) {
-      RunImpl();
-    }
-    timer.Pause();
   }
-  config_.runtime = timer.ElapsedMS() / config_.repeat;
+
+  result_.key = GetConfigKey();
+  result_.op_type = type_;
+  result_.SetTimes(times);
+  result_.flops = GetFlops();
+  result_.bytes = GetBytes();
+  config_.runtime = result_.mean;
   LOG(INFO) << "=== Run " << config_.repeat
             << " times, latency: " << config_.runtime << " ms ===";
+  VLOG(1) << "median: " << result_.median << " ms, p90: " << result_.p90
+          << " ms, " << result_.GFlopsPerSec() << " GFLOP/s, "
+          << result_.bytes << " bytes";
 }
 
 void OpTester::RunImpl() {
@@ -131,10 +158,24 @@ std::vector<std::string> OpTester::GetOpProtoOutputNames() {
   return output_names;
 }
 
+bool OpTester::IsDispensableInput(const std::string &name) {
+  const framework::proto::OpProto &proto =
+      framework::OpInfoMap::Instance().Get(type_).Proto();
+  for (int i = 0; i != proto.inputs_size(); ++i) {
+    if (proto.inputs(i).name() == name) {
+      return proto.inputs(i).dispensable();
+    }
+  }
+  return false;
+}
+
 void OpTester::CreateInputVarDesc() {
   std::vector<std::string> input_names = GetOpProtoInputNames();
   for (auto &name : input_names) {
     const OpInputConfig *input = config_.GetInput(name);
+    if (input == nullptr && IsDispensableInput(name)) {
+      continue;
+    }
     if (input == nullptr) {
       LOG(FATAL) << "The input " << name << " of op " << config_.op_type
                  << " is not correctlly provided.";
@@ -167,6 +208,69 @@ void OpTester::CreateOutputVarDesc() {
   }
 }
 
+static framework::Attribute ParseAttr(framework::proto::AttrType type,
+                                      const std::string &value) {
+  std::vector<std::string> items;
+  std::string item;
+  std::istringstream is(value);
+  while (std::getline(is, item, ',')) {
+    items.push_back(item);
+  }
+  switch (type) {
+    case framework::proto::AttrType::INT:
+      return std::stoi(value);
+    case framework::proto::AttrType::LONG:
+      return static_cast<int64_t>(std::stoll(value));
+    case framework::proto::AttrType::FLOAT:
+      return std::stof(value);
+    case framework::proto::AttrType::BOOLEAN:
+      return value == "true" || value == "1";
+    case framework::proto::AttrType::STRING:
+      return value;
+    case framework::proto::AttrType::INTS: {
+      std::vector<int> ints;
+      for (auto &i : items) ints.push_back(std::stoi(i));
+      return ints;
+    }
+    case framework::proto::AttrType::LONGS: {
+      std::vector<int64_t> longs;
+      for (auto &i : items) longs.push_back(std::stoll(i));
+      return longs;
+    }
+    case framework::proto::AttrType::FLOATS: {
+      std::vector<float> floats;
+      for (auto &i : items) floats.push_back(std::stof(i));
+      return floats;
+    }
+    case framework::proto::AttrType::STRINGS:
+      return items;
+    default:
+      PADDLE_THROW("Unsupported attribute type %d.", static_cast<int>(type));
+  }
+}
+
+// The attributes are written as "name: value;" in the config, where the
+// lists are separated by ',', e.g. "strides: 1,1;".
+void OpTester::CreateOpAttrs() {
+  const framework::proto::OpProto &proto =
+      framework::OpInfoMap::Instance().Get(type_).Proto();
+  std::unordered_set<std::string> attr_names;
+  for (int i = 0; i != proto.attrs_size(); ++i) {
+    const auto &attr = proto.attrs(i);
+    attr_names.insert(attr.name());
+    auto it = config_.attrs.find(attr.name());
+    if (it != config_.attrs.end()) {
+      op_desc_.SetAttr(attr.name(), ParseAttr(attr.type(), it->second));
+    }
+  }
+  for (auto &item : config_.attrs) {
+    if (attr_names.find(item.first) == attr_names.end()) {
+      LOG(FATAL) << "The attribute " << item.first << " is not defined in op "
+                 << config_.op_type << ".";
+    }
+  }
+}
+
 framework::VarDesc *OpTester::Var(const std::string &name) {
   auto it = vars_.find(name);
   if (it != vars_.end()) {
@@ -242,6 +346,95 @@ void OpTester::CreateVariables(framework::Scope *scope) {
   }
 }
 
+std::string OpTester::GetConfigKey() {
+  std::vector<std::string> items;
+  for (auto &input : config_.inputs) {
+    std::stringstream ss;
+    ss << input.name << "=";
+    for (size_t i = 0; i < input.dims.size(); ++i) {
+      ss << (i > 0 ? "x" : "") << input.dims[i];
+    }
+    if (!input.lod.empty()) {
+      ss << "@" << input.lod.back().size() - 1;
+    }
+    items.push_back(ss.str());
+  }
+  std::sort(items.begin(), items.end());
+  std::vector<std::string> attrs;
+  for (auto &item : config_.attrs) {
+    attrs.push_back(item.first + "=" + item.second);
+  }
+  std::sort(attrs.begin(), attrs.end());
+  items.insert(items.end(), attrs.begin(), attrs.end());
+
+  std::string key = type_;
+  for (auto &item : items) {
+    key += " " + item;
+  }
+  return key;
+}
+
+framework::DDim OpTester::GetTensorDims(const std::string &name) {
+  auto *var = scope_->FindVar(config_.op_type + "." + name);
+  if (var == nullptr || !var->IsType<framework::LoDTensor>()) {
+    return framework::make_ddim({0});
+  }
+  return var->Get<framework::LoDTensor>().dims();
+}
+
+// The multiply-adds are counted as 2 flops for the ops of matrix
+// multiplication and convolution, and 1 flop per output element is assumed
+// for the others such as the elementwise and activation ops.
+int64_t OpTester::GetFlops() {
+  if (type_ == "mul") {
+    auto x_dims = GetTensorDims("X");
+    int x_num_col_dims = op_->Attr<int>("x_num_col_dims");
+    int64_t k = framework::product(
+        framework::slice_ddim(x_dims, x_num_col_dims, x_dims.size()));
+    return 2 * framework::product(GetTensorDims("Out")) * k;
+  }
+  if (type_ == "matmul") {
+    auto x_dims = GetTensorDims("X");
+    int size = x_dims.size();
+    int64_t k = x_dims[size - 1];
+    if (size > 1 && op_->Attr<bool>("transpose_X")) {
+      k = x_dims[size - 2];
+    }
+    return 2 * framework::product(GetTensorDims("Out")) * k;
+  }
+  if (type_ == "fc") {
+    return 2 * framework::product(GetTensorDims("Out")) *
+           GetTensorDims("W")[0];
+  }
+  if (type_ == "conv2d" || type_ == "depthwise_conv2d" || type_ == "conv3d") {
+    auto filter_dims = GetTensorDims("Filter");
+    return 2 * framework::product(GetTensorDims("Output")) *
+           (framework::product(filter_dims) / filter_dims[0]);
+  }
+  int64_t flops = 0;
+  for (auto &name : GetOpProtoOutputNames()) {
+    flops = std::max(flops, framework::product(GetTensorDims(name)));
+  }
+  return flops;
+}
+
+// The bytes of all the inputs and outputs, which is the least memory traffic
+// of the op.
+int64_t OpTester::GetBytes() {
+  int64_t bytes = 0;
+  for (auto &item : vars_) {
+    auto *var = scope_->FindVar(item.first);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) {
+      continue;
+    }
+    auto &tensor = var->Get<framework::LoDTensor>();
+    if (tensor.IsInitialized()) {
+      bytes += tensor.numel() * framework::SizeOfType(tensor.type());
+    }
+  }
+  return bytes;
+}
+
 static std::string GenSpaces(int count) {
   std::stringstream ss;
   for (int i = 0; i < count; ++i) {
@@ -292,30 +485,79 @@ std::string OpTester::DebugString() {
   return ss.str();
 }
 
+static void ReadConfigs(const std::string &filename,
+                        std::vector<OpTesterConfig> *op_configs) {
+  std::ifstream fin(filename, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s",
+                 filename.c_str());
+  while (!fin.eof()) {
+    OpTesterConfig config;
+    bool result = config.Init(fin);
+    if (result) {
+      op_configs->push_back(config);
+    }
+  }
+}
+
+// The regular files in dirname, sorted by name so that the results of
+// different runs are in the same order.
+static std::vector<std::string> ListConfigFiles(const std::string &dirname) {
+  DIR *dir = opendir(dirname.c_str());
+  PADDLE_ENFORCE_NOT_NULL(dir, "Cannot open directory %s", dirname.c_str());
+  std::vector<std::string> filenames;
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.empty() || name[0] == '.') {
+      continue;
+    }
+    filenames.push_back(dirname + "/" + name);
+  }
+  closedir(dir);
+  std::sort(filenames.begin(), filenames.end());
+  return filenames;
+}
+
+static void RunConfigs(const std::vector<OpTesterConfig> &op_configs) {
+  std::vector<OpTesterResult> results;
+  for (auto &config : op_configs) {
+    OpTester tester;
+    tester.Init(config);
+    tester.Run();
+    results.push_back(tester.Result());
+  }
+
+  if (!FLAGS_op_result_json.empty()) {
+    WriteResults(FLAGS_op_result_json, results);
+    VLOG(1) << "Write the results of " << results.size() << " configs to "
+            << FLAGS_op_result_json;
+  }
+  if (!FLAGS_op_baseline_json.empty()) {
+    std::vector<std::string> regressions =
+        FindRegressions(results, ReadResults(FLAGS_op_baseline_json),
+                        FLAGS_regression_threshold);
+    for (auto &regression : regressions) {
+      LOG(ERROR) << "Regression: " << regression;
+    }
+    EXPECT_TRUE(regressions.empty());
+  }
+}
+
 TEST(op_tester, base) {
-  if (!FLAGS_op_config_list.empty()) {
-    std::ifstream fin(FLAGS_op_config_list, std::ios::in | std::ios::binary);
-    PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s",
-                   FLAGS_op_config_list.c_str());
+  if (!FLAGS_op_config_list.empty() || !FLAGS_op_config_dir.empty()) {
     std::vector<OpTesterConfig> op_configs;
-    while (!fin.eof()) {
-      OpTesterConfig config;
-      bool result = config.Init(fin);
-      if (result) {
-        op_configs.push_back(config);
+    if (!FLAGS_op_config_list.empty()) {
+      ReadConfigs(FLAGS_op_config_list, &op_configs);
+    }
+    if (!FLAGS_op_config_dir.empty()) {
+      for (auto &filename : ListConfigFiles(FLAGS_op_config_dir)) {
+        ReadConfigs(filename, &op_configs);
       }
     }
     if (FLAGS_specified_config_id >= 0 &&
         FLAGS_specified_config_id < static_cast<int>(op_configs.size())) {
-      OpTester tester;
-      tester.Init(op_configs[FLAGS_specified_config_id]);
-      tester.Run();
+      RunConfigs({op_configs[FLAGS_specified_config_id]});
     } else {
-      for (size_t i = 0; i < op_configs.size(); ++i) {
-        OpTester tester;
-        tester.Init(op_configs[i]);
-        tester.Run();
-      }
+      RunConfigs(op_configs);
     }
   } else {
     OpTester tester;
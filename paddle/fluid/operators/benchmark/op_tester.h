@@ -20,6 +20,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_desc.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/operators/benchmark/op_tester_config.h"
+#include "paddle/fluid/operators/benchmark/op_tester_report.h"
 
 namespace paddle {
 namespace operators {
@@ -34,14 +35,23 @@ class OpTester {
 
   void Run();
 
+  const OpTesterResult &Result() const { return result_; }
+
   std::string DebugString();
 
  private:
   std::vector<std::string> GetOpProtoInputNames();
   std::vector<std::string> GetOpProtoOutputNames();
 
+  bool IsDispensableInput(const std::string &name);
   void CreateInputVarDesc();
   void CreateOutputVarDesc();
+  void CreateOpAttrs();
+
+  std::string GetConfigKey();
+  framework::DDim GetTensorDims(const std::string &name);
+  int64_t GetFlops();
+  int64_t GetBytes();
 
   framework::VarDesc *Var(const std::string &name);
   void CreateVariables(framework::Scope *scope);
@@ -61,6 +71,7 @@ class OpTester {
   std::unique_ptr<framework::OperatorBase> op_;
   platform::Place place_;
   std::unique_ptr<framework::Scope> scope_;
+  OpTesterResult result_;
 };
 
 }  // namespace benchmark
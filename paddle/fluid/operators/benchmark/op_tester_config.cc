@@ -129,6 +129,8 @@ bool OpTesterConfig::Init(std::istream& is) {
         is >> op_type;
       } else if (sep == "device_id" || sep == "device_id:") {
         is >> device_id;
+      } else if (sep == "warmup" || sep == "warmup:") {
+        is >> warmup;
       } else if (sep == "repeat" || sep == "repeat:") {
         is >> repeat;
       } else if (sep == "profile" || sep == "profile:") {
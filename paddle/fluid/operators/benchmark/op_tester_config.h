@@ -49,6 +49,7 @@ struct OpTesterConfig {
   std::vector<OpInputConfig> inputs;
   std::unordered_map<std::string, std::string> attrs;
   int device_id{-1};  // CPU: -1
+  int warmup{1};
   int repeat{1};
   int profile{0};
   int print_debug_string{0};
@@ -0,0 +1,250 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/benchmark/op_tester_report.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+double OpTesterResult::GFlopsPerSec() const {
+  return median > 0 ? flops / median * 1e-6 : 0.0;
+}
+
+double OpTesterResult::GBytesPerSec() const {
+  return median > 0 ? bytes / median * 1e-6 : 0.0;
+}
+
+// nearest-rank percentile of the sorted times
+static double Percentile(const std::vector<double>& sorted, double q) {
+  size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+void OpTesterResult::SetTimes(std::vector<double> times) {
+  PADDLE_ENFORCE(!times.empty(), "No time is recorded for %s.",
+                 key.c_str());
+  std::sort(times.begin(), times.end());
+  repeat = static_cast<int>(times.size());
+  double sum = 0.0;
+  for (auto t : times) {
+    sum += t;
+  }
+  mean = sum / times.size();
+  median = Percentile(times, 0.5);
+  p90 = Percentile(times, 0.9);
+  min = times.front();
+}
+
+static std::string EscapeJson(const std::string& str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+std::string ResultsToJson(const std::vector<OpTesterResult>& results) {
+  std::ostringstream os;
+  os << std::setprecision(6);
+  os << "[\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto& r = results[i];
+    os << "  {\"key\": \"" << EscapeJson(r.key) << "\", \"op_type\": \""
+       << EscapeJson(r.op_type) << "\", \"repeat\": " << r.repeat
+       << ", \"mean_ms\": " << r.mean << ", \"median_ms\": " << r.median
+       << ", \"p90_ms\": " << r.p90 << ", \"min_ms\": " << r.min
+       << ", \"flops\": " << r.flops << ", \"bytes\": " << r.bytes
+       << ", \"gflops_per_sec\": " << r.GFlopsPerSec()
+       << ", \"gbytes_per_sec\": " << r.GBytesPerSec() << "}"
+       << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  os << "]\n";
+  return os.str();
+}
+
+// Only the flat objects of strings and numbers written by ResultsToJson are
+// supported.
+class ResultsParser {
+ public:
+  explicit ResultsParser(const std::string& json) : json_(json) {}
+
+  std::vector<OpTesterResult> Parse() {
+    std::vector<OpTesterResult> results;
+    SkipSpaces();
+    Expect('[');
+    SkipSpaces();
+    if (Peek() == ']') {
+      return results;
+    }
+    while (true) {
+      results.push_back(ParseResult());
+      SkipSpaces();
+      if (Peek() == ',') {
+        ++pos_;
+        continue;
+      }
+      Expect(']');
+      break;
+    }
+    return results;
+  }
+
+ private:
+  OpTesterResult ParseResult() {
+    std::unordered_map<std::string, std::string> strings;
+    std::unordered_map<std::string, double> numbers;
+    SkipSpaces();
+    Expect('{');
+    while (true) {
+      SkipSpaces();
+      std::string name = ParseString();
+      SkipSpaces();
+      Expect(':');
+      SkipSpaces();
+      if (Peek() == '"') {
+        strings[name] = ParseString();
+      } else {
+        numbers[name] = ParseNumber();
+      }
+      SkipSpaces();
+      if (Peek() == ',') {
+        ++pos_;
+        continue;
+      }
+      Expect('}');
+      break;
+    }
+
+    OpTesterResult result;
+    result.key = strings["key"];
+    result.op_type = strings["op_type"];
+    result.repeat = static_cast<int>(numbers["repeat"]);
+    result.mean = numbers["mean_ms"];
+    result.median = numbers["median_ms"];
+    result.p90 = numbers["p90_ms"];
+    result.min = numbers["min_ms"];
+    result.flops = static_cast<int64_t>(numbers["flops"]);
+    result.bytes = static_cast<int64_t>(numbers["bytes"]);
+    return result;
+  }
+
+  std::string ParseString() {
+    Expect('"');
+    std::string str;
+    while (Peek() != '"') {
+      if (Peek() == '\\') {
+        ++pos_;
+      }
+      str += Next();
+    }
+    ++pos_;
+    return str;
+  }
+
+  double ParseNumber() {
+    size_t end = json_.find_first_of(",}] \t\r\n", pos_);
+    PADDLE_ENFORCE(end != std::string::npos && end > pos_,
+                   "Invalid number at %d of the results.", pos_);
+    double value = std::stod(json_.substr(pos_, end - pos_));
+    pos_ = end;
+    return value;
+  }
+
+  void SkipSpaces() {
+    while (pos_ < json_.size() && isspace(json_[pos_])) {
+      ++pos_;
+    }
+  }
+
+  char Peek() {
+    PADDLE_ENFORCE_LT(pos_, json_.size(), "Unexpected end of the results.");
+    return json_[pos_];
+  }
+
+  char Next() {
+    char c = Peek();
+    ++pos_;
+    return c;
+  }
+
+  void Expect(char c) {
+    PADDLE_ENFORCE_EQ(Next(), c, "Invalid results, expect '%c' at %d.", c,
+                      pos_ - 1);
+  }
+
+  const std::string& json_;
+  size_t pos_{0};
+};
+
+std::vector<OpTesterResult> ResultsFromJson(const std::string& json) {
+  return ResultsParser(json).Parse();
+}
+
+void WriteResults(const std::string& filename,
+                  const std::vector<OpTesterResult>& results) {
+  std::ofstream fout(filename, std::ios::out | std::ios::trunc);
+  PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open file %s",
+                 filename.c_str());
+  fout << ResultsToJson(results);
+}
+
+std::vector<OpTesterResult> ReadResults(const std::string& filename) {
+  std::ifstream fin(filename, std::ios::in);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s",
+                 filename.c_str());
+  std::stringstream ss;
+  ss << fin.rdbuf();
+  return ResultsFromJson(ss.str());
+}
+
+std::vector<std::string> FindRegressions(
+    const std::vector<OpTesterResult>& results,
+    const std::vector<OpTesterResult>& baseline, double threshold) {
+  std::unordered_map<std::string, const OpTesterResult*> baseline_map;
+  for (auto& r : baseline) {
+    baseline_map[r.key] = &r;
+  }
+  std::vector<std::string> regressions;
+  for (auto& r : results) {
+    auto it = baseline_map.find(r.key);
+    if (it == baseline_map.end() || it->second->median <= 0) {
+      continue;
+    }
+    double ratio = r.median / it->second->median;
+    if (ratio > 1.0 + threshold) {
+      std::ostringstream os;
+      os << r.key << ": median " << r.median << " ms vs. baseline "
+         << it->second->median << " ms (+" << std::fixed
+         << std::setprecision(1) << (ratio - 1.0) * 100 << "%)";
+      regressions.push_back(os.str());
+    }
+  }
+  return regressions;
+}
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,65 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+// The timing of one op config, all the times are in milliseconds.
+struct OpTesterResult {
+  // op_type, the input shapes and the attributes, which identifies the
+  // config in the baseline
+  std::string key;
+  std::string op_type;
+  int repeat{0};
+  double mean{0.0};
+  double median{0.0};
+  double p90{0.0};
+  double min{0.0};
+  // floating point operations and the bytes of all the inputs and outputs
+  // in one run
+  int64_t flops{0};
+  int64_t bytes{0};
+
+  // GFLOP/s and GB/s at the median time
+  double GFlopsPerSec() const;
+  double GBytesPerSec() const;
+
+  void SetTimes(std::vector<double> times);
+};
+
+// One result per line, so that two reports could be diffed directly.
+std::string ResultsToJson(const std::vector<OpTesterResult>& results);
+
+// Parses the report written by ResultsToJson.
+std::vector<OpTesterResult> ResultsFromJson(const std::string& json);
+
+void WriteResults(const std::string& filename,
+                  const std::vector<OpTesterResult>& results);
+std::vector<OpTesterResult> ReadResults(const std::string& filename);
+
+// Returns a message for every result whose median is slower than the one in
+// the baseline by more than threshold, e.g. 0.1 for 10%.
+std::vector<std::string> FindRegressions(
+    const std::vector<OpTesterResult>& results,
+    const std::vector<OpTesterResult>& baseline, double threshold);
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,97 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/benchmark/op_tester_report.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+static OpTesterResult MakeResult(const std::string& key, double median) {
+  OpTesterResult result;
+  result.key = key;
+  result.op_type = "mul";
+  result.SetTimes({median, median});
+  result.flops = 2000000;
+  result.bytes = 300000;
+  return result;
+}
+
+TEST(OpTesterReport, set_times) {
+  OpTesterResult result;
+  result.SetTimes({5., 1., 4., 2., 3., 10., 9., 8., 7., 6.});
+  EXPECT_EQ(result.repeat, 10);
+  EXPECT_DOUBLE_EQ(result.mean, 5.5);
+  EXPECT_DOUBLE_EQ(result.median, 5.);
+  EXPECT_DOUBLE_EQ(result.p90, 9.);
+  EXPECT_DOUBLE_EQ(result.min, 1.);
+  EXPECT_THROW(result.SetTimes({}), platform::EnforceNotMet);
+}
+
+TEST(OpTesterReport, json) {
+  std::vector<OpTesterResult> results = {MakeResult("mul x=[32, 64]", 1.5),
+                                         MakeResult("key with \"quotes\"", 2)};
+  results[1].op_type = "conv2d";
+  std::string json = ResultsToJson(results);
+  // one result per line
+  EXPECT_EQ(std::count(json.begin(), json.end(), '\n'), 4);
+
+  auto parsed = ResultsFromJson(json);
+  ASSERT_EQ(parsed.size(), results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(parsed[i].key, results[i].key);
+    EXPECT_EQ(parsed[i].op_type, results[i].op_type);
+    EXPECT_EQ(parsed[i].repeat, results[i].repeat);
+    EXPECT_DOUBLE_EQ(parsed[i].mean, results[i].mean);
+    EXPECT_DOUBLE_EQ(parsed[i].median, results[i].median);
+    EXPECT_DOUBLE_EQ(parsed[i].p90, results[i].p90);
+    EXPECT_DOUBLE_EQ(parsed[i].min, results[i].min);
+    EXPECT_EQ(parsed[i].flops, results[i].flops);
+    EXPECT_EQ(parsed[i].bytes, results[i].bytes);
+  }
+
+  EXPECT_TRUE(ResultsFromJson("[]").empty());
+  EXPECT_TRUE(ResultsFromJson(" [\n]\n").empty());
+  EXPECT_THROW(ResultsFromJson("[{\"key\": \"mul\", \"repeat\": 1"),
+               platform::EnforceNotMet);
+  EXPECT_THROW(ResultsFromJson("{}"), platform::EnforceNotMet);
+}
+
+TEST(OpTesterReport, regressions) {
+  std::vector<OpTesterResult> baseline = {MakeResult("a", 1.0),
+                                          MakeResult("b", 1.0),
+                                          MakeResult("c", 1.0)};
+  // a is 20% slower, b is 5% slower, c is faster and d is new
+  std::vector<OpTesterResult> results = {
+      MakeResult("a", 1.2), MakeResult("b", 1.05), MakeResult("c", 0.5),
+      MakeResult("d", 100.0)};
+
+  auto regressions = FindRegressions(results, baseline, 0.1);
+  ASSERT_EQ(regressions.size(), 1UL);
+  EXPECT_EQ(regressions[0].find("a: "), 0UL);
+  EXPECT_NE(regressions[0].find("+20.0%"), std::string::npos);
+
+  EXPECT_EQ(FindRegressions(results, baseline, 0.01).size(), 2UL);
+  EXPECT_TRUE(FindRegressions(results, baseline, 0.5).empty());
+  EXPECT_TRUE(FindRegressions(results, {}, 0.1).empty());
+}
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
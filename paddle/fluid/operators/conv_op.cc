@@ -14,9 +14,12 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/conv_op.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/operators/math/fc_compute.h"
+
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/operators/conv_cudnn_op_cache.h"
 #include "paddle/fluid/platform/cudnn_helper.h"
@@ -474,6 +477,168 @@ class Conv2dGradMaker : public framework::SingleGradOpDescMaker {
   }
 };
 
+// [rows, cols] -> [cols, rows]
+template <typename T>
+static void TransposeRows(const T* src, int rows, int cols, T* dst) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int j = 0; j < cols; ++j) {
+    for (int i = 0; i < rows; ++i) {
+      dst[j * rows + i] = src[i * cols + j];
+    }
+  }
+}
+
+// Unfolds the uint8 image of [channels, height, width] to the col of
+// [output_height, output_width, channels, filter_height, filter_width] as
+// im2col in kOCF format, with the output rows in parallel.
+static void Im2ColOCFInt8(const uint8_t* im, int channels, int height,
+                          int width, int filter_height, int filter_width,
+                          int output_height, int output_width,
+                          const std::vector<int>& strides,
+                          const std::vector<int>& paddings, uint8_t* col) {
+  const int64_t col_width =
+      static_cast<int64_t>(channels) * filter_height * filter_width;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int oh = 0; oh < output_height; ++oh) {
+    uint8_t* dst = col + static_cast<int64_t>(oh) * output_width * col_width;
+    for (int ow = 0; ow < output_width; ++ow) {
+      for (int c = 0; c < channels; ++c) {
+        const uint8_t* src = im + static_cast<int64_t>(c) * height * width;
+        for (int kh = 0; kh < filter_height; ++kh) {
+          const int ih = oh * strides[0] - paddings[0] + kh;
+          for (int kw = 0; kw < filter_width; ++kw) {
+            const int iw = ow * strides[1] - paddings[1] + kw;
+            *dst++ = (ih >= 0 && ih < height && iw >= 0 && iw < width)
+                         ? src[ih * width + iw]
+                         : static_cast<uint8_t>(0);
+          }
+        }
+      }
+    }
+  }
+}
+
+// The plain CPU INT8 conv2d, where Input is the uint8 data quantized by
+// Scale_in and Filter is the int8 weight quantized by Scale_weights.
+// Every image is unfolded by im2col in kOCF format, so that one row of col
+// is one output pixel, then multiplied with the filter by the jit int8 matmul,
+// whose weights are packed at the first run.
+class GemmConvInt8Kernel : public framework::OpKernel<uint8_t> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    const Tensor* input = context.Input<Tensor>("Input");
+    const Tensor* filter = context.Input<Tensor>("Filter");
+    const Tensor* bias = context.Input<Tensor>("Bias");
+    Tensor* output = context.Output<Tensor>("Output");
+    PADDLE_ENFORCE_EQ(filter->type(), framework::proto::VarType::INT8,
+                      "The filter of INT8 conv2d should be int8.");
+    PADDLE_ENFORCE_EQ(input->dims().size(), 4,
+                      "Only conv2d supports INT8 on plain CPU.");
+    PADDLE_ENFORCE(!context.Attr<bool>("fuse_residual_connection"),
+                   "The residual connection is not supported by the plain "
+                   "CPU INT8 conv2d.");
+
+    int groups = context.Attr<int>("groups");
+    std::vector<int> strides = context.Attr<std::vector<int>>("strides");
+    std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
+    std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
+    PADDLE_ENFORCE(dilations[0] == 1 && dilations[1] == 1,
+                   "The plain CPU INT8 conv2d only supports dilation 1 yet.");
+    bool fuse_relu = context.Attr<bool>("fuse_relu");
+    bool force_fp32_output = context.Attr<bool>("force_fp32_output");
+    PADDLE_ENFORCE(force_fp32_output || fuse_relu,
+                   "The uint8 output of conv2d should be fused with relu, "
+                   "otherwise please set force_fp32_output.");
+    float scale_in = context.Attr<float>("Scale_in");
+    float scale_out = context.Attr<float>("Scale_out");
+    auto scale_weights = context.Attr<std::vector<float>>("Scale_weights");
+
+    const int batch_size = static_cast<int>(input->dims()[0]);
+    const int in_channels = static_cast<int>(input->dims()[1]);
+    const int out_channels = static_cast<int>(filter->dims()[0]);
+    const int filter_height = static_cast<int>(filter->dims()[2]);
+    const int filter_width = static_cast<int>(filter->dims()[3]);
+    const int output_height = static_cast<int>(output->dims()[2]);
+    const int output_width = static_cast<int>(output->dims()[3]);
+    const int in_step = in_channels / groups;
+    const int out_step = out_channels / groups;
+    const int col_width = in_step * filter_height * filter_width;
+    const int out_size = output_height * output_width;
+    PADDLE_ENFORCE(
+        scale_weights.size() == 1 ||
+            scale_weights.size() == static_cast<size_t>(out_channels),
+        "The size of Scale_weights should be 1 or %d", out_channels);
+
+    // one packed filter for each group
+    std::vector<std::shared_ptr<const math::FCInt8Functor>> group_fc(groups);
+    for (int g = 0; g < groups; ++g) {
+      std::vector<float> group_scale_weights = scale_weights;
+      if (scale_weights.size() > 1) {
+        group_scale_weights.assign(scale_weights.begin() + g * out_step,
+                                   scale_weights.begin() + (g + 1) * out_step);
+      }
+      Tensor group_filter = filter->Slice(g * out_step, (g + 1) * out_step);
+      Tensor group_bias;
+      if (bias) {
+        group_bias = bias->Slice(g * out_step, (g + 1) * out_step);
+      }
+      group_fc[g] = math::FCInt8FunctorCache::Instance().Get(
+          group_filter, out_step, col_width, true, scale_in,
+          group_scale_weights, scale_out, bias ? &group_bias : nullptr,
+          fuse_relu, !force_fp32_output);
+    }
+
+    auto& dev_ctx =
+        context.template device_context<platform::CPUDeviceContext>();
+    Tensor col = context.AllocateTmpTensor<uint8_t, platform::CPUDeviceContext>(
+        {output_height, output_width, in_step, filter_height, filter_width},
+        dev_ctx);
+    const int out_type_size = force_fp32_output ? sizeof(float) : 1;
+    Tensor out_buffer =
+        context.AllocateTmpTensor<uint8_t, platform::CPUDeviceContext>(
+            {out_size * out_step * out_type_size}, dev_ctx);
+    void* out_data = nullptr;
+    if (force_fp32_output) {
+      out_data = output->mutable_data<float>(context.GetPlace());
+    } else {
+      out_data = output->mutable_data<uint8_t>(context.GetPlace());
+    }
+
+    const int input_height = static_cast<int>(input->dims()[2]);
+    const int input_width = static_cast<int>(input->dims()[3]);
+    const int64_t in_size = static_cast<int64_t>(input_height) * input_width;
+    const uint8_t* input_data = input->data<uint8_t>();
+    for (int i = 0; i < batch_size; i++) {
+      for (int g = 0; g < groups; g++) {
+        Im2ColOCFInt8(
+            input_data +
+                (static_cast<int64_t>(i) * in_channels + g * in_step) * in_size,
+            in_step, input_height, input_width, filter_height, filter_width,
+            output_height, output_width, strides, paddings,
+            col.data<uint8_t>());
+        // [output_height * output_width, out_step]
+        (*group_fc[g])(col.data<uint8_t>(), out_size,
+                       out_buffer.data<uint8_t>());
+        const int64_t out_offset =
+            (static_cast<int64_t>(i) * out_channels + g * out_step) *
+            out_size;
+        if (force_fp32_output) {
+          TransposeRows(
+              reinterpret_cast<const float*>(out_buffer.data<uint8_t>()),
+              out_size, out_step, static_cast<float*>(out_data) + out_offset);
+        } else {
+          TransposeRows(out_buffer.data<uint8_t>(), out_size, out_step,
+                        static_cast<uint8_t*>(out_data) + out_offset);
+        }
+      }
+    }
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -506,7 +671,8 @@ REGISTER_OP_CPU_KERNEL(
 
 REGISTER_OP_CPU_KERNEL(
     conv2d, ops::GemmConvKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::GemmConvKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::GemmConvKernel<paddle::platform::CPUDeviceContext, double>,
+    ops::GemmConvInt8Kernel);
 REGISTER_OP_CPU_KERNEL(
     conv2d_grad,
     ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext, float>,
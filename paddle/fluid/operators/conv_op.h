@@ -15,10 +15,12 @@ limitations under the License. */
 #pragma once
 
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/conv_cpu.h"
 #include "paddle/fluid/operators/math/depthwise_conv.h"
 #include "paddle/fluid/operators/math/im2col.h"
 #include "paddle/fluid/operators/math/vol2col.h"
@@ -107,6 +109,72 @@ class ConvOpGrad : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override;
 };
 
+// conv2d on CPU runs by the conv engine in math/conv_cpu.h, which chooses
+// the depthwise, 1x1 or Winograd algorithm for the shape and computes the
+// images in parallel. Returns false if the engine could not be used.
+template <typename DeviceContext, typename T>
+typename std::enable_if<
+    std::is_same<DeviceContext, platform::CPUDeviceContext>::value &&
+        std::is_floating_point<T>::value,
+    bool>::type
+Conv2DByCPUEngine(const framework::ExecutionContext& context,
+                  const Tensor& input, const Tensor& filter, Tensor* output) {
+  if (filter.dims().size() != 4) return false;
+  math::Conv2DParam param(
+      input.dims(), filter.dims(), output->dims(),
+      context.Attr<std::vector<int>>("strides"),
+      context.Attr<std::vector<int>>("paddings"),
+      context.Attr<std::vector<int>>("dilations"), context.Attr<int>("groups"));
+  math::Conv2DFunctor<T> conv2d;
+  conv2d(context.template device_context<platform::CPUDeviceContext>(), param,
+         math::SelectConv2DAlgo(param), input, filter, output);
+  return true;
+}
+
+template <typename DeviceContext, typename T>
+typename std::enable_if<
+    !(std::is_same<DeviceContext, platform::CPUDeviceContext>::value &&
+      std::is_floating_point<T>::value),
+    bool>::type
+Conv2DByCPUEngine(const framework::ExecutionContext& context,
+                  const Tensor& input, const Tensor& filter, Tensor* output) {
+  return false;
+}
+
+template <typename DeviceContext, typename T>
+typename std::enable_if<
+    std::is_same<DeviceContext, platform::CPUDeviceContext>::value &&
+        std::is_floating_point<T>::value,
+    bool>::type
+Conv2DGradByCPUEngine(const framework::ExecutionContext& context,
+                      const Tensor& input, const Tensor& filter,
+                      const Tensor& output_grad, Tensor* input_grad,
+                      Tensor* filter_grad) {
+  if (filter.dims().size() != 4) return false;
+  math::Conv2DParam param(
+      input.dims(), filter.dims(), output_grad.dims(),
+      context.Attr<std::vector<int>>("strides"),
+      context.Attr<std::vector<int>>("paddings"),
+      context.Attr<std::vector<int>>("dilations"), context.Attr<int>("groups"));
+  math::Conv2DGradFunctor<T> conv2d_grad;
+  conv2d_grad(context.template device_context<platform::CPUDeviceContext>(),
+              param, math::SelectConv2DAlgo(param), input, filter,
+              output_grad, input_grad, filter_grad);
+  return true;
+}
+
+template <typename DeviceContext, typename T>
+typename std::enable_if<
+    !(std::is_same<DeviceContext, platform::CPUDeviceContext>::value &&
+      std::is_floating_point<T>::value),
+    bool>::type
+Conv2DGradByCPUEngine(const framework::ExecutionContext& context,
+                      const Tensor& input, const Tensor& filter,
+                      const Tensor& output_grad, Tensor* input_grad,
+                      Tensor* filter_grad) {
+  return false;
+}
+
 template <typename DeviceContext, typename T>
 class GemmConvKernel : public framework::OpKernel<T> {
  public:
@@ -119,6 +187,10 @@ class GemmConvKernel : public framework::OpKernel<T> {
     Tensor* output = context.Output<Tensor>("Output");
     output->mutable_data<T>(context.GetPlace());
 
+    if (Conv2DByCPUEngine<DeviceContext, T>(context, *input, filter, output)) {
+      return;
+    }
+
     int groups = context.Attr<int>("groups");
     std::vector<int> strides = context.Attr<std::vector<int>>("strides");
     std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
@@ -232,6 +304,13 @@ class GemmConvGradKernel : public framework::OpKernel<T> {
 
     if (!input_grad && !filter_grad) return;
 
+    if (input_grad) input_grad->mutable_data<T>(context.GetPlace());
+    if (filter_grad) filter_grad->mutable_data<T>(context.GetPlace());
+    if (Conv2DGradByCPUEngine<DeviceContext, T>(
+            context, *input, filter, *output_grad, input_grad, filter_grad)) {
+      return;
+    }
+
     int groups = context.Attr<int>("groups");
     std::vector<int> strides = context.Attr<std::vector<int>>("strides");
     std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
@@ -22,8 +22,13 @@ namespace operators {
 
 framework::OpKernelType DeQuantOp::GetExpectedKernelType(
     const framework::ExecutionContext& ctx) const {
+#ifdef PADDLE_WITH_MKLDNN
   framework::LibraryType library_ = framework::LibraryType::kMKLDNN;
   framework::DataLayout layout_ = framework::DataLayout::kMKLDNN;
+#else
+  framework::LibraryType library_ = framework::LibraryType::kPlain;
+  framework::DataLayout layout_ = framework::DataLayout::kAnyLayout;
+#endif
 
   return framework::OpKernelType(ctx.Input<Tensor>("Input")->type(),
                                  ctx.GetPlace(), layout_, library_);
@@ -36,6 +41,23 @@ void DeQuantOpMaker::Make() {
   AddComment(R"DOC(This op will dequantize data from INT8 to FP32)DOC");
 }
 
+// The plain CPU kernel, output = input / Scale
+template <typename T>
+class CPUDeQuantOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* output = ctx.Output<Tensor>("Output");
+    const float reciprocal_scale = 1.f / ctx.Attr<float>("Scale");
+    const T* in_data = input->data<T>();
+    float* out_data = output->mutable_data<float>(ctx.GetPlace());
+    int64_t numel = input->numel();
+    for (int64_t i = 0; i < numel; ++i) {
+      out_data[i] = static_cast<float>(in_data[i]) * reciprocal_scale;
+    }
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -43,3 +65,5 @@ namespace ops = paddle::operators;
 
 REGISTER_OPERATOR(dequantize, ops::DeQuantOp, ops::DeQuantOpMaker,
                   paddle::framework::DefaultGradOpDescMaker<true>);
+REGISTER_OP_CPU_KERNEL(dequantize, ops::CPUDeQuantOpKernel<uint8_t>,
+                       ops::CPUDeQuantOpKernel<int8_t>);
@@ -13,6 +13,7 @@ limitations under the License. */
 
 #include <glog/logging.h>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/detection/nms_util.h"
 #include "paddle/fluid/operators/detection/poly_util.h"
 
 namespace paddle {
@@ -85,69 +86,6 @@ class MultiClassNMSOp : public framework::OperatorWithKernel {
   }
 };
 
-template <class T>
-bool SortScorePairDescend(const std::pair<float, T>& pair1,
-                          const std::pair<float, T>& pair2) {
-  return pair1.first > pair2.first;
-}
-
-template <class T>
-static inline void GetMaxScoreIndex(
-    const std::vector<T>& scores, const T threshold, int top_k,
-    std::vector<std::pair<T, int>>* sorted_indices) {
-  for (size_t i = 0; i < scores.size(); ++i) {
-    if (scores[i] > threshold) {
-      sorted_indices->push_back(std::make_pair(scores[i], i));
-    }
-  }
-  // Sort the score pair according to the scores in descending order
-  std::stable_sort(sorted_indices->begin(), sorted_indices->end(),
-                   SortScorePairDescend<int>);
-  // Keep top_k scores if needed.
-  if (top_k > -1 && top_k < static_cast<int>(sorted_indices->size())) {
-    sorted_indices->resize(top_k);
-  }
-}
-
-template <class T>
-static inline T BBoxArea(const T* box, const bool normalized) {
-  if (box[2] < box[0] || box[3] < box[1]) {
-    // If coordinate values are is invalid
-    // (e.g. xmax < xmin or ymax < ymin), return 0.
-    return static_cast<T>(0.);
-  } else {
-    const T w = box[2] - box[0];
-    const T h = box[3] - box[1];
-    if (normalized) {
-      return w * h;
-    } else {
-      // If coordinate values are not within range [0, 1].
-      return (w + 1) * (h + 1);
-    }
-  }
-}
-
-template <class T>
-static inline T JaccardOverlap(const T* box1, const T* box2,
-                               const bool normalized) {
-  if (box2[0] > box1[2] || box2[2] < box1[0] || box2[1] > box1[3] ||
-      box2[3] < box1[1]) {
-    return static_cast<T>(0.);
-  } else {
-    const T inter_xmin = std::max(box1[0], box2[0]);
-    const T inter_ymin = std::max(box1[1], box2[1]);
-    const T inter_xmax = std::min(box1[2], box2[2]);
-    const T inter_ymax = std::min(box1[3], box2[3]);
-    T norm = normalized ? static_cast<T>(0.) : static_cast<T>(1.);
-    T inter_w = inter_xmax - inter_xmin + norm;
-    T inter_h = inter_ymax - inter_ymin + norm;
-    const T inter_area = inter_w * inter_h;
-    const T bbox1_area = BBoxArea<T>(box1, normalized);
-    const T bbox2_area = BBoxArea<T>(box2, normalized);
-    return inter_area / (bbox1_area + bbox2_area - inter_area);
-  }
-}
-
 template <class T>
 T PolyIoU(const T* box1, const T* box2, const size_t box_size,
           const bool normalized) {
@@ -188,136 +126,136 @@ void SliceOneClass(const platform::DeviceContext& ctx,
 template <typename T>
 class MultiClassNMSKernel : public framework::OpKernel<T> {
  public:
-  void NMSFast(const Tensor& bbox, const Tensor& scores,
-               const T score_threshold, const T nms_threshold, const T eta,
-               const int64_t top_k, std::vector<int>* selected_indices,
-               const bool normalized) const {
-    // The total boxes for each instance.
-    int64_t num_boxes = bbox.dims()[0];
-    // 4: [xmin ymin xmax ymax]
-    // 8: [x1 y1 x2 y2 x3 y3 x4 y4]
-    // 16, 24, or 32: [x1 y1 x2 y2 ...  xn yn], n = 8, 12 or 16
-    int64_t box_size = bbox.dims()[1];
-
-    std::vector<T> scores_data(num_boxes);
-    std::copy_n(scores.data<T>(), num_boxes, scores_data.begin());
+  struct NMSParam {
+    int64_t background_label;
+    int64_t nms_top_k;
+    int64_t keep_top_k;
+    bool normalized;
+    T nms_threshold;
+    T nms_eta;
+    T score_threshold;
+  };
+
+  // The box of the i-th candidate is at bbox_data + i * box_stride, and its
+  // score at scores_data[i * score_stride].
+  void NMSFast(const T* bbox_data, const int64_t box_stride,
+               const int64_t box_size, const T* scores_data,
+               const int64_t score_stride, const int64_t num_boxes,
+               const NMSParam& param,
+               std::vector<int>* selected_indices) const {
     std::vector<std::pair<T, int>> sorted_indices;
-    GetMaxScoreIndex(scores_data, score_threshold, top_k, &sorted_indices);
+    GetMaxScoreIndex(scores_data, num_boxes, score_stride,
+                     param.score_threshold, param.nms_top_k, &sorted_indices);
 
     selected_indices->clear();
-    T adaptive_threshold = nms_threshold;
-    const T* bbox_data = bbox.data<T>();
+    T adaptive_threshold = param.nms_threshold;
+    const T eta = param.nms_eta;
+    RectNMSKeptBoxes<T> kept_boxes(param.normalized);
 
-    while (sorted_indices.size() != 0) {
-      const int idx = sorted_indices.front().second;
+    for (const auto& score_index : sorted_indices) {
+      const int idx = score_index.second;
+      const T* box = bbox_data + idx * box_stride;
       bool keep = true;
-      for (size_t k = 0; k < selected_indices->size(); ++k) {
-        if (keep) {
+      // 4: [xmin ymin xmax ymax]
+      if (box_size == 4) {
+        keep = kept_boxes.TryKeep(box, adaptive_threshold);
+      }
+      // 8: [x1 y1 x2 y2 x3 y3 x4 y4] or 16, 24, 32
+      if (box_size == 8 || box_size == 16 || box_size == 24 ||
+          box_size == 32) {
+        for (size_t k = 0; k < selected_indices->size() && keep; ++k) {
           const int kept_idx = (*selected_indices)[k];
-          T overlap = T(0.);
-          // 4: [xmin ymin xmax ymax]
-          if (box_size == 4) {
-            overlap =
-                JaccardOverlap<T>(bbox_data + idx * box_size,
-                                  bbox_data + kept_idx * box_size, normalized);
-          }
-          // 8: [x1 y1 x2 y2 x3 y3 x4 y4] or 16, 24, 32
-          if (box_size == 8 || box_size == 16 || box_size == 24 ||
-              box_size == 32) {
-            overlap = PolyIoU<T>(bbox_data + idx * box_size,
-                                 bbox_data + kept_idx * box_size, box_size,
-                                 normalized);
-          }
+          T overlap = PolyIoU<T>(box, bbox_data + kept_idx * box_stride,
+                                 box_size, param.normalized);
           keep = overlap <= adaptive_threshold;
-        } else {
-          break;
         }
       }
       if (keep) {
         selected_indices->push_back(idx);
       }
-      sorted_indices.erase(sorted_indices.begin());
       if (keep && eta < 1 && adaptive_threshold > 0.5) {
         adaptive_threshold *= eta;
       }
     }
   }
 
-  void MultiClassNMS(const framework::ExecutionContext& ctx,
-                     const Tensor& scores, const Tensor& bboxes,
-                     const int scores_size,
+  // The classes run in parallel if parallel_classes is true.
+  void MultiClassNMS(const NMSParam& param, const Tensor& scores,
+                     const Tensor& bboxes, const int scores_size,
+                     bool parallel_classes,
                      std::map<int, std::vector<int>>* indices,
                      int* num_nmsed_out) const {
-    int64_t background_label = ctx.Attr<int>("background_label");
-    int64_t nms_top_k = ctx.Attr<int>("nms_top_k");
-    int64_t keep_top_k = ctx.Attr<int>("keep_top_k");
-    bool normalized = ctx.Attr<bool>("normalized");
-    T nms_threshold = static_cast<T>(ctx.Attr<float>("nms_threshold"));
-    T nms_eta = static_cast<T>(ctx.Attr<float>("nms_eta"));
-    T score_threshold = static_cast<T>(ctx.Attr<float>("score_threshold"));
-    auto& dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
-
-    int num_det = 0;
+    const int64_t keep_top_k = param.keep_top_k;
+    const T* scores_data = scores.data<T>();
+    const T* bboxes_data = bboxes.data<T>();
 
+    // 3: scores [C, M], bboxes [M, box_size], shared by the classes
+    // 2: scores [M, C], bboxes [M, C, 4]
     int64_t class_num = scores_size == 3 ? scores.dims()[0] : scores.dims()[1];
-    Tensor bbox_slice, score_slice;
+    int64_t num_boxes = scores_size == 3 ? scores.dims()[1] : scores.dims()[0];
+    int64_t box_size = scores_size == 3 ? bboxes.dims()[1] : bboxes.dims()[2];
+    auto score_of = [&](int64_t label, int64_t idx) {
+      return scores_size == 3 ? scores_data[label * num_boxes + idx]
+                              : scores_data[idx * class_num + label];
+    };
+
+    std::vector<std::vector<int>> class_indices(class_num);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(dynamic) if (parallel_classes)
+#endif
     for (int64_t c = 0; c < class_num; ++c) {
-      if (c == background_label) continue;
+      if (c == param.background_label) continue;
       if (scores_size == 3) {
-        score_slice = scores.Slice(c, c + 1);
-        bbox_slice = bboxes;
+        NMSFast(bboxes_data, box_size, box_size, scores_data + c * num_boxes,
+                1, num_boxes, param, &class_indices[c]);
       } else {
-        score_slice.Resize({scores.dims()[0], 1});
-        bbox_slice.Resize({scores.dims()[0], 4});
-        SliceOneClass<T>(dev_ctx, scores, c, &score_slice);
-        SliceOneClass<T>(dev_ctx, bboxes, c, &bbox_slice);
-      }
-      NMSFast(bbox_slice, score_slice, score_threshold, nms_threshold, nms_eta,
-              nms_top_k, &((*indices)[c]), normalized);
-      if (scores_size == 2) {
-        std::stable_sort((*indices)[c].begin(), (*indices)[c].end());
+        NMSFast(bboxes_data + c * box_size, class_num * box_size, box_size,
+                scores_data + c, class_num, num_boxes, param,
+                &class_indices[c]);
+        std::sort(class_indices[c].begin(), class_indices[c].end());
       }
-      num_det += (*indices)[c].size();
+    }
+
+    int num_det = 0;
+    for (int64_t c = 0; c < class_num; ++c) {
+      if (c == param.background_label) continue;
+      num_det += class_indices[c].size();
+      (*indices)[c] = std::move(class_indices[c]);
     }
 
     *num_nmsed_out = num_det;
-    const T* scores_data = scores.data<T>();
     if (keep_top_k > -1 && num_det > keep_top_k) {
-      const T* sdata;
+      // The score is compared in float like before, and the ties are kept
+      // in the order of the labels and of the indices in a label.
       std::vector<std::pair<float, std::pair<int, int>>> score_index_pairs;
       for (const auto& it : *indices) {
         int label = it.first;
-        if (scores_size == 3) {
-          sdata = scores_data + label * scores.dims()[1];
-        } else {
-          score_slice.Resize({scores.dims()[0], 1});
-          SliceOneClass<T>(dev_ctx, scores, label, &score_slice);
-          sdata = score_slice.data<T>();
-        }
-        const std::vector<int>& label_indices = it.second;
-        for (size_t j = 0; j < label_indices.size(); ++j) {
-          int idx = label_indices[j];
+        for (int idx : it.second) {
           score_index_pairs.push_back(
-              std::make_pair(sdata[idx], std::make_pair(label, idx)));
+              std::make_pair(score_of(label, idx), std::make_pair(label, idx)));
         }
       }
+      std::vector<std::pair<float, int>> order;
+      order.reserve(score_index_pairs.size());
+      for (size_t j = 0; j < score_index_pairs.size(); ++j) {
+        order.emplace_back(score_index_pairs[j].first, static_cast<int>(j));
+      }
       // Keep top k results per image.
-      std::stable_sort(score_index_pairs.begin(), score_index_pairs.end(),
-                       SortScorePairDescend<std::pair<int, int>>);
-      score_index_pairs.resize(keep_top_k);
+      ScoreIndexGreater<float> greater;
+      std::nth_element(order.begin(), order.begin() + keep_top_k, order.end(),
+                       greater);
+      order.resize(keep_top_k);
+      std::sort(order.begin(), order.end(), greater);
 
       // Store the new indices.
       std::map<int, std::vector<int>> new_indices;
-      for (size_t j = 0; j < score_index_pairs.size(); ++j) {
-        int label = score_index_pairs[j].second.first;
-        int idx = score_index_pairs[j].second.second;
-        new_indices[label].push_back(idx);
+      for (const auto& item : order) {
+        const auto& label_index = score_index_pairs[item.second].second;
+        new_indices[label_index.first].push_back(label_index.second);
       }
       if (scores_size == 2) {
-        for (const auto& it : new_indices) {
-          int label = it.first;
-          std::stable_sort(new_indices[label].begin(),
-                           new_indices[label].end());
+        for (auto& it : new_indices) {
+          std::sort(it.second.begin(), it.second.end());
         }
       }
       new_indices.swap(*indices);
@@ -378,30 +316,44 @@ class MultiClassNMSKernel : public framework::OpKernel<T> {
     auto score_size = score_dims.size();
     auto& dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
 
-    std::vector<std::map<int, std::vector<int>>> all_indices;
-    std::vector<size_t> batch_starts = {0};
+    NMSParam param;
+    param.background_label = ctx.Attr<int>("background_label");
+    param.nms_top_k = ctx.Attr<int>("nms_top_k");
+    param.keep_top_k = ctx.Attr<int>("keep_top_k");
+    param.normalized = ctx.Attr<bool>("normalized");
+    param.nms_threshold = static_cast<T>(ctx.Attr<float>("nms_threshold"));
+    param.nms_eta = static_cast<T>(ctx.Attr<float>("nms_eta"));
+    param.score_threshold = static_cast<T>(ctx.Attr<float>("score_threshold"));
+
     int64_t batch_size = score_dims[0];
     int64_t box_dim = boxes->dims()[2];
     int64_t out_dim = box_dim + 2;
-    int num_nmsed_out = 0;
     Tensor boxes_slice, scores_slice;
     int n = score_size == 3 ? batch_size : boxes->lod().back().size() - 1;
+    std::vector<std::map<int, std::vector<int>>> all_indices(n);
+    std::vector<int> num_nmsed_outs(n);
+    // The images of a batch run in parallel, or the classes of one image.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(dynamic) if (n > 1)
+#endif
     for (int i = 0; i < n; ++i) {
+      Tensor image_scores, image_boxes;
       if (score_size == 3) {
-        scores_slice = scores->Slice(i, i + 1);
-        scores_slice.Resize({score_dims[1], score_dims[2]});
-        boxes_slice = boxes->Slice(i, i + 1);
-        boxes_slice.Resize({score_dims[2], box_dim});
+        image_scores = scores->Slice(i, i + 1);
+        image_scores.Resize({score_dims[1], score_dims[2]});
+        image_boxes = boxes->Slice(i, i + 1);
+        image_boxes.Resize({score_dims[2], box_dim});
       } else {
-        auto boxes_lod = boxes->lod().back();
-        scores_slice = scores->Slice(boxes_lod[i], boxes_lod[i + 1]);
-        boxes_slice = boxes->Slice(boxes_lod[i], boxes_lod[i + 1]);
+        auto& boxes_lod = boxes->lod().back();
+        image_scores = scores->Slice(boxes_lod[i], boxes_lod[i + 1]);
+        image_boxes = boxes->Slice(boxes_lod[i], boxes_lod[i + 1]);
       }
-      std::map<int, std::vector<int>> indices;
-      MultiClassNMS(ctx, scores_slice, boxes_slice, score_size, &indices,
-                    &num_nmsed_out);
-      all_indices.push_back(indices);
-      batch_starts.push_back(batch_starts.back() + num_nmsed_out);
+      MultiClassNMS(param, image_scores, image_boxes, score_size, n == 1,
+                    &all_indices[i], &num_nmsed_outs[i]);
+    }
+    std::vector<size_t> batch_starts = {0};
+    for (int i = 0; i < n; ++i) {
+      batch_starts.push_back(batch_starts.back() + num_nmsed_outs[i]);
     }
 
     int num_kept = batch_starts.back();
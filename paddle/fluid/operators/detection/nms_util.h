@@ -0,0 +1,130 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+
+/*
+ * Orders the (score, index) pairs by the score in descending order, and by
+ * the index on ties, which is the order of a stable sort by the score.
+ */
+template <class T>
+struct ScoreIndexGreater {
+  bool operator()(const std::pair<T, int>& a,
+                  const std::pair<T, int>& b) const {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+  }
+};
+
+/*
+ * Collects the num scores at the given stride which are larger than
+ * threshold, sorted in descending order. Only the top_k ones are kept and
+ * sorted if top_k > -1, they are selected by nth_element first.
+ */
+template <class T>
+void GetMaxScoreIndex(const T* scores, int64_t num, int64_t stride,
+                      const T threshold, int64_t top_k,
+                      std::vector<std::pair<T, int>>* sorted_indices) {
+  sorted_indices->clear();
+  for (int64_t i = 0; i < num; ++i) {
+    if (scores[i * stride] > threshold) {
+      sorted_indices->emplace_back(scores[i * stride], static_cast<int>(i));
+    }
+  }
+  ScoreIndexGreater<T> greater;
+  if (top_k > -1 && top_k < static_cast<int64_t>(sorted_indices->size())) {
+    std::nth_element(sorted_indices->begin(), sorted_indices->begin() + top_k,
+                     sorted_indices->end(), greater);
+    sorted_indices->resize(top_k);
+  }
+  std::sort(sorted_indices->begin(), sorted_indices->end(), greater);
+}
+
+template <class T>
+inline T BBoxArea(const T* box, const bool normalized) {
+  if (box[2] < box[0] || box[3] < box[1]) {
+    // If coordinate values are is invalid
+    // (e.g. xmax < xmin or ymax < ymin), return 0.
+    return static_cast<T>(0.);
+  } else {
+    const T w = box[2] - box[0];
+    const T h = box[3] - box[1];
+    if (normalized) {
+      return w * h;
+    } else {
+      // If coordinate values are not within range [0, 1].
+      return (w + 1) * (h + 1);
+    }
+  }
+}
+
+/*
+ * The kept boxes of the greedy NMS on [xmin, ymin, xmax, ymax] boxes. They
+ * are stored as a structure of arrays, so the IoU of a candidate with the
+ * kept boxes is a branchless loop which the compiler vectorizes. The IoU is
+ * computed the same way as JaccardOverlap of the boxes.
+ */
+template <class T>
+class RectNMSKeptBoxes {
+ public:
+  explicit RectNMSKeptBoxes(bool normalized) : normalized_(normalized) {}
+
+  // Keeps the box if its IoU with every kept box is at most threshold.
+  bool TryKeep(const T* box, const T threshold) {
+    const T xmin = box[0], ymin = box[1], xmax = box[2], ymax = box[3];
+    const T area = BBoxArea<T>(box, normalized_);
+    const T norm = normalized_ ? static_cast<T>(0.) : static_cast<T>(1.);
+    const T zero = static_cast<T>(0.);
+    const size_t num = area_.size();
+    // Checked a block at a time to stop early on a suppressed candidate.
+    constexpr size_t kBlock = 16;
+    for (size_t start = 0; start < num; start += kBlock) {
+      const size_t end = std::min(num, start + kBlock);
+      bool suppressed = false;
+      for (size_t k = start; k < end; ++k) {
+        const bool disjoint = (xmin_[k] > xmax) | (xmax_[k] < xmin) |
+                              (ymin_[k] > ymax) | (ymax_[k] < ymin);
+        const T inter_w =
+            std::min(xmax, xmax_[k]) - std::max(xmin, xmin_[k]) + norm;
+        const T inter_h =
+            std::min(ymax, ymax_[k]) - std::max(ymin, ymin_[k]) + norm;
+        const T inter_area = inter_w * inter_h;
+        const T iou = inter_area / (area + area_[k] - inter_area);
+        const T overlap = disjoint ? zero : iou;
+        suppressed |= !(overlap <= threshold);
+      }
+      if (suppressed) {
+        return false;
+      }
+    }
+    xmin_.push_back(xmin);
+    ymin_.push_back(ymin);
+    xmax_.push_back(xmax);
+    ymax_.push_back(ymax);
+    area_.push_back(area);
+    return true;
+  }
+
+ private:
+  bool normalized_;
+  std::vector<T> xmin_, ymin_, xmax_, ymax_, area_;
+};
+
+}  // namespace operators
+}  // namespace paddle
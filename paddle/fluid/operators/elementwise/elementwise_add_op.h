@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/operators/elementwise/elementwise_op.h"
 #include "paddle/fluid/operators/elementwise/elementwise_op_function.h"
+#include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 
 namespace paddle {
@@ -39,6 +40,7 @@ void default_elementwise_add(const framework::ExecutionContext &ctx,
 template <typename DeviceContext, typename T>
 typename std::enable_if<
     std::is_floating_point<T>::value &&
+    !std::is_same<T, platform::bfloat16>::value &&
     std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
 elementwise_add(const framework::ExecutionContext &ctx,
                 const framework::Tensor *x, const framework::Tensor *y,
@@ -51,6 +53,21 @@ elementwise_add(const framework::ExecutionContext &ctx,
   blas.VADD(x->numel(), eigen_x.data(), eigen_y.data(), eigen_z.data());
 }
 
+// bfloat16 is computed in float by the jit kernel and rounded once
+template <typename DeviceContext, typename T>
+typename std::enable_if<
+    std::is_same<T, platform::bfloat16>::value &&
+    std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
+elementwise_add(const framework::ExecutionContext &ctx,
+                const framework::Tensor *x, const framework::Tensor *y,
+                framework::Tensor *z) {
+  int n = static_cast<int>(x->numel());
+  auto compute = jit::KernelFuncs<jit::kVAdd, jit::XYZNTuples<T>,
+                                  platform::CPUPlace>::Cache()
+                     .At(n);
+  compute(x->data<T>(), y->data<T>(), z->mutable_data<T>(ctx.GetPlace()), n);
+}
+
 template <typename DeviceContext, typename T>
 typename std::enable_if<
     !std::is_floating_point<T>::value ||
@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/operators/elementwise/elementwise_op.h"
 #include "paddle/fluid/operators/elementwise/elementwise_op_function.h"
+#include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 
 namespace paddle {
@@ -37,6 +38,7 @@ void default_elementwise_mul(const framework::ExecutionContext& ctx,
 template <typename DeviceContext, typename T>
 typename std::enable_if<
     std::is_floating_point<T>::value &&
+    !std::is_same<T, platform::bfloat16>::value &&
     std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
 elementwise_mul(const framework::ExecutionContext& ctx,
                 const framework::Tensor* x, const framework::Tensor* y,
@@ -46,6 +48,21 @@ elementwise_mul(const framework::ExecutionContext& ctx,
             z->mutable_data<T>(ctx.GetPlace()));
 }
 
+// bfloat16 is computed in float by the jit kernel and rounded once
+template <typename DeviceContext, typename T>
+typename std::enable_if<
+    std::is_same<T, platform::bfloat16>::value &&
+    std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
+elementwise_mul(const framework::ExecutionContext& ctx,
+                const framework::Tensor* x, const framework::Tensor* y,
+                framework::Tensor* z) {
+  int n = static_cast<int>(x->numel());
+  auto compute = jit::KernelFuncs<jit::kVMul, jit::XYZNTuples<T>,
+                                  platform::CPUPlace>::Cache()
+                     .At(n);
+  compute(x->data<T>(), y->data<T>(), z->mutable_data<T>(ctx.GetPlace()), n);
+}
+
 template <typename DeviceContext, typename T>
 typename std::enable_if<
     !std::is_floating_point<T>::value ||
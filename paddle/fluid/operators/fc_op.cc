@@ -128,11 +128,34 @@ void FCOpMaker::Make() {
   AddAttr<bool>("use_mkldnn",
                 "(bool, default false) Only used in mkldnn kernel")
       .SetDefault(false);
+  AddAttr<bool>("fuse_relu",
+                "(bool, default false) Whether to fuse relu into the output, "
+                "only used in INT8 kernel.")
+      .SetDefault(false);
+  AddAttr<float>("Scale_in",
+                 "Scale_in to be used for int8 input data. "
+                 "Only used in INT8 kernel.")
+      .SetDefault(1.0f);
+  AddAttr<std::vector<float>>("Scale_weights",
+                              "Scale_weights to be used for int8 weights data. "
+                              "Only used in INT8 kernel.")
+      .SetDefault({1.0f});
+  AddAttr<float>("Scale_out",
+                 "Scale_out to be used for int8 output data. "
+                 "Only used in INT8 kernel.")
+      .SetDefault(1.0f);
+  AddAttr<bool>("force_fp32_output",
+                "(bool, default false) Force INT8 kernel output FP32.")
+      .SetDefault(false);
   AddComment(R"DOC(
   Fully Connected Operator.
 
   The fully connected operation calculates the output based on the input, weights and bias.
   The size of each dimension of the parameters checked in the infer-shape.
+
+  When the Input is quantized uint8 data and W is int8, the CPU INT8 kernel
+  is used, and the output is uint8 requantized by Scale_out unless
+  force_fp32_output is set.
 )DOC");
 }
 
@@ -162,6 +185,43 @@ class FCOpKernel : public framework::OpKernel<T> {
   }
 };
 
+// Input is the uint8 data quantized by Scale_in and W is the int8 weight
+// quantized by Scale_weights, which is from the calibration.
+class FCInt8OpKernel : public framework::OpKernel<uint8_t> {
+ public:
+  void Compute(const paddle::framework::ExecutionContext& ctx) const override {
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "It must use CPUPlace.");
+    auto input = ctx.Input<Tensor>("Input");
+    auto w = ctx.Input<Tensor>("W");
+    auto bias = ctx.Input<Tensor>("Bias");
+    auto output = ctx.Output<Tensor>("Out");
+    PADDLE_ENFORCE_EQ(w->type(), framework::proto::VarType::INT8,
+                      "The weight of INT8 fc should be int8.");
+    bool fuse_relu = ctx.Attr<bool>("fuse_relu");
+    bool force_fp32_output = ctx.Attr<bool>("force_fp32_output");
+    PADDLE_ENFORCE(force_fp32_output || fuse_relu,
+                   "The uint8 output of fc should be fused with relu, "
+                   "otherwise please set force_fp32_output.");
+    auto w_dims = w->dims();
+    auto out_dims = output->dims();
+    int M = framework::product(out_dims) / out_dims[out_dims.size() - 1];
+
+    // the weights are packed at the first run
+    auto fc = math::FCInt8FunctorCache::Instance().Get(
+        *w, w_dims[1], w_dims[0], false, ctx.Attr<float>("Scale_in"),
+        ctx.Attr<std::vector<float>>("Scale_weights"),
+        ctx.Attr<float>("Scale_out"), bias, fuse_relu, !force_fp32_output);
+    void* output_data = nullptr;
+    if (force_fp32_output) {
+      output_data = output->mutable_data<float>(ctx.GetPlace());
+    } else {
+      output_data = output->mutable_data<uint8_t>(ctx.GetPlace());
+    }
+    (*fc)(input->data<uint8_t>(), M, output_data);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -169,4 +229,6 @@ namespace ops = paddle::operators;
 REGISTER_OPERATOR(fc, ops::FCOp, ops::FCOpMaker,
                   paddle::framework::DefaultGradOpDescMaker<true>);
 REGISTER_OPERATOR(fc_grad, ops::FCOpGrad);
-REGISTER_OP_CPU_KERNEL(fc, ops::FCOpKernel<float>, ops::FCOpKernel<double>);
+REGISTER_OP_CPU_KERNEL(fc, ops::FCOpKernel<float>, ops::FCOpKernel<double>,
+                       ops::FCOpKernel<paddle::platform::bfloat16>,
+                       ops::FCInt8OpKernel);
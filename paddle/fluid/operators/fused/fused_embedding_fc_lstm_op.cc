@@ -557,9 +557,8 @@ class FusedEmbeddingFCLSTMKernel : public framework::OpKernel<T> {
 
     math::Batch2LoDTensorFunctor<DeviceContext, T> to_seq;
     batched_h_out->set_lod(batched_lod);
-    to_seq(dev_ctx, *batched_h_out, hidden_out);
     batched_c_out->set_lod(batched_lod);
-    to_seq(dev_ctx, *batched_c_out, cell_out);
+    to_seq(dev_ctx, {batched_h_out, batched_c_out}, {hidden_out, cell_out});
   }
 
   void Compute(const framework::ExecutionContext& ctx) const override {
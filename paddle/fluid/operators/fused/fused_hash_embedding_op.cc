@@ -0,0 +1,162 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_hash_embedding_op.h"
+#include <string>
+#include "paddle/fluid/framework/var_type_inference.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedHashEmbeddingOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input X of FusedHashEmbeddingOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("W"),
+                   "Input W of FusedHashEmbeddingOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output of FusedHashEmbeddingOp should not be null.");
+
+    auto x_dims = ctx->GetInputDim("X");
+    auto table_dims = ctx->GetInputDim("W");
+    PADDLE_ENFORCE_EQ(x_dims.size(), 2,
+                      "The input of fused_hash_embedding must be 2-D");
+    PADDLE_ENFORCE_EQ(table_dims.size(), 2, "W must be 2-D");
+    int num_hash = ctx->Attrs().Get<int>("num_hash");
+    int mod_by = ctx->Attrs().Get<int>("mod_by");
+    PADDLE_ENFORCE_GT(num_hash, 0, "num_hash must be positive");
+    PADDLE_ENFORCE_GT(mod_by, 0, "mod_by must be positive");
+
+    ctx->SetOutputDim("Out",
+                      framework::make_ddim({x_dims[0], num_hash,
+                                            table_dims[1]}));
+    ctx->ShareLoD("X", /*->*/ "Out");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class FusedHashEmbeddingOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X",
+             "(LoDTensor) The int32 or int64 input of shape [N, K], every "
+             "row of which is hashed.");
+    AddInput("W",
+             "(Tensor) The embedding table of shape [H, D], which is a "
+             "learnable parameter. H must be no less than mod_by.");
+    AddOutput("Out",
+              "(LoDTensor) The embeddings of shape [N, num_hash, D], which "
+              "have the same type as W and the same LoD as X.");
+    AddAttr<int>("num_hash", "(int, default 1) The times of hash.")
+        .SetDefault(1);
+    AddAttr<int>("mod_by",
+                 "(int, default 100000) The hashed ids are modulo mod_by.")
+        .SetDefault(100000);
+    AddAttr<bool>("hash_full_row",
+                  "(bool, default false) Whether to hash all the bytes of "
+                  "every row, the same as in hash_op.")
+        .SetDefault(false);
+    AddAttr<bool>("is_sparse",
+                  "(boolean, default false) "
+                  "Sparse update.")
+        .SetDefault(false);
+    AddComment(R"DOC(
+FusedHashEmbedding Operator.
+
+Computes hash_op followed by lookup_table, without the intermediate ids:
+
+$$Out[i, j] = W[XXH64(X[i], j) \% mod\_by]$$
+
+The ids are computed a block of rows at a time and looked up right away.
+The output shares the LoD information with input X.
+
+)DOC");
+  }
+};
+
+class FusedHashEmbeddingOpGradDescMaker
+    : public framework::DefaultGradOpDescMaker<true> {
+  using ::paddle::framework::DefaultGradOpDescMaker<
+      true>::DefaultGradOpDescMaker;
+
+ protected:
+  virtual std::string GradOpType() const {
+    return "fused_hash_embedding_grad";
+  }
+};
+
+class FusedHashEmbeddingOpGrad : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    auto table_dims = ctx->GetInputDim("W");
+    ctx->SetOutputDim(framework::GradVarName("W"), table_dims);
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class FusedHashEmbeddingOpGradVarTypeInference
+    : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto out_var_name = op_desc.Output(framework::GradVarName("W")).front();
+    auto attr = op_desc.GetAttr("is_sparse");
+    bool is_sparse = boost::get<bool>(attr);
+    if (is_sparse) {
+      VLOG(3) << "fused_hash_embedding_grad op " << framework::GradVarName("W")
+              << " is set to SelectedRows";
+      block->Var(out_var_name)
+          ->SetType(framework::proto::VarType::SELECTED_ROWS);
+    } else {
+      VLOG(3) << "fused_hash_embedding_grad op " << framework::GradVarName("W")
+              << " is set to LoDTensor";
+      block->Var(out_var_name)->SetType(framework::proto::VarType::LOD_TENSOR);
+    }
+    block->Var(out_var_name)->SetDataType(block->Var("W")->GetDataType());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_hash_embedding, ops::FusedHashEmbeddingOp,
+                  ops::FusedHashEmbeddingOpGradDescMaker,
+                  ops::FusedHashEmbeddingOpMaker);
+REGISTER_OPERATOR(fused_hash_embedding_grad, ops::FusedHashEmbeddingOpGrad,
+                  ops::FusedHashEmbeddingOpGradVarTypeInference);
+
+REGISTER_OP_CPU_KERNEL(fused_hash_embedding,
+                       ops::FusedHashEmbeddingKernel<float>,
+                       ops::FusedHashEmbeddingKernel<double>);
+REGISTER_OP_CPU_KERNEL(fused_hash_embedding_grad,
+                       ops::FusedHashEmbeddingGradKernel<float>,
+                       ops::FusedHashEmbeddingGradKernel<double>);
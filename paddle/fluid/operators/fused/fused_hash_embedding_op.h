@@ -0,0 +1,140 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/hash_op.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+
+using LoDTensor = framework::LoDTensor;
+using SelectedRows = framework::SelectedRows;
+
+// The rows of X hashed at a time, whose ids are kept in a small buffer
+// instead of a tensor of all the ids.
+constexpr int64_t kHashEmbeddingBlockRows = 256;
+
+// Calls fn(begin, n, ids) for every block of n rows of X from the row begin,
+// where ids holds the num_hash ids of each row of the block.
+template <typename Fn>
+void ForEachHashedBlock(const LoDTensor& x, int num_hash, int mod_by,
+                        bool hash_full_row, Fn fn) {
+  const int64_t rows = x.dims()[0];
+  const int64_t last_dim = x.dims()[x.dims().size() - 1];
+  std::vector<int64_t> ids(kHashEmbeddingBlockRows * num_hash);
+  for (int64_t begin = 0; begin < rows; begin += kHashEmbeddingBlockRows) {
+    int64_t n = std::min(kHashEmbeddingBlockRows, rows - begin);
+    if (x.type() == framework::proto::VarType::INT32) {
+      MultiHash(x.data<int>() + begin * last_dim, n, last_dim, num_hash,
+                mod_by, hash_full_row, ids.data());
+    } else {
+      MultiHash(x.data<int64_t>() + begin * last_dim, n, last_dim, num_hash,
+                mod_by, hash_full_row, ids.data());
+    }
+    fn(begin, n, ids.data());
+  }
+}
+
+template <typename T>
+class FusedHashEmbeddingKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* x = context.Input<LoDTensor>("X");
+    auto* table_t = context.Input<LoDTensor>("W");
+    auto* output_t = context.Output<LoDTensor>("Out");
+    int num_hash = context.Attr<int>("num_hash");
+    int mod_by = context.Attr<int>("mod_by");
+    bool hash_full_row = context.Attr<bool>("hash_full_row");
+
+    int64_t table_height = table_t->dims()[0];
+    int64_t width = table_t->dims()[1];
+    PADDLE_ENFORCE_LE(mod_by, table_height,
+                      "mod_by must not be larger than the height of W");
+
+    output_t->Resize({x->dims()[0], num_hash, width});
+    auto* output = output_t->mutable_data<T>(context.GetPlace());
+    const T* table = table_t->data<T>();
+    ForEachHashedBlock(*x, num_hash, mod_by, hash_full_row,
+                       [&](int64_t begin, int64_t n, const int64_t* ids) {
+                         T* out = output + begin * num_hash * width;
+                         for (int64_t i = 0; i < n * num_hash; ++i) {
+                           std::memcpy(out + i * width, table + ids[i] * width,
+                                       width * sizeof(T));
+                         }
+                       });
+    output_t->set_lod(x->lod());
+  }
+};
+
+template <typename T>
+class FusedHashEmbeddingGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* x = context.Input<LoDTensor>("X");
+    auto* d_output = context.Input<LoDTensor>(framework::GradVarName("Out"));
+    auto table_dims = context.Input<LoDTensor>("W")->dims();
+    int num_hash = context.Attr<int>("num_hash");
+    int mod_by = context.Attr<int>("mod_by");
+    bool hash_full_row = context.Attr<bool>("hash_full_row");
+    int64_t width = table_dims[1];
+    const T* d_output_data = d_output->data<T>();
+
+    // the ids are hashed again rather than kept from the forward
+    if (context.Attr<bool>("is_sparse")) {
+      auto* d_table =
+          context.Output<SelectedRows>(framework::GradVarName("W"));
+      int64_t ids_num = x->dims()[0] * num_hash;
+      std::vector<int64_t> new_rows(ids_num);
+      ForEachHashedBlock(*x, num_hash, mod_by, hash_full_row,
+                         [&](int64_t begin, int64_t n, const int64_t* ids) {
+                           std::copy(ids, ids + n * num_hash,
+                                     new_rows.begin() + begin * num_hash);
+                         });
+      d_table->set_rows(new_rows);
+      d_table->set_height(table_dims[0]);
+
+      auto* d_table_value = d_table->mutable_value();
+      d_table_value->Resize({ids_num, width});
+      T* d_table_data = d_table_value->mutable_data<T>(context.GetPlace());
+      std::memcpy(d_table_data, d_output_data, sizeof(T) * d_output->numel());
+    } else {
+      auto* d_table = context.Output<LoDTensor>(framework::GradVarName("W"));
+      d_table->Resize(table_dims);
+      T* d_table_data = d_table->mutable_data<T>(context.GetPlace());
+      std::memset(d_table_data, 0, d_table->numel() * sizeof(T));
+      auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
+      ForEachHashedBlock(
+          *x, num_hash, mod_by, hash_full_row,
+          [&](int64_t begin, int64_t n, const int64_t* ids) {
+            const T* d_out = d_output_data + begin * num_hash * width;
+            for (int64_t i = 0; i < n * num_hash; ++i) {
+              blas.AXPY(width, static_cast<T>(1), d_out + i * width,
+                        d_table_data + ids[i] * width);
+            }
+          });
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,178 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fusion_elementwise_chain_op.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/operators/jit/kernels.h"
+
+namespace paddle {
+namespace operators {
+
+static jit::ChainOpType GetChainOpType(const std::string& type) {
+  static const std::unordered_map<std::string, jit::ChainOpType> types = {
+      {"add", jit::kChainAdd},         {"sub", jit::kChainSub},
+      {"rsub", jit::kChainRSub},       {"mul", jit::kChainMul},
+      {"div", jit::kChainDiv},         {"rdiv", jit::kChainRDiv},
+      {"max", jit::kChainMax},         {"min", jit::kChainMin},
+      {"scale", jit::kChainScale},     {"relu", jit::kChainRelu},
+      {"sigmoid", jit::kChainSigmoid}, {"tanh", jit::kChainTanh},
+      {"exp", jit::kChainExp},         {"square", jit::kChainSquare}};
+  auto it = types.find(type);
+  PADDLE_ENFORCE(it != types.end(), "Not support %s in the chain.", type);
+  return it->second;
+}
+
+static jit::elementwise_chain_attr_t GetChainAttr(
+    const std::vector<std::string>& chain_ops,
+    const std::vector<float>& scales, const std::vector<float>& biases) {
+  PADDLE_ENFORCE(scales.empty() || scales.size() == chain_ops.size(),
+                 "The size of scales should be 0 or the number of ops.");
+  PADDLE_ENFORCE(biases.empty() || biases.size() == chain_ops.size(),
+                 "The size of biases should be 0 or the number of ops.");
+  jit::elementwise_chain_attr_t attr;
+  for (size_t i = 0; i < chain_ops.size(); ++i) {
+    PADDLE_ENFORCE(
+        attr.Append(GetChainOpType(chain_ops[i]),
+                    scales.empty() ? 1.f : scales[i],
+                    biases.empty() ? 0.f : biases[i]),
+        "The chain supports at most %d ops and %d inputs.", jit::kMaxChainOps,
+        jit::kMaxChainInputs);
+  }
+  return attr;
+}
+
+void FusionElementwiseChainOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInput("X"),
+                 "Input(X) of FusionElementwiseChainOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                 "Output(Out) of FusionElementwiseChainOp should not be null.");
+  auto attrs = ctx->Attrs();
+  auto attr = GetChainAttr(attrs.Get<std::vector<std::string>>("chain_ops"),
+                           attrs.Get<std::vector<float>>("scales"),
+                           attrs.Get<std::vector<float>>("biases"));
+  PADDLE_ENFORCE_GT(attr.num_ops, 0, "The chain should not be empty.");
+  auto ys_num = ctx->Inputs("Ys").size();
+  PADDLE_ENFORCE_EQ(ys_num, static_cast<size_t>(attr.num_inputs()),
+                    "The number of Inputs(Ys) should be equal to the number "
+                    "of binary ops in the chain.");
+
+  auto x_dims = ctx->GetInputDim("X");
+  if (ctx->IsRuntime() && ys_num > 0) {
+    auto x_numel = framework::product(x_dims);
+    for (auto& y_dims : ctx->GetInputsDim("Ys")) {
+      auto y_numel = framework::product(y_dims);
+      PADDLE_ENFORCE(y_numel > 0 && x_numel % y_numel == 0,
+                     "Every Ys should be as large as X or be broadcast "
+                     "along the leading dims of X.");
+    }
+  }
+  ctx->SetOutputDim("Out", x_dims);
+  ctx->ShareLoD("X", /*->*/ "Out");
+}
+
+framework::OpKernelType FusionElementwiseChainOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(framework::GetDataTypeOfVar(ctx.InputVar("X")),
+                                 ctx.GetPlace());
+}
+
+void FusionElementwiseChainOpMaker::Make() {
+  AddInput("X", "(LoDTensor) The first operand of the chain.");
+  AddInput("Ys",
+           "(Tensor) The other operands of the binary ops, in the order of "
+           "the ops. Each one has the same shape as X, or the shape of the "
+           "trailing dims of X.")
+      .AsDuplicable()
+      .AsDispensable();
+  AddOutput("Out", "(LoDTensor) Output tensor with the same shape as X.");
+  AddAttr<std::vector<std::string>>(
+      "chain_ops",
+      "The ops applied to X one by one, could be add, sub, rsub, mul, div, "
+      "rdiv, max, min, scale, relu, sigmoid, tanh, exp and square. rsub and "
+      "rdiv take the input Y as the first operand.");
+  AddAttr<std::vector<float>>(
+      "scales", "The scale of each op, only used by the scale ops.")
+      .SetDefault({});
+  AddAttr<std::vector<float>>(
+      "biases", "The bias of each op, only used by the scale ops.")
+      .SetDefault({});
+  AddComment(R"DOC(
+  Fusion Elementwise Chain Operator.
+
+  Applies a chain of elementwise binary ops and activations to X without
+  writing the intermediate results to memory, for example
+  $$Out = sigmoid(X * Ys[0] + Ys[1])$$
+)DOC");
+}
+
+template <typename T>
+class FusionElementwiseChainKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<LoDTensor>("X");
+    auto ys = ctx.MultiInput<Tensor>("Ys");
+    auto* out = ctx.Output<LoDTensor>("Out");
+    auto attr =
+        GetChainAttr(ctx.Attr<std::vector<std::string>>("chain_ops"),
+                     ctx.Attr<std::vector<float>>("scales"),
+                     ctx.Attr<std::vector<float>>("biases"));
+    auto chain =
+        jit::Get<jit::kElementwiseChain, jit::ElementwiseChainTuples<T>,
+                 platform::CPUPlace>(attr);
+
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+    const int64_t numel = x->numel();
+    if (numel == 0) {
+      return;
+    }
+    const T* x_data = x->data<T>();
+    // the broadcast inputs repeat every w elements
+    int64_t w = numel;
+    for (auto* y : ys) {
+      PADDLE_ENFORCE(y->numel() > 0 && numel % y->numel() == 0,
+                     "Every Ys should be as large as X or be broadcast "
+                     "along the leading dims of X.");
+      w = std::min(w, y->numel());
+    }
+    for (auto* y : ys) {
+      PADDLE_ENFORCE_EQ(y->numel() % w, 0,
+                        "The sizes of Ys should be multiples of each other.");
+    }
+    std::vector<const T*> ys_data(ys.size());
+    for (int64_t r = 0; r < numel / w; ++r) {
+      for (size_t i = 0; i < ys.size(); ++i) {
+        int64_t y_rows = ys[i]->numel() / w;
+        ys_data[i] = ys[i]->data<T>() + (r % y_rows) * w;
+      }
+      chain(x_data + r * w, ys_data.data(), out_data + r * w,
+            static_cast<int>(w), &attr);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fusion_elementwise_chain, ops::FusionElementwiseChainOp,
+                  ops::FusionElementwiseChainOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+
+REGISTER_OP_CPU_KERNEL(fusion_elementwise_chain,
+                       ops::FusionElementwiseChainKernel<float>,
+                       ops::FusionElementwiseChainKernel<double>);
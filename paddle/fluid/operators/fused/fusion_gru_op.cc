@@ -13,12 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/fused/fusion_gru_op.h"
+#include <algorithm>
 #include <cstring>  // for memcpy
 #include <string>
+#include <vector>
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/fc_compute.h"
 #include "paddle/fluid/operators/math/sequence2batch.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 
 namespace paddle {
 namespace operators {
@@ -211,7 +214,6 @@ class FusionGRUKernel : public framework::OpKernel<T> {
     using DeviceContext = paddle::platform::CPUDeviceContext;
     INIT_BASE_DEFINES;
     INIT_OTHER_DEFINES;
-    const int N = x_lod[0].size() - 1;
     const T* h0_data = h0 ? h0->data<T>() : nullptr;
     const T* wh_state_data = wh_data + D * D2;
     T* hidden_out_data = hidden_out->mutable_data<T>(place);
@@ -220,51 +222,104 @@ class FusionGRUKernel : public framework::OpKernel<T> {
                                       xx_data,
                                       bias ? bias->data<T>() : nullptr);
 
-    int xx_offset = D3;
-    int gate_offset = D;
-    if (is_reverse) {
-      const int offset = (total_T - 1) * D;
-      xx_data = xx_data + offset * 3;
-      hidden_out_data = hidden_out_data + offset;
-      xx_offset = -D3;
-      gate_offset = -D;
+    // The sequences are split into groups of balanced total lengths, which
+    // are computed in parallel. The sequences in one group run their steps
+    // together, so that the hidden GEMVs of one step make one GEMM.
+    const auto& seq_lod = x_lod[0];
+    auto groups = math::PartitionSequencesByLength(
+        seq_lod, platform::GetNumThreads());
+    const int num_groups = groups.size();
+    int max_bs = 0;
+    for (auto& group : groups) {
+      max_bs = std::max(max_bs, static_cast<int>(group.size()));
     }
-    auto move_step = [&]() {
-      xx_data = xx_data + xx_offset;
-      hidden_out_data = hidden_out_data + gate_offset;
-    };
-    for (int i = 0; i < N; ++i) {
-      int bid = is_reverse ? N - 1 - i : i;
-      int seq_len = x_lod[0][bid + 1] - x_lod[0][bid];
-      const T* prev_hidden_data = nullptr;
+    // prev_h, reset_h: [num_groups, max_bs, D],
+    // gemm_out: [num_groups, max_bs, D2], shared by both GEMMs of one step
+    Tensor prev_h, reset_h, gemm_out;
+    T* prev_h_data =
+        prev_h.mutable_data<T>({num_groups * max_bs * D}, platform::CPUPlace());
+    T* reset_h_data = reset_h.mutable_data<T>({num_groups * max_bs * D},
+                                              platform::CPUPlace());
+    T* gemm_out_data = gemm_out.mutable_data<T>({num_groups * max_bs * D2},
+                                                platform::CPUPlace());
+    auto VAddD2 =
+        jit::Get<jit::kVAdd, jit::XYZNTuples<T>, platform::CPUPlace>(D2);
+    auto VAddD =
+        jit::Get<jit::kVAdd, jit::XYZNTuples<T>, platform::CPUPlace>(D);
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(static, 1) if (num_groups > 1)
+#endif
+    for (int g = 0; g < num_groups; ++g) {
+      const std::vector<int>& seqs = groups[g];
+      const int bs = seqs.size();
+      T* cur_prev_h = prev_h_data + g * max_bs * D;
+      T* cur_reset_h = reset_h_data + g * max_bs * D;
+      T* cur_gemm_out = gemm_out_data + g * max_bs * D2;
+      jit::gru_t step_data;
+      auto seq_len = [&](int j) {
+        return static_cast<int>(seq_lod[seqs[j] + 1] - seq_lod[seqs[j]]);
+      };
+      // the row of step t of the j-th sequence
+      auto row = [&](int j, int t) {
+        return static_cast<int>(is_reverse ? seq_lod[seqs[j] + 1] - 1 - t
+                                           : seq_lod[seqs[j]] + t);
+      };
+
       int tstart = 0;
-      if (h0_data) {
-        prev_hidden_data = h0_data + bid * D;
-      } else {
-        one_step.gates = xx_data;
-        one_step.ht = hidden_out_data;
-        ComputeH1(&one_step, &attr);
-        prev_hidden_data = hidden_out_data;
+      for (int j = 0; j < bs; ++j) {
+        if (h0_data) {
+          std::memcpy(cur_prev_h + j * D, h0_data + seqs[j] * D,
+                      sizeof(T) * D);
+        } else {
+          const int r = row(j, 0);
+          step_data.gates = xx_data + r * D3;
+          step_data.ht = hidden_out_data + r * D;
+          ComputeH1(&step_data, &attr);
+          std::memcpy(cur_prev_h + j * D, hidden_out_data + r * D,
+                      sizeof(T) * D);
+        }
+      }
+      if (!h0_data) {
         tstart = 1;
-        move_step();
       }
-      for (int step = tstart; step < seq_len; ++step) {
+
+      int active = bs;
+      for (int t = tstart;; ++t) {
+        while (active > 0 && seq_len(active - 1) <= t) {
+          --active;
+        }
+        if (active == 0) {
+          break;
+        }
         // gemm prev * (Wu + Wr)
-        blas.GEMM(CblasNoTrans, CblasNoTrans, 1, D2, D, static_cast<T>(1),
-                  prev_hidden_data, D, wh_data, D2, static_cast<T>(1), xx_data,
-                  D3);
-        one_step.gates = xx_data;
-        one_step.ht_1 = prev_hidden_data;
-        one_step.ht = hidden_out_data;
-        ComputeHtPart1(&one_step, &attr);
+        blas.GEMM(CblasNoTrans, CblasNoTrans, active, D2, D,
+                  static_cast<T>(1), cur_prev_h, D, wh_data, D2,
+                  static_cast<T>(0), cur_gemm_out, D2);
+        for (int j = 0; j < active; ++j) {
+          T* gates = xx_data + row(j, t) * D3;
+          VAddD2(cur_gemm_out + j * D2, gates, gates, D2);
+          step_data.gates = gates;
+          step_data.ht_1 = cur_prev_h + j * D;
+          step_data.ht = cur_reset_h + j * D;
+          ComputeHtPart1(&step_data, &attr);
+        }
         // gemm rt * Ws
-        blas.GEMM(CblasNoTrans, CblasNoTrans, 1, D, D, static_cast<T>(1),
-                  hidden_out_data, D, wh_state_data, D, static_cast<T>(1),
-                  xx_data + D2, D3);
-        ComputeHtPart2(&one_step, &attr);
-        // save prev
-        prev_hidden_data = hidden_out_data;
-        move_step();
+        blas.GEMM(CblasNoTrans, CblasNoTrans, active, D, D, static_cast<T>(1),
+                  cur_reset_h, D, wh_state_data, D, static_cast<T>(0),
+                  cur_gemm_out, D);
+        for (int j = 0; j < active; ++j) {
+          const int r = row(j, t);
+          T* gates = xx_data + r * D3;
+          VAddD(cur_gemm_out + j * D, gates + D2, gates + D2, D);
+          step_data.gates = gates;
+          step_data.ht_1 = cur_prev_h + j * D;
+          step_data.ht = hidden_out_data + r * D;
+          ComputeHtPart2(&step_data, &attr);
+          // save prev
+          std::memcpy(cur_prev_h + j * D, hidden_out_data + r * D,
+                      sizeof(T) * D);
+        }
       }
     }
   }
@@ -13,11 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/fused/fusion_lstm_op.h"
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <vector>
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/fc_compute.h"
 #include "paddle/fluid/operators/math/sequence2batch.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 
 namespace paddle {
 namespace operators {
@@ -272,7 +276,6 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
     INIT_OTHER_DEFINES;
     auto x_lod = x->lod();
     const int total_T = x_dims[0];
-    const int N = x_lod[0].size() - 1;
     const T* h0_data = h0 ? h0->data<T>() : nullptr;
     const T* c0_data = c0 ? c0->data<T>() : nullptr;
     T* xx_data = xx->mutable_data<T>(place);
@@ -282,53 +285,95 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
     math::FCCompute<DeviceContext, T>(blas, total_T, D4, M, x_data, wx_data,
                                       xx_data, bias->data<T>());
 
-    int xx_offset = D4;
-    int gate_offset = D;
-    if (is_reverse) {
-      const int offset = (total_T - 1) * D;
-      xx_data = xx_data + offset * 4;
-      h_out_data = h_out_data + offset;
-      c_out_data = c_out_data + offset;
-      xx_offset = -D4;
-      gate_offset = -D;
+    // The sequences are split into groups of balanced total lengths, which
+    // are computed in parallel. The sequences in one group run their steps
+    // together, so that the hidden GEMVs of one step make one GEMM.
+    const auto& seq_lod = x_lod[0];
+    auto groups = math::PartitionSequencesByLength(
+        seq_lod, platform::GetNumThreads());
+    const int num_groups = groups.size();
+    int max_bs = 0;
+    for (auto& group : groups) {
+      max_bs = std::max(max_bs, static_cast<int>(group.size()));
     }
+    // prev_h: [num_groups, max_bs, D], gemm_out: [num_groups, max_bs, D4]
+    Tensor prev_h, gemm_out, checked;
+    T* prev_h_data =
+        prev_h.mutable_data<T>({num_groups * max_bs * D}, platform::CPUPlace());
+    T* gemm_out_data = gemm_out.mutable_data<T>({num_groups * max_bs * D4},
+                                                platform::CPUPlace());
+    T* checked_data = nullptr;
+    if (use_peepholes) {
+      // the peephole kernels use it as the temporary buffer
+      checked_data =
+          checked.mutable_data<T>({num_groups * 2 * D}, platform::CPUPlace());
+    }
+    auto VAdd =
+        jit::Get<jit::kVAdd, jit::XYZNTuples<T>, platform::CPUPlace>(D4);
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(static, 1) if (num_groups > 1)
+#endif
+    for (int g = 0; g < num_groups; ++g) {
+      const std::vector<int>& seqs = groups[g];
+      const int bs = seqs.size();
+      T* cur_prev_h = prev_h_data + g * max_bs * D;
+      T* cur_gemm_out = gemm_out_data + g * max_bs * D4;
+      std::vector<const T*> prev_c(bs);
+      jit::lstm_t step_data = one_step;
+      step_data.checked = use_peepholes ? checked_data + g * 2 * D : nullptr;
+      auto seq_len = [&](int j) {
+        return static_cast<int>(seq_lod[seqs[j] + 1] - seq_lod[seqs[j]]);
+      };
+      // the row of step t of the j-th sequence
+      auto row = [&](int j, int t) {
+        return static_cast<int>(is_reverse ? seq_lod[seqs[j] + 1] - 1 - t
+                                           : seq_lod[seqs[j]] + t);
+      };
 
-    for (int i = 0; i < N; ++i) {
-      int bid = is_reverse ? N - 1 - i : i;
-      int seq_len = x_lod[0][bid + 1] - x_lod[0][bid];
-      const T* prev_c_data = nullptr;
-      const T* prev_h_data = nullptr;
       int tstart = 0;
-      if (h0_data) {
-        prev_h_data = h0_data + bid * D;
-        prev_c_data = c0_data + bid * D;
-      } else {
-        one_step.gates = xx_data;
-        one_step.ct = c_out_data;
-        one_step.ht = h_out_data;
-        ComputeC1H1(&one_step, &attr);
+      for (int j = 0; j < bs; ++j) {
+        if (h0_data) {
+          std::memcpy(cur_prev_h + j * D, h0_data + seqs[j] * D,
+                      sizeof(T) * D);
+          prev_c[j] = c0_data + seqs[j] * D;
+        } else {
+          const int r = row(j, 0);
+          step_data.gates = xx_data + r * D4;
+          step_data.ct = c_out_data + r * D;
+          step_data.ht = h_out_data + r * D;
+          ComputeC1H1(&step_data, &attr);
+          std::memcpy(cur_prev_h + j * D, h_out_data + r * D, sizeof(T) * D);
+          prev_c[j] = c_out_data + r * D;
+        }
+      }
+      if (!h0_data) {
         tstart = 1;
-        // move one step
-        prev_h_data = h_out_data;
-        prev_c_data = c_out_data;
-        xx_data = xx_data + xx_offset;
-        h_out_data = h_out_data + gate_offset;
-        c_out_data = c_out_data + gate_offset;
       }
-      for (int step = tstart; step < seq_len; ++step) {
-        GEMM_WH_ADDON(1, prev_h_data, xx_data);
 
-        one_step.gates = xx_data;
-        one_step.ct_1 = prev_c_data;
-        one_step.ct = c_out_data;
-        one_step.ht = h_out_data;
-        ComputeCtHt(&one_step, &attr);
-        // move one step
-        prev_h_data = h_out_data;
-        prev_c_data = c_out_data;
-        xx_data = xx_data + xx_offset;
-        h_out_data = h_out_data + gate_offset;
-        c_out_data = c_out_data + gate_offset;
+      int active = bs;
+      for (int t = tstart;; ++t) {
+        while (active > 0 && seq_len(active - 1) <= t) {
+          --active;
+        }
+        if (active == 0) {
+          break;
+        }
+        blas.GEMM(CblasNoTrans, CblasNoTrans, active, D4, D,
+                  static_cast<T>(1), cur_prev_h, D, wh_data, D4,
+                  static_cast<T>(0), cur_gemm_out, D4);
+        for (int j = 0; j < active; ++j) {
+          const int r = row(j, t);
+          T* gates = xx_data + r * D4;
+          VAdd(cur_gemm_out + j * D4, gates, gates, D4);
+          step_data.gates = gates;
+          step_data.ct_1 = prev_c[j];
+          step_data.ct = c_out_data + r * D;
+          step_data.ht = h_out_data + r * D;
+          ComputeCtHt(&step_data, &attr);
+          std::memcpy(cur_prev_h + j * D, h_out_data + r * D, sizeof(T) * D);
+          prev_c[j] = c_out_data + r * D;
+        }
       }
     }
   }
@@ -450,9 +495,8 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
 
     math::Batch2LoDTensorFunctor<DeviceContext, T> to_seq;
     batched_h_out->set_lod(batched_lod);
-    to_seq(dev_ctx, *batched_h_out, hidden_out);
     batched_c_out->set_lod(batched_lod);
-    to_seq(dev_ctx, *batched_c_out, cell_out);
+    to_seq(dev_ctx, {batched_h_out, batched_c_out}, {hidden_out, cell_out});
   }
 
   void Compute(const framework::ExecutionContext& ctx) const override {
@@ -0,0 +1,123 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <random>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+
+USE_CPU_ONLY_OP(fusion_lstm);
+USE_CPU_ONLY_OP(fusion_gru);
+
+namespace paddle {
+namespace operators {
+
+using framework::LoDTensor;
+
+static void RandomTensor(framework::Scope* scope, const std::string& name,
+                         const framework::DDim& dims, std::mt19937* engine,
+                         const framework::LoD& lod = {}) {
+  std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize(dims);
+  tensor->set_lod(lod);
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = dist(*engine);
+  }
+}
+
+// Runs the op in seq mode with the given number of threads, and returns the
+// outputs.
+static std::vector<std::vector<float>> RunSeqMode(
+    const std::string& type, int gates, bool use_peepholes, int num_threads,
+    const std::vector<std::string>& outputs) {
+  // sequences of various lengths, more than the threads
+  const framework::LoD lod = {{0, 1, 8, 11, 23, 28, 30, 39, 43, 58}};
+  const int total = lod[0].back();
+  const int M = 6;
+  const int D = 5;
+  std::mt19937 engine(0);
+  framework::Scope scope;
+  RandomTensor(&scope, "x", {total, M}, &engine, lod);
+  RandomTensor(&scope, "wx", {M, gates * D}, &engine);
+  RandomTensor(&scope, "wh", {D, gates * D}, &engine);
+  RandomTensor(&scope, "bias", {1, (use_peepholes ? 7 : gates) * D}, &engine);
+
+  framework::VariableNameMap out_names;
+  for (auto& output : outputs) {
+    out_names[output] = {output};
+  }
+  out_names["XX"] = {"XX"};
+  if (use_peepholes) {
+    out_names["CheckedCell"] = {"CheckedCell"};
+  }
+  framework::AttributeMap attrs;
+  attrs["use_seq"] = true;
+  if (type == "fusion_lstm") {
+    attrs["use_peepholes"] = use_peepholes;
+  }
+  auto op = framework::OpRegistry::CreateOp(
+      type,
+      {{"X", {"x"}}, {"WeightX", {"wx"}}, {"WeightH", {"wh"}},
+       {"Bias", {"bias"}}},
+      out_names, attrs);
+
+  platform::SetNumThreads(num_threads);
+  op->Run(scope, platform::CPUPlace());
+  platform::SetNumThreads(1);
+
+  std::vector<std::vector<float>> results;
+  for (auto& output : outputs) {
+    auto& tensor = scope.FindVar(output)->Get<LoDTensor>();
+    EXPECT_EQ(tensor.dims()[0], total);
+    const float* data = tensor.data<float>();
+    results.emplace_back(data, data + tensor.numel());
+  }
+  return results;
+}
+
+// The sequences are split into one group per thread, so the results of
+// several threads are compared with the results of one thread, which runs
+// all the sequences in one group. Without OpenMP both run in one group.
+static void CheckSeqParallel(const std::string& type, int gates,
+                             bool use_peepholes,
+                             const std::vector<std::string>& outputs) {
+  auto serial = RunSeqMode(type, gates, use_peepholes, 1, outputs);
+  auto parallel = RunSeqMode(type, gates, use_peepholes, 4, outputs);
+  ASSERT_EQ(serial.size(), parallel.size());
+  for (size_t i = 0; i < serial.size(); ++i) {
+    ASSERT_EQ(serial[i].size(), parallel[i].size());
+    for (size_t j = 0; j < serial[i].size(); ++j) {
+      EXPECT_NEAR(serial[i][j], parallel[i][j], 1e-5) << outputs[i] << " " << j;
+    }
+  }
+}
+
+TEST(FusionLSTMOp, SeqParallel) {
+  CheckSeqParallel("fusion_lstm", 4, false, {"Hidden", "Cell"});
+}
+
+TEST(FusionLSTMOp, SeqParallelPeepholes) {
+  CheckSeqParallel("fusion_lstm", 4, true, {"Hidden", "Cell"});
+}
+
+TEST(FusionGRUOp, SeqParallel) {
+  CheckSeqParallel("fusion_gru", 3, false, {"Hidden"});
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,214 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/fused/multihead_attention_op.h"
+#include <algorithm>
+#include <string>
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+
+namespace paddle {
+namespace operators {
+
+void MultiheadAttentionOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInput("X"),
+                 "Input(X) of MultiheadAttentionOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInput("W"),
+                 "Input(W) of MultiheadAttentionOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                 "Output(Out) of MultiheadAttentionOp should not be null.");
+
+  auto x_dims = ctx->GetInputDim("X");
+  auto w_dims = ctx->GetInputDim("W");
+  PADDLE_ENFORCE_EQ(x_dims.size(), 3,
+                    "Input(X) should be [batch_size, seq_len, hidden].");
+  PADDLE_ENFORCE_EQ(w_dims.size(), 2, "Input(W) should be a 2-D tensor.");
+  PADDLE_ENFORCE_EQ(x_dims[2], w_dims[0],
+                    "The width of Input(X) should be the height of Input(W).");
+  int head_number = ctx->Attrs().Get<int>("head_number");
+  PADDLE_ENFORCE_GT(head_number, 0, "Attr(head_number) should be positive.");
+  PADDLE_ENFORCE_EQ(w_dims[1] % (3 * head_number), 0,
+                    "The width of Input(W) should be 3 * head_number * "
+                    "head_size.");
+  const int64_t hidden = w_dims[1] / 3;
+  if (ctx->HasInput("Bias")) {
+    PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("Bias")),
+                      w_dims[1],
+                      "The size of Input(Bias) should be the width of W.");
+  }
+  if (ctx->HasInput("BiasQK") && ctx->IsRuntime()) {
+    // [batch_size, head_number, seq_len, seq_len], or shared by the heads
+    auto qk_numel = framework::product(ctx->GetInputDim("BiasQK"));
+    auto scores_numel = x_dims[0] * x_dims[1] * x_dims[1];
+    PADDLE_ENFORCE(qk_numel == scores_numel ||
+                       qk_numel == scores_numel * head_number,
+                   "Input(BiasQK) should be [batch_size, head_number, "
+                   "seq_len, seq_len] or [batch_size, seq_len, seq_len].");
+  }
+  ctx->SetOutputDim("Out", {x_dims[0], x_dims[1], hidden});
+  ctx->ShareLoD("X", /*->*/ "Out");
+}
+
+framework::OpKernelType MultiheadAttentionOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(framework::GetDataTypeOfVar(ctx.InputVar("X")),
+                                 ctx.GetPlace());
+}
+
+void MultiheadAttentionOpMaker::Make() {
+  AddInput("X", "(LoDTensor) The input of shape [batch_size, seq_len, in].");
+  AddInput("W",
+           "(Tensor) The weights of the query, key and value projections "
+           "concatenated along the width, of shape [in, 3 * hidden].");
+  AddInput("Bias",
+           "(Tensor) The biases of the query, key and value projections "
+           "concatenated, of size 3 * hidden.")
+      .AsDispensable();
+  AddInput("BiasQK",
+           "(Tensor) Added to the attention scores before softmax, of shape "
+           "[batch_size, head_number, seq_len, seq_len] or [batch_size, "
+           "seq_len, seq_len].")
+      .AsDispensable();
+  AddOutput("Out",
+            "(LoDTensor) The attention output of shape [batch_size, seq_len, "
+            "hidden], the heads are concatenated along the last dim.");
+  AddAttr<int>("head_number", "The number of the heads.");
+  AddAttr<float>("alpha", "The scale of the scores QK^T.").SetDefault(1.0f);
+  AddComment(R"DOC(
+  Multihead Attention Operator.
+
+  Fuses the query, key and value projections, the split of the heads, the
+  scaled dot product attention and the combination of the heads:
+  $$[Q, K, V] = X * W + Bias$$
+  $$Out_h = softmax(alpha * Q_h * K_h^T + BiasQK_h) * V_h$$
+  The heads are read and written in place, no transposed copy is made.
+)DOC");
+}
+
+template <typename T>
+class MultiheadAttentionKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    using DeviceContext = paddle::platform::CPUDeviceContext;
+    auto* x = ctx.Input<LoDTensor>("X");
+    auto* w = ctx.Input<Tensor>("W");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* bias_qk = ctx.Input<Tensor>("BiasQK");
+    auto* out = ctx.Output<LoDTensor>("Out");
+    const int head_number = ctx.Attr<int>("head_number");
+    const T alpha = static_cast<T>(ctx.Attr<float>("alpha"));
+
+    auto x_dims = x->dims();
+    const int batch_size = x_dims[0];
+    const int seq_len = x_dims[1];
+    const int in_width = x_dims[2];
+    const int qkv_width = w->dims()[1];
+    const int hidden = qkv_width / 3;
+    const int head_size = hidden / head_number;
+
+    // qkv: [batch_size * seq_len, 3 * hidden], one row is [q, k, v]
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
+    Tensor qkv;
+    T* qkv_data = qkv.mutable_data<T>({batch_size * seq_len, qkv_width},
+                                      platform::CPUPlace());
+    blas.MatMul(batch_size * seq_len, qkv_width, in_width, x->data<T>(),
+                w->data<T>(), qkv_data);
+    if (bias) {
+      auto VAddQKV = jit::Get<jit::kVAdd, jit::XYZNTuples<T>,
+                              platform::CPUPlace>(qkv_width);
+      const T* bias_data = bias->data<T>();
+      for (int i = 0; i < batch_size * seq_len; ++i) {
+        T* row = qkv_data + i * qkv_width;
+        VAddQKV(bias_data, row, row, qkv_width);
+      }
+    }
+
+    const T* bias_qk_data = bias_qk ? bias_qk->data<T>() : nullptr;
+    const int64_t scores_size = static_cast<int64_t>(seq_len) * seq_len;
+    const bool bias_qk_per_head =
+        bias_qk && bias_qk->numel() == batch_size * head_number * scores_size;
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+
+    // The queries of every head are split into blocks of rows, so that the
+    // scores of one block stay in the cache from QK^T through softmax to AV.
+    constexpr int kBlockRows = 32;
+    const int num_blocks = (seq_len + kBlockRows - 1) / kBlockRows;
+    const int num_tasks = batch_size * head_number * num_blocks;
+    const int num_threads = std::min(platform::GetNumThreads(), num_tasks);
+    Tensor scores;
+    T* scores_data = scores.mutable_data<T>(
+        {num_threads, kBlockRows, seq_len}, platform::CPUPlace());
+    auto VAddScores =
+        jit::Get<jit::kVAdd, jit::XYZNTuples<T>, platform::CPUPlace>(seq_len);
+    auto Softmax = jit::Get<jit::kSoftmax, jit::SoftmaxTuples<T>,
+                            platform::CPUPlace>(seq_len);
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(static, 1) if (num_threads > 1)
+#endif
+    for (int tid = 0; tid < num_threads; ++tid) {
+      T* cur_scores = scores_data + tid * kBlockRows * seq_len;
+      for (int task = tid; task < num_tasks; task += num_threads) {
+        const int blk = task % num_blocks;
+        const int h = task / num_blocks % head_number;
+        const int b = task / num_blocks / head_number;
+        const int row_start = blk * kBlockRows;
+        const int rows = std::min(kBlockRows, seq_len - row_start);
+
+        const T* q = qkv_data +
+                     (b * seq_len + row_start) * qkv_width + h * head_size;
+        const T* k = qkv_data + b * seq_len * qkv_width + hidden +
+                     h * head_size;
+        const T* v = qkv_data + b * seq_len * qkv_width + 2 * hidden +
+                     h * head_size;
+        // scores = alpha * Q * K^T
+        blas.GEMM(CblasNoTrans, CblasTrans, rows, seq_len, head_size, alpha, q,
+                  qkv_width, k, qkv_width, static_cast<T>(0), cur_scores,
+                  seq_len);
+        if (bias_qk_data) {
+          const T* cur_bias =
+              bias_qk_data +
+              (bias_qk_per_head ? b * head_number + h : b) * scores_size +
+              row_start * seq_len;
+          for (int i = 0; i < rows; ++i) {
+            T* row = cur_scores + i * seq_len;
+            VAddScores(cur_bias + i * seq_len, row, row, seq_len);
+          }
+        }
+        Softmax(cur_scores, cur_scores, seq_len, rows);
+        // out = scores * V, written to the columns of the head
+        T* cur_out =
+            out_data + (b * seq_len + row_start) * hidden + h * head_size;
+        blas.GEMM(CblasNoTrans, CblasNoTrans, rows, head_size, seq_len,
+                  static_cast<T>(1), cur_scores, seq_len, v, qkv_width,
+                  static_cast<T>(0), cur_out, hidden);
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(multihead_attention, ops::MultiheadAttentionOp,
+                  ops::MultiheadAttentionOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+
+REGISTER_OP_CPU_KERNEL(multihead_attention,
+                       ops::MultiheadAttentionKernel<float>,
+                       ops::MultiheadAttentionKernel<double>);
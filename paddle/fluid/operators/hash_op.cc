@@ -57,6 +57,12 @@ $$Out = scale * X$$
 )DOC");
     AddAttr<int>("num_hash", "").SetDefault(1);
     AddAttr<int>("mod_by", "").SetDefault(100000);
+    AddAttr<bool>("hash_full_row",
+                  "(bool, default false) Whether to hash all the bytes of "
+                  "every row. By default sizeof(int) * last_dim bytes are "
+                  "hashed, which is only the first half of an int64 row, "
+                  "to keep the hash values of the existing models.")
+        .SetDefault(false);
   }
 };
 
@@ -14,9 +14,9 @@ limitations under the License. */
 
 #pragma once
 
-extern "C" {
-#include <xxhash.h>
-}
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
@@ -37,6 +37,216 @@ inline void HashOutputSize(const framework::DDim& in_dims,
   out_dims.emplace_back(1);
 }
 
+namespace hash {
+
+// The primes and the rounds of XXH64, see
+// https://github.com/Cyan4973/xxHash/tree/v0.6.5
+constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+inline uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t Round(uint64_t acc, uint64_t input) {
+  acc += input * kPrime2;
+  return Rotl(acc, 31) * kPrime1;
+}
+
+inline uint64_t MergeRound(uint64_t acc, uint64_t val) {
+  acc ^= Round(0, val);
+  return acc * kPrime1 + kPrime4;
+}
+
+inline uint64_t Avalanche(uint64_t h) {
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+
+// xxHash reads the input in little endian, as the CPUs supported do.
+inline uint64_t Read64(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t Read32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Computes a % d without division, see "Faster Remainder by Direct
+// Computation" by Lemire et al. It is exact for any 64-bit a when d < 2^32.
+class FastMod {
+ public:
+  explicit FastMod(uint64_t d) : d_(d) {
+#ifdef __SIZEOF_INT128__
+    m_ = ~static_cast<unsigned __int128>(0) / d + 1;
+#endif
+  }
+
+  uint64_t operator()(uint64_t a) const {
+#ifdef __SIZEOF_INT128__
+    // (m * a mod 2^128) * d / 2^128
+    unsigned __int128 low = m_ * a;
+    unsigned __int128 d = d_;
+    unsigned __int128 lo = static_cast<uint64_t>(low) * d;
+    unsigned __int128 hi = static_cast<uint64_t>(low >> 64) * d + (lo >> 64);
+    return static_cast<uint64_t>(hi >> 64);
+#else
+    return a % d_;
+#endif
+  }
+
+ private:
+  uint64_t d_;
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 m_;
+#endif
+};
+
+// The rows hashed together. The hashes of the rows are independent, so the
+// loops over the rows of a block can be vectorized.
+constexpr int kBlockRows = 16;
+
+// The seed of XXH64 only initializes the accumulators, so the rounds of the
+// input lanes in the tail, which is all of a row shorter than 32 bytes, are
+// computed once and shared by all the seeds. The first row_bytes of every
+// row_stride bytes are hashed.
+template <typename OutT>
+void HashShortRows(const uint8_t* input, int64_t rows, size_t row_stride,
+                   size_t row_bytes, int num_hash, const FastMod& mod,
+                   OutT* output) {
+  const size_t num_lanes = row_bytes / 8;
+  const bool has_word = row_bytes % 8 >= 4;
+  const size_t num_bytes = row_bytes % 4;
+  uint64_t lanes[3][kBlockRows];
+  uint64_t word[kBlockRows];
+  uint64_t h[kBlockRows];
+  for (int64_t begin = 0; begin < rows; begin += kBlockRows) {
+    const int n = static_cast<int>(std::min<int64_t>(kBlockRows, rows - begin));
+    const uint8_t* block = input + begin * row_stride;
+    for (size_t l = 0; l < num_lanes; ++l) {
+      for (int r = 0; r < n; ++r) {
+        lanes[l][r] = Round(0, Read64(block + r * row_stride + l * 8));
+      }
+    }
+    if (has_word) {
+      for (int r = 0; r < n; ++r) {
+        word[r] = Read32(block + r * row_stride + num_lanes * 8) * kPrime1;
+      }
+    }
+    for (int seed = 0; seed < num_hash; ++seed) {
+      for (int r = 0; r < n; ++r) {
+        h[r] = seed + kPrime5 + row_bytes;
+      }
+      for (size_t l = 0; l < num_lanes; ++l) {
+        for (int r = 0; r < n; ++r) {
+          h[r] = Rotl(h[r] ^ lanes[l][r], 27) * kPrime1 + kPrime4;
+        }
+      }
+      if (has_word) {
+        for (int r = 0; r < n; ++r) {
+          h[r] = Rotl(h[r] ^ word[r], 23) * kPrime2 + kPrime3;
+        }
+      }
+      for (size_t b = row_bytes - num_bytes; b < row_bytes; ++b) {
+        for (int r = 0; r < n; ++r) {
+          h[r] = Rotl(h[r] ^ (block[r * row_stride + b] * kPrime5), 11) *
+                 kPrime1;
+        }
+      }
+      OutT* out = output + begin * num_hash + seed;
+      for (int r = 0; r < n; ++r) {
+        out[r * num_hash] = static_cast<OutT>(mod(Avalanche(h[r])));
+      }
+    }
+  }
+}
+
+// Every 32-byte stripe of the row is loaded once for all the seeds.
+template <typename OutT>
+void HashLongRow(const uint8_t* row, size_t row_bytes, int num_hash,
+                 const FastMod& mod, OutT* output) {
+  constexpr int kMaxSeeds = 16;
+  uint64_t v[kMaxSeeds][4];
+  const size_t num_stripes = row_bytes / 32;
+  for (int begin = 0; begin < num_hash; begin += kMaxSeeds) {
+    const int n = std::min(kMaxSeeds, num_hash - begin);
+    for (int s = 0; s < n; ++s) {
+      uint64_t seed = begin + s;
+      v[s][0] = seed + kPrime1 + kPrime2;
+      v[s][1] = seed + kPrime2;
+      v[s][2] = seed;
+      v[s][3] = seed - kPrime1;
+    }
+    for (size_t i = 0; i < num_stripes; ++i) {
+      const uint8_t* p = row + i * 32;
+      const uint64_t in[4] = {Read64(p), Read64(p + 8), Read64(p + 16),
+                              Read64(p + 24)};
+      for (int s = 0; s < n; ++s) {
+        for (int j = 0; j < 4; ++j) {
+          v[s][j] = Round(v[s][j], in[j]);
+        }
+      }
+    }
+    for (int s = 0; s < n; ++s) {
+      uint64_t h = Rotl(v[s][0], 1) + Rotl(v[s][1], 7) + Rotl(v[s][2], 12) +
+                   Rotl(v[s][3], 18);
+      for (int j = 0; j < 4; ++j) {
+        h = MergeRound(h, v[s][j]);
+      }
+      h += row_bytes;
+      const uint8_t* p = row + num_stripes * 32;
+      const uint8_t* end = row + row_bytes;
+      for (; p + 8 <= end; p += 8) {
+        h = Rotl(h ^ Round(0, Read64(p)), 27) * kPrime1 + kPrime4;
+      }
+      if (p + 4 <= end) {
+        h = Rotl(h ^ (Read32(p) * kPrime1), 23) * kPrime2 + kPrime3;
+        p += 4;
+      }
+      for (; p < end; ++p) {
+        h = Rotl(h ^ (*p * kPrime5), 11) * kPrime1;
+      }
+      output[begin + s] = static_cast<OutT>(mod(Avalanche(h)));
+    }
+  }
+}
+
+}  // namespace hash
+
+// Hashes every row of `last_dim` elements with the seeds 0 to num_hash - 1,
+// i.e. output[i * num_hash + j] = XXH64(row i, row bytes, j) % mod_by.
+// The row bytes are sizeof(T) * last_dim if hash_full_row, otherwise
+// sizeof(int) * last_dim as hash_op always did, which is only the first half
+// of an int64 row.
+template <typename T, typename OutT>
+void MultiHash(const T* input, int64_t rows, int64_t last_dim, int num_hash,
+               int mod_by, bool hash_full_row, OutT* output) {
+  PADDLE_ENFORCE_GT(mod_by, 0, "mod_by of the hash must be positive");
+  const hash::FastMod mod(mod_by);
+  const auto* bytes = reinterpret_cast<const uint8_t*>(input);
+  const size_t row_stride = sizeof(T) * last_dim;
+  const size_t row_bytes =
+      hash_full_row ? row_stride : std::min(sizeof(int), sizeof(T)) * last_dim;
+  if (row_bytes < 32) {
+    hash::HashShortRows(bytes, rows, row_stride, row_bytes, num_hash, mod,
+                        output);
+  } else {
+    for (int64_t i = 0; i < rows; ++i) {
+      hash::HashLongRow(bytes + i * row_stride, row_bytes, num_hash, mod,
+                        output + i * num_hash);
+    }
+  }
+}
+
 template <typename T>
 class HashKernel : public framework::OpKernel<T> {
  public:
@@ -45,6 +255,7 @@ class HashKernel : public framework::OpKernel<T> {
     auto* in_t = context.Input<framework::LoDTensor>("X");
     int mod_by = context.Attr<int>("mod_by");
     int num_hash = context.Attr<int>("num_hash");
+    bool hash_full_row = context.Attr<bool>("hash_full_row");
 
     auto in_dims = in_t->dims();
     auto in_lod = in_t->lod();
@@ -59,14 +270,8 @@ class HashKernel : public framework::OpKernel<T> {
 
     auto seq_length = in_dims[0];
     auto last_dim = in_dims[in_dims.size() - 1];
-    auto* input = in_t->data<T>();
-    for (int idx = 0; idx < seq_length; ++idx) {
-      for (int ihash = 0; ihash != num_hash; ++ihash) {
-        output[idx * num_hash + ihash] =
-            XXH64(input, sizeof(int) * last_dim, ihash) % mod_by;
-      }
-      input += last_dim;
-    }
+    MultiHash(in_t->data<T>(), seq_length, last_dim, num_hash, mod_by,
+              hash_full_row, output);
     out_t->set_lod(in_t->lod());
   }
 };
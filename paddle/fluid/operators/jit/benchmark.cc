@@ -301,6 +301,26 @@ void BenchSeqPoolKernel() {
   }
 }
 
+template <jit::KernelType KT, typename T, typename PlaceType>
+void BenchMaxSeqPoolKernel() {
+  for (int w : TestSizes()) {
+    jit::seq_pool_attr_t attr(w, jit::SeqPoolType::kMax);
+    for (int h : TestSizes()) {
+      attr.h = h;
+      Tensor x, y, index;
+      x.Resize({h * w});
+      y.Resize({w});
+      index.Resize({w});
+      RandomVec<T>(h * w, x.mutable_data<T>(PlaceType()), -2.f, 2.f);
+      const T* x_data = x.data<T>();
+      T* y_data = y.mutable_data<T>(PlaceType());
+      int* index_data = index.mutable_data<int>(PlaceType());
+      BenchAllImpls<KT, jit::MaxSeqPoolTuples<T>, PlaceType>(
+          attr, x_data, y_data, index_data, &attr);
+    }
+  }
+}
+
 template <jit::KernelType KT, typename T, typename PlaceType>
 void BenchEmbSeqPoolKernel() {
   std::vector<jit::SeqPoolType> pool_types = {jit::SeqPoolType::kSum};
@@ -393,6 +413,36 @@ void BenchMatMulKernel() {
   }
 }
 
+template <jit::KernelType KT, typename PlaceType>
+void BenchMatMulInt8Kernel() {
+  for (int m : {1, 16, 64}) {
+    for (int n : {16, 128, 512}) {
+      for (int k : {64, 256, 1024}) {
+        Tensor a, b, c, scale, bias;
+        a.Resize({m * k});
+        b.Resize({static_cast<int64_t>(jit::packed_weights_int8_size(n, k))});
+        c.Resize({m * n});
+        scale.Resize({n});
+        bias.Resize({n});
+        RandomVec<uint8_t>(m * k, a.mutable_data<uint8_t>(PlaceType()), 0, 255);
+        RandomVec<int8_t>(b.numel(), b.mutable_data<int8_t>(PlaceType()), -127,
+                          127);
+        RandomVec<float>(n, scale.mutable_data<float>(PlaceType()), 0.f, 1e-3f);
+        RandomVec<float>(n, bias.mutable_data<float>(PlaceType()), -2.f, 2.f);
+        const uint8_t* a_data = a.data<uint8_t>();
+        const int8_t* b_data = b.data<int8_t>();
+        const float* scale_data = scale.data<float>();
+        const float* bias_data = bias.data<float>();
+        float* c_data = c.mutable_data<float>(PlaceType());
+        const jit::matmul_int8_attr_t attr(m, n, k, true, true, false);
+        BenchAllImpls<KT, jit::MatMulInt8Tuples, PlaceType>(
+            attr, a_data, b_data, static_cast<void*>(c_data), scale_data,
+            bias_data, &attr);
+      }
+    }
+  }
+}
+
 template <jit::KernelType KT, typename T, typename PlaceType>
 void BenchSoftmaxKernel() {
   for (int bs : {1, 2, 10}) {
@@ -511,6 +561,10 @@ BENCH_FP32_CPU(kGRUHtPart2) { BenchGRUKernel<jit::kGRUHtPart2, T, CPUPlace>(); }
 // seq pool function
 BENCH_FP32_CPU(kSeqPool) { BenchSeqPoolKernel<jit::kSeqPool, T, CPUPlace>(); }
 
+BENCH_FP32_CPU(kMaxSeqPool) {
+  BenchMaxSeqPoolKernel<jit::kMaxSeqPool, T, CPUPlace>();
+}
+
 // embedding seq pool function
 BENCH_FP32_CPU(kEmbSeqPool) {
   BenchEmbSeqPoolKernel<jit::kEmbSeqPool, T, CPUPlace>();
@@ -522,6 +576,11 @@ BENCH_FP32_CPU(kSgd) { BenchSgdKernel<jit::kSgd, T, CPUPlace>(); }
 // matmul
 BENCH_FP32_CPU(kMatMul) { BenchMatMulKernel<jit::kMatMul, T, CPUPlace>(); }
 
+// int8 matmul
+BENCH_JITKERNEL(kMatMulInt8, INT8, CPU) {
+  BenchMatMulInt8Kernel<jit::kMatMulInt8, CPUPlace>();
+}
+
 // softmax
 BENCH_FP32_CPU(kSoftmax) { BenchSoftmaxKernel<jit::kSoftmax, T, CPUPlace>(); }
 
@@ -0,0 +1,168 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/jit/gen/elementwise_chain.h"
+#include <stddef.h>  // offsetof
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+template <typename JMM>
+void ElementwiseChainJitCode::ApplyOps(JMM& x, JMM& y,  // NOLINT
+                                       const Xbyak::Reg64* reg_ys,
+                                       bool scalar) {
+  int k = 0;
+  for (int i = 0; i < attr_.num_ops; ++i) {
+    const ChainOpType op = attr_.ops[i];
+    if (elementwise_chain_attr_t::IsBinary(op)) {
+      if (scalar) {
+        vmovss(xmm_t(y.getIdx()), ptr[reg_ys[k]]);
+      } else {
+        vmovups(y, ptr[reg_ys[k]]);
+      }
+      ++k;
+    }
+    switch (op) {
+      case kChainAdd:
+        vaddps(x, x, y);
+        break;
+      case kChainSub:
+        vsubps(x, x, y);
+        break;
+      case kChainRSub:
+        vsubps(x, y, x);
+        break;
+      case kChainMul:
+        vmulps(x, x, y);
+        break;
+      case kChainDiv:
+        vdivps(x, x, y);
+        break;
+      case kChainRDiv:
+        vdivps(x, y, x);
+        break;
+      case kChainMax:
+        vmaxps(x, x, y);
+        break;
+      case kChainMin:
+        vminps(x, x, y);
+        break;
+      case kChainScale:
+        vbroadcastss(y, ptr[param_attr + offsetof(elementwise_chain_attr_t,
+                                                  scales) +
+                            i * sizeof(float)]);
+        vmulps(x, x, y);
+        vbroadcastss(y, ptr[param_attr + offsetof(elementwise_chain_attr_t,
+                                                  biases) +
+                            i * sizeof(float)]);
+        vaddps(x, x, y);
+        break;
+      case kChainRelu:
+        act<JMM>(x, x, operand_type::RELU);
+        break;
+      case kChainSigmoid:
+        act<JMM>(x, x, operand_type::SIGMOID);
+        break;
+      case kChainTanh:
+        act<JMM>(x, x, operand_type::TANH);
+        break;
+      case kChainExp:
+        act<JMM>(x, x, operand_type::EXP);
+        break;
+      case kChainSquare:
+        act<JMM>(x, x, operand_type::SQUARE);
+        break;
+      default:
+        LOG(FATAL) << "Do not support this op of chain: " << op;
+        break;
+    }
+  }
+}
+
+void ElementwiseChainJitCode::genCode() {
+  preCode();
+  const Xbyak::Reg64 reg_ys[kMaxChainInputs] = {r9,  r10, r11, rbx,
+                                                r12, r13, r14, r15};
+  const int num_inputs = attr_.num_inputs();
+  for (int k = 0; k < num_inputs; ++k) {
+    mov(reg_ys[k], ptr[param_ys + k * sizeof(void*)]);
+  }
+  movsxd(param_n, param_n.cvt32());
+
+  constexpr size_t block_size = sizeof(float) * YMM_FLOAT_BLOCK;
+  Label l_block, l_tail, l_end;
+  L(l_block);
+  {
+    cmp(param_n, YMM_FLOAT_BLOCK);
+    jl(l_tail, T_NEAR);
+    vmovups(ymm_x, ptr[param_x]);
+    ApplyOps<ymm_t>(ymm_x, ymm_y, reg_ys, false);
+    vmovups(ptr[param_z], ymm_x);
+    add(param_x, block_size);
+    add(param_z, block_size);
+    for (int k = 0; k < num_inputs; ++k) {
+      add(reg_ys[k], block_size);
+    }
+    sub(param_n, YMM_FLOAT_BLOCK);
+    jmp(l_block, T_NEAR);
+  }
+  L(l_tail);
+  {
+    cmp(param_n, 0);
+    jle(l_end, T_NEAR);
+    vmovss(xmm_x, ptr[param_x]);
+    ApplyOps<xmm_t>(xmm_x, xmm_y, reg_ys, true);
+    vmovss(ptr[param_z], xmm_x);
+    add(param_x, sizeof(float));
+    add(param_z, sizeof(float));
+    for (int k = 0; k < num_inputs; ++k) {
+      add(reg_ys[k], sizeof(float));
+    }
+    sub(param_n, 1);
+    jmp(l_tail, T_NEAR);
+  }
+  L(l_end);
+  postCode();
+}
+
+class ElementwiseChainCreator
+    : public JitCodeCreator<elementwise_chain_attr_t> {
+ public:
+  bool UseMe(const elementwise_chain_attr_t& attr) const override {
+    return platform::MayIUse(platform::avx) && attr.num_ops > 0;
+  }
+  size_t CodeSize(const elementwise_chain_attr_t& attr) const override {
+    // the block and the tail, the activations take at most 90 instructions
+    return 256 + 2 * (attr.num_ops * 90 + kMaxChainInputs + 16) * 8;
+  }
+  std::unique_ptr<GenBase> CreateJitCode(
+      const elementwise_chain_attr_t& attr) const override {
+    PADDLE_ENFORCE_LE(attr.num_ops, kMaxChainOps);
+    PADDLE_ENFORCE_LE(attr.num_inputs(), kMaxChainInputs);
+    return make_unique<ElementwiseChainJitCode>(attr, CodeSize(attr));
+  }
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace gen = paddle::operators::jit::gen;
+
+REGISTER_JITKERNEL_GEN(kElementwiseChain, gen::ElementwiseChainCreator);
@@ -0,0 +1,62 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include "glog/logging.h"
+#include "paddle/fluid/operators/jit/gen/act.h"
+#include "paddle/fluid/operators/jit/gen/jitcode.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+// Loads every 8 elements of x once, applies all the ops of the chain in
+// registers and stores the result, the tail is done one by one. n is read at
+// runtime, so the code only depends on the ops.
+class ElementwiseChainJitCode : public VActFunc {
+ public:
+  explicit ElementwiseChainJitCode(const elementwise_chain_attr_t& attr,
+                                   size_t code_size, void* code_ptr = nullptr)
+      : VActFunc(code_size, code_ptr), attr_(attr) {
+    this->genCode();
+  }
+
+  DECLARE_JIT_CODE(ElementwiseChainJitCode);
+  void genCode() override;
+
+ private:
+  template <typename JMM>
+  void ApplyOps(JMM& x, JMM& y, const Xbyak::Reg64* reg_ys,  // NOLINT
+                bool scalar);
+
+  elementwise_chain_attr_t attr_;
+  reg64_t param_x{abi_param1};
+  reg64_t param_ys{abi_param2};
+  reg64_t param_z{abi_param3};
+  reg64_t param_n{abi_param4};
+  reg64_t param_attr{abi_param5};
+
+  xmm_t xmm_x = xmm_t(0);
+  ymm_t ymm_x = ymm_t(0);
+  xmm_t xmm_y = xmm_t(1);
+  ymm_t ymm_y = ymm_t(1);
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,197 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/gen/matmul_int8.h"
+#include <stddef.h>  // offsetof
+#include <algorithm>
+
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+// broadcast (A[k], A[k+1]) as int16 pairs, or (A[k], 0) for the last odd one
+void MatMulInt8JitCode::broadcastA(bool pair) {
+  if (pair) {
+    if (use_avx512_) {
+      vpbroadcastw(ymm_t(bcast_idx), word[reg_ptr_a]);
+      vpmovzxbw(zmm_t(bcast_idx), ymm_t(bcast_idx));
+    } else {
+      vpbroadcastw(xmm_t(bcast_idx), word[reg_ptr_a]);
+      vpmovzxbw(ymm_t(bcast_idx), xmm_t(bcast_idx));
+    }
+  } else {
+    movzx(reg_tmp.cvt32(), byte[reg_ptr_a]);
+    vmovd(xmm_t(bcast_idx), reg_tmp.cvt32());
+    vpbroadcastd(vmm(bcast_idx), xmm_t(bcast_idx));
+  }
+}
+
+void MatMulInt8JitCode::accumulate(int num_blocks, int block_stride) {
+  const int vecs_per_block = use_avx512_ ? 1 : 2;
+  const int vec_bytes = INT8_GEMM_BLOCK * 2 / vecs_per_block;
+  for (int i = 0; i < num_blocks; ++i) {
+    for (int j = 0; j < vecs_per_block; ++j) {
+      auto acc = vmm(acc_start_idx + i * vecs_per_block + j);
+      vpmovsxbw(vmm(wgt_idx),
+                ptr[reg_ptr_b + i * block_stride + j * vec_bytes]);
+      vpmaddwd(vmm(wgt_idx), vmm(wgt_idx), vmm(bcast_idx));
+      vpaddd(acc, acc, vmm(wgt_idx));
+    }
+  }
+}
+
+void MatMulInt8JitCode::saveResults(int block_start, int num_blocks) {
+  const int vecs_per_block = use_avx512_ ? 1 : 2;
+  const int vec_cols = INT8_GEMM_BLOCK / vecs_per_block;
+  auto zero = vmm(bcast_idx);
+  if (with_relu_ || out_u8_) {
+    if (use_avx512_) {
+      vpxord(zero, zero, zero);
+    } else {
+      vpxor(zero, zero, zero);
+    }
+  }
+  for (int i = 0; i < num_blocks; ++i) {
+    const int col_start = (block_start + i) * INT8_GEMM_BLOCK;
+    for (int j = 0; j < vecs_per_block; ++j) {
+      auto acc = vmm(acc_start_idx + i * vecs_per_block + j);
+      const int col = col_start + j * vec_cols;
+      vcvtdq2ps(acc, acc);
+      vmulps(acc, acc, ptr[param_scale + col * sizeof(float)]);
+      if (with_bias_) {
+        vaddps(acc, acc, ptr[param_bias + col * sizeof(float)]);
+      }
+      if (with_relu_) {
+        vmaxps(acc, acc, zero);
+      }
+      if (out_u8_) {
+        // round to the nearest even, the default mode of mxcsr
+        vcvtps2dq(acc, acc);
+      } else {
+        vmovups(ptr[param_c + col * sizeof(float)], acc);
+      }
+    }
+    if (!out_u8_) {
+      continue;
+    }
+    if (use_avx512_) {
+      auto acc = zmm_t(acc_start_idx + i);
+      vpmaxsd(acc, acc, zero);
+      vpmovusdb(ptr[param_c + col_start], acc);
+    } else {
+      ymm_t lo(acc_start_idx + i * 2);
+      ymm_t hi(acc_start_idx + i * 2 + 1);
+      // int16: [lo0-3, hi0-3 | lo4-7, hi4-7] -> [lo0-7 | hi0-7]
+      vpackssdw(lo, lo, hi);
+      vpermq(lo, lo, 0xD8);
+      // uint8 qwords: [lo, lo, hi, hi] -> [lo, hi]
+      vpackuswb(lo, lo, lo);
+      vpermq(lo, lo, 0x08);
+      vmovdqu(ptr[param_c + col_start], xmm_t(lo.getIdx()));
+    }
+  }
+}
+
+void MatMulInt8JitCode::genCode() {
+  preCode();
+  const int vecs_per_block = use_avx512_ ? 1 : 2;
+  const int max_acc_regs = (use_avx512_ ? 32 : 16) - acc_start_idx;
+  const int max_blocks_per_group = max_acc_regs / vecs_per_block;
+  const int num_blocks = n_ / INT8_GEMM_BLOCK;
+  const int num_full_pairs = k_ / 2;
+  const int num_pairs = (k_ + 1) / 2;
+  // bytes of one packed block of INT8_GEMM_BLOCK columns
+  const int block_stride = num_pairs * INT8_GEMM_BLOCK * 2;
+  const int out_type_size = out_u8_ ? sizeof(uint8_t) : sizeof(float);
+
+  Label l_next_row, l_exit;
+  mov(reg_m.cvt32(), dword[param_attr + offsetof(matmul_int8_attr_t, m)]);
+  test(reg_m, reg_m);
+  jz(l_exit, T_NEAR);
+
+  L(l_next_row);
+  for (int block_start = 0; block_start < num_blocks;
+       block_start += max_blocks_per_group) {
+    const int group_blocks =
+        std::min(max_blocks_per_group, num_blocks - block_start);
+    for (int i = 0; i < group_blocks * vecs_per_block; ++i) {
+      auto acc = vmm(acc_start_idx + i);
+      if (use_avx512_) {
+        vpxord(acc, acc, acc);
+      } else {
+        vpxor(acc, acc, acc);
+      }
+    }
+    mov(reg_ptr_a, param_a);
+    mov(reg_ptr_b, param_b);
+    if (block_start > 0) {
+      add(reg_ptr_b, block_start * block_stride);
+    }
+    if (num_full_pairs > 0) {
+      Label l_next_pair;
+      mov(reg_k, num_full_pairs);
+      L(l_next_pair);
+      {
+        broadcastA(true);
+        accumulate(group_blocks, block_stride);
+        add(reg_ptr_a, 2);
+        add(reg_ptr_b, INT8_GEMM_BLOCK * 2);
+        dec(reg_k);
+        jnz(l_next_pair, T_NEAR);
+      }
+    }
+    if (k_ % 2 != 0) {
+      broadcastA(false);
+      accumulate(group_blocks, block_stride);
+    }
+    saveResults(block_start, group_blocks);
+  }
+  add(param_a, k_);
+  add(param_c, n_ * out_type_size);
+  dec(reg_m);
+  jnz(l_next_row, T_NEAR);
+
+  L(l_exit);
+  postCode();
+}
+
+class MatMulInt8Creator : public JitCodeCreator<matmul_int8_attr_t> {
+ public:
+  bool UseMe(const matmul_int8_attr_t& attr) const override {
+    return platform::MayIUse(platform::avx2) &&
+           attr.n % INT8_GEMM_BLOCK == 0;
+  }
+  size_t CodeSize(const matmul_int8_attr_t& attr) const override {
+    return 1024 + (attr.n / INT8_GEMM_BLOCK) * 512;
+  }
+  std::unique_ptr<GenBase> CreateJitCode(
+      const matmul_int8_attr_t& attr) const override {
+    PADDLE_ENFORCE_GT(attr.n, 0);
+    PADDLE_ENFORCE_GT(attr.k, 0);
+    return make_unique<MatMulInt8JitCode>(attr, CodeSize(attr));
+  }
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace gen = paddle::operators::jit::gen;
+
+REGISTER_JITKERNEL_GEN(kMatMulInt8, gen::MatMulInt8Creator);
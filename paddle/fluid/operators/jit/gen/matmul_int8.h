@@ -0,0 +1,99 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include "glog/logging.h"
+#include "paddle/fluid/operators/jit/gen/jitcode.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+// uint8 x int8 gemm on the packed weights.
+// The uint8 pairs of A are zero extended and the int8 pairs of B are sign
+// extended to int16, then accumulated by vpmaddwd, so there is no saturation
+// as vpmaddubsw has.
+// Only n and k are fixed in the code, m is read from attr at runtime.
+class MatMulInt8JitCode : public JitCode {
+ public:
+  explicit MatMulInt8JitCode(const matmul_int8_attr_t& attr,
+                             size_t code_size = 256 * 1024,
+                             void* code_ptr = nullptr)
+      : JitCode(code_size, code_ptr),
+        n_(attr.n),
+        k_(attr.k),
+        with_bias_(attr.with_bias),
+        with_relu_(attr.with_relu),
+        out_u8_(attr.out_u8),
+        use_avx512_(platform::MayIUse(platform::avx512_core)) {
+    PADDLE_ENFORCE_EQ(n_ % INT8_GEMM_BLOCK, 0,
+                      "N should be divisible by %d yet", INT8_GEMM_BLOCK);
+    this->genCode();
+  }
+
+  std::string name() const override {
+    std::string base = "MatMulInt8JitCode";
+    base = base + "_N" + std::to_string(n_) + "_K" + std::to_string(k_);
+    base += (with_bias_ ? "_Bias" : "");
+    base += (with_relu_ ? "_Relu" : "");
+    base += (out_u8_ ? "_U8" : "_F32");
+    base += (use_avx512_ ? "_AVX512" : "_AVX2");
+    return base;
+  }
+  void genCode() override;
+
+ private:
+  // ymm or zmm with the index
+  Xbyak::Xmm vmm(int idx) const {
+    if (use_avx512_) {
+      return Xbyak::Zmm(idx);
+    }
+    return Xbyak::Ymm(idx);
+  }
+  void broadcastA(bool pair);
+  void accumulate(int num_blocks, int block_stride);
+  void saveResults(int block_start, int num_blocks);
+
+  int n_, k_;
+  bool with_bias_, with_relu_, out_u8_;
+  bool use_avx512_;
+
+  reg64_t param_a{abi_param1};
+  reg64_t param_b{abi_param2};
+  reg64_t param_c{abi_param3};
+  reg64_t param_scale{abi_param4};
+  reg64_t param_bias{abi_param5};
+  reg64_t param_attr{abi_param6};
+
+  reg64_t reg_m{r10};
+  reg64_t reg_ptr_a{r11};
+  reg64_t reg_ptr_b{rax};
+  reg64_t reg_k{rbx};
+  reg64_t reg_tmp{r12};
+
+  // vmm 0 is the broadcasted A, vmm 1 is the extended B,
+  // and all the others are accumulators
+  const int bcast_idx = 0;
+  const int wgt_idx = 1;
+  const int acc_start_idx = 2;
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
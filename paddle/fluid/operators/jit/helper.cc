@@ -47,10 +47,13 @@ const char* to_string(KernelType kt) {
     ONE_CASE(kGRUHtPart1);
     ONE_CASE(kGRUHtPart2);
     ONE_CASE(kCRFDecoding);
+    ONE_CASE(kElementwiseChain);
     ONE_CASE(kLayerNorm);
     ONE_CASE(kNCHW16CMulNC);
     ONE_CASE(kSeqPool);
     ONE_CASE(kMatMul);
+    ONE_CASE(kMatMulInt8);
+    ONE_CASE(kMaxSeqPool);
     ONE_CASE(kHMax);
     ONE_CASE(kHSum);
     ONE_CASE(kSoftmax);
@@ -63,12 +66,36 @@ const char* to_string(KernelType kt) {
   return nullptr;
 }
 
+const char* to_string(ChainOpType tp) {
+  switch (tp) {
+    ONE_CASE(kChainAdd);
+    ONE_CASE(kChainSub);
+    ONE_CASE(kChainRSub);
+    ONE_CASE(kChainMul);
+    ONE_CASE(kChainDiv);
+    ONE_CASE(kChainRDiv);
+    ONE_CASE(kChainMax);
+    ONE_CASE(kChainMin);
+    ONE_CASE(kChainScale);
+    ONE_CASE(kChainRelu);
+    ONE_CASE(kChainSigmoid);
+    ONE_CASE(kChainTanh);
+    ONE_CASE(kChainExp);
+    ONE_CASE(kChainSquare);
+    default:
+      PADDLE_THROW("Not support type: %d, or forget to add it.", tp);
+      return "NOT ChainOpType";
+  }
+  return nullptr;
+}
+
 const char* to_string(SeqPoolType tp) {
   switch (tp) {
     ONE_CASE(kNonePoolType);
     ONE_CASE(kSum);
     ONE_CASE(kAvg);
     ONE_CASE(kSqrt);
+    ONE_CASE(kMax);
     default:
       PADDLE_THROW("Not support type: %d, or forget to add it.", tp);
       return "NOT PoolType";
@@ -124,6 +151,28 @@ void pack_weights<float>(const float* src, float* dst, int n, int k) {
   }
 }
 
+size_t packed_weights_int8_size(int n, int k) {
+  const int num_blocks = (n + INT8_GEMM_BLOCK - 1) / INT8_GEMM_BLOCK;
+  const int num_pairs = (k + 1) / 2;
+  return static_cast<size_t>(num_blocks) * num_pairs * INT8_GEMM_BLOCK * 2;
+}
+
+void pack_weights_int8(const int8_t* src, int8_t* dst, int n, int k) {
+  PADDLE_ENFORCE_GT(n, 0);
+  PADDLE_ENFORCE_GT(k, 0);
+  std::memset(dst, 0, packed_weights_int8_size(n, k));
+  const int num_pairs = (k + 1) / 2;
+  for (int i = 0; i < k; ++i) {
+    const int8_t* from = src + i * n;
+    for (int j = 0; j < n; ++j) {
+      const int block_idx = j / INT8_GEMM_BLOCK;
+      const int col = j % INT8_GEMM_BLOCK;
+      dst[((block_idx * num_pairs + i / 2) * INT8_GEMM_BLOCK + col) * 2 +
+          i % 2] = from[j];
+    }
+  }
+}
+
 template <typename T>
 typename std::enable_if<!std::is_same<T, float>::value>::type pack_weights(
     const T* src, T* dst, int n, int k) {
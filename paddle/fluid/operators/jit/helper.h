@@ -27,9 +27,16 @@ namespace paddle {
 namespace operators {
 namespace jit {
 
+// the data types which have jitcode implementations
+template <typename T>
+struct IsJitCodeType {
+  static constexpr bool value =
+      std::is_same<T, float>::value || std::is_same<T, uint8_t>::value;
+};
+
 template <KernelType KT, typename KernelTuples, typename PlaceType>
 inline typename std::enable_if<
-    std::is_same<typename KernelTuples::data_type, float>::value &&
+    IsJitCodeType<typename KernelTuples::data_type>::value &&
         std::is_same<PlaceType, platform::CPUPlace>::value,
     typename KernelTuples::func_type>::type
 GetJitCode(const typename KernelTuples::attr_type& attr) {
@@ -65,7 +72,7 @@ GetJitCode(const typename KernelTuples::attr_type& attr) {
 
 template <KernelType KT, typename KernelTuples, typename PlaceType>
 inline typename std::enable_if<
-    !std::is_same<typename KernelTuples::data_type, float>::value ||
+    !IsJitCodeType<typename KernelTuples::data_type>::value ||
         !std::is_same<PlaceType, platform::CPUPlace>::value,
     typename KernelTuples::func_type>::type
 GetJitCode(const typename KernelTuples::attr_type& attr) {
@@ -149,6 +156,7 @@ class KernelFuncs {
 
 const char* to_string(KernelType kt);
 const char* to_string(SeqPoolType kt);
+const char* to_string(ChainOpType kt);
 
 KernelType to_kerneltype(const std::string& act);
 
@@ -189,15 +197,40 @@ inline std::ostream& operator<<(std::ostream& os, const sgd_attr_t& attr) {
   return os;
 }
 
+inline std::ostream& operator<<(std::ostream& os,
+                                const elementwise_chain_attr_t& attr) {
+  os << "ops[";
+  for (int i = 0; i < attr.num_ops; ++i) {
+    os << (i > 0 ? "," : "") << to_string(attr.ops[i]);
+  }
+  os << "]";
+  return os;
+}
+
 inline std::ostream& operator<<(std::ostream& os, const matmul_attr_t& attr) {
   os << "M[" << attr.m << "],N[" << attr.n << "],K[" << attr.k << "]";
   return os;
 }
 
+inline std::ostream& operator<<(std::ostream& os,
+                                const matmul_int8_attr_t& attr) {
+  os << "M[" << attr.m << "],N[" << attr.n << "],K[" << attr.k
+     << "],with_bias[" << (attr.with_bias ? "True" : "False")
+     << "],with_relu[" << (attr.with_relu ? "True" : "False") << "],out_u8["
+     << (attr.out_u8 ? "True" : "False") << "]";
+  return os;
+}
+
 // expose the method to pack matmul weight
 template <typename T>
 void pack_weights(const T* src, T* dst, int n, int k);
 
+// int8 matmul weights B(K,N) are packed into blocks of INT8_GEMM_BLOCK
+// columns, where every two successive rows are interleaved and the tails are
+// padded with zero, so the packed layout is [N/block][K/2][block][2].
+size_t packed_weights_int8_size(int n, int k);
+void pack_weights_int8(const int8_t* src, int8_t* dst, int n, int k);
+
 }  // namespace jit
 }  // namespace operators
 }  // namespace paddle
@@ -25,7 +25,8 @@ typedef enum {
   kNone = 0,
   // sort by alphabet
   kCRFDecoding = 1,
-  kEmbSeqPool = 2,
+  kElementwiseChain = 2,
+  kEmbSeqPool,
   kGRUH1,
   kGRUHtPart1,
   kGRUHtPart2,
@@ -35,6 +36,8 @@ typedef enum {
   kLSTMC1H1,
   kLayerNorm,
   kMatMul,
+  kMatMulInt8,
+  kMaxSeqPool,
   kNCHW16CMulNC,
   kSeqPool,
   kSoftmax,
@@ -58,6 +61,7 @@ typedef enum {
   kSum = 1,
   kAvg,
   kSqrt,
+  kMax,
 } SeqPoolType;
 
 template <typename T>
@@ -148,6 +152,15 @@ struct SeqPoolTuples {
   typedef void (*func_type)(const T*, T*, const seq_pool_attr_t*);
 };
 
+// y is the max of every column over the h rows of x, and index the row where
+// it is taken (the first one on ties), index could be nullptr.
+template <typename T>
+struct MaxSeqPoolTuples {
+  typedef T data_type;
+  typedef seq_pool_attr_t attr_type;
+  typedef void (*func_type)(const T*, T*, int*, const seq_pool_attr_t*);
+};
+
 typedef struct emb_seq_pool_attr_s {
   int64_t table_height, table_width;
   int64_t index_height, index_width;
@@ -211,6 +224,32 @@ struct MatMulTuples {
   typedef void (*func_type)(const T*, const T*, T*, const matmul_attr_t*);
 };
 
+// uint8 A(M,K) * int8 B(K,N) accumulated in int32, then
+// C = act(int32 * scale + bias), saved as float or requantized to uint8.
+// B should be packed by pack_weights_int8.
+typedef struct matmul_int8_attr_s {
+  int m, n, k;
+  bool with_bias{false};
+  bool with_relu{false};
+  bool out_u8{false};  // saturate the output to uint8 instead of float
+  matmul_int8_attr_s() = default;
+  explicit matmul_int8_attr_s(int m_, int n_, int k_, bool with_bias_ = false,
+                              bool with_relu_ = false, bool out_u8_ = false)
+      : m(m_),
+        n(n_),
+        k(k_),
+        with_bias(with_bias_),
+        with_relu(with_relu_),
+        out_u8(out_u8_) {}
+} matmul_int8_attr_t;
+
+struct MatMulInt8Tuples {
+  typedef uint8_t data_type;
+  typedef matmul_int8_attr_t attr_type;
+  typedef void (*func_type)(const uint8_t*, const int8_t*, void*, const float*,
+                            const float*, const matmul_int8_attr_t*);
+};
+
 template <typename T>
 struct CRFDecodingTuples {
   typedef T data_type;
@@ -241,6 +280,68 @@ struct NCHW16CMulNCTuples {
   typedef void (*func_type)(const T*, const T*, T*, int, int);
 };
 
+// The operations of an elementwise chain, applied to the running value x one
+// by one. The binary ones take the next one of the inputs ys as the other
+// operand, and kChainRSub, kChainRDiv take it as the first operand.
+// kChainScale computes x * scale + bias.
+typedef enum {
+  kChainAdd = 0,
+  kChainSub,
+  kChainRSub,
+  kChainMul,
+  kChainDiv,
+  kChainRDiv,
+  kChainMax,
+  kChainMin,
+  kChainScale,
+  kChainRelu,
+  kChainSigmoid,
+  kChainTanh,
+  kChainExp,
+  kChainSquare,
+} ChainOpType;
+
+constexpr int kMaxChainOps = 12;
+constexpr int kMaxChainInputs = 8;
+
+typedef struct elementwise_chain_attr_s {
+  int num_ops{0};
+  ChainOpType ops[kMaxChainOps];
+  // only used by kChainScale
+  float scales[kMaxChainOps];
+  float biases[kMaxChainOps];
+  elementwise_chain_attr_s() = default;
+  // Returns false if the chain is full.
+  bool Append(ChainOpType op, float scale = 1.f, float bias = 0.f) {
+    if (num_ops == kMaxChainOps ||
+        (IsBinary(op) && num_inputs() == kMaxChainInputs)) {
+      return false;
+    }
+    ops[num_ops] = op;
+    scales[num_ops] = scale;
+    biases[num_ops] = bias;
+    ++num_ops;
+    return true;
+  }
+  static bool IsBinary(ChainOpType op) { return op < kChainScale; }
+  int num_inputs() const {
+    int n = 0;
+    for (int i = 0; i < num_ops; ++i) {
+      n += IsBinary(ops[i]);
+    }
+    return n;
+  }
+} elementwise_chain_attr_t;
+
+// z = chain(x, ys) of n elements
+template <typename T>
+struct ElementwiseChainTuples {
+  typedef T data_type;
+  typedef elementwise_chain_attr_t attr_type;
+  typedef void (*func_type)(const T*, const T* const*, T*, int,
+                            const elementwise_chain_attr_t*);
+};
+
 // Just for adding to kernel pool without template
 class Kernel {
  public:
@@ -73,6 +73,16 @@ size_t JitCodeKey<matmul_attr_t>(const matmul_attr_t& attr) {
   return (key << shift * 2) + ((static_cast<size_t>(attr.n)) << shift) + attr.k;
 }
 
+// m is not in the key, since the int8 matmul jitcode reads it at runtime
+template <>
+size_t JitCodeKey<matmul_int8_attr_t>(const matmul_int8_attr_t& attr) {
+  size_t key = attr.n;
+  constexpr int shift = 24;
+  key = (key << shift) + attr.k;
+  return (key << 3) + (attr.with_bias << 2) + (attr.with_relu << 1) +
+         attr.out_u8;
+}
+
 template <>
 size_t JitCodeKey<emb_seq_pool_attr_t>(const emb_seq_pool_attr_t& attr) {
   return attr.table_width;
@@ -83,6 +93,18 @@ size_t JitCodeKey<sgd_attr_t>(const sgd_attr_t& attr) {
   return attr.grad_width;
 }
 
+// the scales and biases are read at runtime, so only the ops are in the key
+template <>
+size_t JitCodeKey<elementwise_chain_attr_t>(
+    const elementwise_chain_attr_t& attr) {
+  constexpr int op_type_shift = 4;  // support 2^4 op types
+  size_t key = attr.num_ops;
+  for (int i = 0; i < attr.num_ops; ++i) {
+    key = (key << op_type_shift) + static_cast<int>(attr.ops[i]);
+  }
+  return key;
+}
+
 }  // namespace jit
 }  // namespace operators
 }  // namespace paddle
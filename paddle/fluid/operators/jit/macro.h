@@ -27,6 +27,9 @@ namespace jit {
 #define YMM_FLOAT_BLOCK 8
 #define ZMM_FLOAT_BLOCK 16
 
+// the columns of one packed block of int8 matmul weights
+#define INT8_GEMM_BLOCK 16
+
 }  // namespace jit
 }  // namespace operators
 }  // namespace paddle
@@ -0,0 +1,187 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/more/intrinsic/bf16.h"
+#include <immintrin.h>
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace intrinsic {
+
+using platform::bfloat16;
+
+// bfloat16 is the high half of float, so interleaving with zeros expands it
+static inline __m256 LoadBF16(const bfloat16* x) {
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x));
+  __m128i zero = _mm_setzero_si128();
+  __m128 lo = _mm_castsi128_ps(_mm_unpacklo_epi16(zero, v));
+  __m128 hi = _mm_castsi128_ps(_mm_unpackhi_epi16(zero, v));
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+// the same rounding as platform::bfloat16(float), in the low 16 bits of int32
+static inline __m128i RoundToBF16(__m128 v) {
+  __m128i x = _mm_castps_si128(v);
+  __m128i high = _mm_srli_epi32(x, 16);
+  __m128i lsb = _mm_and_si128(high, _mm_set1_epi32(1));
+  __m128i rounded = _mm_srli_epi32(
+      _mm_add_epi32(x, _mm_add_epi32(lsb, _mm_set1_epi32(0x7fff))), 16);
+  __m128i quiet_nan = _mm_or_si128(high, _mm_set1_epi32(0x40));
+  __m128i is_nan = _mm_castps_si128(_mm_cmpunord_ps(v, v));
+  return _mm_blendv_epi8(rounded, quiet_nan, is_nan);
+}
+
+static inline void StoreBF16(bfloat16* y, __m256 v) {
+  __m128i lo = RoundToBF16(_mm256_castps256_ps128(v));
+  __m128i hi = RoundToBF16(_mm256_extractf128_ps(v, 1));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(y), _mm_packus_epi32(lo, hi));
+}
+
+void VMulBF16(const bfloat16* x, const bfloat16* y, bfloat16* z, int n) {
+  int i = 0;
+  for (; i + YMM_FLOAT_BLOCK <= n; i += YMM_FLOAT_BLOCK) {
+    StoreBF16(z + i, _mm256_mul_ps(LoadBF16(x + i), LoadBF16(y + i)));
+  }
+  for (; i < n; ++i) {
+    z[i] = x[i] * y[i];
+  }
+}
+
+void VAddBF16(const bfloat16* x, const bfloat16* y, bfloat16* z, int n) {
+  int i = 0;
+  for (; i + YMM_FLOAT_BLOCK <= n; i += YMM_FLOAT_BLOCK) {
+    StoreBF16(z + i, _mm256_add_ps(LoadBF16(x + i), LoadBF16(y + i)));
+  }
+  for (; i < n; ++i) {
+    z[i] = x[i] + y[i];
+  }
+}
+
+void VAddReluBF16(const bfloat16* x, const bfloat16* y, bfloat16* z, int n) {
+  const __m256 zero = _mm256_setzero_ps();
+  int i = 0;
+  for (; i + YMM_FLOAT_BLOCK <= n; i += YMM_FLOAT_BLOCK) {
+    __m256 tmp = _mm256_add_ps(LoadBF16(x + i), LoadBF16(y + i));
+    StoreBF16(z + i, _mm256_max_ps(tmp, zero));
+  }
+  for (; i < n; ++i) {
+    float tmp = static_cast<float>(x[i]) + static_cast<float>(y[i]);
+    z[i] = bfloat16(tmp > 0.f ? tmp : 0.f);
+  }
+}
+
+void VReluBF16(const bfloat16* x, bfloat16* y, int n) {
+  const __m256 zero = _mm256_setzero_ps();
+  int i = 0;
+  for (; i + YMM_FLOAT_BLOCK <= n; i += YMM_FLOAT_BLOCK) {
+    StoreBF16(y + i, _mm256_max_ps(LoadBF16(x + i), zero));
+  }
+  for (; i < n; ++i) {
+    float tmp = static_cast<float>(x[i]);
+    y[i] = bfloat16(tmp > 0.f ? tmp : 0.f);
+  }
+}
+
+// ROWS rows of C on the YMM_FLOAT_BLOCK columns from n_start.
+// Each B block is expanded once and shared by all the rows.
+template <int ROWS>
+static inline void MatMulBlockBF16(const bfloat16* A, const bfloat16* B,
+                                   bfloat16* C, int N, int K, int n_start) {
+  __m256 acc[ROWS];
+  for (int r = 0; r < ROWS; ++r) {
+    acc[r] = _mm256_setzero_ps();
+  }
+  for (int k = 0; k < K; ++k) {
+    __m256 b = LoadBF16(B + k * N + n_start);
+    for (int r = 0; r < ROWS; ++r) {
+      __m256 a = _mm256_set1_ps(static_cast<float>(A[r * K + k]));
+      acc[r] = _mm256_add_ps(acc[r], _mm256_mul_ps(a, b));
+    }
+  }
+  for (int r = 0; r < ROWS; ++r) {
+    StoreBF16(C + r * N + n_start, acc[r]);
+  }
+}
+
+template <int ROWS>
+static inline void MatMulRowsBF16(const bfloat16* A, const bfloat16* B,
+                                  bfloat16* C, int N, int K) {
+  const int end = N - N % YMM_FLOAT_BLOCK;
+  for (int n = 0; n < end; n += YMM_FLOAT_BLOCK) {
+    MatMulBlockBF16<ROWS>(A, B, C, N, K, n);
+  }
+  for (int r = 0; r < ROWS; ++r) {
+    for (int n = end; n < N; ++n) {
+      float sum = 0.f;
+      for (int k = 0; k < K; ++k) {
+        sum += static_cast<float>(A[r * K + k]) *
+               static_cast<float>(B[k * N + n]);
+      }
+      C[r * N + n] = bfloat16(sum);
+    }
+  }
+}
+
+void MatMulBF16(const bfloat16* A, const bfloat16* B, bfloat16* C,
+                const matmul_attr_t* attr) {
+  constexpr int kRows = 4;
+  const int M = attr->m;
+  const int N = attr->n;
+  const int K = attr->k;
+  int m = 0;
+  for (; m + kRows <= M; m += kRows) {
+    MatMulRowsBF16<kRows>(A + m * K, B, C + m * N, N, K);
+  }
+  for (; m < M; ++m) {
+    MatMulRowsBF16<1>(A + m * K, B, C + m * N, N, K);
+  }
+}
+
+bool VMulBF16Kernel::UseMe(const int& d) const {
+  return platform::MayIUse(platform::avx) && d >= YMM_FLOAT_BLOCK;
+}
+
+bool VAddBF16Kernel::UseMe(const int& d) const {
+  return platform::MayIUse(platform::avx) && d >= YMM_FLOAT_BLOCK;
+}
+
+bool VAddReluBF16Kernel::UseMe(const int& d) const {
+  return platform::MayIUse(platform::avx) && d >= YMM_FLOAT_BLOCK;
+}
+
+bool VReluBF16Kernel::UseMe(const int& d) const {
+  return platform::MayIUse(platform::avx) && d >= YMM_FLOAT_BLOCK;
+}
+
+bool MatMulBF16Kernel::UseMe(const matmul_attr_t& attr) const {
+  return platform::MayIUse(platform::avx) && attr.n >= YMM_FLOAT_BLOCK;
+}
+
+}  // namespace intrinsic
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace intrinsic = paddle::operators::jit::more::intrinsic;
+
+REGISTER_JITKERNEL_MORE(kVMul, intrinsic, intrinsic::VMulBF16Kernel);
+REGISTER_JITKERNEL_MORE(kVAdd, intrinsic, intrinsic::VAddBF16Kernel);
+REGISTER_JITKERNEL_MORE(kVAddRelu, intrinsic, intrinsic::VAddReluBF16Kernel);
+REGISTER_JITKERNEL_MORE(kVRelu, intrinsic, intrinsic::VReluBF16Kernel);
+REGISTER_JITKERNEL_MORE(kMatMul, intrinsic, intrinsic::MatMulBF16Kernel);
@@ -0,0 +1,60 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <type_traits>
+#include "paddle/fluid/operators/jit/kernel_base.h"
+#include "paddle/fluid/platform/bfloat16.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace intrinsic {
+
+// The bfloat16 data is expanded to float in registers and computed by AVX,
+// the results are rounded to the nearest even bfloat16 when storing.
+void VMulBF16(const platform::bfloat16* x, const platform::bfloat16* y,
+              platform::bfloat16* z, int n);
+void VAddBF16(const platform::bfloat16* x, const platform::bfloat16* y,
+              platform::bfloat16* z, int n);
+void VAddReluBF16(const platform::bfloat16* x, const platform::bfloat16* y,
+                  platform::bfloat16* z, int n);
+void VReluBF16(const platform::bfloat16* x, platform::bfloat16* y, int n);
+void MatMulBF16(const platform::bfloat16* A, const platform::bfloat16* B,
+                platform::bfloat16* C, const matmul_attr_t* attr);
+
+#define DECLARE_BF16_KERNEL(name, tuples)                                      \
+  class name##BF16Kernel : public KernelMore<tuples<platform::bfloat16>> {     \
+   public:                                                                     \
+    name##BF16Kernel() { this->func = name##BF16; }                            \
+    bool UseMe(                                                                \
+        const typename tuples<platform::bfloat16>::attr_type&) const override; \
+    const char* ImplType() const override { return "Intrinsic"; }              \
+  }
+
+DECLARE_BF16_KERNEL(VMul, XYZNTuples);
+DECLARE_BF16_KERNEL(VAdd, XYZNTuples);
+DECLARE_BF16_KERNEL(VAddRelu, XYZNTuples);
+DECLARE_BF16_KERNEL(VRelu, XYNTuples);
+DECLARE_BF16_KERNEL(MatMul, MatMulTuples);
+
+#undef DECLARE_BF16_KERNEL
+
+}  // namespace intrinsic
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,75 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/more/intrinsic/max_seq_pool.h"
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace intrinsic {
+
+void MaxSeqPool(const float* x, float* y, int* index,
+                const seq_pool_attr_t* attr) {
+  const int h = attr->h;
+  const int w = attr->w;
+  const int end = w - w % YMM_FLOAT_BLOCK;
+  // Every block of columns keeps its max and row index in registers over all
+  // the rows. The index is blended as float bits, which needs AVX only.
+  for (int j = 0; j < end; j += YMM_FLOAT_BLOCK) {
+    __m256 max_vec = _mm256_loadu_ps(x + j);
+    __m256 idx_vec = _mm256_setzero_ps();
+    for (int i = 1; i < h; ++i) {
+      __m256 cur = _mm256_loadu_ps(x + i * w + j);
+      __m256 mask = _mm256_cmp_ps(cur, max_vec, _CMP_GT_OQ);
+      max_vec = _mm256_blendv_ps(max_vec, cur, mask);
+      idx_vec = _mm256_blendv_ps(
+          idx_vec, _mm256_castsi256_ps(_mm256_set1_epi32(i)), mask);
+    }
+    _mm256_storeu_ps(y + j, max_vec);
+    if (index) {
+      _mm256_storeu_ps(reinterpret_cast<float*>(index + j), idx_vec);
+    }
+  }
+  for (int j = end; j < w; ++j) {
+    float max = x[j];
+    int idx = 0;
+    for (int i = 1; i < h; ++i) {
+      if (x[i * w + j] > max) {
+        max = x[i * w + j];
+        idx = i;
+      }
+    }
+    y[j] = max;
+    if (index) {
+      index[j] = idx;
+    }
+  }
+}
+
+bool MaxSeqPoolKernel::UseMe(const seq_pool_attr_t& attr) const {
+  return platform::MayIUse(platform::avx) && attr.w >= YMM_FLOAT_BLOCK;
+}
+
+}  // namespace intrinsic
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace intrinsic = paddle::operators::jit::more::intrinsic;
+
+REGISTER_JITKERNEL_MORE(kMaxSeqPool, intrinsic, intrinsic::MaxSeqPoolKernel);
@@ -13,6 +13,7 @@
  * limitations under the License. */
 
 #include "paddle/fluid/operators/jit/more/mix/mix.h"
+#include <algorithm>
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/jit/registry.h"
 #include "paddle/fluid/platform/cpu_info.h"
@@ -205,6 +206,38 @@ void GRUHtPart2(gru_t* step, const gru_attr_t* attr) {
   }
 }
 
+// expand a block to float, compute it by the best float kernel and round back
+template <KernelType KT>
+static void ComputeBF16ByFloat(const platform::bfloat16* x,
+                               platform::bfloat16* y, int n) {
+  constexpr int kBlock = 256;
+  float buf[kBlock];
+  for (int i = 0; i < n; i += kBlock) {
+    const int len = std::min(kBlock, n - i);
+    for (int j = 0; j < len; ++j) {
+      buf[j] = static_cast<float>(x[i + j]);
+    }
+    auto compute =
+        KernelFuncs<KT, XYNTuples<float>, platform::CPUPlace>::Cache().At(len);
+    compute(buf, buf, len);
+    for (int j = 0; j < len; ++j) {
+      y[i + j] = platform::bfloat16(buf[j]);
+    }
+  }
+}
+
+void VExpBF16(const platform::bfloat16* x, platform::bfloat16* y, int n) {
+  ComputeBF16ByFloat<kVExp>(x, y, n);
+}
+
+void VSigmoidBF16(const platform::bfloat16* x, platform::bfloat16* y, int n) {
+  ComputeBF16ByFloat<kVSigmoid>(x, y, n);
+}
+
+void VTanhBF16(const platform::bfloat16* x, platform::bfloat16* y, int n) {
+  ComputeBF16ByFloat<kVTanh>(x, y, n);
+}
+
 // TODO(TJ): tuning me
 bool VSigmoidKernel::UseMe(const int& d) const { return true; }
 
@@ -222,6 +255,12 @@ bool GRUHtPart1Kernel::UseMe(const gru_attr_t& attr) const { return true; }
 
 bool GRUHtPart2Kernel::UseMe(const gru_attr_t& attr) const { return true; }
 
+bool VExpBF16Kernel::UseMe(const int& d) const { return true; }
+
+bool VSigmoidBF16Kernel::UseMe(const int& d) const { return true; }
+
+bool VTanhBF16Kernel::UseMe(const int& d) const { return true; }
+
 }  // namespace mix
 }  // namespace more
 }  // namespace jit
@@ -233,8 +272,10 @@ namespace mix = paddle::operators::jit::more::mix;
 #define REGISTER_MORE_KERNEL(key, func) \
   REGISTER_JITKERNEL_MORE(key, mix, mix::func##Kernel)
 
-REGISTER_MORE_KERNEL(kVSigmoid, VSigmoid);
-REGISTER_MORE_KERNEL(kVTanh, VTanh);
+REGISTER_JITKERNEL_MORE(kVExp, mix, mix::VExpBF16Kernel);
+REGISTER_JITKERNEL_MORE(kVSigmoid, mix, mix::VSigmoidKernel,
+                        mix::VSigmoidBF16Kernel);
+REGISTER_JITKERNEL_MORE(kVTanh, mix, mix::VTanhKernel, mix::VTanhBF16Kernel);
 REGISTER_MORE_KERNEL(kSoftmax, Softmax);
 REGISTER_MORE_KERNEL(kLSTMCtHt, LSTMCtHt);
 REGISTER_MORE_KERNEL(kLSTMC1H1, LSTMC1H1);
@@ -16,6 +16,7 @@
 
 #include <type_traits>
 #include "paddle/fluid/operators/jit/kernel_base.h"
+#include "paddle/fluid/platform/bfloat16.h"
 
 namespace paddle {
 namespace operators {
@@ -28,6 +29,11 @@ void VSigmoid(const T* x, T* y, int n);
 void VTanh(const T* x, T* y, int n);
 void Softmax(const T* x, T* y, int n, int bs);
 
+// bfloat16 activations, computed by the float kernels block by block
+void VExpBF16(const platform::bfloat16* x, platform::bfloat16* y, int n);
+void VSigmoidBF16(const platform::bfloat16* x, platform::bfloat16* y, int n);
+void VTanhBF16(const platform::bfloat16* x, platform::bfloat16* y, int n);
+
 void LSTMCtHt(lstm_t* step, const lstm_attr_t* attr);
 void LSTMC1H1(lstm_t* step, const lstm_attr_t* attr);
 void GRUH1(gru_t* step, const gru_attr_t* attr);
@@ -58,6 +64,21 @@ DECLARE_MORE_KERNEL(GRUHtPart2, GRUTuples);
 
 #undef DECLARE_MORE_KERNEL
 
+#define DECLARE_BF16_MORE_KERNEL(name)                        \
+  class name##BF16Kernel                                      \
+      : public KernelMore<XYNTuples<platform::bfloat16>> {    \
+   public:                                                    \
+    name##BF16Kernel() { this->func = name##BF16; }           \
+    bool UseMe(const int&) const override;                    \
+    const char* ImplType() const override { return "Mixed"; } \
+  }
+
+DECLARE_BF16_MORE_KERNEL(VExp);
+DECLARE_BF16_MORE_KERNEL(VSigmoid);
+DECLARE_BF16_MORE_KERNEL(VTanh);
+
+#undef DECLARE_BF16_MORE_KERNEL
+
 }  // namespace mix
 }  // namespace more
 }  // namespace jit
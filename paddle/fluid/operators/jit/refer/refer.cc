@@ -21,20 +21,25 @@ namespace refer = paddle::operators::jit::refer;
   REGISTER_JITKERNEL_REFER(key, refer::func##Kernel<float>, \
                            refer::func##Kernel<double>)
 
-REGISTER_REFER_KERNEL(kVMul, VMul);
-REGISTER_REFER_KERNEL(kVAdd, VAdd);
-REGISTER_REFER_KERNEL(kVAddRelu, VAddRelu);
+#define REGISTER_REFER_KERNEL_WITH_BF16(key, func)                       \
+  REGISTER_JITKERNEL_REFER(key, refer::func##Kernel<float>,              \
+                           refer::func##Kernel<double>,                  \
+                           refer::func##Kernel<paddle::platform::bfloat16>)
+
+REGISTER_REFER_KERNEL_WITH_BF16(kVMul, VMul);
+REGISTER_REFER_KERNEL_WITH_BF16(kVAdd, VAdd);
+REGISTER_REFER_KERNEL_WITH_BF16(kVAddRelu, VAddRelu);
 REGISTER_REFER_KERNEL(kVSub, VSub);
 
 REGISTER_REFER_KERNEL(kVScal, VScal);
 REGISTER_REFER_KERNEL(kVAddBias, VAddBias);
 
-REGISTER_REFER_KERNEL(kVRelu, VRelu);
+REGISTER_REFER_KERNEL_WITH_BF16(kVRelu, VRelu);
 REGISTER_REFER_KERNEL(kVIdentity, VIdentity);
 REGISTER_REFER_KERNEL(kVSquare, VSquare);
-REGISTER_REFER_KERNEL(kVExp, VExp);
-REGISTER_REFER_KERNEL(kVSigmoid, VSigmoid);
-REGISTER_REFER_KERNEL(kVTanh, VTanh);
+REGISTER_REFER_KERNEL_WITH_BF16(kVExp, VExp);
+REGISTER_REFER_KERNEL_WITH_BF16(kVSigmoid, VSigmoid);
+REGISTER_REFER_KERNEL_WITH_BF16(kVTanh, VTanh);
 
 REGISTER_REFER_KERNEL(kLSTMCtHt, LSTMCtHt);
 REGISTER_REFER_KERNEL(kLSTMC1H1, LSTMC1H1);
@@ -49,8 +54,10 @@ REGISTER_REFER_KERNEL(kLayerNorm, LayerNorm);
 REGISTER_REFER_KERNEL(kNCHW16CMulNC, NCHW16CMulNC);
 
 REGISTER_REFER_KERNEL(kSeqPool, SeqPool);
+REGISTER_REFER_KERNEL(kMaxSeqPool, MaxSeqPool);
 
-REGISTER_REFER_KERNEL(kMatMul, MatMul);
+REGISTER_REFER_KERNEL_WITH_BF16(kMatMul, MatMul);
+REGISTER_JITKERNEL_REFER(kMatMulInt8, refer::MatMulInt8Kernel);
 
 REGISTER_REFER_KERNEL(kHMax, HMax);
 REGISTER_REFER_KERNEL(kHSum, HSum);
@@ -61,4 +68,7 @@ REGISTER_REFER_KERNEL(kEmbSeqPool, EmbSeqPool);
 
 REGISTER_REFER_KERNEL(kSgd, Sgd);
 
+REGISTER_REFER_KERNEL(kElementwiseChain, ElementwiseChain);
+
+#undef REGISTER_REFER_KERNEL_WITH_BF16
 #undef REGISTER_REFER_KERNEL
@@ -14,11 +14,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <string>
 #include "paddle/fluid/operators/jit/helper.h"
 #include "paddle/fluid/operators/jit/kernel_base.h"
+#include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -362,6 +365,27 @@ void SeqPool(const T* x, T* y, const seq_pool_attr_t* attr) {
   }
 }
 
+template <typename T>
+void MaxSeqPool(const T* x, T* y, int* index, const seq_pool_attr_t* attr) {
+  for (int w = 0; w < attr->w; ++w) {
+    y[w] = x[w];
+    if (index) {
+      index[w] = 0;
+    }
+  }
+  for (int h = 1; h < attr->h; ++h) {
+    const T* src = x + h * attr->w;
+    for (int w = 0; w < attr->w; ++w) {
+      if (src[w] > y[w]) {
+        y[w] = src[w];
+        if (index) {
+          index[w] = h;
+        }
+      }
+    }
+  }
+}
+
 // A(M,K) * B(K,N) = C(M,N)
 template <typename T>
 void MatMul(const T* A, const T* B, T* C, const matmul_attr_t* attr) {
@@ -381,6 +405,104 @@ void MatMul(const T* A, const T* B, T* C, const matmul_attr_t* attr) {
   }
 }
 
+// uint8 A(M,K) * int8 packed B(K,N), see pack_weights_int8 for the layout
+// C(M,N) = act(int32 result * scale[n] + bias[n]), as float or uint8
+inline void MatMulInt8(const uint8_t* A, const int8_t* B, void* C,
+                       const float* scale, const float* bias,
+                       const matmul_int8_attr_t* attr) {
+  int M = attr->m;
+  int N = attr->n;
+  int K = attr->k;
+  int num_pairs = (K + 1) / 2;
+  for (int m = 0; m < M; ++m) {
+    const uint8_t* pa = A + m * K;
+    for (int n = 0; n < N; ++n) {
+      const int8_t* pb = B + (n / INT8_GEMM_BLOCK) * num_pairs *
+                                 INT8_GEMM_BLOCK * 2 +
+                         (n % INT8_GEMM_BLOCK) * 2;
+      int32_t acc = 0;
+      for (int k = 0; k < K; ++k) {
+        acc += static_cast<int32_t>(pa[k]) *
+               static_cast<int32_t>(pb[(k / 2) * INT8_GEMM_BLOCK * 2 + k % 2]);
+      }
+      float res = static_cast<float>(acc) * scale[n];
+      if (attr->with_bias) {
+        res += bias[n];
+      }
+      if (attr->with_relu) {
+        res = res > 0.f ? res : 0.f;
+      }
+      if (attr->out_u8) {
+        res = std::nearbyint(res);
+        res = std::min(std::max(res, 0.f), 255.f);
+        reinterpret_cast<uint8_t*>(C)[m * N + n] = static_cast<uint8_t>(res);
+      } else {
+        reinterpret_cast<float*>(C)[m * N + n] = res;
+      }
+    }
+  }
+}
+
+// The bfloat16 kernels compute in float and round every result only once.
+template <>
+inline void VAddRelu<platform::bfloat16>(const platform::bfloat16* x,
+                                         const platform::bfloat16* y,
+                                         platform::bfloat16* z, int n) {
+  for (int i = 0; i < n; ++i) {
+    float tmp = static_cast<float>(x[i]) + static_cast<float>(y[i]);
+    z[i] = platform::bfloat16(tmp > 0.f ? tmp : 0.f);
+  }
+}
+
+template <>
+inline void VRelu<platform::bfloat16>(const platform::bfloat16* x,
+                                      platform::bfloat16* y, int n) {
+  for (int i = 0; i < n; ++i) {
+    float tmp = static_cast<float>(x[i]);
+    y[i] = platform::bfloat16(tmp > 0.f ? tmp : 0.f);
+  }
+}
+
+#define DEFINE_BF16_XYN_BY_FLOAT(name)                                \
+  template <>                                                         \
+  inline void name<platform::bfloat16>(const platform::bfloat16* x,   \
+                                       platform::bfloat16* y, int n) { \
+    for (int i = 0; i < n; ++i) {                                     \
+      float tmp = static_cast<float>(x[i]);                           \
+      name<float>(&tmp, &tmp, 1);                                     \
+      y[i] = platform::bfloat16(tmp);                                 \
+    }                                                                 \
+  }
+
+DEFINE_BF16_XYN_BY_FLOAT(VExp);
+DEFINE_BF16_XYN_BY_FLOAT(VSigmoid);
+DEFINE_BF16_XYN_BY_FLOAT(VTanh);
+
+#undef DEFINE_BF16_XYN_BY_FLOAT
+
+// bfloat16 A(M,K) * B(K,N) = C(M,N), accumulated in float
+template <>
+inline void MatMul<platform::bfloat16>(const platform::bfloat16* A,
+                                       const platform::bfloat16* B,
+                                       platform::bfloat16* C,
+                                       const matmul_attr_t* attr) {
+  int M = attr->m;
+  int N = attr->n;
+  int K = attr->k;
+  for (int m = 0; m < M; ++m) {
+    const platform::bfloat16* pa = A + m * K;
+    platform::bfloat16* pc = C + m * N;
+    for (int n = 0; n < N; ++n) {
+      const platform::bfloat16* pb = B + n;
+      float sum = static_cast<float>(pa[0]) * static_cast<float>(pb[0]);
+      for (int k = 1; k < K; ++k) {
+        sum += static_cast<float>(pa[k]) * static_cast<float>(pb[k * N]);
+      }
+      pc[n] = platform::bfloat16(sum);
+    }
+  }
+}
+
 template <typename T>
 void HMax(const T* x, T* res, int n) {
   res[0] = x[0];
@@ -476,6 +598,70 @@ void Sgd(const T* lr, const T* param, const T* grad, const int64_t* rows,
   }
 }
 
+// z = the ops of attr applied to x one by one, see ChainOpType
+template <typename T>
+void ElementwiseChain(const T* x, const T* const* ys, T* z, int n,
+                      const elementwise_chain_attr_t* attr) {
+  if (z != x) {
+    std::memcpy(z, x, sizeof(T) * n);
+  }
+  int k = 0;
+  for (int i = 0; i < attr->num_ops; ++i) {
+    const T* y = elementwise_chain_attr_t::IsBinary(attr->ops[i]) ? ys[k++]
+                                                                  : nullptr;
+    switch (attr->ops[i]) {
+      case kChainAdd:
+        for (int j = 0; j < n; ++j) z[j] += y[j];
+        break;
+      case kChainSub:
+        for (int j = 0; j < n; ++j) z[j] -= y[j];
+        break;
+      case kChainRSub:
+        for (int j = 0; j < n; ++j) z[j] = y[j] - z[j];
+        break;
+      case kChainMul:
+        for (int j = 0; j < n; ++j) z[j] *= y[j];
+        break;
+      case kChainDiv:
+        for (int j = 0; j < n; ++j) z[j] /= y[j];
+        break;
+      case kChainRDiv:
+        for (int j = 0; j < n; ++j) z[j] = y[j] / z[j];
+        break;
+      case kChainMax:
+        for (int j = 0; j < n; ++j) z[j] = z[j] > y[j] ? z[j] : y[j];
+        break;
+      case kChainMin:
+        for (int j = 0; j < n; ++j) z[j] = z[j] < y[j] ? z[j] : y[j];
+        break;
+      case kChainScale: {
+        const T scale = static_cast<T>(attr->scales[i]);
+        const T bias = static_cast<T>(attr->biases[i]);
+        for (int j = 0; j < n; ++j) z[j] = z[j] * scale + bias;
+        break;
+      }
+      case kChainRelu:
+        VRelu(z, z, n);
+        break;
+      case kChainSigmoid:
+        VSigmoid(z, z, n);
+        break;
+      case kChainTanh:
+        VTanh(z, z, n);
+        break;
+      case kChainExp:
+        VExp(z, z, n);
+        break;
+      case kChainSquare:
+        VSquare(z, z, n);
+        break;
+      default:
+        PADDLE_THROW("Unsupported op %d of the elementwise chain.",
+                     attr->ops[i]);
+    }
+  }
+}
+
 #define DECLARE_REFER_KERNEL(name, tuples)             \
   template <typename T>                                \
   class name##Kernel : public ReferKernel<tuples<T>> { \
@@ -516,9 +702,15 @@ DECLARE_REFER_KERNEL(LayerNorm, LayerNormTuples);
 DECLARE_REFER_KERNEL(NCHW16CMulNC, NCHW16CMulNCTuples);
 
 DECLARE_REFER_KERNEL(SeqPool, SeqPoolTuples);
+DECLARE_REFER_KERNEL(MaxSeqPool, MaxSeqPoolTuples);
 
 DECLARE_REFER_KERNEL(MatMul, MatMulTuples);
 
+class MatMulInt8Kernel : public ReferKernel<MatMulInt8Tuples> {
+ public:
+  MatMulInt8Kernel() { this->func = MatMulInt8; }
+};
+
 DECLARE_REFER_KERNEL(HMax, XRNTuples);
 DECLARE_REFER_KERNEL(HSum, XRNTuples);
 
@@ -528,6 +720,8 @@ DECLARE_REFER_KERNEL(EmbSeqPool, EmbSeqPoolTuples);
 
 DECLARE_REFER_KERNEL(Sgd, SgdTuples);
 
+DECLARE_REFER_KERNEL(ElementwiseChain, ElementwiseChainTuples);
+
 #undef DECLARE_REFER_KERNEL
 
 }  // namespace refer
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <algorithm>
+#include <cmath>
 #include <random>
 #include <string>
 #include <vector>
@@ -20,6 +21,7 @@ limitations under the License. */
 #include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/place.h"
 
@@ -49,6 +51,31 @@ void ExpectEQ(const T* target, const T* refer, size_t n) {
   }
 }
 
+// bfloat16 keeps 8 significant bits, so allow one rounding of difference
+template <>
+void ExpectEQ<paddle::platform::bfloat16>(
+    const paddle::platform::bfloat16* target,
+    const paddle::platform::bfloat16* refer, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    float tgt = static_cast<float>(target[i]);
+    float ref = static_cast<float>(refer[i]);
+    float acc = std::max(static_cast<float>(FLAGS_acc), std::abs(ref) / 128);
+    EXPECT_NEAR(tgt, ref, acc) << " at index : " << i;
+  }
+}
+
+std::vector<paddle::platform::bfloat16> RandomBF16Vec(const int n,
+                                                      const float lower,
+                                                      const float upper) {
+  std::vector<float> data(n);
+  RandomVec<float>(n, data.data(), lower, upper);
+  std::vector<paddle::platform::bfloat16> res(n);
+  for (int i = 0; i < n; ++i) {
+    res[i] = paddle::platform::bfloat16(data[i]);
+  }
+  return res;
+}
+
 std::vector<int> TestSizes() {
   std::vector<int> s;
   for (int i = 1; i < 32; ++i) {
@@ -271,6 +298,30 @@ struct TestFuncWithRefer<jit::SeqPoolTuples<T>, std::vector<T>, std::vector<T>,
   }
 };
 
+template <typename T>
+struct TestFuncWithRefer<jit::MaxSeqPoolTuples<T>, std::vector<T>,
+                         std::vector<T>, std::vector<int>,
+                         typename jit::MaxSeqPoolTuples<T>::attr_type> {
+  void operator()(const typename jit::MaxSeqPoolTuples<T>::func_type tgt,
+                  const std::vector<T>& x, const std::vector<T>& yref,
+                  const std::vector<int>& idx_ref,
+                  const typename jit::MaxSeqPoolTuples<T>::attr_type& attr) {
+    EXPECT_TRUE(tgt != nullptr);
+    EXPECT_EQ(x.size() % yref.size(), static_cast<size_t>(0));
+    int w = yref.size();
+    std::vector<T> y(w);
+    std::vector<int> idx(w);
+    tgt(x.data(), y.data(), idx.data(), &attr);
+    ExpectEQ<T>(y.data(), yref.data(), w);
+    for (int i = 0; i < w; ++i) {
+      EXPECT_EQ(idx[i], idx_ref[i]);
+    }
+    // test without index
+    tgt(x.data(), y.data(), nullptr, &attr);
+    ExpectEQ<T>(y.data(), yref.data(), w);
+  }
+};
+
 template <typename T>
 struct TestFuncWithRefer<jit::EmbSeqPoolTuples<T>, std::vector<T>,
                          std::vector<int64_t>, std::vector<T>,
@@ -358,6 +409,37 @@ struct TestFuncWithRefer<jit::MatMulTuples<T>, std::vector<T>, std::vector<T>,
   }
 };
 
+template <>
+struct TestFuncWithRefer<jit::MatMulInt8Tuples, std::vector<uint8_t>,
+                         std::vector<int8_t>, std::vector<float>,
+                         std::vector<float>, std::vector<float>,
+                         typename jit::MatMulInt8Tuples::attr_type> {
+  void operator()(const typename jit::MatMulInt8Tuples::func_type tgt,
+                  const std::vector<uint8_t>& a, const std::vector<int8_t>& b,
+                  const std::vector<float>& scale,
+                  const std::vector<float>& bias,
+                  const std::vector<float>& cref,
+                  const typename jit::MatMulInt8Tuples::attr_type& attr) {
+    EXPECT_TRUE(tgt != nullptr);
+    EXPECT_EQ(a.size(), static_cast<size_t>(attr.m * attr.k));
+    EXPECT_EQ(b.size(), jit::packed_weights_int8_size(attr.n, attr.k));
+    EXPECT_EQ(cref.size(), static_cast<size_t>(attr.m * attr.n));
+    if (attr.out_u8) {
+      std::vector<uint8_t> c(cref.size());
+      tgt(a.data(), b.data(), c.data(), scale.data(), bias.data(), &attr);
+      // the rounding may differ by one if the refer uses fma
+      for (size_t i = 0; i < c.size(); ++i) {
+        EXPECT_NEAR(static_cast<float>(c[i]), cref[i], 1.f)
+            << " at index : " << i;
+      }
+    } else {
+      std::vector<float> c(cref.size());
+      tgt(a.data(), b.data(), c.data(), scale.data(), bias.data(), &attr);
+      ExpectEQ<float>(c.data(), cref.data(), cref.size());
+    }
+  }
+};
+
 template <typename T>
 struct TestFuncWithRefer<jit::LayerNormTuples<T>, std::vector<T>,
                          std::vector<T>, std::vector<T>, std::vector<T>,
@@ -415,6 +497,35 @@ struct TestFuncWithRefer<jit::CRFDecodingTuples<T>, int, std::vector<T>,
   }
 };
 
+template <typename T>
+struct TestFuncWithRefer<jit::ElementwiseChainTuples<T>, std::vector<T>,
+                         std::vector<std::vector<T>>, std::vector<T>,
+                         typename jit::ElementwiseChainTuples<T>::attr_type> {
+  void operator()(
+      const typename jit::ElementwiseChainTuples<T>::func_type tgt,
+      const std::vector<T>& x, const std::vector<std::vector<T>>& ys,
+      const std::vector<T>& zref,
+      const typename jit::ElementwiseChainTuples<T>::attr_type& attr) {
+    EXPECT_TRUE(tgt != nullptr);
+    EXPECT_EQ(ys.size(), static_cast<size_t>(attr.num_inputs()));
+    EXPECT_EQ(zref.size(), x.size());
+    std::vector<const T*> ys_data;
+    for (auto& y : ys) {
+      EXPECT_EQ(y.size(), x.size());
+      ys_data.push_back(y.data());
+    }
+    const int n = static_cast<int>(x.size());
+    std::vector<T> z(n);
+    tgt(x.data(), ys_data.data(), z.data(), n, &attr);
+    ExpectEQ<T>(z.data(), zref.data(), n);
+
+    // inplace
+    std::copy(x.begin(), x.end(), z.begin());
+    tgt(z.data(), ys_data.data(), z.data(), n, &attr);
+    ExpectEQ<T>(z.data(), zref.data(), n);
+  }
+};
+
 template <jit::KernelType KT, typename KernelTuples, typename PlaceType,
           typename... Args>
 void TestAllImpls(const typename KernelTuples::attr_type& attr, Args... args) {
@@ -663,6 +774,29 @@ void TestKernelSeqPoolTuples() {
   }
 }
 
+template <jit::KernelType KT, typename T, typename PlaceType>
+void TestKernelMaxSeqPoolTuples() {
+  VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
+  auto test_sizes = TestSizes();
+  test_sizes.erase(std::remove(test_sizes.begin(), test_sizes.end(), 1000));
+  for (int w : test_sizes) {
+    jit::seq_pool_attr_t attr(w, jit::SeqPoolType::kMax);
+    for (int h : test_sizes) {
+      attr.h = h;
+      auto ref = jit::GetRefer<KT, jit::MaxSeqPoolTuples<T>>();
+      EXPECT_TRUE(ref != nullptr);
+      std::vector<T> x(h * w), yref(w);
+      std::vector<int> idx_ref(w);
+      RandomVec<T>(h * w, x.data(), -2.f, 2.f);
+      ref(x.data(), yref.data(), idx_ref.data(), &attr);
+      VLOG(10) << attr;
+      TestAllImpls<KT, jit::MaxSeqPoolTuples<T>, PlaceType, std::vector<T>,
+                   std::vector<T>, std::vector<int>>(attr, x, yref, idx_ref,
+                                                     attr);
+    }
+  }
+}
+
 template <jit::KernelType KT, typename T, typename PlaceType>
 void TestKernelMatMulTuples() {
   VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
@@ -691,6 +825,125 @@ void TestKernelMatMulTuples() {
   FLAGS_acc = last_acc;
 }
 
+template <jit::KernelType KT, typename PlaceType>
+void TestKernelMatMulInt8Tuples() {
+  VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
+  auto last_acc = FLAGS_acc;
+  FLAGS_acc = 1e-3;
+  for (int m : {1, 2, 3}) {
+    for (int n : {1, 15, 16, 48, 128, 256}) {
+      for (int k : {1, 2, 3, 16, 17, 100}) {
+        auto ref = jit::GetRefer<KT, jit::MatMulInt8Tuples>();
+        EXPECT_TRUE(ref != nullptr);
+        std::vector<uint8_t> a(m * k);
+        std::vector<int8_t> b(k * n);
+        std::vector<int8_t> packed_b(jit::packed_weights_int8_size(n, k));
+        std::vector<float> scale(n), bias(n);
+        RandomVec<uint8_t>(m * k, a.data(), 0, 255);
+        RandomVec<int8_t>(k * n, b.data(), -127, 127);
+        RandomVec<float>(n, scale.data(), 0.5f / (k * 64), 1.5f / (k * 64));
+        RandomVec<float>(n, bias.data(), -2.f, 2.f);
+        jit::pack_weights_int8(b.data(), packed_b.data(), n, k);
+
+        // check the refer on packed weights with the plain int32 results
+        std::vector<float> ones(n, 1.f), c_int32(m * n);
+        const jit::matmul_int8_attr_t plain_attr(m, n, k);
+        ref(a.data(), packed_b.data(), c_int32.data(), ones.data(), nullptr,
+            &plain_attr);
+        for (int i = 0; i < m; ++i) {
+          for (int j = 0; j < n; ++j) {
+            int32_t sum = 0;
+            for (int l = 0; l < k; ++l) {
+              sum += static_cast<int32_t>(a[i * k + l]) * b[l * n + j];
+            }
+            EXPECT_EQ(static_cast<float>(sum), c_int32[i * n + j]);
+          }
+        }
+
+        for (bool with_bias : {false, true}) {
+          for (bool with_relu : {false, true}) {
+            for (bool out_u8 : {false, true}) {
+              const jit::matmul_int8_attr_t attr(m, n, k, with_bias, with_relu,
+                                                 out_u8);
+              std::vector<float> cref(m * n);
+              if (out_u8) {
+                std::vector<uint8_t> cref_u8(m * n);
+                ref(a.data(), packed_b.data(), cref_u8.data(), scale.data(),
+                    bias.data(), &attr);
+                std::copy(cref_u8.begin(), cref_u8.end(), cref.begin());
+              } else {
+                ref(a.data(), packed_b.data(), cref.data(), scale.data(),
+                    bias.data(), &attr);
+              }
+              TestAllImpls<KT, jit::MatMulInt8Tuples, PlaceType,
+                           std::vector<uint8_t>, std::vector<int8_t>,
+                           std::vector<float>, std::vector<float>,
+                           std::vector<float>>(attr, a, packed_b, scale, bias,
+                                               cref, attr);
+            }
+          }
+        }
+      }
+    }
+  }
+  FLAGS_acc = last_acc;
+}
+
+template <jit::KernelType KT, typename PlaceType>
+void TestKernelXYZNTuplesBF16() {
+  using T = paddle::platform::bfloat16;
+  VLOG(10) << "===== Test JITKernel bfloat16 " << jit::to_string(KT);
+  for (int d : TestSizes()) {
+    auto ref = jit::GetRefer<KT, jit::XYZNTuples<T>>();
+    EXPECT_TRUE(ref != nullptr);
+    std::vector<T> x = RandomBF16Vec(d, -20.f, 20.f);
+    std::vector<T> y = RandomBF16Vec(d, -20.f, 20.f);
+    std::vector<T> zref(d);
+    ref(x.data(), y.data(), zref.data(), d);
+    TestAllImpls<KT, jit::XYZNTuples<T>, PlaceType, std::vector<T>,
+                 std::vector<T>, std::vector<T>>(d, x, y, zref);
+  }
+}
+
+template <jit::KernelType KT, typename PlaceType>
+void TestKernelXYNTuplesBF16() {
+  using T = paddle::platform::bfloat16;
+  VLOG(10) << "===== Test JITKernel bfloat16 " << jit::to_string(KT);
+  for (int d : TestSizes()) {
+    auto ref = jit::GetRefer<KT, jit::XYNTuples<T>>();
+    EXPECT_TRUE(ref != nullptr);
+    std::vector<T> x = RandomBF16Vec(d, -2.f, 2.f);
+    std::vector<T> yref(d);
+    ref(x.data(), yref.data(), d);
+    TestAllImpls<KT, jit::XYNTuples<T>, PlaceType, std::vector<T>,
+                 std::vector<T>>(d, x, yref);
+  }
+}
+
+template <jit::KernelType KT, typename PlaceType>
+void TestKernelMatMulTuplesBF16() {
+  using T = paddle::platform::bfloat16;
+  VLOG(10) << "===== Test JITKernel bfloat16 " << jit::to_string(KT);
+  auto last_acc = FLAGS_acc;
+  FLAGS_acc = 1e-2;
+  for (int m : {1, 3, 4, 5}) {
+    for (int n : {1, 7, 8, 17, 32}) {
+      for (int k : {1, 2, 15, 16, 100}) {
+        auto ref = jit::GetRefer<KT, jit::MatMulTuples<T>>();
+        EXPECT_TRUE(ref != nullptr);
+        std::vector<T> a = RandomBF16Vec(m * k, -2.f, 2.f);
+        std::vector<T> b = RandomBF16Vec(k * n, -2.f, 2.f);
+        std::vector<T> c(m * n);
+        const jit::matmul_attr_t attr{m, n, k};
+        ref(a.data(), b.data(), c.data(), &attr);
+        TestAllImpls<KT, jit::MatMulTuples<T>, PlaceType, std::vector<T>,
+                     std::vector<T>, std::vector<T>>(attr, a, b, c, attr);
+      }
+    }
+  }
+  FLAGS_acc = last_acc;
+}
+
 template <jit::KernelType KT, typename T, typename PlaceType>
 void TestKernelSoftmaxTuples() {
   VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
@@ -926,6 +1179,44 @@ void TestKernelCRFDecodingTuples() {
   }
 }
 
+template <jit::KernelType KT, typename T, typename PlaceType>
+void TestKernelElementwiseChainTuples() {
+  VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
+  std::vector<std::vector<jit::ChainOpType>> chains = {
+      {jit::kChainAdd, jit::kChainRelu},
+      {jit::kChainMul, jit::kChainAdd, jit::kChainSigmoid},
+      {jit::kChainScale, jit::kChainTanh, jit::kChainRSub, jit::kChainSquare},
+      {jit::kChainDiv, jit::kChainRDiv, jit::kChainMax, jit::kChainMin,
+       jit::kChainExp},
+      {jit::kChainSub, jit::kChainScale, jit::kChainAdd, jit::kChainAdd,
+       jit::kChainAdd, jit::kChainAdd, jit::kChainAdd, jit::kChainAdd,
+       jit::kChainAdd, jit::kChainTanh}};
+  for (auto& chain : chains) {
+    jit::elementwise_chain_attr_t attr;
+    for (auto op : chain) {
+      EXPECT_TRUE(attr.Append(op, 0.5f, -0.2f));
+    }
+    for (int n : TestSizes()) {
+      auto ref = jit::GetRefer<KT, jit::ElementwiseChainTuples<T>>();
+      EXPECT_TRUE(ref != nullptr);
+      std::vector<T> x(n), zref(n);
+      // keep away from zero, which could be divided
+      std::vector<std::vector<T>> ys(attr.num_inputs(), std::vector<T>(n));
+      RandomVec<T>(n, x.data(), 0.5f, 2.f);
+      std::vector<const T*> ys_data;
+      for (auto& y : ys) {
+        RandomVec<T>(n, y.data(), 0.5f, 2.f);
+        ys_data.push_back(y.data());
+      }
+      ref(x.data(), ys_data.data(), zref.data(), n, &attr);
+      VLOG(10) << attr;
+      TestAllImpls<KT, jit::ElementwiseChainTuples<T>, PlaceType,
+                   std::vector<T>, std::vector<std::vector<T>>,
+                   std::vector<T>>(attr, x, ys, zref, attr);
+    }
+  }
+}
+
 #define TEST_CPU_KERNEL(test_tuple, kernel_type)                 \
   TEST(JITKernel, kernel_type) {                                 \
     TestKernel##test_tuple<jit::kernel_type, float, CPUPlace>(); \
@@ -960,12 +1251,32 @@ TEST_CPU_KERNEL(GRUTuples, kGRUHtPart2);
 TEST_CPU_KERNEL(NCHW16CMulNCTuples, kNCHW16CMulNC);
 
 TEST_CPU_KERNEL(SeqPoolTuples, kSeqPool);
+TEST_CPU_KERNEL(MaxSeqPoolTuples, kMaxSeqPool);
 TEST_CPU_KERNEL(MatMulTuples, kMatMul);
 TEST_CPU_KERNEL(SoftmaxTuples, kSoftmax);
 TEST_CPU_KERNEL(EmbSeqPoolTuples, kEmbSeqPool);
 TEST_CPU_KERNEL(SgdTuples, kSgd);
 TEST_CPU_KERNEL(LayerNormTuples, kLayerNorm);
 TEST_CPU_KERNEL(CRFDecodingTuples, kCRFDecoding);
+TEST_CPU_KERNEL(ElementwiseChainTuples, kElementwiseChain);
+
+TEST(JITKernel, kMatMulInt8) {
+  TestKernelMatMulInt8Tuples<jit::kMatMulInt8, CPUPlace>();
+}
+
+#define TEST_CPU_KERNEL_BF16(test_tuple, kernel_type)           \
+  TEST(JITKernel, kernel_type##_bf16) {                         \
+    TestKernel##test_tuple##BF16<jit::kernel_type, CPUPlace>(); \
+  }
+
+TEST_CPU_KERNEL_BF16(XYZNTuples, kVMul);
+TEST_CPU_KERNEL_BF16(XYZNTuples, kVAdd);
+TEST_CPU_KERNEL_BF16(XYZNTuples, kVAddRelu);
+TEST_CPU_KERNEL_BF16(XYNTuples, kVRelu);
+TEST_CPU_KERNEL_BF16(XYNTuples, kVExp);
+TEST_CPU_KERNEL_BF16(XYNTuples, kVSigmoid);
+TEST_CPU_KERNEL_BF16(XYNTuples, kVTanh);
+TEST_CPU_KERNEL_BF16(MatMulTuples, kMatMul);
 
 TEST(JITKernel_key, lstm) {
   jit::lstm_attr_t attr1(8, jit::kVIdentity, jit::kVSigmoid, jit::kVTanh);
@@ -998,4 +1309,28 @@ TEST(JITKernel_key, gru) {
   EXPECT_TRUE(key2 == key3);
   EXPECT_TRUE(key3 != key4);
 }
+
+TEST(JITKernel_key, elementwise_chain) {
+  jit::elementwise_chain_attr_t attr1, attr2, attr3, attr4;
+  attr1.Append(jit::kChainAdd);
+  attr1.Append(jit::kChainRelu);
+  attr2.Append(jit::kChainAdd);
+  attr2.Append(jit::kChainRelu);
+  attr2.Append(jit::kChainAdd);
+  attr3.Append(jit::kChainAdd);
+  attr3.Append(jit::kChainRelu);
+  attr3.Append(jit::kChainAdd);
+  attr4.Append(jit::kChainScale, 2.f, 1.f);
+  attr4.Append(jit::kChainAdd);
+  attr4.Append(jit::kChainRelu);
+
+  auto key1 = jit::JitCodeKey<jit::elementwise_chain_attr_t>(attr1);
+  auto key2 = jit::JitCodeKey<jit::elementwise_chain_attr_t>(attr2);
+  auto key3 = jit::JitCodeKey<jit::elementwise_chain_attr_t>(attr3);
+  auto key4 = jit::JitCodeKey<jit::elementwise_chain_attr_t>(attr4);
+
+  EXPECT_TRUE(key1 != key2);
+  EXPECT_TRUE(key2 == key3);
+  EXPECT_TRUE(key3 != key4);
+}
 // TODO(TJ): add more test about key and pool
@@ -160,12 +160,9 @@ class LSTMKernel : public framework::OpKernel<T> {
 
     math::Batch2LoDTensorFunctor<DeviceContext, T> to_seq;
     batch_hidden.set_lod(batch_gate->lod());
-    // restore the output hidden in LoDTensor from the batch hidden
-    to_seq(device_ctx, batch_hidden, hidden_out);
-
     batch_cell.set_lod(batch_gate->lod());
-    // restore the output cell state in LoDTensor from the batch cell
-    to_seq(device_ctx, batch_cell, cell_out);
+    // restore the output hidden and cell state in LoDTensor from the batches
+    to_seq(device_ctx, {&batch_hidden, &batch_cell}, {hidden_out, cell_out});
   }
 };
 
@@ -252,18 +249,19 @@ class LSTMGradKernel : public framework::OpKernel<T> {
 
     math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
 
-    auto ToBatch = [&batch_gate, &to_batch](
-        const DeviceContext& ctx, const framework::LoDTensor& src,
-        const framework::DDim& dims, framework::LoDTensor& dst) {
+    auto InitBatch = [&batch_gate](const DeviceContext& ctx,
+                                   const framework::DDim& dims,
+                                   framework::LoDTensor& dst) {
       dst.mutable_data<T>(dims, ctx.GetPlace());
       dst.set_lod(batch_gate->lod());
-      to_batch(ctx, src, &dst, false);
     };
 
     LoDTensor batch_hidden, batch_hidden_g, batch_cell;
-    ToBatch(device_ctx, *hidden_out, out_dims, batch_hidden);
-    ToBatch(device_ctx, *hidden_g, out_dims, batch_hidden_g);
-    ToBatch(device_ctx, *cell_out, out_dims, batch_cell);
+    InitBatch(device_ctx, out_dims, batch_hidden);
+    InitBatch(device_ctx, out_dims, batch_hidden_g);
+    InitBatch(device_ctx, out_dims, batch_cell);
+    to_batch(device_ctx, {hidden_out, hidden_g, cell_out},
+             {&batch_hidden, &batch_hidden_g, &batch_cell});
 
     LoDTensor batch_cell_g, batch_gate_g;
     batch_cell_g.mutable_data<T>(out_dims, ctx.GetPlace());
@@ -238,12 +238,9 @@ class LSTMPKernel : public framework::OpKernel<T> {
 
     math::Batch2LoDTensorFunctor<DeviceContext, T> to_seq;
     batch_proj.set_lod(batch_gate->lod());
-    // restore the output hidden in LoDTensor from the batch hidden
-    to_seq(device_ctx, batch_proj, proj_out);
-
     batch_cell.set_lod(batch_gate->lod());
-    // restore the output cell state in LoDTensor from the batch cell
-    to_seq(device_ctx, batch_cell, cell_out);
+    // restore the output hidden and cell state in LoDTensor from the batches
+    to_seq(device_ctx, {&batch_proj, &batch_cell}, {proj_out, cell_out});
   }
 };
 
@@ -360,19 +357,20 @@ class LSTMPGradKernel : public framework::OpKernel<T> {
 
     math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
 
-    auto ToBatch = [&batch_gate, &to_batch](
-        const DeviceContext& ctx, const framework::LoDTensor& src,
-        const framework::DDim& dims, framework::LoDTensor& dst) {
+    auto InitBatch = [&batch_gate](const DeviceContext& ctx,
+                                   const framework::DDim& dims,
+                                   framework::LoDTensor& dst) {
       dst.mutable_data<T>(dims, ctx.GetPlace());
       dst.set_lod(batch_gate->lod());
-      to_batch(ctx, src, &dst, false);
     };
 
     LoDTensor batch_hidden_g, batch_proj, batch_proj_g, batch_cell;
     batch_hidden_g.mutable_data<T>(out_dims, ctx.GetPlace());
-    ToBatch(device_ctx, *proj_out, proj_dims, batch_proj);        // T x P
-    ToBatch(device_ctx, *projection_g, proj_dims, batch_proj_g);  // T x P
-    ToBatch(device_ctx, *cell_out, out_dims, batch_cell);         // T x D
+    InitBatch(device_ctx, proj_dims, batch_proj);    // T x P
+    InitBatch(device_ctx, proj_dims, batch_proj_g);  // T x P
+    InitBatch(device_ctx, out_dims, batch_cell);     // T x D
+    to_batch(device_ctx, {proj_out, projection_g, cell_out},
+             {&batch_proj, &batch_proj_g, &batch_cell});
 
     LoDTensor batch_cell_g, batch_gate_g;
     batch_cell_g.mutable_data<T>(out_dims, ctx.GetPlace());
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #pragma once
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <vector>
@@ -306,6 +307,116 @@ struct CBlas<platform::float16> {
 #endif
 };
 
+// bfloat16 only halves the storage, GEMM converts to float and runs sgemm so
+// that the accumulation keeps the float precision. The matrices are converted
+// a tile at a time into the scratch buffers of the thread, which are reused by
+// the following calls, so the float copies never exceed the tiles.
+template <>
+struct CBlas<platform::bfloat16> {
+  template <typename ORDER>
+  static void GEMM(ORDER order, CBLAS_TRANSPOSE transA,
+                   CBLAS_TRANSPOSE transB, int M, int N, int K,
+                   platform::bfloat16 alpha, const platform::bfloat16 *A,
+                   int lda, const platform::bfloat16 *B, int ldb,
+                   platform::bfloat16 beta, platform::bfloat16 *C, int ldc) {
+    PADDLE_ENFORCE(order == CblasRowMajor,
+                   "bfloat16 GEMM only supports the row major layout");
+    constexpr int kTileM = 256;
+    constexpr int kTileN = 1024;
+    constexpr int kTileK = 256;
+    thread_local std::vector<float> a_tile, b_tile, c_tile;
+    a_tile.resize(std::min(M, kTileM) * std::min(K, kTileK));
+    b_tile.resize(std::min(K, kTileK) * std::min(N, kTileN));
+    c_tile.resize(std::min(M, kTileM) * std::min(N, kTileN));
+    const bool trans_a = transA != CblasNoTrans;
+    const bool trans_b = transB != CblasNoTrans;
+    const float alpha_f = static_cast<float>(alpha);
+    const float beta_f = static_cast<float>(beta);
+    for (int m0 = 0; m0 < M; m0 += kTileM) {
+      const int mb = std::min(kTileM, M - m0);
+      for (int n0 = 0; n0 < N; n0 += kTileN) {
+        const int nb = std::min(kTileN, N - n0);
+        if (beta_f != 0.f) {
+          ToFloat(C, ldc, false, m0, n0, mb, nb, c_tile.data());
+        }
+        for (int k0 = 0; k0 < K; k0 += kTileK) {
+          const int kb = std::min(kTileK, K - k0);
+          ToFloat(A, lda, trans_a, m0, k0, mb, kb, a_tile.data());
+          ToFloat(B, ldb, trans_b, k0, n0, kb, nb, b_tile.data());
+          CBlas<float>::GEMM(CblasRowMajor, CblasNoTrans, CblasNoTrans, mb,
+                             nb, kb, alpha_f, a_tile.data(), kb,
+                             b_tile.data(), nb, k0 == 0 ? beta_f : 1.f,
+                             c_tile.data(), nb);
+        }
+        for (int i = 0; i < mb; ++i) {
+          for (int j = 0; j < nb; ++j) {
+            C[(m0 + i) * ldc + n0 + j] = platform::bfloat16(c_tile[i * nb + j]);
+          }
+        }
+      }
+    }
+  }
+#ifdef PADDLE_WITH_LIBXSMM
+  // column major, as libxsmm: C(m, n) is the row major C^T = B^T * A^T
+  static void SMM_GEMM(const char *transa, const char *transb, const int *m,
+                       const int *n, const int *k,
+                       const platform::bfloat16 *alpha,
+                       const platform::bfloat16 *a, const int *lda,
+                       const platform::bfloat16 *b, const int *ldb,
+                       const platform::bfloat16 *beta, platform::bfloat16 *c,
+                       const int *ldc) {
+    auto trans = [](const char *t) {
+      return (*t == 'N' || *t == 'n') ? CblasNoTrans : CblasTrans;
+    };
+    GEMM(CblasRowMajor, trans(transb), trans(transa), *n, *m, *k, *alpha, b,
+         *ldb, a, *lda, *beta, c, *ldc);
+  }
+#endif
+  static void AXPY(int n, platform::bfloat16 alpha,
+                   const platform::bfloat16 *x, int incx,
+                   platform::bfloat16 *y, int incy) {
+    const float alpha_f = static_cast<float>(alpha);
+    for (int i = 0; i < n; ++i) {
+      float sum = static_cast<float>(y[i * incy]) +
+                  alpha_f * static_cast<float>(x[i * incx]);
+      y[i * incy] = platform::bfloat16(sum);
+    }
+  }
+  static void VCOPY(int n, const platform::bfloat16 *x, int incx,
+                    platform::bfloat16 *y, int incy) {
+    for (int i = 0; i < n; ++i) {
+      y[i * incy] = x[i * incx];
+    }
+  }
+  static void VMUL(...) { PADDLE_THROW("bfloat16 VMUL not supported on CPU"); }
+  static void VEXP(...) { PADDLE_THROW("bfloat16 VEXP not supported on CPU"); }
+  static void VSQUARE(...) {
+    PADDLE_THROW("bfloat16 VSQUARE not supported on CPU");
+  }
+  static void VPOW(...) { PADDLE_THROW("bfloat16 VPOW not supported on CPU"); }
+  static void DOT(...) { PADDLE_THROW("bfloat16 DOT not supported on CPU"); }
+  static void SCAL(...) { PADDLE_THROW("bfloat16 SCAL not supported on CPU"); }
+  static void ASUM(...) { PADDLE_THROW("bfloat16 ASUM not supported on CPU"); }
+#ifdef PADDLE_WITH_MKLML
+  static void GEMM_BATCH(...) {
+    PADDLE_THROW("bfloat16 GEMM_BATCH not supported on CPU");
+  }
+#endif
+
+ private:
+  // Converts the tile [rows, cols] at (row0, col0) of x, or of x^T if trans.
+  static void ToFloat(const platform::bfloat16 *x, int ld, bool trans,
+                      int row0, int col0, int rows, int cols, float *y) {
+    for (int i = 0; i < rows; ++i) {
+      for (int j = 0; j < cols; ++j) {
+        y[i * cols + j] =
+            trans ? static_cast<float>(x[(col0 + j) * ld + row0 + i])
+                  : static_cast<float>(x[(row0 + i) * ld + col0 + j]);
+      }
+    }
+  }
+};
+
 #ifdef PADDLE_WITH_MKLML
 template <>
 template <typename T>
@@ -0,0 +1,928 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/conv_cpu.h"
+#include <algorithm>
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/im2col.h"
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+using framework::Tensor;
+
+Conv2DParam::Conv2DParam(const framework::DDim& input_dims,
+                         const framework::DDim& filter_dims,
+                         const framework::DDim& output_dims,
+                         const std::vector<int>& strides,
+                         const std::vector<int>& paddings,
+                         const std::vector<int>& dilations, int groups)
+    : groups(groups) {
+  PADDLE_ENFORCE_EQ(input_dims.size(), 4, "The input of conv2d should be 4-D.");
+  PADDLE_ENFORCE_EQ(filter_dims.size(), 4,
+                    "The filter of conv2d should be 4-D.");
+  PADDLE_ENFORCE_EQ(output_dims.size(), 4,
+                    "The output of conv2d should be 4-D.");
+  PADDLE_ENFORCE(strides.size() == 2 && paddings.size() == 2 &&
+                     dilations.size() == 2,
+                 "The strides, paddings and dilations of conv2d should have "
+                 "2 elements.");
+  batch_size = static_cast<int>(input_dims[0]);
+  input_channels = static_cast<int>(input_dims[1]);
+  input_height = static_cast<int>(input_dims[2]);
+  input_width = static_cast<int>(input_dims[3]);
+  output_channels = static_cast<int>(output_dims[1]);
+  output_height = static_cast<int>(output_dims[2]);
+  output_width = static_cast<int>(output_dims[3]);
+  filter_height = static_cast<int>(filter_dims[2]);
+  filter_width = static_cast<int>(filter_dims[3]);
+  stride_height = strides[0];
+  stride_width = strides[1];
+  padding_height = paddings[0];
+  padding_width = paddings[1];
+  dilation_height = dilations[0];
+  dilation_width = dilations[1];
+  PADDLE_ENFORCE_EQ(input_channels % groups, 0);
+  PADDLE_ENFORCE_EQ(output_channels % groups, 0);
+  PADDLE_ENFORCE_EQ(filter_dims[1] * groups, input_channels);
+}
+
+static inline int GetThreadId() {
+#ifdef PADDLE_WITH_MKLML
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+static bool IsDepthwise(const Conv2DParam& p) {
+  return p.groups > 1 && p.groups == p.input_channels &&
+         p.output_channels % p.input_channels == 0;
+}
+
+static bool Is1x1(const Conv2DParam& p) {
+  return p.filter_height == 1 && p.filter_width == 1;
+}
+
+// The input grad of the Winograd conv is also computed by Winograd with the
+// padding of 2 - padding, so the padding should not be larger than 2.
+static bool IsWinogradShape(const Conv2DParam& p) {
+  return p.groups == 1 && p.filter_height == 3 && p.filter_width == 3 &&
+         p.stride_height == 1 && p.stride_width == 1 &&
+         p.dilation_height == 1 && p.dilation_width == 1 &&
+         p.padding_height <= 2 && p.padding_width <= 2;
+}
+
+// The gemm runs on the image directly for the 1x1 filters with stride 1 and
+// without padding, the dilation makes no difference for them.
+static bool NeedUnfold(const Conv2DParam& p) {
+  return !(Is1x1(p) && p.stride_height == 1 && p.stride_width == 1 &&
+           p.padding_height == 0 && p.padding_width == 0);
+}
+
+bool Conv2DAlgoSupported(const Conv2DParam& param, Conv2DAlgo algo) {
+  switch (algo) {
+    case Conv2DAlgo::kIm2ColGemm:
+      return true;
+    case Conv2DAlgo::kDirect1x1:
+      return Is1x1(param);
+    case Conv2DAlgo::kDepthwise:
+      return IsDepthwise(param);
+    case Conv2DAlgo::kWinograd2x2:
+    case Conv2DAlgo::kWinograd4x4:
+      return IsWinogradShape(param);
+  }
+  return false;
+}
+
+// The transforms of Winograd only pay off when they are shared by enough
+// channels.
+constexpr int kWinogradMinChannels = 16;
+
+Conv2DAlgo SelectConv2DAlgo(const Conv2DParam& param) {
+  if (IsDepthwise(param)) {
+    return Conv2DAlgo::kDepthwise;
+  }
+  if (Is1x1(param)) {
+    return Conv2DAlgo::kDirect1x1;
+  }
+  if (IsWinogradShape(param) &&
+      param.input_channels >= kWinogradMinChannels &&
+      param.output_channels >= kWinogradMinChannels &&
+      param.output_height >= 4 && param.output_width >= 4) {
+    return (param.output_height >= 8 && param.output_width >= 8)
+               ? Conv2DAlgo::kWinograd4x4
+               : Conv2DAlgo::kWinograd2x2;
+  }
+  return Conv2DAlgo::kIm2ColGemm;
+}
+
+// The multiply-adds of one gemm under which it could not make use of all
+// the threads.
+constexpr int64_t kSmallGemmSize = 1 << 20;
+
+bool UseConv2DBatchParallel(const Conv2DParam& param, Conv2DAlgo algo) {
+  const int threads = platform::GetNumThreads();
+  if (threads <= 1) {
+    return false;
+  }
+  if (algo == Conv2DAlgo::kDepthwise) {
+    // no gemm at all, the images and channels are always split
+    return true;
+  }
+  const bool winograd = algo == Conv2DAlgo::kWinograd2x2 ||
+                        algo == Conv2DAlgo::kWinograd4x4;
+  const int64_t tasks = winograd ? param.batch_size
+                                 : static_cast<int64_t>(param.batch_size) *
+                                       param.groups;
+  if (tasks <= 1) {
+    return false;
+  }
+  if (tasks >= threads) {
+    return true;
+  }
+  const int64_t gemm_size =
+      static_cast<int64_t>(param.output_channels / param.groups) *
+      param.output_height * param.output_width *
+      (param.input_channels / param.groups) * param.filter_height *
+      param.filter_width;
+  return gemm_size < kSmallGemmSize;
+}
+
+const char* Conv2DAlgoName(Conv2DAlgo algo) {
+  switch (algo) {
+    case Conv2DAlgo::kIm2ColGemm:
+      return "Im2ColGemm";
+    case Conv2DAlgo::kDirect1x1:
+      return "Direct1x1";
+    case Conv2DAlgo::kDepthwise:
+      return "Depthwise";
+    case Conv2DAlgo::kWinograd2x2:
+      return "Winograd2x2";
+    case Conv2DAlgo::kWinograd4x4:
+      return "Winograd4x4";
+  }
+  return "Unknown";
+}
+
+// [c_num, height, width] of the image i from the channel c_start
+static Tensor ImageSlice(const Tensor& x, int i, int c_start, int c_num) {
+  Tensor image = x.Slice(i, i + 1);
+  image.Resize(framework::slice_ddim(x.dims(), 1, x.dims().size()));
+  return image.Slice(c_start, c_start + c_num);
+}
+
+// col: [channels, filter_height, filter_width, output_height, output_width]
+static framework::DDim ColDims(const Conv2DParam& p) {
+  return framework::make_ddim({p.input_channels / p.groups, p.filter_height,
+                               p.filter_width, p.output_height,
+                               p.output_width});
+}
+
+// Unfolds the image to the col of the gemm. The 1x1 filters only gather the
+// strided pixels, without the loops of filter positions.
+template <typename T>
+static void Unfold(const platform::CPUDeviceContext& context,
+                   const Conv2DParam& p, Conv2DAlgo algo, const Tensor& im,
+                   Tensor* col) {
+  if (algo != Conv2DAlgo::kDirect1x1) {
+    Im2ColFunctor<ColFormat::kCFO, platform::CPUDeviceContext, T> im2col;
+    im2col(context, im, {p.dilation_height, p.dilation_width},
+           {p.stride_height, p.stride_width},
+           {p.padding_height, p.padding_width, p.padding_height,
+            p.padding_width},
+           col);
+    return;
+  }
+  const int channels = static_cast<int>(im.dims()[0]);
+  const int64_t in_size = static_cast<int64_t>(p.input_height) * p.input_width;
+  const T* im_data = im.data<T>();
+  T* col_data = col->data<T>();
+  for (int c = 0; c < channels; ++c) {
+    for (int oh = 0; oh < p.output_height; ++oh) {
+      const int ih = oh * p.stride_height - p.padding_height;
+      const bool valid_h = ih >= 0 && ih < p.input_height;
+      for (int ow = 0; ow < p.output_width; ++ow) {
+        const int iw = ow * p.stride_width - p.padding_width;
+        *col_data++ = (valid_h && iw >= 0 && iw < p.input_width)
+                          ? im_data[ih * p.input_width + iw]
+                          : static_cast<T>(0);
+      }
+    }
+    im_data += in_size;
+  }
+}
+
+// Adds the col back to the image, as the reverse of Unfold.
+template <typename T>
+static void Fold(const platform::CPUDeviceContext& context,
+                 const Conv2DParam& p, Conv2DAlgo algo, const Tensor& col,
+                 Tensor* im) {
+  if (algo != Conv2DAlgo::kDirect1x1) {
+    Col2ImFunctor<ColFormat::kCFO, platform::CPUDeviceContext, T> col2im;
+    col2im(context, col, {p.dilation_height, p.dilation_width},
+           {p.stride_height, p.stride_width},
+           {p.padding_height, p.padding_width, p.padding_height,
+            p.padding_width},
+           im);
+    return;
+  }
+  const int channels = static_cast<int>(im->dims()[0]);
+  const int64_t in_size = static_cast<int64_t>(p.input_height) * p.input_width;
+  const T* col_data = col.data<T>();
+  T* im_data = im->data<T>();
+  for (int c = 0; c < channels; ++c) {
+    for (int oh = 0; oh < p.output_height; ++oh) {
+      const int ih = oh * p.stride_height - p.padding_height;
+      const bool valid_h = ih >= 0 && ih < p.input_height;
+      for (int ow = 0; ow < p.output_width; ++ow, ++col_data) {
+        const int iw = ow * p.stride_width - p.padding_width;
+        if (valid_h && iw >= 0 && iw < p.input_width) {
+          im_data[ih * p.input_width + iw] += *col_data;
+        }
+      }
+    }
+    im_data += in_size;
+  }
+}
+
+// The gemm of every image and group: out_g = filter_g * col_g, where
+// filter_g is [out_step, col_height] and col_g is [col_height, col_width].
+template <typename T>
+static void GemmConv2D(const platform::CPUDeviceContext& context,
+                       const Conv2DParam& p, Conv2DAlgo algo,
+                       const Tensor& input, const Tensor& filter,
+                       Tensor* output) {
+  const int in_step = p.input_channels / p.groups;
+  const int out_step = p.output_channels / p.groups;
+  const int col_height = in_step * p.filter_height * p.filter_width;
+  const int col_width = p.output_height * p.output_width;
+  const int64_t filter_step = static_cast<int64_t>(out_step) * col_height;
+  const int tasks = p.batch_size * p.groups;
+  const bool parallel = UseConv2DBatchParallel(p, algo);
+  const bool unfold = NeedUnfold(p);
+
+  // one col for each thread
+  const int threads = parallel ? platform::GetNumThreads() : 1;
+  std::vector<Tensor> cols(unfold ? threads : 0);
+  for (auto& col : cols) {
+    col.mutable_data<T>(ColDims(p), platform::CPUPlace());
+  }
+
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  const T* filter_data = filter.data<T>();
+  T* output_data = output->data<T>();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+  for (int t = 0; t < tasks; ++t) {
+    const int i = t / p.groups;
+    const int g = t % p.groups;
+    const int64_t out_offset =
+        (static_cast<int64_t>(i) * p.output_channels + g * out_step) *
+        col_width;
+    Tensor in_slice = ImageSlice(input, i, g * in_step, in_step);
+    const T* col_data = in_slice.data<T>();
+    if (unfold) {
+      Tensor* col = &cols[GetThreadId()];
+      Unfold<T>(context, p, algo, in_slice, col);
+      col_data = col->data<T>();
+    }
+    blas.GEMM(CblasNoTrans, CblasNoTrans, out_step, col_width, col_height,
+              static_cast<T>(1), filter_data + g * filter_step, col_data,
+              static_cast<T>(0), output_data + out_offset);
+  }
+}
+
+template <typename T>
+static void GemmConv2DGrad(const platform::CPUDeviceContext& context,
+                           const Conv2DParam& p, Conv2DAlgo algo,
+                           const Tensor& input, const Tensor& filter,
+                           const Tensor& output_grad, Tensor* input_grad,
+                           Tensor* filter_grad) {
+  const int in_step = p.input_channels / p.groups;
+  const int out_step = p.output_channels / p.groups;
+  const int col_height = in_step * p.filter_height * p.filter_width;
+  const int col_width = p.output_height * p.output_width;
+  const int64_t filter_step = static_cast<int64_t>(out_step) * col_height;
+  const int tasks = p.batch_size * p.groups;
+  const bool parallel = UseConv2DBatchParallel(p, algo);
+  const int threads = parallel ? platform::GetNumThreads() : 1;
+  const bool unfold = NeedUnfold(p);
+
+  std::vector<Tensor> cols(unfold ? threads : 0);
+  for (auto& col : cols) {
+    col.mutable_data<T>(ColDims(p), platform::CPUPlace());
+  }
+
+  SetConstant<platform::CPUDeviceContext, T> set_zero;
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  const T* filter_data = filter.data<T>();
+  const T* out_grad_data = output_grad.data<T>();
+
+  if (input_grad) {
+    // the gemm writes the input grad directly if it is not unfolded
+    if (unfold) {
+      set_zero(context, input_grad, static_cast<T>(0));
+    }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+    for (int t = 0; t < tasks; ++t) {
+      const int i = t / p.groups;
+      const int g = t % p.groups;
+      const int64_t out_offset =
+          (static_cast<int64_t>(i) * p.output_channels + g * out_step) *
+          col_width;
+      Tensor in_grad_slice = ImageSlice(*input_grad, i, g * in_step, in_step);
+      Tensor* col = unfold ? &cols[GetThreadId()] : nullptr;
+      T* col_data = unfold ? col->data<T>() : in_grad_slice.data<T>();
+      blas.GEMM(CblasTrans, CblasNoTrans, col_height, col_width, out_step,
+                static_cast<T>(1), filter_data + g * filter_step,
+                out_grad_data + out_offset, static_cast<T>(0), col_data);
+      if (unfold) {
+        Fold<T>(context, p, algo, *col, &in_grad_slice);
+      }
+    }
+  }
+
+  if (filter_grad) {
+    // The images share the filter grad, so they are split among several
+    // partial copies of it, which are accumulated in parallel and summed at
+    // last. The copies take at most kMaxFilterGradPartialBytes whatever the
+    // number of threads, e.g. 6 copies of a 512x512x3x3 float filter, and a
+    // filter larger than half of it is accumulated by one loop over the
+    // images, where only the gemm runs in parallel.
+    constexpr int64_t kMaxFilterGradPartialBytes = 64 << 20;
+    const int64_t filter_numel = filter_grad->numel();
+    const int64_t max_partials = std::max<int64_t>(
+        1, kMaxFilterGradPartialBytes /
+               static_cast<int64_t>(filter_numel * sizeof(T)));
+    const int partials =
+        static_cast<int>(std::min<int64_t>(threads, max_partials));
+    Tensor partial;
+    T* partial_data = filter_grad->data<T>();
+    if (partials > 1) {
+      partial_data = partial.mutable_data<T>({partials * filter_numel},
+                                             platform::CPUPlace());
+      set_zero(context, &partial, static_cast<T>(0));
+    } else {
+      set_zero(context, filter_grad, static_cast<T>(0));
+    }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (partials > 1)
+#endif
+    for (int part = 0; part < partials; ++part) {
+      T* filter_grad_data = partial_data + part * filter_numel;
+      Tensor* col = unfold ? &cols[GetThreadId()] : nullptr;
+      for (int t = part; t < tasks; t += partials) {
+        const int i = t / p.groups;
+        const int g = t % p.groups;
+        const int64_t out_offset =
+            (static_cast<int64_t>(i) * p.output_channels + g * out_step) *
+            col_width;
+        Tensor in_slice = ImageSlice(input, i, g * in_step, in_step);
+        const T* col_data = in_slice.data<T>();
+        if (unfold) {
+          Unfold<T>(context, p, algo, in_slice, col);
+          col_data = col->data<T>();
+        }
+        blas.GEMM(CblasNoTrans, CblasTrans, out_step, col_height, col_width,
+                  static_cast<T>(1), out_grad_data + out_offset, col_data,
+                  static_cast<T>(1), filter_grad_data + g * filter_step);
+      }
+    }
+    if (partials > 1) {
+      T* filter_grad_data = filter_grad->data<T>();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+      for (int64_t j = 0; j < filter_numel; ++j) {
+        T sum = partial_data[j];
+        for (int part = 1; part < partials; ++part) {
+          sum += partial_data[part * filter_numel + j];
+        }
+        filter_grad_data[j] = sum;
+      }
+    }
+  }
+}
+
+// Each output channel of depthwise conv2d only reads the input channel
+// oc / multiplier, so the direct loops avoid the gemm on the tiny matrices.
+template <typename T>
+static void DepthwiseConv2D(const Conv2DParam& p, const Tensor& input,
+                            const Tensor& filter, Tensor* output) {
+  const int multiplier = p.output_channels / p.input_channels;
+  const int64_t in_size = static_cast<int64_t>(p.input_height) * p.input_width;
+  const int64_t out_size =
+      static_cast<int64_t>(p.output_height) * p.output_width;
+  const int filter_size = p.filter_height * p.filter_width;
+  const int tasks = p.batch_size * p.output_channels;
+  const T* input_data = input.data<T>();
+  const T* filter_data = filter.data<T>();
+  T* output_data = output->data<T>();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int t = 0; t < tasks; ++t) {
+    const int i = t / p.output_channels;
+    const int oc = t % p.output_channels;
+    const int c = oc / multiplier;
+    const T* in = input_data + (i * p.input_channels + c) * in_size;
+    const T* w = filter_data + oc * filter_size;
+    T* out = output_data + t * out_size;
+    for (int oh = 0; oh < p.output_height; ++oh) {
+      for (int ow = 0; ow < p.output_width; ++ow) {
+        T sum = static_cast<T>(0);
+        for (int kh = 0; kh < p.filter_height; ++kh) {
+          const int ih =
+              oh * p.stride_height - p.padding_height + kh * p.dilation_height;
+          if (ih < 0 || ih >= p.input_height) {
+            continue;
+          }
+          for (int kw = 0; kw < p.filter_width; ++kw) {
+            const int iw =
+                ow * p.stride_width - p.padding_width + kw * p.dilation_width;
+            if (iw >= 0 && iw < p.input_width) {
+              sum += in[ih * p.input_width + iw] * w[kh * p.filter_width + kw];
+            }
+          }
+        }
+        out[oh * p.output_width + ow] = sum;
+      }
+    }
+  }
+}
+
+template <typename T>
+static void DepthwiseConv2DGrad(const Conv2DParam& p, const Tensor& input,
+                                const Tensor& filter,
+                                const Tensor& output_grad, Tensor* input_grad,
+                                Tensor* filter_grad) {
+  const int multiplier = p.output_channels / p.input_channels;
+  const int64_t in_size = static_cast<int64_t>(p.input_height) * p.input_width;
+  const int64_t out_size =
+      static_cast<int64_t>(p.output_height) * p.output_width;
+  const int filter_size = p.filter_height * p.filter_width;
+  const T* input_data = input.data<T>();
+  const T* filter_data = filter.data<T>();
+  const T* out_grad_data = output_grad.data<T>();
+
+  if (input_grad) {
+    // every task owns one channel of the input grad
+    const int tasks = p.batch_size * p.input_channels;
+    T* in_grad_data = input_grad->data<T>();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int t = 0; t < tasks; ++t) {
+      const int i = t / p.input_channels;
+      const int c = t % p.input_channels;
+      T* in_grad = in_grad_data + t * in_size;
+      std::fill(in_grad, in_grad + in_size, static_cast<T>(0));
+      for (int m = 0; m < multiplier; ++m) {
+        const int oc = c * multiplier + m;
+        const T* w = filter_data + oc * filter_size;
+        const T* out_grad =
+            out_grad_data + (i * p.output_channels + oc) * out_size;
+        for (int oh = 0; oh < p.output_height; ++oh) {
+          for (int ow = 0; ow < p.output_width; ++ow) {
+            const T dout = out_grad[oh * p.output_width + ow];
+            for (int kh = 0; kh < p.filter_height; ++kh) {
+              const int ih = oh * p.stride_height - p.padding_height +
+                             kh * p.dilation_height;
+              if (ih < 0 || ih >= p.input_height) {
+                continue;
+              }
+              for (int kw = 0; kw < p.filter_width; ++kw) {
+                const int iw = ow * p.stride_width - p.padding_width +
+                               kw * p.dilation_width;
+                if (iw >= 0 && iw < p.input_width) {
+                  in_grad[ih * p.input_width + iw] +=
+                      dout * w[kh * p.filter_width + kw];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  if (filter_grad) {
+    // every task owns one output channel of the filter grad
+    T* filter_grad_data = filter_grad->data<T>();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int oc = 0; oc < p.output_channels; ++oc) {
+      const int c = oc / multiplier;
+      T* w_grad = filter_grad_data + oc * filter_size;
+      std::fill(w_grad, w_grad + filter_size, static_cast<T>(0));
+      for (int i = 0; i < p.batch_size; ++i) {
+        const T* in = input_data + (i * p.input_channels + c) * in_size;
+        const T* out_grad =
+            out_grad_data + (i * p.output_channels + oc) * out_size;
+        for (int oh = 0; oh < p.output_height; ++oh) {
+          for (int ow = 0; ow < p.output_width; ++ow) {
+            const T dout = out_grad[oh * p.output_width + ow];
+            for (int kh = 0; kh < p.filter_height; ++kh) {
+              const int ih = oh * p.stride_height - p.padding_height +
+                             kh * p.dilation_height;
+              if (ih < 0 || ih >= p.input_height) {
+                continue;
+              }
+              for (int kw = 0; kw < p.filter_width; ++kw) {
+                const int iw = ow * p.stride_width - p.padding_width +
+                               kw * p.dilation_width;
+                if (iw >= 0 && iw < p.input_width) {
+                  w_grad[kh * p.filter_width + kw] +=
+                      dout * in[ih * p.input_width + iw];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/*
+ * Winograd F(MxM, 3x3) computes one MxM output tile from one (M+2)x(M+2)
+ * input tile d and the 3x3 filter g by
+ *     Y = AT * [(G * g * GT) . (BT * d * B)] * A,
+ * where . is the element-wise product. The element-wise products of all
+ * channels at the same position make one gemm, so a conv is
+ * (M+2)x(M+2) gemms between the transformed filters and input tiles.
+ */
+template <int M>
+struct WinogradMatrix;
+
+template <>
+struct WinogradMatrix<2> {
+  static const double* BT() {
+    static const double bt[] = {1, 0, -1, 0,  // NOLINT
+                                0, 1, 1,  0,  // NOLINT
+                                0, -1, 1, 0,  // NOLINT
+                                0, 1, 0,  -1};
+    return bt;
+  }
+  static const double* G() {
+    static const double g[] = {1,   0,    0,    // NOLINT
+                               0.5, 0.5,  0.5,  // NOLINT
+                               0.5, -0.5, 0.5,  // NOLINT
+                               0,   0,    1};
+    return g;
+  }
+  static const double* AT() {
+    static const double at[] = {1, 1, 1, 0,  // NOLINT
+                                0, 1, -1, -1};
+    return at;
+  }
+};
+
+template <>
+struct WinogradMatrix<4> {
+  static const double* BT() {
+    static const double bt[] = {4, 0,  -5, 0,  1, 0,  // NOLINT
+                                0, -4, -4, 1,  1, 0,  // NOLINT
+                                0, 4,  -4, -1, 1, 0,  // NOLINT
+                                0, -2, -1, 2,  1, 0,  // NOLINT
+                                0, 2,  -1, -2, 1, 0,  // NOLINT
+                                0, 4,  0,  -5, 0, 1};
+    return bt;
+  }
+  static const double* G() {
+    static const double g[] = {1.0 / 4,   0,          0,         // NOLINT
+                               -1.0 / 6,  -1.0 / 6,   -1.0 / 6,  // NOLINT
+                               -1.0 / 6,  1.0 / 6,    -1.0 / 6,  // NOLINT
+                               1.0 / 24,  1.0 / 12,   1.0 / 6,   // NOLINT
+                               1.0 / 24,  -1.0 / 12,  1.0 / 6,   // NOLINT
+                               0,         0,          1};
+    return g;
+  }
+  static const double* AT() {
+    static const double at[] = {1, 1, 1,  1, 1,  0,  // NOLINT
+                                0, 1, -1, 2, -2, 0,  // NOLINT
+                                0, 1, 1,  4, 4,  0,  // NOLINT
+                                0, 1, -1, 8, -8, 1};
+    return at;
+  }
+};
+
+// Y = L * X * LT, where L is [R, C], X is [C, C] and Y is [R, R].
+template <typename T, int R, int C>
+static inline void WinogradTransform(const double* L, const T* X, T* Y) {
+  T tmp[R * C];
+  for (int r = 0; r < R; ++r) {
+    for (int j = 0; j < C; ++j) {
+      T sum = static_cast<T>(0);
+      for (int k = 0; k < C; ++k) {
+        sum += static_cast<T>(L[r * C + k]) * X[k * C + j];
+      }
+      tmp[r * C + j] = sum;
+    }
+  }
+  for (int r = 0; r < R; ++r) {
+    for (int q = 0; q < R; ++q) {
+      T sum = static_cast<T>(0);
+      for (int k = 0; k < C; ++k) {
+        sum += tmp[r * C + k] * static_cast<T>(L[q * C + k]);
+      }
+      Y[r * R + q] = sum;
+    }
+  }
+}
+
+// U = G * g * GT for the 3x3 filters, U: [tile * tile, out_c, in_c]
+template <typename T, int M>
+static void WinogradFilterTransform(const Conv2DParam& p, const T* filter,
+                                    T* u) {
+  constexpr int kTile = M + 2;
+  constexpr int kTileSize = kTile * kTile;
+  const int channels = p.output_channels * p.input_channels;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int oc_c = 0; oc_c < channels; ++oc_c) {
+    // G is [kTile, 3], tmp = G * g and tile = tmp * GT
+    const double* g = WinogradMatrix<M>::G();
+    const T* w = filter + oc_c * 9;
+    T tmp[kTile * 3];
+    T tile[kTileSize];
+    for (int r = 0; r < kTile; ++r) {
+      for (int j = 0; j < 3; ++j) {
+        tmp[r * 3 + j] = static_cast<T>(g[r * 3]) * w[j] +
+                         static_cast<T>(g[r * 3 + 1]) * w[3 + j] +
+                         static_cast<T>(g[r * 3 + 2]) * w[6 + j];
+      }
+    }
+    for (int r = 0; r < kTile; ++r) {
+      for (int q = 0; q < kTile; ++q) {
+        tile[r * kTile + q] = tmp[r * 3] * static_cast<T>(g[q * 3]) +
+                              tmp[r * 3 + 1] * static_cast<T>(g[q * 3 + 1]) +
+                              tmp[r * 3 + 2] * static_cast<T>(g[q * 3 + 2]);
+      }
+    }
+    for (int xi = 0; xi < kTileSize; ++xi) {
+      u[static_cast<int64_t>(xi) * channels + oc_c] = tile[xi];
+    }
+  }
+}
+
+// Winograd conv of the image i, where v and m are the buffers of
+// [tile * tile, in_c, tiles] and [tile * tile, out_c, tiles].
+template <typename T, int M>
+static void WinogradImage(const platform::CPUDeviceContext& context,
+                          const Conv2DParam& p, const T* u, const T* input,
+                          T* output, T* v, T* m, bool inner_parallel) {
+  constexpr int kTile = M + 2;
+  constexpr int kTileSize = kTile * kTile;
+  const int tiles_h = (p.output_height + M - 1) / M;
+  const int tiles_w = (p.output_width + M - 1) / M;
+  const int tiles = tiles_h * tiles_w;
+  const int64_t in_size = static_cast<int64_t>(p.input_height) * p.input_width;
+  const int64_t out_size =
+      static_cast<int64_t>(p.output_height) * p.output_width;
+
+  // V = BT * d * B of every input tile
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (inner_parallel)
+#endif
+  for (int c = 0; c < p.input_channels; ++c) {
+    const T* in = input + c * in_size;
+    T d[kTileSize];
+    T tile[kTileSize];
+    for (int th = 0; th < tiles_h; ++th) {
+      for (int tw = 0; tw < tiles_w; ++tw) {
+        const int h_start = th * M - p.padding_height;
+        const int w_start = tw * M - p.padding_width;
+        for (int r = 0; r < kTile; ++r) {
+          const int ih = h_start + r;
+          for (int q = 0; q < kTile; ++q) {
+            const int iw = w_start + q;
+            d[r * kTile + q] = (ih >= 0 && ih < p.input_height && iw >= 0 &&
+                                iw < p.input_width)
+                                   ? in[ih * p.input_width + iw]
+                                   : static_cast<T>(0);
+          }
+        }
+        WinogradTransform<T, kTile, kTile>(WinogradMatrix<M>::BT(), d, tile);
+        const int tile_idx = th * tiles_w + tw;
+        for (int xi = 0; xi < kTileSize; ++xi) {
+          v[(static_cast<int64_t>(xi) * p.input_channels + c) * tiles +
+            tile_idx] = tile[xi];
+        }
+      }
+    }
+  }
+
+  // M[xi] = U[xi] * V[xi]
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  for (int xi = 0; xi < kTileSize; ++xi) {
+    blas.GEMM(CblasNoTrans, CblasNoTrans, p.output_channels, tiles,
+              p.input_channels, static_cast<T>(1),
+              u + static_cast<int64_t>(xi) * p.output_channels *
+                      p.input_channels,
+              v + static_cast<int64_t>(xi) * p.input_channels * tiles,
+              static_cast<T>(0),
+              m + static_cast<int64_t>(xi) * p.output_channels * tiles);
+  }
+
+  // Y = AT * M * A, cropped at the right and bottom edges
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (inner_parallel)
+#endif
+  for (int oc = 0; oc < p.output_channels; ++oc) {
+    T* out = output + oc * out_size;
+    T tile[kTileSize];
+    T y[M * M];
+    for (int th = 0; th < tiles_h; ++th) {
+      for (int tw = 0; tw < tiles_w; ++tw) {
+        const int tile_idx = th * tiles_w + tw;
+        for (int xi = 0; xi < kTileSize; ++xi) {
+          tile[xi] = m[(static_cast<int64_t>(xi) * p.output_channels + oc) *
+                           tiles +
+                       tile_idx];
+        }
+        WinogradTransform<T, M, kTile>(WinogradMatrix<M>::AT(), tile, y);
+        const int h_num = std::min(M, p.output_height - th * M);
+        const int w_num = std::min(M, p.output_width - tw * M);
+        for (int r = 0; r < h_num; ++r) {
+          for (int q = 0; q < w_num; ++q) {
+            out[(th * M + r) * p.output_width + tw * M + q] = y[r * M + q];
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename T, int M>
+static void WinogradConv2D(const platform::CPUDeviceContext& context,
+                           const Conv2DParam& p, Conv2DAlgo algo,
+                           const Tensor& input, const Tensor& filter,
+                           Tensor* output) {
+  constexpr int kTile = M + 2;
+  constexpr int kTileSize = kTile * kTile;
+  const int tiles = ((p.output_height + M - 1) / M) *
+                    ((p.output_width + M - 1) / M);
+  const bool parallel = UseConv2DBatchParallel(p, algo);
+  const int threads = parallel ? platform::GetNumThreads() : 1;
+
+  Tensor u;
+  T* u_data = u.mutable_data<T>(
+      {kTileSize, p.output_channels, p.input_channels}, platform::CPUPlace());
+  WinogradFilterTransform<T, M>(p, filter.data<T>(), u_data);
+
+  const int64_t v_size =
+      static_cast<int64_t>(kTileSize) * p.input_channels * tiles;
+  const int64_t m_size =
+      static_cast<int64_t>(kTileSize) * p.output_channels * tiles;
+  Tensor v, m;
+  T* v_data = v.mutable_data<T>({threads * v_size}, platform::CPUPlace());
+  T* m_data = m.mutable_data<T>({threads * m_size}, platform::CPUPlace());
+
+  const int64_t in_numel =
+      static_cast<int64_t>(p.input_channels) * p.input_height * p.input_width;
+  const int64_t out_numel = static_cast<int64_t>(p.output_channels) *
+                            p.output_height * p.output_width;
+  const T* input_data = input.data<T>();
+  T* output_data = output->data<T>();
+  if (parallel) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < p.batch_size; ++i) {
+      const int tid = GetThreadId();
+      WinogradImage<T, M>(context, p, u_data, input_data + i * in_numel,
+                          output_data + i * out_numel, v_data + tid * v_size,
+                          m_data + tid * m_size, false);
+    }
+  } else {
+    for (int i = 0; i < p.batch_size; ++i) {
+      WinogradImage<T, M>(context, p, u_data, input_data + i * in_numel,
+                          output_data + i * out_numel, v_data, m_data, true);
+    }
+  }
+}
+
+template <typename T, int M>
+static void WinogradConv2DGrad(const platform::CPUDeviceContext& context,
+                               const Conv2DParam& p, Conv2DAlgo algo,
+                               const Tensor& input, const Tensor& filter,
+                               const Tensor& output_grad, Tensor* input_grad,
+                               Tensor* filter_grad) {
+  if (input_grad) {
+    // With stride 1, the input grad is the conv of the output grad with the
+    // filter rotated by 180 degrees and transposed to [in_c, out_c, 3, 3],
+    // on the padding of 2 - padding.
+    Tensor rotated;
+    T* rotated_data = rotated.mutable_data<T>(
+        {p.input_channels, p.output_channels, 3, 3}, platform::CPUPlace());
+    const T* filter_data = filter.data<T>();
+    for (int oc = 0; oc < p.output_channels; ++oc) {
+      for (int c = 0; c < p.input_channels; ++c) {
+        const T* w = filter_data + (oc * p.input_channels + c) * 9;
+        T* w_rot = rotated_data + (c * p.output_channels + oc) * 9;
+        for (int k = 0; k < 9; ++k) {
+          w_rot[k] = w[8 - k];
+        }
+      }
+    }
+    Conv2DParam grad_param = p;
+    grad_param.input_channels = p.output_channels;
+    grad_param.input_height = p.output_height;
+    grad_param.input_width = p.output_width;
+    grad_param.output_channels = p.input_channels;
+    grad_param.output_height = p.input_height;
+    grad_param.output_width = p.input_width;
+    grad_param.padding_height = 2 - p.padding_height;
+    grad_param.padding_width = 2 - p.padding_width;
+    WinogradConv2D<T, M>(context, grad_param, algo, output_grad, rotated,
+                         input_grad);
+  }
+  if (filter_grad) {
+    GemmConv2DGrad<T>(context, p, Conv2DAlgo::kIm2ColGemm, input, filter,
+                      output_grad, nullptr, filter_grad);
+  }
+}
+
+template <typename T>
+void Conv2DFunctor<T>::operator()(const platform::CPUDeviceContext& context,
+                                  const Conv2DParam& param, Conv2DAlgo algo,
+                                  const Tensor& input, const Tensor& filter,
+                                  Tensor* output) {
+  PADDLE_ENFORCE(Conv2DAlgoSupported(param, algo),
+                 "The conv2d algorithm %s does not support this shape.",
+                 Conv2DAlgoName(algo));
+  switch (algo) {
+    case Conv2DAlgo::kDepthwise:
+      DepthwiseConv2D<T>(param, input, filter, output);
+      break;
+    case Conv2DAlgo::kWinograd2x2:
+      WinogradConv2D<T, 2>(context, param, algo, input, filter, output);
+      break;
+    case Conv2DAlgo::kWinograd4x4:
+      WinogradConv2D<T, 4>(context, param, algo, input, filter, output);
+      break;
+    default:
+      GemmConv2D<T>(context, param, algo, input, filter, output);
+  }
+}
+
+template <typename T>
+void Conv2DGradFunctor<T>::operator()(
+    const platform::CPUDeviceContext& context, const Conv2DParam& param,
+    Conv2DAlgo algo, const Tensor& input, const Tensor& filter,
+    const Tensor& output_grad, Tensor* input_grad, Tensor* filter_grad) {
+  PADDLE_ENFORCE(Conv2DAlgoSupported(param, algo),
+                 "The conv2d algorithm %s does not support this shape.",
+                 Conv2DAlgoName(algo));
+  switch (algo) {
+    case Conv2DAlgo::kDepthwise:
+      DepthwiseConv2DGrad<T>(param, input, filter, output_grad, input_grad,
+                             filter_grad);
+      break;
+    case Conv2DAlgo::kWinograd2x2:
+      WinogradConv2DGrad<T, 2>(context, param, algo, input, filter,
+                               output_grad, input_grad, filter_grad);
+      break;
+    case Conv2DAlgo::kWinograd4x4:
+      WinogradConv2DGrad<T, 4>(context, param, algo, input, filter,
+                               output_grad, input_grad, filter_grad);
+      break;
+    default:
+      GemmConv2DGrad<T>(context, param, algo, input, filter, output_grad,
+                        input_grad, filter_grad);
+  }
+}
+
+template class Conv2DFunctor<float>;
+template class Conv2DFunctor<double>;
+template class Conv2DGradFunctor<float>;
+template class Conv2DGradFunctor<double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
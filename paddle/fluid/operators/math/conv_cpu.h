@@ -0,0 +1,119 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * \brief The shape and attributes of one conv2d on NCHW data.
+ *
+ * input:  [batch_size, input_channels, input_height, input_width]
+ * filter: [output_channels, input_channels / groups, filter_height,
+ *          filter_width]
+ * output: [batch_size, output_channels, output_height, output_width]
+ */
+struct Conv2DParam {
+  Conv2DParam(const framework::DDim& input_dims,
+              const framework::DDim& filter_dims,
+              const framework::DDim& output_dims,
+              const std::vector<int>& strides,
+              const std::vector<int>& paddings,
+              const std::vector<int>& dilations, int groups);
+
+  int batch_size;
+  int groups;
+  int input_channels;
+  int input_height;
+  int input_width;
+  int output_channels;
+  int output_height;
+  int output_width;
+  int filter_height;
+  int filter_width;
+  int stride_height;
+  int stride_width;
+  int padding_height;
+  int padding_width;
+  int dilation_height;
+  int dilation_width;
+};
+
+/*
+ * The algorithms of the CPU conv2d engine.
+ *
+ * kIm2ColGemm:  im2col + gemm for each image and group, the default one.
+ * kDirect1x1:   1x1 filters, gemm on the input directly, or on the strided
+ *               pixels gathered without the col of filter positions.
+ * kDepthwise:   groups == input_channels, direct loops without gemm.
+ * kWinograd2x2: F(2x2, 3x3) Winograd for 3x3 filters with stride 1.
+ * kWinograd4x4: F(4x4, 3x3) Winograd for 3x3 filters with stride 1, which
+ *               saves more multiplications on the larger outputs.
+ */
+enum class Conv2DAlgo {
+  kIm2ColGemm = 0,
+  kDirect1x1 = 1,
+  kDepthwise = 2,
+  kWinograd2x2 = 3,
+  kWinograd4x4 = 4,
+};
+
+// Returns the fastest algorithm for the shape.
+Conv2DAlgo SelectConv2DAlgo(const Conv2DParam& param);
+
+// Whether the algorithm could compute the shape.
+bool Conv2DAlgoSupported(const Conv2DParam& param, Conv2DAlgo algo);
+
+// Whether the images and groups are computed in parallel, each by one
+// thread with a single-threaded gemm. Otherwise they are computed one by
+// one and the gemm itself runs in parallel, which suits the large images.
+bool UseConv2DBatchParallel(const Conv2DParam& param, Conv2DAlgo algo);
+
+const char* Conv2DAlgoName(Conv2DAlgo algo);
+
+/*
+ * \brief The conv2d engine on CPU. The output, input_grad and filter_grad
+ *        should have been allocated, and all of them are overwritten.
+ *        input_grad or filter_grad could be nullptr if it is not required.
+ */
+template <typename T>
+class Conv2DFunctor {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const Conv2DParam& param, Conv2DAlgo algo,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter, framework::Tensor* output);
+};
+
+template <typename T>
+class Conv2DGradFunctor {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const Conv2DParam& param, Conv2DAlgo algo,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const framework::Tensor& output_grad,
+                  framework::Tensor* input_grad,
+                  framework::Tensor* filter_grad);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
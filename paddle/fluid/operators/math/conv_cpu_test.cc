@@ -0,0 +1,213 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/conv_cpu.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace math = paddle::operators::math;
+using paddle::framework::Tensor;
+
+struct ConvShape {
+  int n, c, h, w, oc, kh, kw, stride, pad, dilation, groups;
+};
+
+template <typename T>
+void RandomTensor(Tensor* t, const paddle::framework::DDim& dims,
+                  std::mt19937* engine) {
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  T* data = t->mutable_data<T>(dims, paddle::platform::CPUPlace());
+  for (int64_t i = 0; i < t->numel(); ++i) {
+    data[i] = static_cast<T>(dist(*engine));
+  }
+}
+
+// The direct loops of conv2d and its grads as the reference.
+template <typename T>
+void NaiveConv2D(const math::Conv2DParam& p, const T* x, const T* w,
+                 const T* dy, T* y, T* dx, T* dw) {
+  const int in_step = p.input_channels / p.groups;
+  const int out_step = p.output_channels / p.groups;
+  std::fill(dx, dx + p.batch_size * p.input_channels * p.input_height *
+                         p.input_width,
+            static_cast<T>(0));
+  std::fill(dw, dw + p.output_channels * in_step * p.filter_height *
+                         p.filter_width,
+            static_cast<T>(0));
+  for (int i = 0; i < p.batch_size; ++i) {
+    for (int oc = 0; oc < p.output_channels; ++oc) {
+      const int g = oc / out_step;
+      for (int oh = 0; oh < p.output_height; ++oh) {
+        for (int ow = 0; ow < p.output_width; ++ow) {
+          const int out_idx =
+              ((i * p.output_channels + oc) * p.output_height + oh) *
+                  p.output_width +
+              ow;
+          T sum = 0;
+          for (int c = 0; c < in_step; ++c) {
+            const int ic = g * in_step + c;
+            for (int kh = 0; kh < p.filter_height; ++kh) {
+              const int ih = oh * p.stride_height - p.padding_height +
+                             kh * p.dilation_height;
+              for (int kw = 0; kw < p.filter_width; ++kw) {
+                const int iw = ow * p.stride_width - p.padding_width +
+                               kw * p.dilation_width;
+                if (ih < 0 || ih >= p.input_height || iw < 0 ||
+                    iw >= p.input_width) {
+                  continue;
+                }
+                const int in_idx =
+                    ((i * p.input_channels + ic) * p.input_height + ih) *
+                        p.input_width +
+                    iw;
+                const int w_idx =
+                    ((oc * in_step + c) * p.filter_height + kh) *
+                        p.filter_width +
+                    kw;
+                sum += x[in_idx] * w[w_idx];
+                dx[in_idx] += dy[out_idx] * w[w_idx];
+                dw[w_idx] += dy[out_idx] * x[in_idx];
+              }
+            }
+          }
+          y[out_idx] = sum;
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void ExpectNear(const Tensor& actual, const std::vector<T>& expected,
+                double rtol, const char* name, math::Conv2DAlgo algo) {
+  const T* data = actual.data<T>();
+  ASSERT_EQ(actual.numel(), static_cast<int64_t>(expected.size()));
+  for (size_t i = 0; i < expected.size(); ++i) {
+    const double ref = static_cast<double>(expected[i]);
+    const double tol = rtol * std::max(1.0, std::fabs(ref));
+    ASSERT_NEAR(data[i], expected[i], tol)
+        << name << " of " << math::Conv2DAlgoName(algo) << " at " << i;
+  }
+}
+
+template <typename T>
+void TestConv2D(const ConvShape& s, double rtol) {
+  std::mt19937 engine(2019);
+  const int oh = (s.h + 2 * s.pad - (s.dilation * (s.kh - 1) + 1)) / s.stride +
+                 1;
+  const int ow = (s.w + 2 * s.pad - (s.dilation * (s.kw - 1) + 1)) / s.stride +
+                 1;
+  auto input_dims = paddle::framework::make_ddim({s.n, s.c, s.h, s.w});
+  auto filter_dims =
+      paddle::framework::make_ddim({s.oc, s.c / s.groups, s.kh, s.kw});
+  auto output_dims = paddle::framework::make_ddim({s.n, s.oc, oh, ow});
+  math::Conv2DParam param(input_dims, filter_dims, output_dims,
+                          {s.stride, s.stride}, {s.pad, s.pad},
+                          {s.dilation, s.dilation}, s.groups);
+
+  Tensor input, filter, output_grad;
+  RandomTensor<T>(&input, input_dims, &engine);
+  RandomTensor<T>(&filter, filter_dims, &engine);
+  RandomTensor<T>(&output_grad, output_dims, &engine);
+
+  std::vector<T> ref_output(output_grad.numel());
+  std::vector<T> ref_input_grad(input.numel());
+  std::vector<T> ref_filter_grad(filter.numel());
+  NaiveConv2D<T>(param, input.data<T>(), filter.data<T>(),
+                 output_grad.data<T>(), ref_output.data(),
+                 ref_input_grad.data(), ref_filter_grad.data());
+
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  math::Conv2DFunctor<T> conv2d;
+  math::Conv2DGradFunctor<T> conv2d_grad;
+  const math::Conv2DAlgo algos[] = {
+      math::Conv2DAlgo::kIm2ColGemm, math::Conv2DAlgo::kDirect1x1,
+      math::Conv2DAlgo::kDepthwise, math::Conv2DAlgo::kWinograd2x2,
+      math::Conv2DAlgo::kWinograd4x4};
+  for (auto algo : algos) {
+    if (!math::Conv2DAlgoSupported(param, algo)) continue;
+    Tensor output, input_grad, filter_grad;
+    output.mutable_data<T>(output_dims, paddle::platform::CPUPlace());
+    input_grad.mutable_data<T>(input_dims, paddle::platform::CPUPlace());
+    filter_grad.mutable_data<T>(filter_dims, paddle::platform::CPUPlace());
+    conv2d(context, param, algo, input, filter, &output);
+    ExpectNear<T>(output, ref_output, rtol, "output", algo);
+
+    conv2d_grad(context, param, algo, input, filter, output_grad, &input_grad,
+                &filter_grad);
+    ExpectNear<T>(input_grad, ref_input_grad, rtol, "input_grad", algo);
+    ExpectNear<T>(filter_grad, ref_filter_grad, rtol, "filter_grad", algo);
+
+    // only one of the grads
+    Tensor input_grad_only;
+    input_grad_only.mutable_data<T>(input_dims, paddle::platform::CPUPlace());
+    conv2d_grad(context, param, algo, input, filter, output_grad,
+                &input_grad_only, nullptr);
+    ExpectNear<T>(input_grad_only, ref_input_grad, rtol, "input_grad", algo);
+  }
+}
+
+const ConvShape kShapes[] = {
+    // n, c, h, w, oc, kh, kw, stride, pad, dilation, groups
+    {2, 3, 7, 9, 4, 3, 3, 1, 1, 1, 1},      // im2col
+    {2, 4, 8, 8, 6, 3, 3, 2, 1, 2, 2},      // groups, stride and dilation
+    {3, 8, 6, 7, 5, 1, 1, 1, 0, 1, 1},      // 1x1 without col
+    {2, 6, 9, 7, 4, 1, 1, 2, 1, 1, 2},      // 1x1 strided and padded
+    {2, 4, 9, 9, 8, 3, 3, 1, 1, 1, 4},      // depthwise with multiplier 2
+    {2, 5, 10, 8, 5, 5, 5, 2, 2, 1, 5},     // depthwise 5x5 strided
+    {2, 16, 6, 5, 16, 3, 3, 1, 1, 1, 1},    // Winograd tail tiles
+    {1, 17, 11, 13, 18, 3, 3, 1, 0, 1, 1},  // Winograd without padding
+    {3, 16, 12, 10, 20, 3, 3, 1, 2, 1, 1},  // Winograd with padding 2
+};
+
+TEST(Conv2D, Float) {
+  for (auto& shape : kShapes) {
+    TestConv2D<float>(shape, 1e-3);
+  }
+}
+
+TEST(Conv2D, Double) {
+  for (auto& shape : kShapes) {
+    TestConv2D<double>(shape, 1e-9);
+  }
+}
+
+TEST(Conv2D, SelectAlgo) {
+  auto select = [](const ConvShape& s) {
+    const int oh = (s.h + 2 * s.pad - s.kh) / s.stride + 1;
+    const int ow = (s.w + 2 * s.pad - s.kw) / s.stride + 1;
+    math::Conv2DParam param(
+        paddle::framework::make_ddim({s.n, s.c, s.h, s.w}),
+        paddle::framework::make_ddim({s.oc, s.c / s.groups, s.kh, s.kw}),
+        paddle::framework::make_ddim({s.n, s.oc, oh, ow}),
+        {s.stride, s.stride}, {s.pad, s.pad}, {1, 1}, s.groups);
+    return math::SelectConv2DAlgo(param);
+  };
+  EXPECT_EQ(select({1, 32, 14, 14, 32, 3, 3, 1, 1, 1, 32}),
+            math::Conv2DAlgo::kDepthwise);
+  EXPECT_EQ(select({1, 32, 14, 14, 64, 1, 1, 1, 0, 1, 1}),
+            math::Conv2DAlgo::kDirect1x1);
+  EXPECT_EQ(select({1, 32, 14, 14, 64, 3, 3, 1, 1, 1, 1}),
+            math::Conv2DAlgo::kWinograd4x4);
+  EXPECT_EQ(select({1, 32, 6, 6, 64, 3, 3, 1, 1, 1, 1}),
+            math::Conv2DAlgo::kWinograd2x2);
+  EXPECT_EQ(select({1, 3, 14, 14, 64, 3, 3, 1, 1, 1, 1}),
+            math::Conv2DAlgo::kIm2ColGemm);
+  EXPECT_EQ(select({1, 32, 14, 14, 64, 3, 3, 2, 1, 1, 1}),
+            math::Conv2DAlgo::kIm2ColGemm);
+}
@@ -14,6 +14,11 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 
@@ -51,6 +56,167 @@ inline void FCCompute(const BlasT<DeviceContext, T>& blas, const int M,
   }
 }
 
+// Computes the quantized uint8 X(M,K) * int8 W(K,N) by the jit int8 matmul.
+// The quantized data equals the real data multiplied by its scale, so the
+// output is dequantized to float, or requantized to uint8 with scale_out,
+// after adding the float bias and relu.
+class FCInt8Functor {
+ public:
+  // W is (N,K) if trans_w, and scale_weights is per output channel or global.
+  FCInt8Functor(const int8_t* w, int n, int k, bool trans_w, float scale_in,
+                const std::vector<float>& scale_weights, float scale_out,
+                const float* bias, bool with_relu, bool out_u8)
+      : attr_(0, n, k, bias != nullptr, with_relu, out_u8) {
+    PADDLE_ENFORCE(scale_weights.size() == 1 ||
+                       scale_weights.size() == static_cast<size_t>(n),
+                   "The size of Scale_weights should be 1 or %d", n);
+    platform::CPUPlace place;
+    packed_w_.Resize(
+        {static_cast<int64_t>(jit::packed_weights_int8_size(n, k))});
+    if (trans_w) {
+      framework::Tensor w_t;
+      int8_t* w_t_data = w_t.mutable_data<int8_t>({k, n}, place);
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < k; ++j) {
+          w_t_data[j * n + i] = w[i * k + j];
+        }
+      }
+      jit::pack_weights_int8(w_t_data, packed_w_.mutable_data<int8_t>(place),
+                             n, k);
+    } else {
+      jit::pack_weights_int8(w, packed_w_.mutable_data<int8_t>(place), n, k);
+    }
+
+    const float out_scale = out_u8 ? scale_out : 1.f;
+    float* scales = scales_.mutable_data<float>({n}, place);
+    for (int i = 0; i < n; ++i) {
+      float scale_w =
+          scale_weights.size() == 1 ? scale_weights[0] : scale_weights[i];
+      scales[i] = out_scale / (scale_in * scale_w);
+    }
+    if (bias) {
+      float* scaled_bias = bias_.mutable_data<float>({n}, place);
+      for (int i = 0; i < n; ++i) {
+        scaled_bias[i] = bias[i] * out_scale;
+      }
+    }
+    func_ = jit::Get<jit::kMatMulInt8, jit::MatMulInt8Tuples,
+                     platform::CPUPlace>(attr_);
+  }
+
+  // out is float or uint8 as the out_u8 given
+  void operator()(const uint8_t* x, int m, void* out) const {
+    constexpr int kRowsPerTask = 16;
+    const int num_tasks = (m + kRowsPerTask - 1) / kRowsPerTask;
+    const size_t out_row_size =
+        attr_.n * (attr_.out_u8 ? sizeof(uint8_t) : sizeof(float));
+    const int8_t* w_data = packed_w_.data<int8_t>();
+    const float* scales = scales_.data<float>();
+    const float* bias = attr_.with_bias ? bias_.data<float>() : nullptr;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int t = 0; t < num_tasks; ++t) {
+      const int row = t * kRowsPerTask;
+      jit::matmul_int8_attr_t attr = attr_;
+      attr.m = std::min(kRowsPerTask, m - row);
+      func_(x + row * attr.k, w_data,
+            reinterpret_cast<uint8_t*>(out) + row * out_row_size, scales, bias,
+            &attr);
+    }
+  }
+
+ private:
+  jit::matmul_int8_attr_t attr_;
+  jit::MatMulInt8Tuples::func_type func_;
+  framework::Tensor packed_w_;
+  framework::Tensor scales_;
+  framework::Tensor bias_;
+};
+
+// Packing the weights costs as much as several runs of a small matmul, so the
+// functors of the int8 inference ops are cached by the data of their weights
+// and built at the first run only. The weights of inference are not changed
+// in place, so an entry is reused while the memory of its weight and bias is
+// alive and the scales are the same, and rebuilt otherwise.
+class FCInt8FunctorCache {
+ public:
+  static FCInt8FunctorCache& Instance() {
+    static FCInt8FunctorCache cache;
+    return cache;
+  }
+
+  // W is the int8 tensor of (N,K) if trans_w, and bias is nullable.
+  std::shared_ptr<const FCInt8Functor> Get(
+      const framework::Tensor& w, int n, int k, bool trans_w, float scale_in,
+      const std::vector<float>& scale_weights, float scale_out,
+      const framework::Tensor* bias, bool with_relu, bool out_u8) {
+    const int8_t* w_data = w.data<int8_t>();
+    const float* bias_data = bias ? bias->data<float>() : nullptr;
+    Entry key;
+    key.w_holder = w.Holder();
+    if (bias) {
+      key.bias_holder = bias->Holder();
+    }
+    key.bias_data = bias_data;
+    key.n = n;
+    key.k = k;
+    key.trans_w = trans_w;
+    key.with_relu = with_relu;
+    key.out_u8 = out_u8;
+    key.scale_in = scale_in;
+    key.scale_out = scale_out;
+    key.scale_weights = scale_weights;
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = entries_.find(w_data);
+    if (it != entries_.end() && it->second.Matches(key)) {
+      return it->second.fc;
+    }
+    // drop the entries whose weights are released
+    for (auto e = entries_.begin(); e != entries_.end();) {
+      e = e->second.w_holder.expired() ? entries_.erase(e) : std::next(e);
+    }
+    key.fc = std::make_shared<const FCInt8Functor>(
+        w_data, n, k, trans_w, scale_in, scale_weights, scale_out, bias_data,
+        with_relu, out_u8);
+    Entry& entry = entries_[w_data];
+    entry = std::move(key);
+    return entry.fc;
+  }
+
+ private:
+  FCInt8FunctorCache() = default;
+
+  struct Entry {
+    bool Matches(const Entry& key) const {
+      return !w_holder.expired() && w_holder.lock() == key.w_holder.lock() &&
+             bias_data == key.bias_data &&
+             bias_holder.lock() == key.bias_holder.lock() && n == key.n &&
+             k == key.k && trans_w == key.trans_w &&
+             with_relu == key.with_relu && out_u8 == key.out_u8 &&
+             scale_in == key.scale_in && scale_out == key.scale_out &&
+             scale_weights == key.scale_weights;
+    }
+
+    std::weak_ptr<memory::Allocation> w_holder;
+    std::weak_ptr<memory::Allocation> bias_holder;
+    const float* bias_data{nullptr};
+    int n{0};
+    int k{0};
+    bool trans_w{false};
+    bool with_relu{false};
+    bool out_u8{false};
+    float scale_in{1.f};
+    float scale_out{1.f};
+    std::vector<float> scale_weights;
+    std::shared_ptr<const FCInt8Functor> fc;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<const int8_t*, Entry> entries_;
+};
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence2batch.h"
+#include <deque>
+#include <mutex>  // NOLINT
 
 namespace paddle {
 namespace operators {
@@ -23,34 +25,197 @@ class CopyMatrixRowsFunctor<platform::CPUDeviceContext, T> {
  public:
   void operator()(const platform::CPUDeviceContext& context,
                   const framework::Tensor& src,
-                  framework::Vector<size_t> index_lod, framework::Tensor* dst,
+                  const framework::Vector<size_t>& index_lod,
+                  framework::Tensor* dst, bool is_src_index) {
+    (*this)(context, std::vector<const framework::Tensor*>{&src}, index_lod,
+            std::vector<framework::Tensor*>{dst}, is_src_index);
+  }
+
+  void operator()(const platform::CPUDeviceContext& context,
+                  const std::vector<const framework::Tensor*>& srcs,
+                  const framework::Vector<size_t>& index_lod,
+                  const std::vector<framework::Tensor*>& dsts,
                   bool is_src_index) {
-    size_t* index = index_lod.data();
-    auto src_dims = src.dims();
-    auto dst_dims = dst->dims();
-    PADDLE_ENFORCE_EQ(src_dims.size(), 2UL,
-                      "The src must be matrix with rank 2.");
-    PADDLE_ENFORCE_EQ(dst_dims.size(), 2UL,
-                      "The dst must be matrix with rank 2.");
-    PADDLE_ENFORCE_EQ(src_dims[1], dst_dims[1],
-                      "The width of src and dst must be same.");
-    auto height = dst_dims[0];
-    auto width = dst_dims[1];
-    auto* src_data = src.data<T>();
-    auto* dst_data = dst->data<T>();
-    const int sz = width * sizeof(T);
-    if (is_src_index) {
-      for (int i = 0; i < height; ++i) {
-        memcpy(dst_data + i * width, src_data + index[i] * width, sz);
-      }
-    } else {
-      for (int i = 0; i < height; ++i) {
-        memcpy(dst_data + index[i] * width, src_data + i * width, sz);
+    PADDLE_ENFORCE_EQ(srcs.size(), dsts.size());
+    const size_t* index = index_lod.data();
+    std::vector<const T*> src_datas;
+    std::vector<T*> dst_datas;
+    std::vector<int64_t> widths;
+    int64_t height = 0;
+    int64_t total_width = 0;
+    for (size_t i = 0; i < srcs.size(); ++i) {
+      auto src_dims = srcs[i]->dims();
+      auto dst_dims = dsts[i]->dims();
+      PADDLE_ENFORCE_EQ(src_dims.size(), 2UL,
+                        "The src must be matrix with rank 2.");
+      PADDLE_ENFORCE_EQ(dst_dims.size(), 2UL,
+                        "The dst must be matrix with rank 2.");
+      PADDLE_ENFORCE_EQ(src_dims[1], dst_dims[1],
+                        "The width of src and dst must be same.");
+      PADDLE_ENFORCE(i == 0 || dst_dims[0] == height,
+                     "The dsts must have the same height.");
+      height = dst_dims[0];
+      widths.push_back(dst_dims[1]);
+      total_width += dst_dims[1];
+      src_datas.push_back(srcs[i]->data<T>());
+      dst_datas.push_back(dsts[i]->data<T>());
+    }
+
+    // Every thread copies a block of rows of all the tensors.
+    constexpr int64_t kParallelMinNumel = 1 << 16;
+    constexpr int64_t kBlockRows = 64;
+    const int64_t num_blocks = (height + kBlockRows - 1) / kBlockRows;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (num_blocks > 1 && \
+                             height * total_width >= kParallelMinNumel)
+#endif
+    for (int64_t b = 0; b < num_blocks; ++b) {
+      const int64_t end = std::min(height, (b + 1) * kBlockRows);
+      for (size_t t = 0; t < src_datas.size(); ++t) {
+        const int64_t width = widths[t];
+        const T* src_data = src_datas[t];
+        T* dst_data = dst_datas[t];
+        const size_t sz = width * sizeof(T);
+        for (int64_t i = b * kBlockRows; i < end; ++i) {
+          const int64_t src_row = is_src_index ? index[i] : i;
+          const int64_t dst_row = is_src_index ? i : index[i];
+          memcpy(dst_data + dst_row * width, src_data + src_row * width, sz);
+        }
       }
     }
   }
 };
 
+// The levels are kept in plain vectors, not in the copy-on-write LoD, whose
+// data would be shared by all the callers, and copied to the device of the
+// first one.
+struct BatchLoDCacheEntry {
+  std::vector<size_t> lod;
+  bool is_reverse;
+  std::vector<std::vector<size_t>> batch_lod;
+};
+
+static framework::LoD ToLoD(const std::vector<std::vector<size_t>>& levels) {
+  framework::LoD lod;
+  for (auto& level : levels) {
+    lod.emplace_back(level);
+  }
+  return lod;
+}
+
+static framework::LoD BuildBatchLoD(const framework::Vector<size_t>& lod,
+                                    bool is_reverse) {
+  // Calculate the length of each sequence and
+  // sort sequence index by the length.
+  // example:  sequences = {s0, s1, s2}
+  //           s0: 0 0 0 0, s1: 1 1 1 1 1, s2: 2 2 2
+  //           seq_info[3] = {(4, 5, 1), (0, 4, 0), (9, 3, 2)}
+  //
+  struct SeqInfo {
+    SeqInfo(int start, int length, int seq_idx)
+        : start(start), length(length), seq_idx(seq_idx) {}
+    int start;
+    int length;
+    int seq_idx;
+  };
+  std::vector<SeqInfo> seq_info;
+  for (size_t seq_id = 0; seq_id < lod.size() - 1; ++seq_id) {
+    int length = lod[seq_id + 1] - lod[seq_id];
+    seq_info.emplace_back(lod[seq_id], length, seq_id);
+  }
+
+  std::sort(seq_info.begin(), seq_info.end(),
+            [](SeqInfo a, SeqInfo b) { return a.length > b.length; });
+
+  // Calculate the start position of each batch.
+  // example:  sequences = {s0, s1, s2}
+  //           s0: 0 0 0 0, s1: 1 1 1 1 1, s2: 2 2 2
+  //           max_seqlen = 5,
+  //           batchIndex = {b0, b1, b2, b3, b4}
+  //           b0: 1 0 2, b1: 1 0 2, b2: 1 0 2, b3: 1 0, b4: 1
+  //           batch_start_positions[6] = {0, 3, 6, 9, 11, 12}
+  //              batch_start_positions[0] = len(b0)
+  //              batch_start_positions[1] = len(b0) + len(b1)
+  //              batch_start_positions[2] = len(b0) + len(b1) + len(b2)
+  //              ...
+  //           seq2batch_idx[12] = {4, 0, 9,
+  //                                5, 1, 10,
+  //                                6, 2, 11,
+  //                                7, 3,
+  //                                8}
+  //           seq_order = {1, 0, 2}, the sort order.
+  //               where 1 is the second sequence,
+  //                     0 is the first sequence,
+  //                     2 is the third sequence.
+  // The max_seqlen represents batch size after rearranging the
+  // input LodTensor. It is also the maximum length of input sequence.
+
+  paddle::framework::LoD batch_lods;
+  batch_lods.emplace_back(std::vector<size_t>{0});
+  batch_lods.emplace_back(std::vector<size_t>{0});
+  batch_lods.emplace_back(std::vector<size_t>{0});
+
+  // batch_lods[0] is the start positions for batch LoDTensor
+  int max_seqlen = seq_info[0].length;
+  batch_lods[0].resize(static_cast<size_t>(max_seqlen + 1));
+  // batch_lods[1] is the raw index in the input LoDTensor
+  batch_lods[1].resize(lod.back());
+  // batch_lods[2] is the sort order for the input LoDTensor.
+  batch_lods[2].resize(seq_info.size());
+
+  size_t* batch_starts = batch_lods[0].data();
+  size_t* seq2batch_idx = batch_lods[1].data();
+  batch_starts[0] = 0;
+  for (int n = 0; n < max_seqlen; n++) {
+    auto batch_id = static_cast<int>(batch_starts[n]);
+    for (size_t i = 0; i < seq_info.size(); ++i) {
+      int seq_len = seq_info[i].length;
+      int start = seq_info[i].start;
+      if (n < seq_len) {
+        seq2batch_idx[batch_id] =
+            is_reverse ? start + seq_len - 1 - n : start + n;
+        batch_id++;
+      } else {
+        break;
+      }
+    }
+    batch_starts[n + 1] = static_cast<size_t>(batch_id);
+  }
+  size_t* seq_order = batch_lods[2].data();
+  for (size_t i = 0; i < seq_info.size(); ++i) {
+    seq_order[i] = seq_info[i].seq_idx;
+  }
+  return batch_lods;
+}
+
+framework::LoD GetBatchLoD(const framework::Vector<size_t>& lod,
+                           bool is_reverse) {
+  // A few entries cover the forward and the reverse layers of a model.
+  constexpr size_t kCacheSize = 8;
+  static std::deque<BatchLoDCacheEntry> cache;
+  static std::mutex mutex;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : cache) {
+      if (entry.is_reverse == is_reverse && entry.lod.size() == lod.size() &&
+          std::equal(entry.lod.begin(), entry.lod.end(), lod.begin())) {
+        return ToLoD(entry.batch_lod);
+      }
+    }
+  }
+  framework::LoD batch_lod = BuildBatchLoD(lod, is_reverse);
+  std::vector<std::vector<size_t>> levels;
+  for (auto& level : batch_lod) {
+    levels.emplace_back(level);
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  cache.push_front({lod, is_reverse, std::move(levels)});
+  if (cache.size() > kCacheSize) {
+    cache.pop_back();
+  }
+  return batch_lod;
+}
+
 template class CopyMatrixRowsFunctor<platform::CPUDeviceContext, float>;
 template class CopyMatrixRowsFunctor<platform::CPUDeviceContext, double>;
 
@@ -41,8 +41,8 @@ class CopyMatrixRowsFunctor<platform::CUDADeviceContext, T> {
  public:
   void operator()(const platform::CUDADeviceContext& context,
                   const framework::Tensor& src,
-                  framework::Vector<size_t> index_lod, framework::Tensor* dst,
-                  bool is_src_index) {
+                  const framework::Vector<size_t>& index_lod,
+                  framework::Tensor* dst, bool is_src_index) {
     auto src_dims = src.dims();
     auto dst_dims = dst->dims();
     PADDLE_ENFORCE_EQ(src_dims.size(), 2,
@@ -63,6 +63,17 @@ class CopyMatrixRowsFunctor<platform::CUDADeviceContext, T> {
         src_data, dst_data, index_lod.CUDAData(context.GetPlace()), height,
         width, is_src_index);
   }
+
+  void operator()(const platform::CUDADeviceContext& context,
+                  const std::vector<const framework::Tensor*>& srcs,
+                  const framework::Vector<size_t>& index_lod,
+                  const std::vector<framework::Tensor*>& dsts,
+                  bool is_src_index) {
+    PADDLE_ENFORCE_EQ(srcs.size(), dsts.size());
+    for (size_t i = 0; i < srcs.size(); ++i) {
+      (*this)(context, *srcs[i], index_lod, dsts[i], is_src_index);
+    }
+  }
 };
 
 template class CopyMatrixRowsFunctor<platform::CUDADeviceContext, float>;
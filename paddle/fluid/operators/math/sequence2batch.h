@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 #include <algorithm>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -37,120 +38,71 @@ class CopyMatrixRowsFunctor {
   // copy the input src to the indexed rows of output dst.
   // The indexed rows are based on the input index.
   void operator()(const DeviceContext& context, const framework::Tensor& src,
-                  framework::Vector<size_t> index_lod, framework::Tensor* dst,
+                  const framework::Vector<size_t>& index_lod,
+                  framework::Tensor* dst, bool is_src_index);
+
+  // Copies every srcs[i] to dsts[i] as above, in one pass over the index.
+  void operator()(const DeviceContext& context,
+                  const std::vector<const framework::Tensor*>& srcs,
+                  const framework::Vector<size_t>& index_lod,
+                  const std::vector<framework::Tensor*>& dsts,
                   bool is_src_index);
 };
 
+/*
+ * \brief Returns the batch LoD of LoDTensor2BatchFunctor for the sequence
+ *        lod: the start positions of the batches, the raw index of every
+ *        row in the input and the sort order of the sequences. The recent
+ *        ones are cached by the lod, since all the recurrent layers of a
+ *        model see the same lod in a minibatch.
+ */
+framework::LoD GetBatchLoD(const framework::Vector<size_t>& lod,
+                           bool is_reverse);
+
 template <typename DeviceContext, typename T>
 class LoDTensor2BatchFunctor {
-  // Calculate the length of each sequence and
-  // sort sequence index by the length.
-  // example:  sequences = {s0, s1, s2}
-  //           s0: 0 0 0 0, s1: 1 1 1 1 1, s2: 2 2 2
-  //           seq_info[3] = {(4, 5, 1), (0, 4, 0), (9, 3, 2)}
-  //
-  struct SeqInfo {
-    SeqInfo(int start, int length, int seq_idx)
-        : start(start), length(length), seq_idx(seq_idx) {}
-    int start;
-    int length;
-    int seq_idx;
-  };
-
  public:
   void operator()(const DeviceContext& context,
                   const framework::LoDTensor& lod_tensor,
                   framework::LoDTensor* batch, bool is_cal_batch_lod,
                   bool is_reverse = false) const {
     if (!is_cal_batch_lod) {
-      auto lods = batch->lod();
-      PADDLE_ENFORCE_GT(lods.size(), 2UL,
-                        "The LoD of LoDTensor should inlcude at least 2-level "
-                        "sequence information.");
-      PADDLE_ENFORCE_EQ(
-          lods[1].size(), static_cast<size_t>(lod_tensor.dims()[0]),
-          "The LoD information should be consistent with the dims.");
-      CopyMatrixRowsFunctor<DeviceContext, T> to_batch;
-      to_batch(context, lod_tensor, lods[1], batch, true);
+      (*this)(context, {&lod_tensor}, {batch});
       return;
     }
 
     auto lods = lod_tensor.lod();
     PADDLE_ENFORCE_EQ(lods.size(), 1UL, "Only support one level sequence now.");
 
-    const auto& lod = lods[0];
+    batch->set_lod(GetBatchLoD(lods[0], is_reverse));
 
-    std::vector<SeqInfo> seq_info;
-    for (size_t seq_id = 0; seq_id < lod.size() - 1; ++seq_id) {
-      int length = lod[seq_id + 1] - lod[seq_id];
-      seq_info.emplace_back(lod[seq_id], length, seq_id);
-    }
+    CopyMatrixRowsFunctor<DeviceContext, T> to_batch;
+    to_batch(context, lod_tensor, batch->lod()[1], batch, true);
+  }
 
-    std::sort(seq_info.begin(), seq_info.end(),
-              [](SeqInfo a, SeqInfo b) { return a.length > b.length; });
-
-    // Calculate the start position of each batch.
-    // example:  sequences = {s0, s1, s2}
-    //           s0: 0 0 0 0, s1: 1 1 1 1 1, s2: 2 2 2
-    //           max_seqlen = 5,
-    //           batchIndex = {b0, b1, b2, b3, b4}
-    //           b0: 1 0 2, b1: 1 0 2, b2: 1 0 2, b3: 1 0, b4: 1
-    //           batch_start_positions[6] = {0, 3, 6, 9, 11, 12}
-    //              batch_start_positions[0] = len(b0)
-    //              batch_start_positions[1] = len(b0) + len(b1)
-    //              batch_start_positions[2] = len(b0) + len(b1) + len(b2)
-    //              ...
-    //           seq2batch_idx[12] = {4, 0, 9,
-    //                                5, 1, 10,
-    //                                6, 2, 11,
-    //                                7, 3,
-    //                                8}
-    //           seq_order = {1, 0, 2}, the sort order.
-    //               where 1 is the second sequence,
-    //                     0 is the first sequence,
-    //                     2 is the third sequence.
-    // The max_seqlen represents batch size after rearranging the
-    // input LodTensor. It is also the maximum length of input sequence.
-
-    paddle::framework::LoD batch_lods;
-    batch_lods.emplace_back(std::vector<size_t>{0});
-    batch_lods.emplace_back(std::vector<size_t>{0});
-    batch_lods.emplace_back(std::vector<size_t>{0});
-
-    // batch_lods[0] is the start positions for batch LoDTensor
-    int max_seqlen = seq_info[0].length;
-    batch_lods[0].resize(static_cast<size_t>(max_seqlen + 1));
-    // batch_lods[1] is the raw index in the input LoDTensor
-    batch_lods[1].resize(static_cast<size_t>(lod_tensor.dims()[0]));
-    // batch_lods[2] is the sort order for the input LoDTensor.
-    batch_lods[2].resize(seq_info.size());
-
-    size_t* batch_starts = batch_lods[0].data();
-    size_t* seq2batch_idx = batch_lods[1].data();
-    batch_starts[0] = 0;
-    for (int n = 0; n < max_seqlen; n++) {
-      auto batch_id = static_cast<int>(batch_starts[n]);
-      for (size_t i = 0; i < seq_info.size(); ++i) {
-        int seq_len = seq_info[i].length;
-        int start = seq_info[i].start;
-        if (n < seq_len) {
-          seq2batch_idx[batch_id] =
-              is_reverse ? start + seq_len - 1 - n : start + n;
-          batch_id++;
-        } else {
-          break;
-        }
-      }
-      batch_starts[n + 1] = static_cast<size_t>(batch_id);
-    }
-    size_t* seq_order = batch_lods[2].data();
-    for (size_t i = 0; i < seq_info.size(); ++i) {
-      seq_order[i] = seq_info[i].seq_idx;
+  // Reorders every lod_tensors[i] to batches[i] by the batch LoD, which
+  // should be set in all of batches.
+  void operator()(const DeviceContext& context,
+                  const std::vector<const framework::LoDTensor*>& lod_tensors,
+                  const std::vector<framework::LoDTensor*>& batches) const {
+    PADDLE_ENFORCE_EQ(lod_tensors.size(), batches.size());
+    std::vector<const framework::Tensor*> srcs;
+    std::vector<framework::Tensor*> dsts;
+    for (size_t i = 0; i < batches.size(); ++i) {
+      auto& lods = batches[i]->lod();
+      PADDLE_ENFORCE_GT(lods.size(), 2UL,
+                        "The LoD of LoDTensor should inlcude at least 2-level "
+                        "sequence information.");
+      PADDLE_ENFORCE_EQ(
+          lods[1].size(), static_cast<size_t>(lod_tensors[i]->dims()[0]),
+          "The LoD information should be consistent with the dims.");
+      PADDLE_ENFORCE(lods[1] == batches[0]->lod()[1],
+                     "The batches should share the same batch LoD.");
+      srcs.push_back(lod_tensors[i]);
+      dsts.push_back(batches[i]);
     }
-    batch->set_lod(batch_lods);
-
     CopyMatrixRowsFunctor<DeviceContext, T> to_batch;
-    to_batch(context, lod_tensor, batch_lods[1], batch, true);
+    to_batch(context, srcs, batches[0]->lod()[1], dsts, true);
   }
 };
 
@@ -160,18 +112,70 @@ class Batch2LoDTensorFunctor {
   void operator()(const DeviceContext& context,
                   const framework::LoDTensor& batch,
                   framework::LoDTensor* lod_tensor) const {
-    auto in_lod = batch.lod();
-    PADDLE_ENFORCE_GT(in_lod.size(), 2UL,
-                      "The LoD of LoDTensor should inlcude at least 2-level "
-                      "sequence information.");
-    PADDLE_ENFORCE_EQ(
-        in_lod[1].size(), static_cast<size_t>(lod_tensor->dims()[0]),
-        "The LoD information should be consistent with the dims.");
+    (*this)(context, {&batch}, {lod_tensor});
+  }
+
+  // Restores every batches[i] to lod_tensors[i], all of batches should have
+  // the same batch LoD.
+  void operator()(const DeviceContext& context,
+                  const std::vector<const framework::LoDTensor*>& batches,
+                  const std::vector<framework::LoDTensor*>& lod_tensors) const {
+    PADDLE_ENFORCE_EQ(batches.size(), lod_tensors.size());
+    std::vector<const framework::Tensor*> srcs;
+    std::vector<framework::Tensor*> dsts;
+    for (size_t i = 0; i < batches.size(); ++i) {
+      auto& in_lod = batches[i]->lod();
+      PADDLE_ENFORCE_GT(in_lod.size(), 2UL,
+                        "The LoD of LoDTensor should inlcude at least 2-level "
+                        "sequence information.");
+      PADDLE_ENFORCE_EQ(
+          in_lod[1].size(), static_cast<size_t>(lod_tensors[i]->dims()[0]),
+          "The LoD information should be consistent with the dims.");
+      PADDLE_ENFORCE(in_lod[1] == batches[0]->lod()[1],
+                     "The batches should share the same batch LoD.");
+      srcs.push_back(batches[i]);
+      dsts.push_back(lod_tensors[i]);
+    }
     CopyMatrixRowsFunctor<DeviceContext, T> to_seq;
-    to_seq(context, batch, in_lod[1], lod_tensor, false);
+    to_seq(context, srcs, batches[0]->lod()[1], dsts, false);
   }
 };
 
+/*
+ * \brief Splits the non-empty sequences of lod into at most num_groups
+ *        groups with balanced total lengths, by assigning the longest
+ *        sequence to the lightest group first. The sequences in each group
+ *        are sorted by their lengths in descending order, so the sequences
+ *        still running at any step are a prefix of the group.
+ */
+inline std::vector<std::vector<int>> PartitionSequencesByLength(
+    const framework::Vector<size_t>& lod, int num_groups) {
+  std::vector<std::pair<size_t, int>> seqs;
+  for (size_t i = 0; i + 1 < lod.size(); ++i) {
+    if (lod[i + 1] > lod[i]) {
+      seqs.emplace_back(lod[i + 1] - lod[i], static_cast<int>(i));
+    }
+  }
+  std::stable_sort(seqs.begin(), seqs.end(),
+                   [](const std::pair<size_t, int>& a,
+                      const std::pair<size_t, int>& b) {
+                     return a.first > b.first;
+                   });
+  num_groups = std::max(1, std::min(num_groups, static_cast<int>(seqs.size())));
+  std::vector<std::vector<int>> groups(num_groups);
+  std::vector<size_t> loads(num_groups, 0);
+  for (auto& seq : seqs) {
+    int lightest = static_cast<int>(
+        std::min_element(loads.begin(), loads.end()) - loads.begin());
+    groups[lightest].push_back(seq.second);
+    loads[lightest] += seq.first;
+  }
+  if (seqs.empty()) {
+    groups.clear();
+  }
+  return groups;
+}
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
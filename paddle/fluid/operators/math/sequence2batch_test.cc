@@ -0,0 +1,101 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/sequence2batch.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(Sequence2Batch, CPU) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  // enough rows to be copied in parallel
+  std::vector<size_t> starts{0};
+  for (size_t i = 0; i < 400; ++i) {
+    starts.push_back(starts.back() + 1 + i % 9);
+  }
+  const int64_t height = starts.back();
+  const std::vector<int64_t> widths{16, 48};
+
+  for (bool is_reverse : {false, true}) {
+    std::vector<paddle::framework::LoDTensor> seqs(2), batches(2), outs(2);
+    for (size_t t = 0; t < seqs.size(); ++t) {
+      seqs[t].set_lod({starts});
+      float* data = seqs[t].mutable_data<float>({height, widths[t]}, place);
+      for (int64_t i = 0; i < seqs[t].numel(); ++i) {
+        data[i] = static_cast<float>(i * (t + 1));
+      }
+      batches[t].mutable_data<float>(seqs[t].dims(), place);
+      outs[t].mutable_data<float>(seqs[t].dims(), place);
+    }
+
+    paddle::operators::math::LoDTensor2BatchFunctor<
+        paddle::platform::CPUDeviceContext, float>
+        to_batch;
+    to_batch(context, seqs[0], &batches[0], true, is_reverse);
+    // the batch LoD is cached by the lod
+    EXPECT_EQ(paddle::operators::math::GetBatchLoD(starts, is_reverse),
+              batches[0].lod());
+    batches[1].set_lod(batches[0].lod());
+    to_batch(context, {&seqs[1]}, {&batches[1]});
+
+    // check the row order against the batch LoD
+    auto& batch_starts = batches[0].lod()[0];
+    auto& seq2batch = batches[0].lod()[1];
+    for (size_t n = 0; n + 1 < batch_starts.size(); ++n) {
+      for (size_t i = batch_starts[n]; i < batch_starts[n + 1]; ++i) {
+        size_t seq_id = batches[0].lod()[2][i - batch_starts[n]];
+        size_t len = starts[seq_id + 1] - starts[seq_id];
+        size_t row = is_reverse ? starts[seq_id] + len - 1 - n
+                                : starts[seq_id] + n;
+        EXPECT_EQ(seq2batch[i], row);
+        for (size_t t = 0; t < seqs.size(); ++t) {
+          for (int64_t k = 0; k < widths[t]; ++k) {
+            EXPECT_EQ(batches[t].data<float>()[i * widths[t] + k],
+                      seqs[t].data<float>()[row * widths[t] + k]);
+          }
+        }
+      }
+    }
+
+    paddle::operators::math::Batch2LoDTensorFunctor<
+        paddle::platform::CPUDeviceContext, float>
+        to_seq;
+    to_seq(context, {&batches[0], &batches[1]}, {&outs[0], &outs[1]});
+    for (size_t t = 0; t < seqs.size(); ++t) {
+      for (int64_t i = 0; i < seqs[t].numel(); ++i) {
+        EXPECT_EQ(outs[t].data<float>()[i], seqs[t].data<float>()[i]);
+      }
+    }
+  }
+}
+
+TEST(Sequence2Batch, CachedLoDPerPlace) {
+  std::vector<size_t> starts{0, 3, 8, 10};
+  // The cached batch LoD is copied for every call, so the calls for two
+  // places share no data, which is copied to the device of each.
+  auto first = paddle::operators::math::GetBatchLoD(starts, false);
+  auto second = paddle::operators::math::GetBatchLoD(starts, false);
+  ASSERT_EQ(first, second);
+  for (size_t i = 0; i < first.size(); ++i) {
+    EXPECT_NE(first[i].data(), second[i].data());
+  }
+#ifdef PADDLE_WITH_CUDA
+  if (paddle::platform::GetCUDADeviceCount() >= 2) {
+    for (size_t i = 0; i < first.size(); ++i) {
+      EXPECT_NE(first[i].CUDAData(paddle::platform::CUDAPlace(0)), nullptr);
+      EXPECT_NE(second[i].CUDAData(paddle::platform::CUDAPlace(1)), nullptr);
+    }
+  }
+#endif
+}
@@ -13,48 +13,91 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence_padding.h"
+#include <algorithm>
 
 namespace paddle {
 namespace operators {
 namespace math {
 
+// Copies the valid steps of the sequences between the sequence tensor and the
+// padded one, in parallel over the sequences when the batch is large. The
+// padded steps are filled by pad_value if it is given.
 template <typename T>
 void CopyValidData(framework::Tensor* dst_tensor,
                    const framework::Tensor* src_tensor,
                    const framework::Vector<size_t>& seq_offsets,
                    int pad_seq_len, int step_width, bool norm_by_len,
-                   CopyType type, PadLayout layout) {
+                   CopyType type, PadLayout layout,
+                   const framework::Tensor* pad_value = nullptr) {
   int seq_num = seq_offsets.size() - 1;
   const T* src_data = src_tensor->data<T>();
   T* dst_data = dst_tensor->data<T>();
+  const T* pad_value_data = pad_value ? pad_value->data<T>() : nullptr;
+  const bool pad_by_step = pad_value && pad_value->numel() == step_width;
 
-  int seq_cpy_gap = step_width;
-  int pad_cpy_gap =
-      layout == kBatchLengthWidth ? step_width : seq_num * step_width;
   for (int seq_idx = 0; seq_idx < seq_num; ++seq_idx) {
     int valid_seq_len = seq_offsets[seq_idx + 1] - seq_offsets[seq_idx];
     PADDLE_ENFORCE_GE(
         pad_seq_len, valid_seq_len,
         "The padded sequence length can not be less than its original length.");
-    int seq_data_offset = seq_offsets[seq_idx] * step_width;
-    int pad_data_offset = layout == kBatchLengthWidth
-                              ? seq_idx * pad_seq_len * step_width
-                              : seq_idx * step_width;
-    float scale = 1.0f / static_cast<float>(valid_seq_len);
-
-    for (int step_idx = 0; step_idx < valid_seq_len; ++step_idx) {
-      const T* src =
-          src_data + (type == kSeqToPad ? seq_data_offset : pad_data_offset);
-      T* dst =
-          dst_data + (type == kSeqToPad ? pad_data_offset : seq_data_offset);
-      memcpy(dst, src, step_width * sizeof(T));
+  }
+
+  const int64_t seq_cpy_gap = step_width;
+  const int64_t pad_cpy_gap =
+      layout == kBatchLengthWidth ? step_width : seq_num * step_width;
+  constexpr int64_t kParallelMinNumel = 1 << 16;
+  const bool parallel =
+      seq_num > 1 && static_cast<int64_t>(seq_offsets.back()) * step_width >=
+                         kParallelMinNumel;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (parallel)
+#endif
+  for (int seq_idx = 0; seq_idx < seq_num; ++seq_idx) {
+    int valid_seq_len = seq_offsets[seq_idx + 1] - seq_offsets[seq_idx];
+    int64_t seq_data_offset =
+        static_cast<int64_t>(seq_offsets[seq_idx]) * step_width;
+    int64_t pad_data_offset =
+        layout == kBatchLengthWidth
+            ? static_cast<int64_t>(seq_idx) * pad_seq_len * step_width
+            : static_cast<int64_t>(seq_idx) * step_width;
+    const T* src =
+        src_data + (type == kSeqToPad ? seq_data_offset : pad_data_offset);
+    T* dst = dst_data + (type == kSeqToPad ? pad_data_offset : seq_data_offset);
+    const int64_t src_gap = type == kSeqToPad ? seq_cpy_gap : pad_cpy_gap;
+    const int64_t dst_gap = type == kSeqToPad ? pad_cpy_gap : seq_cpy_gap;
+    T scale = static_cast<T>(1.0f / static_cast<float>(valid_seq_len));
+
+    if (src_gap == step_width && dst_gap == step_width) {
+      // the steps are contiguous on both sides, one block for the sequence
+      int64_t numel = static_cast<int64_t>(valid_seq_len) * step_width;
+      memcpy(dst, src, numel * sizeof(T));
       if (norm_by_len) {
-        for (int i = 0; i < step_width; ++i) {
-          *(dst + i) *= scale;
+        for (int64_t i = 0; i < numel; ++i) {
+          dst[i] *= scale;
+        }
+      }
+    } else {
+      for (int step_idx = 0; step_idx < valid_seq_len; ++step_idx) {
+        T* dst_step = dst + step_idx * dst_gap;
+        memcpy(dst_step, src + step_idx * src_gap, step_width * sizeof(T));
+        if (norm_by_len) {
+          for (int i = 0; i < step_width; ++i) {
+            dst_step[i] *= scale;
+          }
+        }
+      }
+    }
+
+    if (pad_value_data) {
+      T* pad = dst_data + pad_data_offset;
+      for (int step_idx = valid_seq_len; step_idx < pad_seq_len; ++step_idx) {
+        T* pad_step = pad + step_idx * pad_cpy_gap;
+        if (pad_by_step) {
+          memcpy(pad_step, pad_value_data, step_width * sizeof(T));
+        } else {
+          std::fill(pad_step, pad_step + step_width, *pad_value_data);
         }
       }
-      seq_data_offset += seq_cpy_gap;
-      pad_data_offset += pad_cpy_gap;
     }
   }
 }
@@ -83,21 +126,28 @@ class PaddingLoDTensorFunctor<platform::CPUDeviceContext, T> {
                    "The numel of 'pad_value' can only be 1 or be equal to the "
                    "'step_width'.");
 
-    // fill padding value
-    T* pad_data = pad_tensor->data<T>();
-    const T* pad_value_data = pad_value.data<T>();
-    if (pad_value.numel() == 1) {
-      for (int i = 0; i < pad_tensor->numel(); ++i) {
-        pad_data[i] = *pad_value_data;
-      }
-    } else {
-      for (int i = 0; i < pad_tensor->numel(); i += step_width) {
-        memcpy(pad_data + i, pad_value_data, step_width * sizeof(T));
+    // The padded steps are filled along with the copy when the padded tensor
+    // holds exactly the padded sequences, or all filled at first.
+    int64_t seq_num = seq_offsets.size() - 1;
+    bool fill_in_copy =
+        pad_tensor->numel() == seq_num * pad_seq_len * step_width;
+    if (!fill_in_copy) {
+      T* pad_data = pad_tensor->data<T>();
+      const T* pad_value_data = pad_value.data<T>();
+      if (pad_value.numel() == 1) {
+        for (int i = 0; i < pad_tensor->numel(); ++i) {
+          pad_data[i] = *pad_value_data;
+        }
+      } else {
+        for (int i = 0; i < pad_tensor->numel(); i += step_width) {
+          memcpy(pad_data + i, pad_value_data, step_width * sizeof(T));
+        }
       }
     }
 
     CopyValidData<T>(pad_tensor, &seq_tensor, seq_offsets, pad_seq_len,
-                     step_width, norm_by_times, kSeqToPad, layout);
+                     step_width, norm_by_times, kSeqToPad, layout,
+                     fill_in_copy ? &pad_value : nullptr);
   }
 };
 
@@ -32,6 +32,14 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
 
+// The sequences are pooled in parallel only when the batch is large enough
+// to pay for the threads.
+static bool UseParallelSeqPool(int64_t num_seq, int64_t numel) {
+  constexpr int64_t kParallelMinNumel = 1 << 16;
+  return num_seq > 1 && numel >= kParallelMinNumel;
+}
+
+// The index is not filled in the test phase.
 template <typename T, bool is_test>
 class MaxSeqPoolFunctor {
  public:
@@ -40,72 +48,45 @@ class MaxSeqPoolFunctor {
                   framework::Tensor* index) {
     auto in_dims = input.dims();
     auto out_dims = output->dims();
-    auto idx_dims = index->dims();
     PADDLE_ENFORCE_GT(in_dims.size(), 1);
     PADDLE_ENFORCE_GT(out_dims.size(), 1);
     for (int64_t i = 1; i < in_dims.size(); ++i) {
       PADDLE_ENFORCE_EQ(in_dims[i], out_dims[i]);
     }
-    PADDLE_ENFORCE_EQ(idx_dims, out_dims);
-
-    auto starts = input.lod()[0];
-    const T* in_data = input.data<T>();
-    T* out_data = output->data<T>();
-    int* max_index = index->data<int>();
-
-    int64_t num_seq = out_dims[0];
-    int64_t dim = output->numel() / num_seq;
-    for (int64_t i = 0; i < num_seq; ++i) {
-      for (int64_t k = 0; k < dim; ++k) {
-        out_data[i * dim + k] = in_data[starts[i] * dim + k];
-        max_index[i * dim + k] = starts[i];
-      }
-      for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
-        for (int64_t k = 0; k < dim; ++k) {
-          if (in_data[j * dim + k] > out_data[i * dim + k]) {
-            out_data[i * dim + k] = in_data[j * dim + k];
-            max_index[i * dim + k] = j;
-          }
-        }
-      }
-    }
-  }
-};
-// Instantisation of Max Sequence Pooling for test phase eg. no need to fill
-// index buffer
-template <typename T>
-class MaxSeqPoolFunctor<T, true> {
- public:
-  void operator()(const platform::CPUDeviceContext& context,
-                  const framework::LoDTensor& input, framework::Tensor* output,
-                  framework::Tensor* index) {
-    auto in_dims = input.dims();
-    auto out_dims = output->dims();
-    PADDLE_ENFORCE_GT(in_dims.size(), 1);
-    PADDLE_ENFORCE_GT(out_dims.size(), 1);
-    for (int64_t i = 1; i < in_dims.size(); ++i) {
-      PADDLE_ENFORCE_EQ(in_dims[i], out_dims[i]);
+    if (!is_test) {
+      PADDLE_ENFORCE_EQ(index->dims(), out_dims);
     }
 
     auto starts = input.lod()[0];
     const T* in_data = input.data<T>();
     T* out_data = output->data<T>();
+    int* max_index = is_test ? nullptr : index->data<int>();
 
     int64_t num_seq = out_dims[0];
     int64_t dim = output->numel() / num_seq;
+    const jit::seq_pool_attr_t attr(static_cast<int>(dim),
+                                    jit::SeqPoolType::kMax);
+    auto max_pool = jit::Get<jit::kMaxSeqPool, jit::MaxSeqPoolTuples<T>,
+                             platform::CPUPlace>(attr);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (UseParallelSeqPool(num_seq, input.numel()))
+#endif
     for (int64_t i = 0; i < num_seq; ++i) {
-      std::memcpy(&out_data[i * dim], &in_data[starts[i] * dim],
-                  dim * sizeof(T));
-      for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
+      jit::seq_pool_attr_t seq_attr = attr;
+      seq_attr.h = static_cast<int>(starts[i + 1] - starts[i]);
+      int* seq_index = max_index ? max_index + i * dim : nullptr;
+      max_pool(in_data + starts[i] * dim, out_data + i * dim, seq_index,
+               &seq_attr);
+      if (seq_index) {
+        // the kernel gives the row in the sequence
         for (int64_t k = 0; k < dim; ++k) {
-          if (in_data[j * dim + k] > out_data[i * dim + k]) {
-            out_data[i * dim + k] = in_data[j * dim + k];
-          }
+          seq_index[k] += starts[i];
         }
       }
     }
   }
 };
+
 template <typename T>
 class MaxSeqPoolGradFunctor {
  public:
@@ -131,6 +112,10 @@ class MaxSeqPoolGradFunctor {
     set_zero(context, in_grad, static_cast<T>(0.0));
     int64_t num_seq = og_dims[0];
     int64_t dim = out_grad.numel() / num_seq;
+    // Every sequence scatters to its own rows only.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (UseParallelSeqPool(num_seq, in_grad->numel()))
+#endif
     for (int64_t i = 0; i < num_seq; ++i) {
       for (int64_t j = 0; j < dim; ++j) {
         int step_id = max_index[i * dim + j];
@@ -140,29 +125,36 @@ class MaxSeqPoolGradFunctor {
   }
 };
 
+// Copies the first or the last item of every sequence between the input and
+// the output, in either direction.
+template <typename T>
+static void CopySeqItems(const framework::Vector<size_t>& lod, bool last,
+                         int64_t item_size, bool seq_to_item, const T* src,
+                         T* dst) {
+  int64_t num_seq = static_cast<int64_t>(lod.size()) - 1;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (UseParallelSeqPool(num_seq, num_seq * item_size))
+#endif
+  for (int64_t i = 0; i < num_seq; ++i) {
+    int64_t row = static_cast<int64_t>(last ? lod[i + 1] - 1 : lod[i]);
+    int64_t seq_offset = row * item_size;
+    int64_t item_offset = i * item_size;
+    std::memcpy(dst + (seq_to_item ? item_offset : seq_offset),
+                src + (seq_to_item ? seq_offset : item_offset),
+                item_size * sizeof(T));
+  }
+}
+
 template <typename T>
 class LastSeqPoolFunctor {
  public:
   void operator()(const platform::CPUDeviceContext& context,
                   const framework::LoDTensor& input,
                   framework::Tensor* output) {
-    // Create pointers to input and output data
-    auto* in_data = input.data<T>();
-    auto* out_data = output->data<T>();
-
     // Calculate the size of each item in sequence
     int64_t item_size = input.numel() / input.dims()[0];
-    auto lod = input.lod()[0];
-    int seq_num = static_cast<int>(lod.size()) - 1;
-    for (int i = 0; i < seq_num; ++i) {
-      // Calculate the length of each sequence
-      int64_t seq_len = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      // Point to the begin of next sequence
-      in_data += seq_len * item_size;
-      // Copy the last item of sequence to output
-      std::memcpy(out_data, (in_data - item_size), item_size * sizeof(T));
-      out_data += item_size;
-    }
+    CopySeqItems<T>(input.lod()[0], true, item_size, true, input.data<T>(),
+                    output->data<T>());
   }
 };
 
@@ -172,23 +164,10 @@ class FirstSeqPoolFunctor {
   void operator()(const platform::CPUDeviceContext& context,
                   const framework::LoDTensor& input,
                   framework::Tensor* output) {
-    // Create pointers to input and output data
-    auto* in_data = input.data<T>();
-    auto* out_data = output->data<T>();
-
     // Calculate the size of each item in sequence
     int64_t item_size = input.numel() / input.dims()[0];
-    auto lod = input.lod()[0];
-    int seq_num = static_cast<int>(lod.size()) - 1;
-    for (int i = 0; i < seq_num; ++i) {
-      // Calculate the length of each sequence
-      int64_t seq_len = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      // Copy the first item of sequence to output
-      std::memcpy(out_data, in_data, item_size * sizeof(T));
-      // Point to the next sequence
-      in_data += seq_len * item_size;
-      out_data += item_size;
-    }
+    CopySeqItems<T>(input.lod()[0], false, item_size, true, input.data<T>(),
+                    output->data<T>());
   }
 };
 
@@ -305,6 +284,10 @@ class SequencePoolGradFunctor<platform::CPUDeviceContext, T> {
       // set X@Grad be zero at first when pooltype is LAST/FIRST
       math::SetConstant<platform::CPUDeviceContext, T> functor;
       functor(context, in_grad, 0);
+      int64_t item_size = in_grad->numel() / in_grad->dims()[0];
+      CopySeqItems<T>(in_grad->lod()[0], pooltype == "LAST", item_size, false,
+                      out_grad.data<T>(), in_grad->data<T>());
+      return;
     }
 
     if (pooltype == "SUM") {
@@ -323,7 +306,6 @@ class SequencePoolGradFunctor<platform::CPUDeviceContext, T> {
       int64_t w = in_grad->numel() / in_grad->dims()[0];
       auto in_g_e = EigenMatrix<T>::From(in_g_t, {h, w});
       auto out_g_e = EigenMatrix<T>::From(out_g_t, {1, w});
-      auto out_g_e_v = EigenVector<T>::Flatten(out_g_t);
       Eigen::DSizes<int, 2> bcast(h, 1);
 
       if (pooltype == "AVERAGE") {
@@ -331,10 +313,6 @@ class SequencePoolGradFunctor<platform::CPUDeviceContext, T> {
       } else if (pooltype == "SQRT") {
         in_g_e.device(place) =
             (out_g_e / std::sqrt(static_cast<T>(h))).broadcast(bcast);
-      } else if (pooltype == "LAST") {
-        in_g_e.chip(h - 1, 0).device(place) = out_g_e_v;
-      } else if (pooltype == "FIRST") {
-        in_g_e.chip(0, 0).device(place) = out_g_e_v;
       } else {
         PADDLE_THROW("unsupported pooling pooltype");
       }
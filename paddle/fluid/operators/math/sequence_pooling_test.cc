@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence_pooling.h"
 #include <gtest/gtest.h>
+#include <string>
 #include <vector>
 
 template <typename DeviceContext, typename Place, typename T>
@@ -111,6 +112,83 @@ TEST(SequencePoolingGrad, CPU_SUM) {
                          paddle::platform::CPUPlace, float>(lod2);
 }
 
+// A batch large enough to be pooled in parallel, checked with plain loops.
+TEST(SequencePooling, CPU_MAX_FIRST_LAST) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  const int64_t width = 67;
+  std::vector<size_t> starts{0};
+  for (size_t i = 0; i < 300; ++i) {
+    starts.push_back(starts.back() + 1 + i % 7);
+  }
+  const int64_t num_seq = starts.size() - 1;
+  paddle::framework::LoDTensor input;
+  input.set_lod({starts});
+  float* in_data = input.mutable_data<float>(
+      {static_cast<int64_t>(starts.back()), width}, place);
+  for (int64_t i = 0; i < input.numel(); ++i) {
+    in_data[i] = static_cast<float>((i * 7919) % 1009);
+  }
+
+  paddle::framework::Tensor out, index;
+  out.mutable_data<float>({num_seq, width}, place);
+  index.mutable_data<int>({num_seq, width}, place);
+  paddle::operators::math::SequencePoolFunctor<
+      paddle::platform::CPUDeviceContext, float>()(context, "MAX", input, &out,
+                                                   false, &index);
+  for (int64_t i = 0; i < num_seq; ++i) {
+    for (int64_t k = 0; k < width; ++k) {
+      int64_t max_row = starts[i];
+      for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
+        if (in_data[j * width + k] > in_data[max_row * width + k]) {
+          max_row = j;
+        }
+      }
+      EXPECT_EQ(out.data<float>()[i * width + k], in_data[max_row * width + k]);
+      EXPECT_EQ(index.data<int>()[i * width + k], max_row);
+    }
+  }
+
+  paddle::framework::LoDTensor in_grad;
+  in_grad.set_lod({starts});
+  in_grad.mutable_data<float>(input.dims(), place);
+  paddle::operators::math::SequencePoolGradFunctor<
+      paddle::platform::CPUDeviceContext, float>()(context, "MAX", out,
+                                                   &in_grad, &index);
+  for (int64_t i = 0; i < num_seq; ++i) {
+    for (size_t j = starts[i]; j < starts[i + 1]; ++j) {
+      for (int64_t k = 0; k < width; ++k) {
+        float expected = index.data<int>()[i * width + k] ==
+                                 static_cast<int>(j)
+                             ? out.data<float>()[i * width + k]
+                             : 0.f;
+        EXPECT_EQ(in_grad.data<float>()[j * width + k], expected);
+      }
+    }
+  }
+
+  for (std::string pooltype : {"FIRST", "LAST"}) {
+    paddle::operators::math::SequencePoolFunctor<
+        paddle::platform::CPUDeviceContext, float>()(context, pooltype, input,
+                                                     &out, false);
+    paddle::operators::math::SequencePoolGradFunctor<
+        paddle::platform::CPUDeviceContext, float>()(context, pooltype, out,
+                                                     &in_grad);
+    for (int64_t i = 0; i < num_seq; ++i) {
+      size_t row = pooltype == "FIRST" ? starts[i] : starts[i + 1] - 1;
+      for (size_t j = starts[i]; j < starts[i + 1]; ++j) {
+        for (int64_t k = 0; k < width; ++k) {
+          EXPECT_EQ(in_grad.data<float>()[j * width + k],
+                    j == row ? in_data[row * width + k] : 0.f);
+        }
+      }
+      for (int64_t k = 0; k < width; ++k) {
+        EXPECT_EQ(out.data<float>()[i * width + k], in_data[row * width + k]);
+      }
+    }
+  }
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(SequencePoolingGrad, CUDA_SUM) {
   paddle::framework::LoD lod1;
@@ -40,6 +40,8 @@ class AucOp : public framework::OperatorWithKernel {
 
     PADDLE_ENFORCE_GE(num_pred_buckets, 1, "num_thresholds must larger than 1");
     PADDLE_ENFORCE_GE(slide_steps, 0, "slide_steps must be natural number");
+    PADDLE_ENFORCE_GE(ctx->Attrs().Get<int>("merge_steps"), 1,
+                      "merge_steps must be positive");
 
     ctx->SetOutputDim("AUC", {1});
 
@@ -87,6 +89,13 @@ class AucOpMaker : public framework::OpProtoAndCheckerMaker {
         .SetDefault((2 << 12) - 1);
     AddAttr<int>("slide_steps", "Use slide steps to calc batch auc.")
         .SetDefault(1);
+    AddAttr<int>("merge_steps",
+                 "(int, default 1) When the stats are shared by several "
+                 "threads, e.g. in Hogwild training, every thread merges its "
+                 "own buckets into them every merge_steps batches. In between, "
+                 "the AUC is computed from the stats of the last merge and "
+                 "the buckets of the thread.")
+        .SetDefault(1);
     AddComment(R"DOC(
 Area Under The Curve (AUC) Operator.
 
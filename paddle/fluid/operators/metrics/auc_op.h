@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <string>
 #include <vector>
+#include "paddle/fluid/framework/metric_accumulator.h"
 #include "paddle/fluid/framework/op_registry.h"
 
 namespace paddle {
@@ -35,6 +36,7 @@ class AucKernel : public framework::OpKernel<T> {
     // buckets contain numbers from 0 to num_thresholds
     int num_pred_buckets = num_thresholds + 1;
     int slide_steps = ctx.Attr<int>("slide_steps");
+    int merge_steps = ctx.Attr<int>("merge_steps");
 
     // Only use output var for now, make sure it's persistable and
     // not cleaned up for each batch.
@@ -48,11 +50,19 @@ class AucKernel : public framework::OpKernel<T> {
     std::vector<int64_t> stat_pos_data(num_pred_buckets, 0);
     std::vector<int64_t> stat_neg_data(num_pred_buckets, 0);
 
-    auto stat_pos_calc = stat_pos_data.data();
-    auto stat_neg_calc = stat_neg_data.data();
+    statAuc(label, predict, num_thresholds, stat_pos_data.data(),
+            stat_neg_data.data());
 
-    statAuc(label, predict, num_pred_buckets, num_thresholds, slide_steps,
-            origin_stat_pos, origin_stat_neg, &stat_pos_calc, &stat_neg_calc);
+    // The stats may be shared by several threads, e.g. the Hogwild workers,
+    // so the batch is merged into them by the accumulators.
+    auto pos_accumulator = framework::MetricAccumulator<int64_t>::Get(
+        stat_pos->Holder(), origin_stat_pos, num_pred_buckets, slide_steps);
+    auto neg_accumulator = framework::MetricAccumulator<int64_t>::Get(
+        stat_neg->Holder(), origin_stat_neg, num_pred_buckets, slide_steps);
+    const int64_t *stat_pos_calc =
+        pos_accumulator->Add(stat_pos_data.data(), merge_steps);
+    const int64_t *stat_neg_calc =
+        neg_accumulator->Add(stat_neg_data.data(), merge_steps);
 
     calcAuc(ctx, stat_pos_calc, stat_neg_calc, num_thresholds, auc);
   }
@@ -65,10 +75,8 @@ class AucKernel : public framework::OpKernel<T> {
 
   inline static void statAuc(const framework::Tensor *label,
                              const framework::Tensor *predict,
-                             const int num_pred_buckets,
-                             const int num_thresholds, const int slide_steps,
-                             int64_t *origin_stat_pos, int64_t *origin_stat_neg,
-                             int64_t **stat_pos, int64_t **stat_neg) {
+                             const int num_thresholds, int64_t *stat_pos,
+                             int64_t *stat_neg) {
     size_t batch_size = predict->dims()[0];
     size_t inference_width = predict->dims()[1];
     const T *inference_data = predict->data<T>();
@@ -83,58 +91,16 @@ class AucKernel : public framework::OpKernel<T> {
 
       uint32_t binIdx = static_cast<uint32_t>(predict_data * num_thresholds);
       if (label_data[i]) {
-        (*stat_pos)[binIdx] += 1.0;
+        stat_pos[binIdx] += 1;
       } else {
-        (*stat_neg)[binIdx] += 1.0;
-      }
-    }
-
-    int bucket_length = num_pred_buckets * sizeof(int64_t);
-
-    // will stat auc unlimited.
-    if (slide_steps == 0) {
-      for (int slide = 0; slide < num_pred_buckets; ++slide) {
-        origin_stat_pos[slide] += (*stat_pos)[slide];
-        origin_stat_neg[slide] += (*stat_neg)[slide];
-      }
-
-      *stat_pos = origin_stat_pos;
-      *stat_neg = origin_stat_neg;
-
-    } else {
-      for (int slide = 1; slide < slide_steps; ++slide) {
-        int dst_idx = (slide - 1) * num_pred_buckets;
-        int src_inx = slide * num_pred_buckets;
-        std::memcpy(origin_stat_pos + dst_idx, origin_stat_pos + src_inx,
-                    bucket_length);
-        std::memcpy(origin_stat_neg + dst_idx, origin_stat_neg + src_inx,
-                    bucket_length);
-      }
-
-      std::memcpy(origin_stat_pos + (slide_steps - 1) * num_pred_buckets,
-                  *stat_pos, bucket_length);
-      std::memcpy(origin_stat_neg + (slide_steps - 1) * num_pred_buckets,
-                  *stat_neg, bucket_length);
-
-      std::memset(*stat_pos, 0, bucket_length);
-      std::memset(*stat_neg, 0, bucket_length);
-
-      for (int slide = 0; slide < num_pred_buckets; ++slide) {
-        int stat_pos_steps = 0;
-        int stat_neg_steps = 0;
-        for (int step = 0; step < slide_steps; ++step) {
-          stat_pos_steps += origin_stat_pos[slide + step * num_pred_buckets];
-          stat_neg_steps += origin_stat_neg[slide + step * num_pred_buckets];
-        }
-        (*stat_pos)[slide] += stat_pos_steps;
-        (*stat_neg)[slide] += stat_neg_steps;
+        stat_neg[binIdx] += 1;
       }
     }
   }
 
   inline static void calcAuc(const framework::ExecutionContext &ctx,
-                             int64_t *stat_pos, int64_t *stat_neg,
-                             int num_thresholds,
+                             const int64_t *stat_pos,
+                             const int64_t *stat_neg, int num_thresholds,
                              framework::Tensor *auc_tensor) {
     auto *auc = auc_tensor->mutable_data<double>(ctx.GetPlace());
 
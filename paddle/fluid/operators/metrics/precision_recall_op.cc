@@ -133,6 +133,12 @@ class PrecisionRecallOpMaker : public framework::OpProtoAndCheckerMaker {
               "for each class is [true positives, false positives, "
               "true negatives, false negatives].");
     AddAttr<int>("class_number", "(int) Number of classes to be evaluated.");
+    AddAttr<int>("merge_steps",
+                 "(int, default 1) Only used when StatesInfo and "
+                 "AccumStatesInfo are the same variable, which may be shared "
+                 "by several threads, e.g. in Hogwild training. Every thread "
+                 "merges its own states into it every merge_steps batches.")
+        .SetDefault(1);
     AddComment(R"DOC(
 Precision Recall Operator.
 
@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
+#include <vector>
 #include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/framework/metric_accumulator.h"
 #include "paddle/fluid/framework/op_registry.h"
 
 namespace paddle {
@@ -41,17 +44,17 @@ class PrecisionRecallKernel : public framework::OpKernel<T> {
     const int* ids_data = in0->data<int>();
     const int* labels_data = in1->data<int>();
     size_t cls_num = static_cast<size_t>(ctx.Attr<int>("class_number"));
+    int merge_steps = ctx.Attr<int>("merge_steps");
     const T* weights_data = in2 ? in2->data<T>() : nullptr;
     const T* states_data = in3 ? in3->data<T>() : nullptr;
     double* batch_metrics_data = out0->mutable_data<double>(ctx.GetPlace());
     double* accum_metrics_data = out1->mutable_data<double>(ctx.GetPlace());
-    out2->mutable_data<T>(ctx.GetPlace());
-    auto accum_states = EigenMatrix<T>::From(*out2);
-    accum_states.setZero();
-    T* accum_states_data = out2->data<T>();
+    T* accum_states_data = out2->mutable_data<T>(ctx.GetPlace());
 
     size_t sample_num = in0->dims()[0];
     size_t state_var_num = 4;  // TP FP TN FN
+    std::vector<T> batch_states(cls_num * state_var_num, 0);
+    T* batch_states_data = batch_states.data();
 
     // get states info for current batch
     for (size_t i = 0; i < sample_num; ++i) {
@@ -66,25 +69,37 @@ class PrecisionRecallKernel : public framework::OpKernel<T> {
 
       T w = weights_data ? weights_data[i] : 1.0;
       if (idx == label) {
-        accum_states_data[idx * state_var_num + TP] += w;
+        batch_states_data[idx * state_var_num + TP] += w;
         for (size_t j = 0; j < cls_num; ++j) {
-          accum_states_data[j * state_var_num + TN] += w;
+          batch_states_data[j * state_var_num + TN] += w;
         }
-        accum_states_data[idx * state_var_num + TN] -= w;
+        batch_states_data[idx * state_var_num + TN] -= w;
       } else {
-        accum_states_data[label * state_var_num + FN] += w;
-        accum_states_data[idx * state_var_num + FP] += w;
+        batch_states_data[label * state_var_num + FN] += w;
+        batch_states_data[idx * state_var_num + FP] += w;
         for (size_t j = 0; j < cls_num; ++j) {
-          accum_states_data[j * state_var_num + TN] += w;
+          batch_states_data[j * state_var_num + TN] += w;
         }
-        accum_states_data[idx * state_var_num + TN] -= w;
-        accum_states_data[label * state_var_num + TN] -= w;
+        batch_states_data[idx * state_var_num + TN] -= w;
+        batch_states_data[label * state_var_num + TN] -= w;
       }
     }
 
-    ComputeMetrics(accum_states_data, batch_metrics_data, state_var_num,
+    ComputeMetrics(batch_states_data, batch_metrics_data, state_var_num,
                    cls_num);
 
+    if (states_data == accum_states_data) {
+      // The states are accumulated in place and may be shared by several
+      // threads, e.g. the Hogwild workers, so the batch is merged into them
+      // by the accumulator.
+      auto accumulator = framework::MetricAccumulator<T>::Get(
+          out2->Holder(), accum_states_data, batch_states.size(), 0);
+      ComputeMetrics(accumulator->Add(batch_states_data, merge_steps),
+                     accum_metrics_data, state_var_num, cls_num);
+      return;
+    }
+
+    std::copy(batch_states.begin(), batch_states.end(), accum_states_data);
     if (states_data) {
       for (size_t i = 0; i < cls_num; ++i) {
         for (size_t j = 0; j < state_var_num; ++j) {
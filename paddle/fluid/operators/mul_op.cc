@@ -187,7 +187,11 @@ REGISTER_OPERATOR(mul, ops::MulOp, ops::MulOpMaker, ops::MulOpInferVarType,
 REGISTER_OPERATOR(mul_grad, ops::MulGradOp);
 REGISTER_OP_CPU_KERNEL(
     mul, ops::MulKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::MulKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::MulKernel<paddle::platform::CPUDeviceContext, double>,
+    ops::MulKernel<paddle::platform::CPUDeviceContext,
+                   paddle::platform::bfloat16>);
 REGISTER_OP_CPU_KERNEL(
     mul_grad, ops::MulGradKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::MulGradKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::MulGradKernel<paddle::platform::CPUDeviceContext, double>,
+    ops::MulGradKernel<paddle::platform::CPUDeviceContext,
+                       paddle::platform::bfloat16>);
@@ -148,10 +148,19 @@ class NCEOpMaker : public framework::OpProtoAndCheckerMaker {
         .SetDefault(0);
     AddAttr<int>("seed",
                  "(int) The seed used in sampler. If it is 0, "
-                 "the sampler will generate a seed randomly.")
+                 "the sampler will generate a seed randomly. The sampler "
+                 "is kept across the iterations, so a fixed seed gives one "
+                 "continuous stream of samples per thread, rather than the "
+                 "same samples in every iteration.")
         .SetDefault(0);
     AddAttr<bool>("is_sparse", "(boolean, default false) Sparse update.")
         .SetDefault(false);
+    AddAttr<bool>("shared_negatives",
+                  "(boolean, default false) Whether all the samples in the "
+                  "mini-batch share the same negative classes. The shared "
+                  "negatives are scored and their gradients are computed by "
+                  "GEMM instead of one dot product per sample.")
+        .SetDefault(false);
 
     // for parameter prefetch
     AddAttr<bool>("remote_prefetch", "").SetDefault(false);
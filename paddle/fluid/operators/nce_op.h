@@ -16,13 +16,17 @@ limitations under the License. */
 
 #include <math.h>
 #include <iterator>
+#include <map>
+#include <memory>
 #include <random>
 #include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/sampler.h"
 #include "unsupported/Eigen/CXX11/Tensor"
 
@@ -43,6 +47,80 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
 
+// The samplers are cached per thread by their configuration and the op, so they
+// are not rebuilt in every iteration and the random engine keeps its stream
+// instead of being reseeded. The op is told by the name of its SampleLabels,
+// so the nce ops with the same configuration draw from their own streams, and
+// the grad op, which only reads the probabilities, shares the sampler of its
+// forward op. The custom distribution is only referred by the sampler, so its
+// cached sampler is rebuilt when the tensors are reallocated.
+inline Sampler *GetSampler(const framework::ExecutionContext &context) {
+  int sampler_type = context.Attr<int>("sampler");
+  int seed = context.Attr<int>("seed");
+  int num_total_classes = context.Attr<int>("num_total_classes");
+
+  const float *probs_data = nullptr;
+  const int *alias_data = nullptr;
+  const float *alias_probs_data = nullptr;
+  if (sampler_type == 2) {
+    auto dist_probs = context.Input<Tensor>("CustomDistProbs");
+    auto dist_alias = context.Input<Tensor>("CustomDistAlias");
+    auto dist_alias_probs = context.Input<Tensor>("CustomDistAliasProbs");
+
+    PADDLE_ENFORCE_EQ(dist_probs->numel(), num_total_classes);
+    PADDLE_ENFORCE_EQ(dist_alias->numel(), num_total_classes);
+    PADDLE_ENFORCE_EQ(dist_alias_probs->numel(), num_total_classes);
+
+    probs_data = dist_probs->data<float>();
+    alias_data = dist_alias->data<int>();
+    alias_probs_data = dist_alias_probs->data<float>();
+  }
+
+  struct CachedSampler {
+    const void *probs;
+    const void *alias;
+    const void *alias_probs;
+    std::unique_ptr<Sampler> sampler;
+  };
+  const auto &op = context.op();
+  const std::string sample_labels = op.HasOutputs("SampleLabels")
+                                        ? op.Output("SampleLabels")
+                                        : op.Input("SampleLabels");
+  static thread_local std::map<std::tuple<int, int, int, std::string>,
+                               CachedSampler>
+      cache;
+  auto &cached = cache[std::make_tuple(sampler_type, num_total_classes, seed,
+                                       sample_labels)];
+  if (cached.sampler && cached.probs == probs_data &&
+      cached.alias == alias_data && cached.alias_probs == alias_probs_data) {
+    return cached.sampler.get();
+  }
+
+  switch (sampler_type) {
+    case 0: {
+      cached.sampler.reset(
+          new math::UniformSampler(num_total_classes - 1, seed));
+      break;
+    }
+    case 1: {
+      cached.sampler.reset(
+          new math::LogUniformSampler(num_total_classes - 1, seed));
+      break;
+    }
+    case 2: {
+      cached.sampler.reset(
+          new math::CustomSampler(num_total_classes - 1, probs_data,
+                                  alias_data, alias_probs_data, seed));
+      break;
+    }
+    default: { PADDLE_THROW("Unsupported SamplerType."); }
+  }
+  cached.probs = probs_data;
+  cached.alias = alias_data;
+  cached.alias_probs = alias_probs_data;
+  return cached.sampler.get();
+}
+
 template <typename DeviceContext, typename T>
 void PrepareSamples(const framework::ExecutionContext &context,
                     Sampler *sampler) {
@@ -52,6 +130,7 @@ void PrepareSamples(const framework::ExecutionContext &context,
   // for unitest
   std::vector<int> custom_neg_classes =
       context.Attr<std::vector<int>>("custom_neg_classes");
+  bool shared_negatives = context.Attr<bool>("shared_negatives");
 
   auto sample_labels = context.Output<Tensor>("SampleLabels");
   auto sample_labels_dims = sample_labels->dims();
@@ -59,14 +138,22 @@ void PrepareSamples(const framework::ExecutionContext &context,
       sample_labels->mutable_data<int64_t>(context.GetPlace());
 
   int num_label = label_dims.size() == 2 ? label_dims[1] : 1;
+  // the negative classes used by every sample
+  std::vector<int64_t> negatives(custom_neg_classes.begin(),
+                                 custom_neg_classes.end());
+  if (negatives.empty() && shared_negatives) {
+    for (int j = num_label; j < sample_labels_dims[1]; ++j) {
+      negatives.push_back(sampler->Sample());
+    }
+  }
   int index = 0;
   for (int64_t i = 0; i < label_dims[0]; ++i) {
     int j = 0;
     for (; j < num_label; ++j) {
       sample_labels_data[index++] = label_data[i * num_label + j];
     }
-    if (custom_neg_classes.size() > 0) {
-      for (auto label : custom_neg_classes) {
+    if (negatives.size() > 0) {
+      for (auto label : negatives) {
         sample_labels_data[index++] = label;
       }
     } else {
@@ -78,43 +165,69 @@ void PrepareSamples(const framework::ExecutionContext &context,
   }
 }
 
+// Gathers the weights of the negative classes shared by the batch, which are
+// the tail of every row of SampleLabels, into a [num_neg, dim] block.
+template <typename T>
+void GatherSharedNegatives(const Tensor &weight, const int64_t *neg_labels,
+                           int64_t num_neg, Tensor *neg_weight) {
+  const int64_t dim = weight.dims()[1];
+  const T *weight_data = weight.data<T>();
+  T *neg_weight_data =
+      neg_weight->mutable_data<T>({num_neg, dim}, platform::CPUPlace());
+  for (int64_t k = 0; k < num_neg; ++k) {
+    std::memcpy(neg_weight_data + k * dim, weight_data + neg_labels[k] * dim,
+                dim * sizeof(T));
+  }
+}
+
+// Accumulates the weight gradients x_i * sample_grad_ij to the rows returned
+// by row_of(label). When the negatives are shared by the batch, their
+// gradients are reduced over the batch by one GEMM before being scattered.
+template <typename DeviceContext, typename T, typename RowFn>
+void NCEWeightGrad(const framework::ExecutionContext &context,
+                   const Tensor &sample_labels, const T *sample_grad_data,
+                   int64_t num_true_class, RowFn row_of) {
+  auto &dev_ctx = context.template device_context<DeviceContext>();
+  auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
+  auto *input = context.Input<Tensor>("Input");
+  const T *x_data = input->data<T>();
+  const int64_t batch_size = sample_labels.dims()[0];
+  const int64_t num_sampled = sample_labels.dims()[1];
+  const int64_t dim = input->dims()[1];
+  const int64_t *sample_labels_data = sample_labels.data<int64_t>();
+  bool shared_negatives = context.Attr<bool>("shared_negatives");
+
+  const int64_t num_scattered = shared_negatives ? num_true_class : num_sampled;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    for (int64_t j = 0; j < num_scattered; ++j) {
+      int64_t idx = i * num_sampled + j;
+      blas.AXPY(dim, sample_grad_data[idx], x_data + i * dim,
+                row_of(sample_labels_data[idx]));
+    }
+  }
+  const int64_t num_neg = num_sampled - num_true_class;
+  if (shared_negatives && num_neg > 0) {
+    Tensor neg_grad;
+    T *neg_grad_data =
+        neg_grad.mutable_data<T>({num_neg, dim}, platform::CPUPlace());
+    blas.GEMM(CblasTrans, CblasNoTrans, num_neg, dim, batch_size,
+              static_cast<T>(1), sample_grad_data + num_true_class,
+              num_sampled, x_data, dim, static_cast<T>(0), neg_grad_data,
+              dim);
+    for (int64_t k = 0; k < num_neg; ++k) {
+      blas.AXPY(dim, static_cast<T>(1), neg_grad_data + k * dim,
+                row_of(sample_labels_data[num_true_class + k]));
+    }
+  }
+}
+
 template <typename DeviceContext, typename T>
 class NCEKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext &context) const override {
-    int sampler_type = context.Attr<int>("sampler");
-    int seed = context.Attr<int>("seed");
-    int num_total_classes = context.Attr<int>("num_total_classes");
     int num_neg_samples = context.Attr<int>("num_neg_samples");
-
-    Sampler *sampler;
-    switch (sampler_type) {
-      case 0: {
-        sampler = new math::UniformSampler(num_total_classes - 1, seed);
-        break;
-      }
-      case 1: {
-        sampler = new math::LogUniformSampler(num_total_classes - 1, seed);
-        break;
-      }
-      case 2: {
-        auto dist_probs = context.Input<Tensor>("CustomDistProbs");
-        auto dist_alias = context.Input<Tensor>("CustomDistAlias");
-        auto dist_alias_probs = context.Input<Tensor>("CustomDistAliasProbs");
-
-        PADDLE_ENFORCE_EQ(dist_probs->numel(), num_total_classes);
-        PADDLE_ENFORCE_EQ(dist_alias->numel(), num_total_classes);
-        PADDLE_ENFORCE_EQ(dist_alias_probs->numel(), num_total_classes);
-
-        const float *probs_data = dist_probs->data<float>();
-        const int *alias_data = dist_alias->data<int>();
-        const float *alias_probs_data = dist_alias_probs->data<float>();
-        sampler = new math::CustomSampler(num_total_classes - 1, probs_data,
-                                          alias_data, alias_probs_data, seed);
-        break;
-      }
-      default: { PADDLE_THROW("Unsupported SamplerType."); }
-    }
+    bool shared_negatives = context.Attr<bool>("shared_negatives");
+    Sampler *sampler = GetSampler(context);
 
     PrepareSamples<DeviceContext, T>(context, sampler);
     auto sample_labels = context.Output<Tensor>("SampleLabels");
@@ -217,6 +330,36 @@ class NCEKernel : public framework::OpKernel<T> {
         sample_out_data[i] = (1. / (1. + exp(-sample_out_data[i])));
       }
       context.scope().DeleteScope(&local_scope);
+    } else if (shared_negatives) {
+      auto &dev_ctx = context.template device_context<DeviceContext>();
+      auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
+      auto *input = context.Input<Tensor>("Input");
+      auto *weight = context.Input<Tensor>("Weight");
+      const T *x_data = input->data<T>();
+      const T *w_data = weight->data<T>();
+      const int64_t batch_size = sample_labels->dims()[0];
+      const int64_t dim = input->dims()[1];
+      const int64_t num_neg = sampled_labels_num - num_true_class;
+      for (int64_t i = 0; i < batch_size; ++i) {
+        for (int64_t j = 0; j < num_true_class; ++j) {
+          int64_t idx = i * sampled_labels_num + j;
+          sample_out_data[idx] += blas.DOT(
+              dim, x_data + i * dim, w_data + sample_labels_data[idx] * dim);
+        }
+      }
+      // all the samples are scored against the shared negatives by one GEMM
+      if (num_neg > 0) {
+        Tensor neg_weight;
+        GatherSharedNegatives<T>(*weight, sample_labels_data + num_true_class,
+                                 num_neg, &neg_weight);
+        blas.GEMM(CblasNoTrans, CblasTrans, batch_size, num_neg, dim,
+                  static_cast<T>(1), x_data, dim, neg_weight.data<T>(), dim,
+                  static_cast<T>(1), sample_out_data + num_true_class,
+                  sampled_labels_num);
+      }
+      for (int64_t i = 0; i < sample_labels->numel(); ++i) {
+        sample_out_data[i] = (1. / (1. + exp(-sample_out_data[i])));
+      }
     } else {
       auto weight_mat =
           EigenMatrix<T>::From(*(context.Input<Tensor>("Weight")));
@@ -242,7 +385,6 @@ class NCEKernel : public framework::OpKernel<T> {
         out_data[i] += w * cost;
       }
     }
-    delete sampler;
   }
 };
 
@@ -263,42 +405,13 @@ class NCEGradKernel : public framework::OpKernel<T> {
       sample_weight_data = sample_weight->data<T>();
     }
     int num_neg_samples = context.Attr<int>("num_neg_samples");
-    int num_total_classes = context.Attr<int>("num_total_classes");
     int num_true_class = 1;
     if (label != nullptr) {
       num_true_class = label->dims()[1];
     }
 
-    int sampler_type = context.Attr<int>("sampler");
-    int seed = context.Attr<int>("seed");
-    Sampler *sampler;
-    switch (sampler_type) {
-      case 0: {
-        sampler = new math::UniformSampler(num_total_classes - 1, seed);
-        break;
-      }
-      case 1: {
-        sampler = new math::LogUniformSampler(num_total_classes - 1, seed);
-        break;
-      }
-      case 2: {
-        auto dist_probs = context.Input<Tensor>("CustomDistProbs");
-        auto dist_alias = context.Input<Tensor>("CustomDistAlias");
-        auto dist_alias_probs = context.Input<Tensor>("CustomDistAliasProbs");
-
-        PADDLE_ENFORCE_EQ(dist_probs->numel(), num_total_classes);
-        PADDLE_ENFORCE_EQ(dist_alias->numel(), num_total_classes);
-        PADDLE_ENFORCE_EQ(dist_alias_probs->numel(), num_total_classes);
-
-        const float *probs_data = dist_probs->data<float>();
-        const int *alias_data = dist_alias->data<int>();
-        const float *alias_probs_data = dist_alias_probs->data<float>();
-        sampler = new math::CustomSampler(num_total_classes - 1, probs_data,
-                                          alias_data, alias_probs_data, seed);
-        break;
-      }
-      default: { PADDLE_THROW("Unsupported SamplerType."); }
-    }
+    bool shared_negatives = context.Attr<bool>("shared_negatives");
+    Sampler *sampler = GetSampler(context);
 
     //    T b = 1. / num_total_classes * num_neg_samples;
     Tensor sample_grad;  // tmp tensor
@@ -335,13 +448,10 @@ class NCEGradKernel : public framework::OpKernel<T> {
       if (d_w != nullptr) {
         auto d_w_data = d_w->mutable_data<T>(context.GetPlace());
         std::fill(d_w_data, d_w_data + d_w->numel(), 0.0);
-        auto d_w_matrix = EigenMatrix<T>::From(*d_w);
-        auto x_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
-        for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-          d_w_matrix.chip(sample_labels_data[i], 0) +=
-              x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-              sample_grad_data[i];
-        }
+        const int64_t dim = d_w->dims()[1];
+        NCEWeightGrad<DeviceContext, T>(
+            context, *sample_labels, sample_grad_data, num_true_class,
+            [&](int64_t label) { return d_w_data + label * dim; });
       }
     } else {
       std::vector<int64_t> labels;
@@ -375,13 +485,10 @@ class NCEGradKernel : public framework::OpKernel<T> {
       auto d_w_data = d_table_value->mutable_data<T>(context.GetPlace());
       std::fill(d_w_data, d_w_data + d_table_value->numel(), 0.0);
 
-      auto d_w_matrix = EigenMatrix<T>::From(*d_table_value);
-      auto x_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
-      for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        d_w_matrix.chip(d_w->Index(sample_labels_data[i]), 0) +=
-            x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-            sample_grad_data[i];
-      }
+      const int64_t dim = table_dim[1];
+      NCEWeightGrad<DeviceContext, T>(
+          context, *sample_labels, sample_grad_data, num_true_class,
+          [&](int64_t label) { return d_w_data + d_w->Index(label) * dim; });
     }
 
     // get d_x
@@ -389,15 +496,34 @@ class NCEGradKernel : public framework::OpKernel<T> {
     if (d_x != nullptr) {
       auto *d_x_data = d_x->mutable_data<T>(context.GetPlace());
       std::fill(d_x_data, d_x_data + d_x->numel(), 0.0);
-      auto d_x_matrix = EigenMatrix<T>::From(*d_x);
-      auto w_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Weight")));
-      for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        d_x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) +=
-            w_matrix.chip(sample_labels_data[i], 0) * sample_grad_data[i];
+      auto &dev_ctx = context.template device_context<DeviceContext>();
+      auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
+      auto *weight = context.Input<Tensor>("Weight");
+      const T *w_data = weight->data<T>();
+      const int64_t batch_size = sample_labels->dims()[0];
+      const int64_t num_sampled = sample_labels->dims()[1];
+      const int64_t dim = d_x->dims()[1];
+      const int64_t num_scattered =
+          shared_negatives ? num_true_class : num_sampled;
+      for (int64_t i = 0; i < batch_size; ++i) {
+        for (int64_t j = 0; j < num_scattered; ++j) {
+          int64_t idx = i * num_sampled + j;
+          blas.AXPY(dim, sample_grad_data[idx],
+                    w_data + sample_labels_data[idx] * dim,
+                    d_x_data + i * dim);
+        }
+      }
+      const int64_t num_neg = num_sampled - num_true_class;
+      if (shared_negatives && num_neg > 0) {
+        Tensor neg_weight;
+        GatherSharedNegatives<T>(*weight, sample_labels_data + num_true_class,
+                                 num_neg, &neg_weight);
+        blas.GEMM(CblasNoTrans, CblasNoTrans, batch_size, dim, num_neg,
+                  static_cast<T>(1), sample_grad_data + num_true_class,
+                  num_sampled, neg_weight.data<T>(), dim, static_cast<T>(1),
+                  d_x_data, dim);
       }
     }
-
-    delete sampler;
   }
 };
 }  // namespace operators
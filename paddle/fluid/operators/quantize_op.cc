@@ -13,6 +13,8 @@
  *     limitations under the License. */
 
 #include "paddle/fluid/operators/quantize_op.h"
+#include <algorithm>
+#include <cmath>
 #ifdef PADDLE_WITH_MKLDNN
 #include "paddle/fluid/platform/mkldnn_helper.h"
 #endif
@@ -22,8 +24,13 @@ namespace operators {
 
 framework::OpKernelType QuantOp::GetExpectedKernelType(
     const framework::ExecutionContext& ctx) const {
+#ifdef PADDLE_WITH_MKLDNN
   framework::LibraryType library_ = framework::LibraryType::kMKLDNN;
   framework::DataLayout layout_ = framework::DataLayout::kMKLDNN;
+#else
+  framework::LibraryType library_ = framework::LibraryType::kPlain;
+  framework::DataLayout layout_ = framework::DataLayout::kAnyLayout;
+#endif
 
   return framework::OpKernelType(ctx.Input<Tensor>("Input")->type(),
                                  ctx.GetPlace(), layout_, library_);
@@ -39,9 +46,40 @@ void QuantOpMaker::Make() {
   AddComment(R"DOC(This op will quantize data from FP32 to INT8)DOC");
 }
 
+// The plain CPU kernel, output = saturate(round(input * Scale)), which is
+// uint8 by default, or int8 if is_negative_input.
+template <typename T>
+class CPUQuantOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* output = ctx.Output<Tensor>("Output");
+    float scale = ctx.Attr<float>("Scale");
+    if (ctx.Attr<bool>("is_negative_input")) {
+      Quantize<int8_t>(*input, scale, -128.f, 127.f, ctx.GetPlace(), output);
+    } else {
+      Quantize<uint8_t>(*input, scale, 0.f, 255.f, ctx.GetPlace(), output);
+    }
+  }
+
+ private:
+  template <typename OutT>
+  void Quantize(const Tensor& input, float scale, float lower, float upper,
+                const platform::Place& place, Tensor* output) const {
+    const T* in_data = input.data<T>();
+    OutT* out_data = output->mutable_data<OutT>(place);
+    int64_t numel = input.numel();
+    for (int64_t i = 0; i < numel; ++i) {
+      float v = std::nearbyint(static_cast<float>(in_data[i]) * scale);
+      out_data[i] = static_cast<OutT>(std::min(std::max(v, lower), upper));
+    }
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 namespace ops = paddle::operators;
 
 REGISTER_OPERATOR(quantize, ops::QuantOp, ops::QuantOpMaker,
                   paddle::framework::DefaultGradOpDescMaker<true>);
+REGISTER_OP_CPU_KERNEL(quantize, ops::CPUQuantOpKernel<float>);
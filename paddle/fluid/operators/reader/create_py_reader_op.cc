@@ -37,6 +37,8 @@ class PyReader : public framework::FileReader {
 
   void Shutdown() override { queue_->Close(); }
 
+  void Interrupt() override { queue_->Close(); }
+
   void Start() override { queue_->ReOpen(); }
 
  private:
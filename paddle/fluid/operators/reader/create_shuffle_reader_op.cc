@@ -12,15 +12,26 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <mutex>  // NOLINT
 #include <random>
+#include <thread>  // NOLINT
 #include "glog/logging.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
 #include "paddle/fluid/operators/reader/reader_op_registry.h"
+#include "paddle/fluid/platform/profiler.h"
 
 namespace paddle {
 namespace operators {
 namespace reader {
 
+// The shuffle reader keeps a reservoir of buffer_size instances, which is
+// refilled from the underlying reader by a background thread as soon as an
+// instance is drawn, so that reading doesn't stall at the buffer boundaries.
+// Every instance is drawn uniformly from the full reservoir, or from what is
+// left when the underlying reader is exhausted.
 class ShuffleReader : public framework::DecoratedReader {
  public:
   ShuffleReader(const std::shared_ptr<ReaderBase>& reader, size_t buffer_size,
@@ -31,56 +42,137 @@ class ShuffleReader : public framework::DecoratedReader {
       std::random_device device;
       seed_ = device();
     }
-    ReloadBuffer();
+    engine_.seed(seed_);
+    slots_.resize(buffer_size_);
+    StartFilling();
   }
 
+  ~ShuffleReader() { StopFilling(); }
+
   void ReadNextImpl(std::vector<framework::LoDTensor>* out) override {
     out->clear();
-    if (iteration_pos_ >= buffer_.size()) {
-      VLOG(10) << "Resetting shuffle buffer";
-      ReloadBuffer();
-      if (buffer_.empty()) {
-        return;
-      }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (filled_.size() < buffer_size_ && !eof_) {
+      platform::RecordEvent record_event("ShuffleReader::Stall");
+      auto start = std::chrono::steady_clock::now();
+      cv_.wait(lock, [this] { return filled_.size() >= buffer_size_ || eof_; });
+      stall_ms_ += std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+      ++num_stalls_;
+    }
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+    depth_sum_ += filled_.size();
+    ++num_reads_;
+    if (filled_.empty()) {
+      return;
     }
-    *out = buffer_[iteration_pos_++];
+    std::uniform_int_distribution<size_t> dist(0, filled_.size() - 1);
+    std::swap(filled_[dist(engine_)], filled_.back());
+    size_t slot = filled_.back();
+    filled_.pop_back();
+    // The slot is left empty, so the next instance read into it shares no
+    // memory with the one returned.
+    out->swap(slots_[slot]);
+    free_.push_back(slot);
+    cv_.notify_all();
   }
 
  private:
-  void ShutdownImpl() override {
-    reader_->Shutdown();
-    buffer_.clear();
-    iteration_pos_ = 0;
-  }
+  void ShutdownImpl() override { StopFilling(); }
 
   void StartImpl() override {
     reader_->Start();
-    ReloadBuffer();
+    StartFilling();
   }
 
-  void ReloadBuffer() {
-    buffer_.clear();
-    buffer_.reserve(buffer_size_);
-    iteration_pos_ = 0;
+  void StartFilling() {
+    filled_.clear();
+    free_.clear();
     for (size_t i = 0; i < buffer_size_; ++i) {
-      std::vector<framework::LoDTensor> ins;
-      reader_->ReadNext(&ins);
-      if (ins.empty()) {
-        break;
+      slots_[i].clear();
+      free_.push_back(i);
+    }
+    stop_ = false;
+    eof_ = false;
+    error_ = nullptr;
+    filler_ = std::thread([this] { FillLoop(); });
+  }
+
+  // Interrupts the underlying reader before joining the filler, so that a
+  // filler blocked in reading it, e.g. on the queue of a py_reader, returns.
+  // Shutdown takes the lock the blocked ReadNext holds, so the underlying
+  // reader is only shut down after the filler stops.
+  void StopFilling() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    reader_->Interrupt();
+    if (filler_.joinable()) {
+      filler_.join();
+    }
+    reader_->Shutdown();
+    VLOG(1) << "Shuffle reader read " << num_reads_ << " instances, average "
+            << "reservoir depth "
+            << (num_reads_ ? depth_sum_ / num_reads_ : 0.) << ", stalled "
+            << num_stalls_ << " times for " << stall_ms_ << " ms";
+  }
+
+  void FillLoop() {
+    while (true) {
+      size_t slot;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !free_.empty() || stop_; });
+        if (stop_) return;
+        slot = free_.back();
+        free_.pop_back();
+      }
+      std::exception_ptr error;
+      try {
+        reader_->ReadNext(&slots_[slot]);
+      } catch (...) {
+        error = std::current_exception();
       }
-      buffer_.emplace_back(ins);
+      std::lock_guard<std::mutex> lock(mutex_);
+      // Reading a reader which has been shut down fails, it is not an error.
+      if (stop_) return;
+      if (error || slots_[slot].empty()) {
+        free_.push_back(slot);
+        error_ = error;
+        eof_ = true;
+        cv_.notify_all();
+        return;
+      }
+      filled_.push_back(slot);
+      cv_.notify_all();
     }
-    std::mt19937 g(seed_);
-    std::shuffle(buffer_.begin(), buffer_.end(), g);
-    seed_ = g();  // update seed_;
-    VLOG(10) << "random buffer size = " << buffer_.size();
   }
 
   size_t buffer_size_;
-  std::vector<std::vector<framework::LoDTensor>> buffer_;
-
-  size_t iteration_pos_;
   size_t seed_;
+  std::mt19937 engine_;
+
+  // The instances, the indices of the filled ones and the free ones.
+  std::vector<std::vector<framework::LoDTensor>> slots_;
+  std::vector<size_t> filled_;
+  std::vector<size_t> free_;
+  bool stop_{false};
+  bool eof_{false};
+  std::exception_ptr error_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread filler_;
+
+  // The statistics of reading.
+  size_t num_reads_{0};
+  double depth_sum_{0.};
+  size_t num_stalls_{0};
+  double stall_ms_{0.};
 };
 
 class CreateShuffleReaderOp : public framework::OperatorBase {
@@ -111,6 +203,7 @@ class CreateShuffleReaderOpMaker : public DecoratedReaderMakerBase {
 
       A shuffle reader takes another reader as its 'underlying reader'
       and yields the underlying reader's outputs in a shuffled order.
+      A background thread keeps refilling the shuffle buffer.
     )DOC");
   }
 };
@@ -0,0 +1,118 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/operators/reader/blocking_queue.h"
+
+USE_NO_KERNEL_OP(create_shuffle_reader);
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// Reads the instances from a queue in ReadNextImpl, i.e. under the lock of
+// ReaderBase, like a reader decorating a py_reader. A negative value fails.
+class QueueReader : public framework::FileReader {
+ public:
+  QueueReader() : queue_(16) {}
+
+  BlockingQueue<int>* queue() { return &queue_; }
+
+  void Interrupt() override { queue_.Close(); }
+
+ protected:
+  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override {
+    out->clear();
+    int value;
+    if (!queue_.Receive(&value)) return;
+    PADDLE_ENFORCE_GE(value, 0, "bad instance");
+    framework::LoDTensor tensor;
+    tensor.mutable_data<int>(framework::make_ddim({1}),
+                             platform::CPUPlace())[0] = value;
+    out->push_back(tensor);
+  }
+
+  void ShutdownImpl() override { queue_.Close(); }
+
+  void StartImpl() override { queue_.ReOpen(); }
+
+ private:
+  BlockingQueue<int> queue_;
+};
+
+std::shared_ptr<QueueReader> CreateShuffleReader(framework::Scope* scope,
+                                                 int buffer_size) {
+  auto source = std::make_shared<QueueReader>();
+  scope->Var("source")->GetMutable<framework::ReaderHolder>()->Reset(source);
+  scope->Var("shuffled");
+  framework::AttributeMap attrs;
+  attrs["buffer_size"] = buffer_size;
+  auto op = framework::OpRegistry::CreateOp("create_shuffle_reader",
+                                            {{"UnderlyingReader", {"source"}}},
+                                            {{"Out", {"shuffled"}}}, attrs);
+  op->Run(*scope, platform::CPUPlace());
+  return source;
+}
+
+TEST(ShuffleReader, ShutdownWhileBlocked) {
+  framework::Scope scope;
+  auto source = CreateShuffleReader(&scope, 4);
+  auto* shuffled =
+      scope.FindVar("shuffled")->GetMutable<framework::ReaderHolder>();
+  // Let the filler block on the empty queue, then shut the reader down.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  shuffled->Shutdown();
+
+  // The reader can be started again and reads all the instances.
+  shuffled->Start();
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_TRUE(source->queue()->Send(i));
+  }
+  source->queue()->Close();
+  std::set<int> values;
+  std::vector<framework::LoDTensor> out;
+  for (shuffled->ReadNext(&out); !out.empty(); shuffled->ReadNext(&out)) {
+    values.insert(out[0].data<int>()[0]);
+  }
+  EXPECT_EQ(values, std::set<int>({0, 1, 2, 3, 4, 5}));
+
+  // Destroying the reader while the filler is blocked doesn't hang either.
+  shuffled->Shutdown();
+  shuffled->Start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  scope.EraseVars({"shuffled"});
+}
+
+TEST(ShuffleReader, RethrowFillerError) {
+  framework::Scope scope;
+  auto source = CreateShuffleReader(&scope, 4);
+  auto* shuffled =
+      scope.FindVar("shuffled")->GetMutable<framework::ReaderHolder>();
+  ASSERT_TRUE(source->queue()->Send(1));
+  ASSERT_TRUE(source->queue()->Send(-1));
+  std::vector<framework::LoDTensor> out;
+  EXPECT_THROW(shuffled->ReadNext(&out), platform::EnforceNotMet);
+  shuffled->Shutdown();
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
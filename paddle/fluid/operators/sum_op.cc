@@ -12,11 +12,14 @@ limitations under the License. */
 #include "paddle/fluid/operators/sum_op.h"
 
 #include <algorithm>
+#include <numeric>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "paddle/fluid/framework/var_type_inference.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 
 #ifdef PADDLE_WITH_MKLDNN
 #include "paddle/fluid/platform/mkldnn_helper.h"
@@ -229,6 +232,216 @@ class SumGradMaker : public framework::GradOpDescMakerBase {
   }
 };
 
+namespace {
+
+// The size of the blocks of the output, which stay in the cache while all
+// the inputs are added to them.
+constexpr int64_t kSumBlockSize = 4096;
+// The least elements to read to sum in parallel.
+constexpr int64_t kSumParallelSize = 1 << 16;
+
+template <typename T>
+void SumDense(const std::vector<const T *> &ins, int64_t numel, T *out) {
+  int64_t num_blocks = (numel + kSumBlockSize - 1) / kSumBlockSize;
+  int64_t num_ins = ins.size();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (numel * num_ins >= kSumParallelSize)
+#endif
+  for (int64_t b = 0; b < num_blocks; ++b) {
+    int64_t begin = b * kSumBlockSize;
+    int64_t len = std::min(kSumBlockSize, numel - begin);
+    T *o = out + begin;
+    // the first input is the output if it is in place
+    if (ins[0] != out) {
+      std::copy(ins[0] + begin, ins[0] + begin + len, o);
+    }
+    int64_t i = 1;
+    for (; i + 4 <= num_ins; i += 4) {
+      const T *a = ins[i] + begin;
+      const T *b = ins[i + 1] + begin;
+      const T *c = ins[i + 2] + begin;
+      const T *d = ins[i + 3] + begin;
+      for (int64_t j = 0; j < len; ++j) {
+        o[j] += (a[j] + b[j]) + (c[j] + d[j]);
+      }
+    }
+    for (; i < num_ins; ++i) {
+      const T *a = ins[i] + begin;
+      for (int64_t j = 0; j < len; ++j) {
+        o[j] += a[j];
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+bool SumFastPath<platform::CPUDeviceContext, T>::SumToTensor(
+    const framework::ExecutionContext &context,
+    const std::vector<const framework::Variable *> &in_vars, bool in_place,
+    LoDTensor *out) const {
+  int64_t numel = out->numel();
+  if (numel == 0) {
+    return false;
+  }
+  std::vector<const T *> dense_ins;
+  std::vector<const SelectedRows *> sparse_ins;
+  if (in_place) {
+    // the output is reused, and the first input is not read again
+    dense_ins.push_back(out->data<T>());
+  }
+  for (size_t i = in_place ? 1 : 0; i < in_vars.size(); ++i) {
+    if (in_vars[i]->IsType<LoDTensor>()) {
+      auto &in = in_vars[i]->Get<LoDTensor>();
+      if (in.numel() == 0) {
+        continue;
+      }
+      if (in.numel() != numel) {
+        return false;
+      }
+      dense_ins.push_back(in.data<T>());
+    } else if (in_vars[i]->IsType<SelectedRows>()) {
+      auto &in = in_vars[i]->Get<SelectedRows>();
+      if (in.rows().size() > 0) {
+        sparse_ins.push_back(&in);
+      }
+    } else {
+      return false;
+    }
+  }
+
+  auto &dev_ctx = context.template device_context<platform::CPUDeviceContext>();
+  T *out_data = out->mutable_data<T>(context.GetPlace());
+  if (dense_ins.empty()) {
+    math::SetConstant<platform::CPUDeviceContext, T> constant_functor;
+    constant_functor(dev_ctx, out, static_cast<T>(0));
+  } else {
+    SumDense(dense_ins, numel, out_data);
+  }
+  math::SelectedRowsAddToTensor<platform::CPUDeviceContext, T> functor;
+  for (auto *in : sparse_ins) {
+    functor(dev_ctx, *in, out);
+  }
+  return true;
+}
+
+template <typename T>
+bool SumFastPath<platform::CPUDeviceContext, T>::SumToSelectedRows(
+    const framework::ExecutionContext &context,
+    const std::vector<const framework::Variable *> &in_vars,
+    SelectedRows *out) const {
+  std::vector<const SelectedRows *> ins;
+  size_t num_rows = 0;
+  for (auto *in_var : in_vars) {
+    if (!in_var->IsType<SelectedRows>()) {
+      return false;
+    }
+    auto &in = in_var->Get<SelectedRows>();
+    if (in.rows().size() > 0) {
+      ins.push_back(&in);
+      num_rows += in.rows().size();
+    }
+  }
+  if (ins.empty()) {
+    // no data, just set a empty out tensor.
+    out->mutable_rows()->clear();
+    out->mutable_value()->mutable_data<T>(framework::make_ddim({0}),
+                                          context.GetPlace());
+    return true;
+  }
+
+  int64_t width = ins[0]->value().dims()[1];
+  int64_t height = ins[0]->height();
+  for (auto *in : ins) {
+    PADDLE_ENFORCE_EQ(width, in->value().dims()[1],
+                      "all input should have same "
+                      "dimension except for the first one");
+    PADDLE_ENFORCE_EQ(height, in->height(),
+                      "all input should have same height");
+  }
+
+  // Finds the unique rows in one pass, and the output row of every input
+  // row, which is the order of the row in the sorted unique rows.
+  std::unordered_map<int64_t, int64_t> row_to_id;
+  row_to_id.reserve(num_rows);
+  std::vector<int64_t> rows;
+  std::vector<int64_t> targets;
+  targets.reserve(num_rows);
+  for (auto *in : ins) {
+    for (int64_t row : in->rows()) {
+      auto it = row_to_id.emplace(row, rows.size()).first;
+      if (it->second == static_cast<int64_t>(rows.size())) {
+        rows.push_back(row);
+      }
+      targets.push_back(it->second);
+    }
+  }
+  std::vector<int64_t> order(rows.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&rows](int64_t a, int64_t b) { return rows[a] < rows[b]; });
+  std::vector<int64_t> sorted_rows(rows.size());
+  std::vector<int64_t> rank(rows.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    sorted_rows[i] = rows[order[i]];
+    rank[order[i]] = i;
+  }
+  for (auto &t : targets) {
+    t = rank[t];
+  }
+
+  // The output rows are split to the threads, and every thread adds the
+  // input rows to its output rows in the order of the inputs.
+  int64_t num_out = sorted_rows.size();
+  framework::Tensor merged;
+  T *merged_data = merged.mutable_data<T>(
+      framework::make_ddim({num_out, width}), context.GetPlace());
+  std::vector<uint8_t> touched(num_out, 0);
+  int num_parts = static_cast<int64_t>(num_rows) * width >= kSumParallelSize
+                      ? platform::GetNumThreads()
+                      : 1;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (num_parts > 1)
+#endif
+  for (int p = 0; p < num_parts; ++p) {
+    int64_t lo = num_out * p / num_parts;
+    int64_t hi = num_out * (p + 1) / num_parts;
+    const int64_t *target = targets.data();
+    for (auto *in : ins) {
+      const T *in_data = in->value().data<T>();
+      for (size_t i = 0; i < in->rows().size(); ++i, ++target) {
+        int64_t t = *target;
+        if (t < lo || t >= hi) {
+          continue;
+        }
+        const T *src = in_data + i * width;
+        T *dst = merged_data + t * width;
+        if (touched[t]) {
+          for (int64_t j = 0; j < width; ++j) {
+            dst[j] += src[j];
+          }
+        } else {
+          std::copy(src, src + width, dst);
+          touched[t] = 1;
+        }
+      }
+    }
+  }
+
+  // the inputs have been read, so the output may be the first input
+  out->set_rows(sorted_rows);
+  out->set_height(height);
+  *out->mutable_value() = merged;
+  out->SyncIndex();
+  return true;
+}
+
+template struct SumFastPath<platform::CPUDeviceContext, float>;
+template struct SumFastPath<platform::CPUDeviceContext, double>;
+template struct SumFastPath<platform::CPUDeviceContext, int>;
+template struct SumFastPath<platform::CPUDeviceContext, int64_t>;
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -27,6 +27,39 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenVector = framework::EigenVector<T, MajorType, IndexType>;
 
+// The fast paths of SumKernel, which return false if the inputs are not
+// supported and should be summed one by one.
+template <typename DeviceContext, typename T>
+struct SumFastPath {
+  bool SumToTensor(const framework::ExecutionContext &context,
+                   const std::vector<const framework::Variable *> &in_vars,
+                   bool in_place, LoDTensor *out) const {
+    return false;
+  }
+
+  bool SumToSelectedRows(
+      const framework::ExecutionContext &context,
+      const std::vector<const framework::Variable *> &in_vars,
+      SelectedRows *out) const {
+    return false;
+  }
+};
+
+// On CPU, the dense inputs are summed block by block in one pass over the
+// output, and the SelectedRows inputs are merged into the unique rows by a
+// hash map, both in parallel. See sum_op.cc.
+template <typename T>
+struct SumFastPath<platform::CPUDeviceContext, T> {
+  bool SumToTensor(const framework::ExecutionContext &context,
+                   const std::vector<const framework::Variable *> &in_vars,
+                   bool in_place, LoDTensor *out) const;
+
+  bool SumToSelectedRows(
+      const framework::ExecutionContext &context,
+      const std::vector<const framework::Variable *> &in_vars,
+      SelectedRows *out) const;
+};
+
 template <typename DeviceContext, typename T>
 class SumKernel : public framework::OpKernel<T> {
  public:
@@ -37,8 +70,12 @@ class SumKernel : public framework::OpKernel<T> {
 
     bool in_place = out_var == in_vars[0];
 
+    SumFastPath<DeviceContext, T> fast_path;
     if (out_var->IsType<framework::LoDTensor>()) {
       auto *out = context.Output<LoDTensor>("Out");
+      if (fast_path.SumToTensor(context, in_vars, in_place, out)) {
+        return;
+      }
       if (!in_place) {
         out->mutable_data<T>(context.GetPlace());
       }
@@ -86,6 +123,10 @@ class SumKernel : public framework::OpKernel<T> {
       if (in_place && in_vars.size() < 2) {
         return;
       }
+      if (fast_path.SumToSelectedRows(context, in_vars,
+                                      context.Output<SelectedRows>("Out"))) {
+        return;
+      }
 
       std::vector<const paddle::framework::SelectedRows *> inputs;
       SelectedRows temp_in0;
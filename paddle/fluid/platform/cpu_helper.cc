@@ -47,5 +47,13 @@ void SetNumThreads(int num_threads) {
 #endif
 }
 
+int GetNumThreads() {
+#ifdef PADDLE_WITH_MKLML
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
 }  // namespace platform
 }  // namespace paddle
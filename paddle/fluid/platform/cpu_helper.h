@@ -22,5 +22,9 @@ namespace platform {
 //! Set the number of threads in use.
 void SetNumThreads(int num_threads);
 
+//! The number of threads of the OpenMP parallel loops in the CPU kernels,
+//! which is 1 if they are not compiled with OpenMP.
+int GetNumThreads();
+
 }  // namespace platform
 }  // namespace paddle
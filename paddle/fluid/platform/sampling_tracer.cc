@@ -0,0 +1,341 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampling_tracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/platform/device_tracer.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_int32(tracer_sample_period, 0,
+             "The sampling tracer traces one in every tracer_sample_period "
+             "iterations of every thread, it is disabled if it is 0.");
+DEFINE_int32(tracer_buffer_size, 65536,
+             "The size of the ring buffer of the latest events kept by the "
+             "sampling tracer for every thread, it is rounded up to a power "
+             "of 2.");
+
+namespace paddle {
+namespace platform {
+
+thread_local bool g_trace_sampled = false;
+
+namespace {
+
+inline uint64_t ReadTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+// The tsc and the wall time read at the same point, two of them convert the
+// tsc of the events to the wall time.
+struct TscAnchor {
+  uint64_t tsc;
+  uint64_t ns;
+};
+
+inline TscAnchor ReadAnchor() { return {ReadTsc(), PosixInNsec()}; }
+
+const TscAnchor g_start_anchor = ReadAnchor();
+
+struct TraceEvent {
+  uint32_t name_id;
+  uint64_t start;
+  uint64_t end;
+};
+
+// The events of one thread, only written by the thread. The records are
+// atomic so that they can be read while being overwritten, and the torn
+// ones are dropped by checking the write index again after reading.
+class TraceRing {
+ public:
+  TraceRing(size_t capacity, int64_t thread_id)
+      : capacity_(capacity),
+        records_(new Record[capacity]),
+        thread_id_(thread_id) {}
+
+  size_t capacity() const { return capacity_; }
+
+  int64_t thread_id() const { return thread_id_; }
+
+  void Push(uint32_t name_id, uint64_t start, uint64_t end) {
+    uint64_t n = next_.load(std::memory_order_relaxed);
+    // the record must not be seen written before the previous index
+    std::atomic_thread_fence(std::memory_order_release);
+    Record& r = records_[n & (capacity_ - 1)];
+    r.name_id.store(name_id, std::memory_order_relaxed);
+    r.start.store(start, std::memory_order_relaxed);
+    r.end.store(end, std::memory_order_relaxed);
+    next_.store(n + 1, std::memory_order_release);
+  }
+
+  void Collect(std::vector<TraceEvent>* events) const {
+    uint64_t end = next_.load(std::memory_order_acquire);
+    uint64_t begin = std::max(begin_.load(std::memory_order_relaxed),
+                              end > capacity_ ? end - capacity_ : 0);
+    std::vector<TraceEvent> copied;
+    copied.reserve(end - begin);
+    for (uint64_t i = begin; i < end; ++i) {
+      const Record& r = records_[i & (capacity_ - 1)];
+      copied.push_back({static_cast<uint32_t>(r.name_id.load(
+                            std::memory_order_relaxed)),
+                        r.start.load(std::memory_order_relaxed),
+                        r.end.load(std::memory_order_relaxed)});
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // the records from index `overwritten` may be overwritten while copying
+    uint64_t next = next_.load(std::memory_order_relaxed);
+    uint64_t overwritten = next >= capacity_ ? next - capacity_ + 1 : 0;
+    for (uint64_t i = std::max(begin, overwritten); i < end; ++i) {
+      events->push_back(copied[i - begin]);
+    }
+  }
+
+  void Reset() {
+    begin_.store(next_.load(std::memory_order_acquire),
+                 std::memory_order_relaxed);
+  }
+
+ private:
+  struct Record {
+    std::atomic<uint64_t> name_id{0};
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> end{0};
+  };
+
+  const uint64_t capacity_;
+  std::unique_ptr<Record[]> records_;
+  const int64_t thread_id_;
+  std::atomic<uint64_t> next_{0};
+  std::atomic<uint64_t> begin_{0};
+};
+
+std::mutex g_trace_names_mutex;
+std::vector<std::string> g_trace_names;
+std::unordered_map<std::string, uint32_t> g_trace_name_ids;
+
+// A ring is kept after its thread exits so that its events can still be
+// exported, and it is reused by the next new thread. So the number of rings
+// is bounded by the peak number of the tracing threads, even if the threads
+// are created again and again, e.g. by every train_from_dataset, and a
+// thread id in the trace is shared by threads which did not run together.
+std::mutex g_trace_rings_mutex;
+std::list<std::shared_ptr<TraceRing>> g_trace_rings;
+std::vector<std::shared_ptr<TraceRing>> g_free_trace_rings;
+int64_t g_next_trace_thread_id = 0;
+
+// Releases the ring of the thread to g_free_trace_rings at the thread exit.
+struct ThreadTraceRing {
+  ~ThreadTraceRing() {
+    if (ring) {
+      std::lock_guard<std::mutex> guard(g_trace_rings_mutex);
+      g_free_trace_rings.push_back(std::move(ring));
+    }
+  }
+
+  std::shared_ptr<TraceRing> ring;
+};
+
+thread_local ThreadTraceRing g_trace_ring;
+thread_local int g_trace_depth = 0;
+thread_local uint64_t g_trace_iteration = 0;
+
+TraceRing& GetTraceRing() {
+  auto& ring = g_trace_ring.ring;
+  if (!ring) {
+    size_t capacity = 2;
+    while (capacity < static_cast<size_t>(FLAGS_tracer_buffer_size)) {
+      capacity <<= 1;
+    }
+    std::lock_guard<std::mutex> guard(g_trace_rings_mutex);
+    // reuse the latest released ring of the same size
+    auto it = std::find_if(g_free_trace_rings.rbegin(),
+                           g_free_trace_rings.rend(),
+                           [capacity](const std::shared_ptr<TraceRing>& r) {
+                             return r->capacity() == capacity;
+                           });
+    if (it != g_free_trace_rings.rend()) {
+      ring = std::move(*it);
+      g_free_trace_rings.erase(std::next(it).base());
+    } else {
+      ring = std::make_shared<TraceRing>(capacity, g_next_trace_thread_id++);
+      g_trace_rings.push_back(ring);
+    }
+  }
+  return *ring;
+}
+
+std::string EscapeJson(const std::string& s) {
+  std::string escaped;
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped.push_back(' ');
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+uint32_t TraceNameId(const std::string& name) {
+  static thread_local std::unordered_map<std::string, uint32_t> cache;
+  auto it = cache.find(name);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  uint32_t id;
+  {
+    std::lock_guard<std::mutex> guard(g_trace_names_mutex);
+    auto res = g_trace_name_ids.emplace(name, g_trace_names.size());
+    if (res.second) {
+      g_trace_names.push_back(name);
+    }
+    id = res.first->second;
+  }
+  cache.emplace(name, id);
+  return id;
+}
+
+TraceIteration::TraceIteration() {
+  if (g_trace_depth++ > 0) return;
+  int period = FLAGS_tracer_sample_period;
+  g_trace_sampled = period > 0 && g_trace_iteration++ % period == 0;
+}
+
+TraceIteration::~TraceIteration() {
+  if (--g_trace_depth == 0) {
+    g_trace_sampled = false;
+  }
+}
+
+RecordTrace::RecordTrace(uint32_t name_id)
+    : name_id_(name_id), start_(g_trace_sampled ? ReadTsc() : 0) {}
+
+RecordTrace::RecordTrace(const std::string& name)
+    : RecordTrace(g_trace_sampled ? TraceNameId(name) : 0) {}
+
+RecordTrace::~RecordTrace() {
+  if (start_ == 0) return;
+  GetTraceRing().Push(name_id_, start_, ReadTsc());
+}
+
+proto::Profile GetTraceProfile() {
+  std::vector<std::string> names;
+  {
+    std::lock_guard<std::mutex> guard(g_trace_names_mutex);
+    names = g_trace_names;
+  }
+  std::list<std::shared_ptr<TraceRing>> rings;
+  {
+    std::lock_guard<std::mutex> guard(g_trace_rings_mutex);
+    rings = g_trace_rings;
+  }
+
+  TscAnchor anchor = ReadAnchor();
+  double ns_per_tick =
+      anchor.tsc > g_start_anchor.tsc
+          ? static_cast<double>(anchor.ns - g_start_anchor.ns) /
+                (anchor.tsc - g_start_anchor.tsc)
+          : 1.0;
+  auto to_ns = [&](uint64_t tsc) {
+    return g_start_anchor.ns +
+           static_cast<uint64_t>((tsc - g_start_anchor.tsc) * ns_per_tick);
+  };
+
+  proto::Profile profile;
+  uint64_t start_ns = std::numeric_limits<uint64_t>::max();
+  uint64_t end_ns = 0;
+  std::vector<TraceEvent> events;
+  for (auto& ring : rings) {
+    events.clear();
+    ring->Collect(&events);
+    for (auto& e : events) {
+      PADDLE_ENFORCE_LT(e.name_id, names.size());
+      auto* event = profile.add_events();
+      event->set_type(proto::Event::CPU);
+      event->set_name(names[e.name_id]);
+      event->set_start_ns(to_ns(e.start));
+      event->set_end_ns(to_ns(e.end));
+      event->set_device_id(-1);
+      event->set_sub_device_id(ring->thread_id());
+      start_ns = std::min<uint64_t>(start_ns, event->start_ns());
+      end_ns = std::max<uint64_t>(end_ns, event->end_ns());
+    }
+  }
+  if (profile.events_size() > 0) {
+    profile.set_start_ns(start_ns);
+    profile.set_end_ns(end_ns);
+  }
+  return profile;
+}
+
+void ExportTraceProfile(const std::string& path) {
+  proto::Profile profile = GetTraceProfile();
+  std::ofstream fout(path, std::ios::out | std::ios::trunc | std::ios::binary);
+  PADDLE_ENFORCE(fout.is_open(), "Cannot open %s to write the trace.", path);
+  fout << profile.SerializeAsString();
+}
+
+void ExportChromeTrace(const std::string& path) {
+  proto::Profile profile = GetTraceProfile();
+  std::ofstream fout(path, std::ios::out | std::ios::trunc);
+  PADDLE_ENFORCE(fout.is_open(), "Cannot open %s to write the trace.", path);
+  fout << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+  for (int i = 0; i < profile.events_size(); ++i) {
+    const auto& e = profile.events(i);
+    // the timestamps of the Chrome trace are in microseconds
+    fout << (i > 0 ? ",\n" : "\n") << "{\"name\":\"" << EscapeJson(e.name())
+         << "\",\"cat\":\"CPU\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+         << e.sub_device_id() << ",\"ts\":" << e.start_ns() / 1000.0
+         << ",\"dur\":" << (e.end_ns() - e.start_ns()) / 1000.0 << "}";
+  }
+  fout << "\n]}\n";
+}
+
+void ResetTrace() {
+  std::lock_guard<std::mutex> guard(g_trace_rings_mutex);
+  for (auto& ring : g_trace_rings) {
+    ring->Reset();
+  }
+}
+
+}  // namespace platform
+}  // namespace paddle
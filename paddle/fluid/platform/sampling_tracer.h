@@ -0,0 +1,83 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "paddle/fluid/platform/profiler.pb.h"
+
+namespace paddle {
+namespace platform {
+
+/*
+ * A low-overhead tracer which is cheap enough to be always on, e.g. in
+ * serving. Unlike the profiler, it takes no lock on the hot path:
+ *
+ * 1. The event names are interned into ids once per thread.
+ * 2. Every thread writes its events to its own fixed-size ring buffer, so the
+ *    memory is bounded and the oldest events are overwritten. The ring of an
+ *    exited thread is reused by the next new thread.
+ * 3. The timestamps are read by rdtsc and converted to nanoseconds only when
+ *    the trace is exported.
+ * 4. Only one in FLAGS_tracer_sample_period iterations of every thread is
+ *    traced, it is disabled when the period is 0.
+ *
+ * The trace can be exported to the profiler.proto format, as the profiler
+ * does, or to the Chrome trace format at any time.
+ */
+
+// Whether the current iteration of the calling thread is traced.
+extern thread_local bool g_trace_sampled;
+
+inline bool IsTraceSampled() { return g_trace_sampled; }
+
+// Interns the event name, the returned id is stable in the process.
+uint32_t TraceNameId(const std::string& name);
+
+// Marks an iteration of the calling thread, e.g. an executor run. Only the
+// outermost iteration is counted and decides whether it is traced.
+class TraceIteration {
+ public:
+  TraceIteration();
+  ~TraceIteration();
+};
+
+// Records the scope as an event of the calling thread, if it is traced.
+class RecordTrace {
+ public:
+  explicit RecordTrace(uint32_t name_id);
+  explicit RecordTrace(const std::string& name);
+  ~RecordTrace();
+
+ private:
+  uint32_t name_id_;
+  uint64_t start_;
+};
+
+// Collects the events in the ring buffers of all the threads.
+proto::Profile GetTraceProfile();
+
+// Writes the events as a serialized proto::Profile.
+void ExportTraceProfile(const std::string& path);
+
+// Writes the events in the Chrome trace format, which can be loaded by
+// chrome://tracing.
+void ExportChromeTrace(const std::string& path);
+
+// Drops the events in the ring buffers of all the threads.
+void ResetTrace();
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,113 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampling_tracer.h"
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+
+DECLARE_int32(tracer_sample_period);
+DECLARE_int32(tracer_buffer_size);
+
+namespace paddle {
+namespace platform {
+
+TEST(SamplingTracer, Sample) {
+  FLAGS_tracer_sample_period = 4;
+  ResetTrace();
+  for (int i = 0; i < 8; ++i) {
+    TraceIteration iteration;
+    RecordTrace outer("outer");
+    {
+      // nested iterations are not counted
+      TraceIteration nested;
+      RecordTrace inner("inner");
+    }
+  }
+  FLAGS_tracer_sample_period = 0;
+
+  proto::Profile profile = GetTraceProfile();
+  // the 1st and the 5th iterations are traced
+  ASSERT_EQ(profile.events_size(), 4);
+  for (auto& e : profile.events()) {
+    EXPECT_TRUE(e.name() == "inner" || e.name() == "outer");
+    EXPECT_LE(e.start_ns(), e.end_ns());
+    EXPECT_EQ(e.device_id(), -1);
+  }
+  EXPECT_EQ(TraceNameId("outer"), TraceNameId(std::string("outer")));
+  EXPECT_NE(TraceNameId("outer"), TraceNameId("inner"));
+}
+
+TEST(SamplingTracer, RingBuffer) {
+  FLAGS_tracer_sample_period = 1;
+  FLAGS_tracer_buffer_size = 16;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([]() {
+      for (int i = 0; i < 100; ++i) {
+        TraceIteration iteration;
+        RecordTrace record("op_" + std::to_string(i % 3));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  FLAGS_tracer_sample_period = 0;
+
+  // every new thread keeps the latest 15 events, the oldest slot of the
+  // ring may be being overwritten so it is not collected
+  proto::Profile profile = GetTraceProfile();
+  int events = 0;
+  for (auto& e : profile.events()) {
+    if (e.name().compare(0, 3, "op_") == 0) ++events;
+  }
+  EXPECT_EQ(events, 4 * 15);
+
+  ResetTrace();
+  EXPECT_EQ(GetTraceProfile().events_size(), 0);
+}
+
+TEST(SamplingTracer, ReuseRing) {
+  FLAGS_tracer_sample_period = 1;
+  FLAGS_tracer_buffer_size = 16;
+  ResetTrace();
+  // the threads run one after another, so they all write the same ring
+  for (int t = 0; t < 8; ++t) {
+    std::thread thread([]() {
+      TraceIteration iteration;
+      RecordTrace record("reused");
+    });
+    thread.join();
+  }
+  FLAGS_tracer_sample_period = 0;
+
+  proto::Profile profile = GetTraceProfile();
+  std::set<int64_t> thread_ids;
+  int events = 0;
+  for (auto& e : profile.events()) {
+    if (e.name() == "reused") {
+      thread_ids.insert(e.sub_device_id());
+      ++events;
+    }
+  }
+  EXPECT_EQ(events, 8);
+  EXPECT_EQ(thread_ids.size(), 1UL);
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -46,6 +46,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/init.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_tracer.h"
 #include "paddle/fluid/pybind/async_executor_py.h"
 #include "paddle/fluid/pybind/const_value.h"
 #include "paddle/fluid/pybind/data_set_py.h"
@@ -335,6 +336,14 @@ PYBIND11_MODULE(core, m) {
       .def("set", PyCUDAPinnedTensorSetFromArray<uint8_t>)
       .def("set", PyCUDAPinnedTensorSetFromArray<int8_t>)
 #endif
+      .def("_share_data_with_numpy", PyCPUTensorShareDataWithArray<float>)
+      .def("_share_data_with_numpy", PyCPUTensorShareDataWithArray<int>)
+      .def("_share_data_with_numpy", PyCPUTensorShareDataWithArray<double>)
+      .def("_share_data_with_numpy", PyCPUTensorShareDataWithArray<int64_t>)
+      .def("_share_data_with_numpy", PyCPUTensorShareDataWithArray<bool>)
+      .def("_share_data_with_numpy", PyCPUTensorShareDataWithArray<uint16_t>)
+      .def("_share_data_with_numpy", PyCPUTensorShareDataWithArray<uint8_t>)
+      .def("_share_data_with_numpy", PyCPUTensorShareDataWithArray<int8_t>)
       .def("shape", [](Tensor &self) { return vectorize(self.dims()); })
       .def("_set_float_element", TensorSetElement<float>)
       .def("_get_float_element", TensorGetElement<float>)
@@ -974,6 +983,9 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("disable_profiler", platform::DisableProfiler);
   m.def("is_profiler_enabled", platform::IsProfileEnabled);
   m.def("reset_profiler", platform::ResetProfiler);
+  m.def("export_trace_profile", platform::ExportTraceProfile);
+  m.def("export_chrome_trace", platform::ExportChromeTrace);
+  m.def("reset_trace", platform::ResetTrace);
   m.def("get_pass", [](const std::string &pass_type) {
     auto pass = framework::ir::PassRegistry::Instance().Get(pass_type);
     return std::shared_ptr<framework::ir::Pass>(std::move(pass));
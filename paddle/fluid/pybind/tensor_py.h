@@ -14,8 +14,12 @@ limitations under the License. */
 
 #pragma once
 #include <Python.h>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/memory/memcpy.h"
@@ -191,6 +195,99 @@ inline void PyCPUTensorSetFromArray(
   std::memcpy(dst, array.data(), sizeof(uint16_t) * array.size());
 }
 
+// Releases the references of the numpy arrays borrowed by tensors. The
+// tensors could be destroyed in the threads of C++ readers, which do not
+// hold the GIL. Acquiring the GIL there could deadlock with the Python
+// thread waiting for the readers, so the references are released later in
+// the thread holding the GIL.
+class NumpyReleaser {
+ public:
+  static NumpyReleaser &Instance() {
+    static NumpyReleaser releaser;
+    return releaser;
+  }
+
+  void Add(PyObject *obj) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    pending_.push_back(obj);
+    if (!scheduled_ && Py_IsInitialized()) {
+      scheduled_ = Py_AddPendingCall(&NumpyReleaser::PendingCall, nullptr) == 0;
+    }
+  }
+
+  // Must be called with the GIL held.
+  void ReleaseAll() {
+    std::vector<PyObject *> pending;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      pending.swap(pending_);
+      scheduled_ = false;
+    }
+    for (auto *obj : pending) {
+      Py_DECREF(obj);
+    }
+  }
+
+ private:
+  NumpyReleaser() = default;
+
+  static int PendingCall(void *) {
+    Instance().ReleaseAll();
+    return 0;
+  }
+
+  std::mutex mutex_;
+  std::vector<PyObject *> pending_;
+  bool scheduled_{false};
+};
+
+// The allocation borrowing the buffer of a numpy array instead of copying
+// it, the array is kept alive until the allocation is destroyed.
+class NumpyAllocation : public memory::Allocation {
+ public:
+  explicit NumpyAllocation(pybind11::array array)
+      : Allocation(array.mutable_data(), array.nbytes(),
+                   platform::CPUPlace()),
+        array_(std::move(array)) {}
+
+  ~NumpyAllocation() {
+    NumpyReleaser::Instance().Add(array_.release().ptr());
+  }
+
+ private:
+  pybind11::object array_;
+};
+
+// Lets the tensor share the buffer of the array on CPU, so that any change
+// of the array is seen by the tensor, and vice versa. The array is converted
+// first if it is not C contiguous or of another type, and copied if it is
+// not writeable, since the tensor might be written by the operators.
+template <typename T>
+void PyCPUTensorShareDataWithArray(
+    framework::Tensor *self,
+    pybind11::array_t<T, pybind11::array::c_style | pybind11::array::forcecast>
+        array) {
+  NumpyReleaser::Instance().ReleaseAll();
+  if (!array.writeable()) {
+    PyCPUTensorSetFromArray<T>(self, array, platform::CPUPlace());
+    return;
+  }
+  std::vector<int64_t> dims;
+  dims.reserve(array.ndim());
+  for (decltype(array.ndim()) i = 0; i < array.ndim(); ++i) {
+    dims.push_back(static_cast<int64_t>(array.shape()[i]));
+  }
+
+  self->Resize(framework::make_ddim(dims));
+  std::shared_ptr<memory::Allocation> holder(
+      new NumpyAllocation(std::move(array)));
+  // uint16_t in the parameter type is mapped to platform::float16
+  using ElemType = typename std::conditional<std::is_same<T, uint16_t>::value,
+                                             platform::float16, T>::type;
+  self->ResetHolderWithType(std::move(holder),
+                            framework::DataTypeTrait<ElemType>::DataType);
+}
+
 #ifdef PADDLE_WITH_CUDA
 template <typename T>
 void PyCUDATensorSetFromArray(
@@ -134,7 +134,9 @@ def __bootstrap__():
         'fast_eager_deletion_mode', 'allocator_strategy',
         'reader_queue_speed_test_mode', 'print_sub_graph_dir',
         'pe_profile_fname', 'warpctc_dir', 'inner_op_parallelism',
-        'enable_parallel_graph', 'multiple_of_cupti_buffer_size'
+        'enable_parallel_graph', 'multiple_of_cupti_buffer_size',
+        'tracer_sample_period', 'tracer_buffer_size',
+        'hogwild_cache_thread_buffers'
     ]
     if 'Darwin' not in sysstr:
         read_env_flags.append('use_pinned_memory')
@@ -91,7 +91,11 @@ class DataToLoDTensorConverter(object):
             #else:
             #    self._check_shape(arr.shape)
         t = core.LoDTensor()
-        t.set(arr, self.place)
+        if isinstance(self.place, core.CPUPlace):
+            # arr is owned by the converter only, so it is safe to share
+            t._share_data_with_numpy(arr)
+        else:
+            t.set(arr, self.place)
         if self.lod_level > 0:
             t.set_recursive_sequence_lengths(self.lod)
         return t
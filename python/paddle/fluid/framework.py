@@ -215,8 +215,8 @@ def dtype_is_floating(dtype):
         dtype = convert_np_dtype_to_dtype_(dtype)
 
     return dtype in [
-        core.VarDesc.VarType.FP16, core.VarDesc.VarType.FP32,
-        core.VarDesc.VarType.FP64
+        core.VarDesc.VarType.FP16, core.VarDesc.VarType.BF16,
+        core.VarDesc.VarType.FP32, core.VarDesc.VarType.FP64
     ]
 
 
@@ -559,6 +559,7 @@ def _py_reader(capacity,
     current_reset_method = reader.reset
     reader.thread = None
     reader.tensor_provider = None
+    reader.zero_copy = False
     reader.exited = False
 
     def start_provide_thread(func):
@@ -568,7 +569,10 @@ def _py_reader(capacity,
                 for item in tensors:
                     if not isinstance(item, core.LoDTensor):
                         tmp = core.LoDTensor()
-                        tmp.set(item, core.CPUPlace())
+                        if reader.zero_copy:
+                            tmp._share_data_with_numpy(item)
+                        else:
+                            tmp.set(item, core.CPUPlace())
                         item = tmp
 
                     array.append(item)
@@ -584,8 +588,9 @@ def _py_reader(capacity,
         reader.thread.daemon = True
         reader.thread.start()
 
-    def __set_tensor_provider__(func):
+    def __set_tensor_provider__(func, zero_copy=False):
         reader.tensor_provider = func
+        reader.zero_copy = zero_copy
 
     def __set_paddle_reader__(paddle_reader):
         with program_guard(Program(), Program()):
@@ -653,6 +658,9 @@ def py_reader(capacity,
     called when each pass begins, while the :code:`reset()` method should be
     called when the pass ends and :code:`fluid.core.EOFException` raises.
     Note that :code:`Program.clone()` method cannot clone :code:`py_reader`.
+    :code:`decorate_tensor_provider(func, zero_copy=True)` lets the queue
+    share the numpy arrays yielded by :code:`func` instead of copying them,
+    so :code:`func` must not modify the arrays after yielding them.
 
     Args:
        capacity(int): The buffer capacity maintained by :code:`py_reader`.
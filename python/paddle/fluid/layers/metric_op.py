@@ -83,7 +83,8 @@ def auc(input,
         curve='ROC',
         num_thresholds=2**12 - 1,
         topk=1,
-        slide_steps=1):
+        slide_steps=1,
+        merge_steps=1):
     """
     **Area Under the Curve (AUC) Layer**
 
@@ -111,6 +112,13 @@ def auc(input,
                              the roc curve. Default 200.
         topk(int): only topk number of prediction output will be used for auc.
         slide_steps: when calc batch auc, we can not only use step currently but the previous steps can be used. slide_steps=1 means use the current step, slide_steps=3 means use current step and the previous second steps, slide_steps=0 use all of the steps.
+        merge_steps(int): When the stats are shared by several threads, e.g.
+                          in Hogwild training, every thread merges its
+                          batches into them every merge_steps batches, and
+                          the AUC between two merges only adds the pending
+                          batches of the thread to the last merge. A larger
+                          value takes the lock of the stats less often.
+                          Default 1, every batch is merged.
 
 
     Returns:
@@ -161,7 +169,8 @@ def auc(input,
         attrs={
             "curve": curve,
             "num_thresholds": num_thresholds,
-            "slide_steps": slide_steps
+            "slide_steps": slide_steps,
+            "merge_steps": merge_steps
         },
         outputs={
             "AUC": [batch_auc_out],
@@ -180,7 +189,8 @@ def auc(input,
         attrs={
             "curve": curve,
             "num_thresholds": num_thresholds,
-            "slide_steps": 0
+            "slide_steps": 0,
+            "merge_steps": merge_steps
         },
         outputs={
             "AUC": [auc_out],
@@ -5178,7 +5178,9 @@ def nce(input,
                        It is used when sampler is set to 'custom_dist'.
                        custom_dist[i] is the probsbility of i-th class to be sampled.
                        default: None.
-        seed (int): The seed used in sampler. default: 0.
+        seed (int): The seed used in sampler. A fixed seed gives one continuous
+                    stream of samples across the iterations, not the same
+                    samples in every iteration. default: 0.
         is_sparse(bool): The flag indicating whether to use sparse update, the weight@GRAD and bias@GRAD will be changed to SelectedRows.
 
     Returns:
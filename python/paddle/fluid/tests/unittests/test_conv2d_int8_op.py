@@ -0,0 +1,119 @@
+# Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+
+import paddle.fluid.core as core
+from op_test import OpTest
+from test_conv2d_op import conv2d_forward_naive
+
+
+class TestConv2dInt8Op(OpTest):
+    def setUp(self):
+        self.op_type = "conv2d"
+        self.stride = [1, 1]
+        self.pad = [0, 0]
+        self.groups = 1
+        self.input_size = [2, 3, 5, 5]  # NCHW
+        self.filter_num = 6
+        self.filter_size = [3, 3]
+        self.force_fp32_output = True
+        self.fuse_relu = False
+        self.init_test_case()
+
+        f_c = self.input_size[1] // self.groups
+        filter_shape = [self.filter_num, f_c] + self.filter_size
+        scale_in = 10.0
+        scale_out = 0.5
+        scale_weights = np.random.uniform(10.0, 20.0,
+                                          self.filter_num).astype("float32")
+        input = np.random.randint(0, 255, self.input_size).astype("uint8")
+        filter = np.random.randint(-127, 127, filter_shape).astype("int8")
+        bias = np.random.random(self.filter_num).astype("float32")
+
+        conv_param = {
+            'stride': self.stride,
+            'pad': self.pad,
+            'dilation': [1, 1]
+        }
+        acc = conv2d_forward_naive(
+            input.astype("int32"),
+            filter.astype("int32"), self.groups, conv_param)[0]
+        out = acc / (scale_in * scale_weights.reshape(1, -1, 1, 1)) + \
+            bias.reshape(1, -1, 1, 1)
+        if self.fuse_relu:
+            out = np.maximum(out, 0)
+        if self.force_fp32_output:
+            out = out.astype("float32")
+        else:
+            out = np.clip(np.round(out * scale_out), 0, 255).astype("uint8")
+
+        self.inputs = {'Input': input, 'Filter': filter, 'Bias': bias}
+        self.attrs = {
+            'strides': self.stride,
+            'paddings': self.pad,
+            'groups': self.groups,
+            'dilations': [1, 1],
+            'fuse_relu': self.fuse_relu,
+            'force_fp32_output': self.force_fp32_output,
+            'Scale_in': scale_in,
+            'Scale_out': scale_out,
+            'Scale_weights': scale_weights.tolist()
+        }
+        self.outputs = {'Output': out}
+
+    def init_test_case(self):
+        pass
+
+    def test_check_output(self):
+        # the plain int8 kernel is CPU only
+        if self.force_fp32_output:
+            self.check_output_with_place(core.CPUPlace(), atol=1e-2)
+        else:
+            self.check_output_with_place(core.CPUPlace(), atol=1)
+
+
+class TestConv2dInt8OpPadStride(TestConv2dInt8Op):
+    def init_test_case(self):
+        self.pad = [1, 1]
+        self.stride = [2, 2]
+        self.input_size = [2, 3, 7, 6]
+
+
+class TestConv2dInt8OpGroup(TestConv2dInt8Op):
+    def init_test_case(self):
+        self.pad = [1, 1]
+        self.groups = 3
+        self.input_size = [2, 6, 5, 5]
+
+
+class TestConv2dInt8OpRelu(TestConv2dInt8Op):
+    def init_test_case(self):
+        self.pad = [1, 1]
+        self.fuse_relu = True
+
+
+class TestConv2dInt8OpUint8Output(TestConv2dInt8Op):
+    def init_test_case(self):
+        self.groups = 2
+        self.input_size = [1, 4, 6, 6]
+        self.fuse_relu = True
+        self.force_fp32_output = False
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -106,5 +106,38 @@ class TestFCOpWithBias3(TestFCOpWithBias):
         self.init_shapes(1, 64, 32, 3, 3)
 
 
+class TestFCInt8Op(OpTest):
+    def setUp(self):
+        self.op_type = "fc"
+        self.init_shapes()
+        scale_in = 10.0
+        scale_weights = np.random.uniform(10.0, 20.0,
+                                          self.oc).astype("float32")
+        x = np.random.randint(0, 255, (self.mb, self.ic)).astype("uint8")
+        w = np.random.randint(-127, 127, (self.ic, self.oc)).astype("int8")
+        bias = np.random.random((1, self.oc)).astype("float32")
+        out = np.dot(x.astype("int32"), w.astype("int32")).astype("float32")
+        out = out / (scale_in * scale_weights) + bias
+
+        self.inputs = {'Input': x, 'W': w, 'Bias': bias}
+        self.attrs = {
+            'Scale_in': scale_in,
+            'Scale_weights': scale_weights.tolist(),
+            'force_fp32_output': True
+        }
+        self.outputs = {'Out': out}
+
+    def init_shapes(self):
+        self.mb, self.ic, self.oc = 4, 40, 32
+
+    def test_check_output(self):
+        self.check_output(atol=1e-2)
+
+
+class TestFCInt8OpOddShape(TestFCInt8Op):
+    def init_shapes(self):
+        self.mb, self.ic, self.oc = 3, 17, 10
+
+
 if __name__ == "__main__":
     unittest.main()
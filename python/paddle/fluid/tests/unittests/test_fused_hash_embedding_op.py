@@ -0,0 +1,136 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+# The results of hash_op with num_hash = 4 and mod_by = 10000 for the int32
+# inputs 0 to 9, see test_hash_op.py.
+HASHED_DIGITS = np.array([
+    [4372, 9456, 8204, 6695], [6897, 3218, 2013, 1241],
+    [9662, 9217, 1129, 8487], [9407, 6715, 6949, 8094],
+    [9369, 4525, 8935, 9210], [3481, 7475, 7158, 3928],
+    [8310, 1327, 1654, 4567], [9038, 7951, 5953, 8657],
+    [1719, 5986, 9919, 3421], [8473, 694, 5142, 2479]
+])
+
+
+class TestFusedHashEmbeddingOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_hash_embedding"
+        self.init_test_case()
+        x = np.random.randint(0, 10, (30, 1)).astype("int32")
+        # h % 10000 % 100 == h % 100
+        table = np.random.random((100, self.emb_size)).astype("float32")
+        ids = HASHED_DIGITS[x[:, 0]] % 100
+        lod = [[9, 4, 11, 6]]
+        self.inputs = {'X': (x, lod), 'W': table}
+        self.attrs = {
+            'num_hash': 4,
+            'mod_by': 100,
+            'is_sparse': self.is_sparse
+        }
+        self.outputs = {'Out': (table[ids], lod)}
+
+    def init_test_case(self):
+        self.emb_size = 8
+        self.is_sparse = False
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['W'], 'Out', no_grad_set=set(['X']))
+
+
+class TestFusedHashEmbeddingOpSparse(TestFusedHashEmbeddingOp):
+    def init_test_case(self):
+        self.emb_size = 3
+        self.is_sparse = True
+
+    def test_check_grad(self):
+        # the rows of the sparse gradient summed up must give the dense one
+        x, lod = self.inputs['X']
+        table = self.inputs['W']
+        d_out = np.random.random(self.outputs['Out'][0].shape).astype(
+            "float32")
+        program = fluid.Program()
+        with fluid.program_guard(program, fluid.Program()):
+            block = program.global_block()
+            ids = fluid.layers.data(
+                name='X', shape=[1], dtype='int32', lod_level=1)
+            weight = block.create_parameter(
+                name='W', shape=list(table.shape), dtype='float32')
+            out = block.create_var(name='Out', dtype='float32')
+            block.append_op(
+                type='fused_hash_embedding',
+                inputs={'X': ids,
+                        'W': weight},
+                outputs={'Out': out},
+                attrs=self.attrs)
+            out_weight = fluid.layers.data(
+                name='out_weight',
+                shape=list(d_out.shape),
+                dtype='float32',
+                append_batch_size=False)
+            loss = fluid.layers.reduce_sum(
+                fluid.layers.elementwise_mul(out, out_weight))
+            fluid.backward.append_backward(loss)
+
+        place = core.CPUPlace()
+        scope = core.Scope()
+        with fluid.scope_guard(scope):
+            exe = fluid.Executor(place)
+            exe.run(program,
+                    feed={
+                        'X': fluid.create_lod_tensor(x, lod, place),
+                        'W': table,
+                        'out_weight': d_out
+                    })
+        d_table = scope.find_var('W@GRAD').get_selected_rows()
+
+        expected = np.zeros(table.shape).astype("float32")
+        hashed = HASHED_DIGITS[x[:, 0]] % 100
+        np.add.at(expected,
+                  hashed.flatten(), d_out.reshape(-1, self.emb_size))
+        self.assertEqual(d_table.height(), table.shape[0])
+        actual = np.zeros(table.shape).astype("float32")
+        np.add.at(actual, d_table.rows(), np.array(d_table.get_tensor()))
+        self.assertTrue(np.allclose(actual, expected, atol=1e-5))
+
+
+class TestFusedHashEmbeddingOpFullRow(OpTest):
+    def setUp(self):
+        self.op_type = "fused_hash_embedding"
+        # the same ids as TestHashInt64Op in test_hash_op.py
+        x = np.array([[1, 2], [3, 4], [1 << 40, -5], [1, 2]]).astype("int64")
+        ids = np.array([[6524, 3896], [3640, 7562], [7005, 913],
+                        [6524, 3896]])
+        table = np.random.random((10000, 2)).astype("float32")
+        lod = [[3, 1]]
+        self.inputs = {'X': (x, lod), 'W': table}
+        self.attrs = {'num_hash': 2, 'mod_by': 10000, 'hash_full_row': True}
+        self.outputs = {'Out': (table[ids], lod)}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,107 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def sigmoid(x):
+    return 1. / (1. + np.exp(-x))
+
+
+def apply_chain(x, ys, chain_ops, scales, biases):
+    binary_ops = {
+        'add': lambda x, y: x + y,
+        'sub': lambda x, y: x - y,
+        'rsub': lambda x, y: y - x,
+        'mul': lambda x, y: x * y,
+        'div': lambda x, y: x / y,
+        'rdiv': lambda x, y: y / x,
+        'max': np.maximum,
+        'min': np.minimum
+    }
+    unary_ops = {
+        'relu': lambda x: np.maximum(x, 0),
+        'sigmoid': sigmoid,
+        'tanh': np.tanh,
+        'exp': np.exp,
+        'square': np.square
+    }
+    out = x
+    k = 0
+    for i, op in enumerate(chain_ops):
+        if op in binary_ops:
+            out = binary_ops[op](out, ys[k])
+            k += 1
+        elif op == 'scale':
+            out = out * scales[i] + biases[i]
+        else:
+            out = unary_ops[op](out)
+    return out
+
+
+class TestFusionElementwiseChainOp(OpTest):
+    def setUp(self):
+        self.op_type = 'fusion_elementwise_chain'
+        self.x_shape = (4, 5, 37)
+        self.y_shapes = [(4, 5, 37), (37, )]
+        self.chain_ops = ['mul', 'add', 'sigmoid']
+        self.set_conf()
+        self.scales = [0.5] * len(self.chain_ops)
+        self.biases = [-0.2] * len(self.chain_ops)
+        # keep away from zero, which could be divided
+        x = np.random.uniform(0.5, 2, self.x_shape).astype('float32')
+        ys = [
+            np.random.uniform(0.5, 2, shape).astype('float32')
+            for shape in self.y_shapes
+        ]
+
+        self.inputs = {'X': x}
+        if ys:
+            self.inputs['Ys'] = [('y%d' % i, y) for i, y in enumerate(ys)]
+        self.outputs = {
+            'Out': apply_chain(x, ys, self.chain_ops, self.scales,
+                               self.biases).astype('float32')
+        }
+        self.attrs = {
+            'chain_ops': self.chain_ops,
+            'scales': self.scales,
+            'biases': self.biases
+        }
+
+    def set_conf(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusionElementwiseChainOpUnary(TestFusionElementwiseChainOp):
+    def set_conf(self):
+        self.y_shapes = []
+        self.chain_ops = ['scale', 'tanh', 'square', 'relu']
+
+
+class TestFusionElementwiseChainOpReversed(TestFusionElementwiseChainOp):
+    def set_conf(self):
+        self.x_shape = (3, 16)
+        self.y_shapes = [(3, 16), (16, ), (3, 16), (3, 16)]
+        self.chain_ops = ['rsub', 'rdiv', 'scale', 'max', 'min', 'exp']
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -53,5 +53,40 @@ class TestScaleOp(OpTest):
         self.check_output()
 
 
+class TestHashInt64Op(OpTest):
+    def setUp(self):
+        self.op_type = "hash"
+        # all the bytes of the int64 rows are hashed
+        in_seq = np.array(
+            [[1, 2], [3, 4], [1 << 40, -5], [1, 2]]).astype("int64")
+        out_seq = np.array([[[6524], [3896]], [[3640], [7562]],
+                            [[7005], [913]], [[6524], [3896]]]).astype("int64")
+        lod = [[3, 1]]
+        self.inputs = {'X': (in_seq, lod)}
+        self.attrs = {'num_hash': 2, 'mod_by': 10000, 'hash_full_row': True}
+        self.outputs = {'Out': (out_seq, lod)}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestHashInt64OpDefault(OpTest):
+    def setUp(self):
+        self.op_type = "hash"
+        # only sizeof(int) * last_dim bytes, the first int64, of the rows are
+        # hashed by default
+        in_seq = np.array(
+            [[1, 2], [3, 4], [1 << 40, -5], [1, 7]]).astype("int64")
+        out_seq = np.array([[[1269], [9609]], [[8465], [5822]],
+                            [[771], [629]], [[1269], [9609]]]).astype("int64")
+        lod = [[3, 1]]
+        self.inputs = {'X': (in_seq, lod)}
+        self.attrs = {'num_hash': 2, 'mod_by': 10000}
+        self.outputs = {'Out': (out_seq, lod)}
+
+    def test_check_output(self):
+        self.check_output()
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -104,8 +104,16 @@ def nms(boxes,
     return selected_indices
 
 
-def multiclass_nms(boxes, scores, background, score_threshold, nms_threshold,
-                   nms_top_k, keep_top_k, normalized, shared):
+def multiclass_nms(boxes,
+                   scores,
+                   background,
+                   score_threshold,
+                   nms_threshold,
+                   nms_top_k,
+                   keep_top_k,
+                   normalized,
+                   shared,
+                   eta=1.0):
     if shared:
         class_num = scores.shape[0]
         priorbox_num = scores.shape[1]
@@ -119,10 +127,10 @@ def multiclass_nms(boxes, scores, background, score_threshold, nms_threshold,
         if c == background: continue
         if shared:
             indices = nms(boxes, scores[c], score_threshold, nms_threshold,
-                          nms_top_k, normalized)
+                          nms_top_k, normalized, eta)
         else:
             indices = nms(boxes[:, c, :], scores[:, c], score_threshold,
-                          nms_threshold, nms_top_k, normalized)
+                          nms_threshold, nms_top_k, normalized, eta)
         selected_indices[c] = indices
         num_det += len(indices)
 
@@ -196,7 +204,8 @@ def batched_multiclass_nms(boxes,
                            nms_threshold,
                            nms_top_k,
                            keep_top_k,
-                           normalized=True):
+                           normalized=True,
+                           eta=1.0):
     batch_size = scores.shape[0]
 
     det_outs = []
@@ -211,7 +220,8 @@ def batched_multiclass_nms(boxes,
             nms_top_k,
             keep_top_k,
             normalized,
-            shared=True)
+            shared=True,
+            eta=eta)
         if nmsed_num == 0:
             continue
 
@@ -235,15 +245,21 @@ class TestMulticlassNMSOp(OpTest):
         self.score_threshold = 0.01
 
     def setUp(self):
+        self.background = 0
+        self.nms_threshold = 0.3
+        self.nms_top_k = 400
+        self.keep_top_k = 200
+        self.nms_eta = 1.0
+        self.score_precision = None
         self.set_argument()
         N = 7
         M = 1200
         C = 21
         BOX_SIZE = 4
-        background = 0
-        nms_threshold = 0.3
-        nms_top_k = 400
-        keep_top_k = 200
+        background = self.background
+        nms_threshold = self.nms_threshold
+        nms_top_k = self.nms_top_k
+        keep_top_k = self.keep_top_k
         score_threshold = self.score_threshold
 
         scores = np.random.random((N * M, C)).astype('float32')
@@ -254,6 +270,10 @@ class TestMulticlassNMSOp(OpTest):
             return exps / np.sum(exps)
 
         scores = np.apply_along_axis(softmax, 1, scores)
+        if self.score_precision:
+            # many equal scores, the ties are broken by the index
+            scores = np.floor(scores / self.score_precision)
+            scores = (scores * self.score_precision).astype('float32')
         scores = np.reshape(scores, (N, M, C))
         scores = np.transpose(scores, (0, 2, 1))
 
@@ -261,9 +281,15 @@ class TestMulticlassNMSOp(OpTest):
         boxes[:, :, 0:2] = boxes[:, :, 0:2] * 0.5
         boxes[:, :, 2:4] = boxes[:, :, 2:4] * 0.5 + 0.5
 
-        nmsed_outs, lod = batched_multiclass_nms(boxes, scores, background,
-                                                 score_threshold, nms_threshold,
-                                                 nms_top_k, keep_top_k)
+        nmsed_outs, lod = batched_multiclass_nms(
+            boxes,
+            scores,
+            background,
+            score_threshold,
+            nms_threshold,
+            nms_top_k,
+            keep_top_k,
+            eta=self.nms_eta)
         nmsed_outs = [-1] if not nmsed_outs else nmsed_outs
         nmsed_outs = np.array(nmsed_outs).astype('float32')
 
@@ -271,12 +297,12 @@ class TestMulticlassNMSOp(OpTest):
         self.inputs = {'BBoxes': boxes, 'Scores': scores}
         self.outputs = {'Out': (nmsed_outs, [lod])}
         self.attrs = {
-            'background_label': 0,
+            'background_label': background,
             'nms_threshold': nms_threshold,
             'nms_top_k': nms_top_k,
             'keep_top_k': keep_top_k,
             'score_threshold': score_threshold,
-            'nms_eta': 1.0,
+            'nms_eta': self.nms_eta,
             'normalized': True,
         }
 
@@ -291,16 +317,52 @@ class TestMulticlassNMSOpNoOutput(TestMulticlassNMSOp):
         self.score_threshold = 2.0
 
 
+class TestMulticlassNMSOpKeepTopK(TestMulticlassNMSOp):
+    def set_argument(self):
+        self.score_threshold = 0.01
+        # far fewer than the detections of every image
+        self.keep_top_k = 10
+        self.nms_top_k = 50
+
+
+class TestMulticlassNMSOpTies(TestMulticlassNMSOp):
+    def set_argument(self):
+        self.score_threshold = 0.01
+        self.score_precision = 0.01
+        self.keep_top_k = 30
+
+
+class TestMulticlassNMSOpEta(TestMulticlassNMSOp):
+    def set_argument(self):
+        self.score_threshold = 0.01
+        # the threshold is adapted while it is above 0.5
+        self.nms_threshold = 0.7
+        self.nms_eta = 0.9
+
+
+class TestMulticlassNMSOpBackground(TestMulticlassNMSOp):
+    def set_argument(self):
+        self.score_threshold = 0.01
+        self.background = 3
+
+
+class TestMulticlassNMSOpNoBackground(TestMulticlassNMSOp):
+    def set_argument(self):
+        self.score_threshold = 0.01
+        self.background = -1
+
+
 class TestMulticlassNMSLoDInput(OpTest):
     def set_argument(self):
         self.score_threshold = 0.01
 
     def setUp(self):
+        self.box_lod = [[1200]]
         self.set_argument()
         M = 1200
         C = 21
         BOX_SIZE = 4
-        box_lod = [[1200]]
+        box_lod = self.box_lod
         background = 0
         nms_threshold = 0.3
         nms_top_k = 400
@@ -348,6 +410,13 @@ class TestMulticlassNMSLoDInput(OpTest):
         self.check_output()
 
 
+class TestMulticlassNMSLoDInputImages(TestMulticlassNMSLoDInput):
+    def set_argument(self):
+        self.score_threshold = 0.01
+        # several images of various numbers of boxes
+        self.box_lod = [[300, 500, 400]]
+
+
 class TestIOU(unittest.TestCase):
     def test_iou(self):
         box1 = np.array([4.0, 3.0, 7.0, 5.0]).astype('float32')
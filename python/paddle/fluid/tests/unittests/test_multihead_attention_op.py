@@ -0,0 +1,89 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def softmax(x):
+    e = np.exp(x - np.max(x, axis=-1, keepdims=True))
+    return e / np.sum(e, axis=-1, keepdims=True)
+
+
+def multihead_attention(x, w, bias, bias_qk, head_number, alpha):
+    batch_size, seq_len, _ = x.shape
+    hidden = w.shape[1] // 3
+    head_size = hidden // head_number
+    qkv = np.dot(x, w) + bias
+
+    def split_heads(t):
+        t = t.reshape(batch_size, seq_len, head_number, head_size)
+        return t.transpose(0, 2, 1, 3)
+
+    q = split_heads(qkv[:, :, :hidden])
+    k = split_heads(qkv[:, :, hidden:2 * hidden])
+    v = split_heads(qkv[:, :, 2 * hidden:])
+    scores = alpha * np.matmul(q, k.transpose(0, 1, 3, 2)) + bias_qk
+    out = np.matmul(softmax(scores), v)
+    return out.transpose(0, 2, 1, 3).reshape(batch_size, seq_len, hidden)
+
+
+class TestMultiheadAttentionOp(OpTest):
+    def setUp(self):
+        self.op_type = 'multihead_attention'
+        self.batch_size = 2
+        self.seq_len = 40
+        self.in_width = 24
+        self.head_number = 4
+        self.head_size = 8
+        self.set_conf()
+        hidden = self.head_number * self.head_size
+        alpha = self.head_size**-0.5
+        x = np.random.uniform(
+            -1, 1,
+            (self.batch_size, self.seq_len, self.in_width)).astype('float32')
+        w = np.random.uniform(
+            -0.5, 0.5, (self.in_width, 3 * hidden)).astype('float32')
+        bias = np.random.uniform(-0.5, 0.5, (3 * hidden, )).astype('float32')
+        bias_qk = np.random.uniform(
+            -1, 0, (self.batch_size, self.head_number, self.seq_len,
+                    self.seq_len)).astype('float32')
+
+        self.inputs = {'X': x, 'W': w, 'Bias': bias, 'BiasQK': bias_qk}
+        self.outputs = {
+            'Out': multihead_attention(x, w, bias, bias_qk, self.head_number,
+                                       alpha).astype('float32')
+        }
+        self.attrs = {'head_number': self.head_number, 'alpha': alpha}
+
+    def set_conf(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-4)
+
+
+class TestMultiheadAttentionOpOneBlock(TestMultiheadAttentionOp):
+    def set_conf(self):
+        self.batch_size = 3
+        self.seq_len = 7
+        self.head_number = 2
+        self.head_size = 5
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -118,6 +118,65 @@ class TestNCECase1Tensor(TestNCE):
         self.generate_data(10, 20, 10, 2, 5, False)
 
 
+class TestNCESharedNegatives(TestNCE):
+    def set_data(self):
+        self.generate_data(10, 20, 10, 2, 5, False)
+        self.attrs['shared_negatives'] = True
+
+
+class TestNCESharedNegativesSampled(unittest.TestCase):
+    def test_rows_share_negatives(self):
+        batch_size, dim, num_classes = 16, 8, 50
+        num_true_class, num_neg_samples = 2, 6
+        program = fluid.Program()
+        with fluid.program_guard(program, fluid.Program()):
+            block = program.global_block()
+            input = fluid.layers.data(
+                name='input', shape=[dim], dtype='float32')
+            label = fluid.layers.data(
+                name='label', shape=[num_true_class], dtype='int64')
+            weight = block.create_var(
+                name='weight', shape=[num_classes, dim], dtype='float32')
+            outputs = {}
+            for name, dtype in [('Cost', 'float32'),
+                                ('SampleLogits', 'float32'),
+                                ('SampleLabels', 'int64')]:
+                outputs[name] = block.create_var(name=name, dtype=dtype)
+            # the negatives are sampled, no custom_neg_classes
+            block.append_op(
+                type='nce',
+                inputs={'Input': input,
+                        'Label': label,
+                        'Weight': weight},
+                outputs=outputs,
+                attrs={
+                    'num_total_classes': num_classes,
+                    'num_neg_samples': num_neg_samples,
+                    'sampler': 0,
+                    'seed': 1,
+                    'shared_negatives': True
+                })
+
+        labels = np.random.randint(
+            0, num_classes, (batch_size, num_true_class)).astype('int64')
+        exe = fluid.Executor(fluid.CPUPlace())
+        sample_labels, = exe.run(program,
+                                 feed={
+                                     'input': np.random.randn(
+                                         batch_size, dim).astype('float32'),
+                                     'label': labels,
+                                     'weight': np.random.randn(
+                                         num_classes, dim).astype('float32')
+                                 },
+                                 fetch_list=[outputs['SampleLabels']])
+        self.assertEqual(sample_labels.shape,
+                         (batch_size, num_true_class + num_neg_samples))
+        self.assertTrue((sample_labels[:, :num_true_class] == labels).all())
+        negatives = sample_labels[:, num_true_class:]
+        for row in negatives:
+            self.assertTrue((row == negatives[0]).all())
+
+
 class TestNCECase1SelectedRows(unittest.TestCase):
     def setUp(self):
         self.base_lr = 0.0001
@@ -0,0 +1,137 @@
+# Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+from op_test import OpTest
+
+
+@unittest.skipIf(core.is_compiled_with_mkldnn(),
+                 "the MKL-DNN kernels are tested in mkldnn/")
+class TestQuantizeOp(OpTest):
+    def setUp(self):
+        self.op_type = 'quantize'
+        self.scale = 2.0
+        self.is_negative = False
+        self.init_test_case()
+        if self.is_negative:
+            input = (200 * np.random.random_sample([3, 4, 5]) - 100
+                     ).astype('float32')
+            output = np.clip(np.round(input * self.scale), -128,
+                             127).astype('int8')
+        else:
+            input = (200 * np.random.random_sample([3, 4, 5])
+                     ).astype('float32')
+            output = np.clip(np.round(input * self.scale), 0,
+                             255).astype('uint8')
+        self.inputs = {'Input': input}
+        self.outputs = {'Output': output}
+        self.attrs = {
+            'Scale': self.scale,
+            'is_negative_input': self.is_negative
+        }
+
+    def init_test_case(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output_with_place(core.CPUPlace(), atol=1)
+
+
+class TestQuantizeOpNegative(TestQuantizeOp):
+    def init_test_case(self):
+        self.scale = 0.5
+        self.is_negative = True
+
+
+class TestQuantizeOpSaturation(TestQuantizeOp):
+    def init_test_case(self):
+        self.scale = 3.0
+        self.is_negative = True
+
+
+@unittest.skipIf(core.is_compiled_with_mkldnn(),
+                 "the MKL-DNN kernels are tested in mkldnn/")
+class TestDequantizeOp(OpTest):
+    def setUp(self):
+        self.op_type = 'dequantize'
+        self.scale = 4.0
+        input = np.random.randint(0, 255, [3, 4, 5]).astype('uint8')
+        self.inputs = {'Input': input}
+        self.outputs = {'Output': input.astype('float32') / self.scale}
+        self.attrs = {'Scale': self.scale}
+
+    def test_check_output(self):
+        self.check_output_with_place(core.CPUPlace(), atol=1e-5)
+
+
+@unittest.skipIf(core.is_compiled_with_mkldnn(),
+                 "the MKL-DNN kernels are tested in mkldnn/")
+class TestQuantizeDequantizeRoundTrip(unittest.TestCase):
+    def round_trip(self, input, scale, is_negative):
+        main = fluid.Program()
+        with fluid.program_guard(main, fluid.Program()):
+            x = fluid.layers.data(
+                name='x',
+                shape=list(input.shape),
+                dtype='float32',
+                append_batch_size=False)
+            block = main.global_block()
+            quantized = block.create_var(
+                name='quantized',
+                dtype='int8' if is_negative else 'uint8',
+                shape=x.shape)
+            out = block.create_var(name='out', dtype='float32', shape=x.shape)
+            block.append_op(
+                type='quantize',
+                inputs={'Input': x},
+                outputs={'Output': quantized},
+                attrs={'Scale': scale,
+                       'is_negative_input': is_negative})
+            block.append_op(
+                type='dequantize',
+                inputs={'Input': quantized},
+                outputs={'Output': out},
+                attrs={'Scale': scale})
+        exe = fluid.Executor(fluid.CPUPlace())
+        return exe.run(main, feed={'x': input}, fetch_list=[out])[0]
+
+    def test_uint8(self):
+        scale = 255.0 / 10.0
+        input = (10 * np.random.random_sample([8, 16])).astype('float32')
+        out = self.round_trip(input, scale, False)
+        # the error of rounding is at most half a step
+        self.assertTrue(np.all(np.abs(out - input) <= 0.5 / scale + 1e-6))
+
+    def test_int8(self):
+        scale = 127.0 / 5.0
+        input = (10 * np.random.random_sample([8, 16]) - 5).astype('float32')
+        out = self.round_trip(input, scale, True)
+        self.assertTrue(np.all(np.abs(out - input) <= 0.5 / scale + 1e-6))
+
+    def test_saturation(self):
+        # the values out of the range are saturated to it
+        scale = 10.0
+        input = np.array([[-100, -12.8, -1, 0, 1, 12.7, 100]]).astype('float32')
+        out = self.round_trip(input, scale, True)
+        self.assertTrue(np.allclose(out, np.clip(input, -12.8, 12.7)))
+
+
+if __name__ == '__main__':
+    unittest.main()
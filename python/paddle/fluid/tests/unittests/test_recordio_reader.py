@@ -83,6 +83,11 @@ class TestRecordIO(unittest.TestCase):
         self.test_main(decorator_callback=lambda reader: fluid.layers.io.shuffle(
             reader, buffer_size=200))
 
+    def test_shuffle_reader_small_buffer(self):
+        # The buffer is refilled many times in one pass.
+        self.test_main(decorator_callback=lambda reader: fluid.layers.io.shuffle(
+            reader, buffer_size=3))
+
     def test_double_buffer_reader(self):
         self.test_main(decorator_callback=lambda reader: fluid.layers.io.double_buffer(reader,
                                                                                        place='cuda:0' if fluid.core.is_compiled_with_cuda() else 'cpu'))
@@ -48,6 +48,19 @@ class TestSumOp(OpTest):
         pass
 
 
+class TestSumOpManyInputs(OpTest):
+    def setUp(self):
+        self.op_type = "sum"
+        xs = [
+            np.random.random((50, 200)).astype(np.float32) for _ in range(9)
+        ]
+        self.inputs = {"X": [("x%d" % i, x) for i, x in enumerate(xs)]}
+        self.outputs = {'Out': np.sum(xs, axis=0)}
+
+    def test_check_output(self):
+        self.check_output()
+
+
 class TestSelectedRowsSumOp(OpTest):
     def setUp(self):
         self.height = 10
@@ -139,6 +152,46 @@ class TestSelectedRowsSumOp(OpTest):
                 self.check_with_place(place, inplace)
 
 
+class TestSelectedRowsSumOpDuplicatedRows(TestSelectedRowsSumOp):
+    def setUp(self):
+        self.height = 10
+        self.row_numel = 12
+        self.rows = [6, 0, 5, 6, 2, 0, 3]
+        self.dtype = np.float32
+        self.init_kernel_type()
+
+    def check_input_and_optput(self,
+                               scope,
+                               place,
+                               inplace,
+                               w1_has_data=False,
+                               w2_has_data=False,
+                               w3_has_data=False):
+        self.create_selected_rows(scope, place, "W1", w1_has_data)
+        self.create_selected_rows(scope, place, "W2", w2_has_data)
+        self.create_selected_rows(scope, place, "W3", w3_has_data)
+
+        out_var_name = "W1" if inplace else "Out"
+        out = scope.var(out_var_name).get_selected_rows()
+        sum_op = Operator("sum", X=["W1", "W2", "W3"], Out=out_var_name)
+        sum_op.run(scope, place)
+
+        has_data_w_num = sum([w1_has_data, w2_has_data, w3_has_data])
+        if has_data_w_num == 0:
+            self.assertEqual(len(out.rows()), 0)
+            return
+        # the duplicated rows are merged into the sorted unique rows
+        expected = np.zeros((self.height, self.row_numel)).astype(self.dtype)
+        for row in self.rows:
+            expected[row] += row * has_data_w_num
+        unique_rows = sorted(set(self.rows))
+        out_rows = list(out.rows())
+        self.assertEqual(sorted(out_rows), unique_rows)
+        out_t = np.array(out.get_tensor())
+        for i, row in enumerate(out_rows):
+            self.assertTrue(np.array_equal(out_t[i], expected[row]))
+
+
 class TestLoDTensorAndSelectedRowsOp(TestSelectedRowsSumOp):
     def setUp(self):
         self.height = 10
@@ -183,6 +183,43 @@ class TestTensor(unittest.TestCase):
             tensor_array = numpy.array(tensor)
             self.assertEqual((0, 1), tensor_array.shape)
 
+    def test_share_data_with_numpy(self):
+        tensor = core.LoDTensor()
+        array = numpy.random.random((4, 5, 6)).astype('float32')
+        tensor._share_data_with_numpy(array)
+        self.assertEqual([4, 5, 6], tensor.shape())
+        self.assertEqual(core.VarDesc.VarType.FP32, tensor._dtype())
+
+        # the tensor and the array share the same memory
+        array[1, 2, 3] = 7.0
+        self.assertAlmostEqual(7.0, numpy.array(tensor)[1, 2, 3])
+        tensor._set_float_element(0, 3.0)
+        self.assertAlmostEqual(3.0, array[0, 0, 0])
+
+        # the tensor keeps the array alive
+        expected = array.copy()
+        del array
+        self.assertTrue(numpy.array_equal(expected, numpy.array(tensor)))
+
+    def test_share_data_with_converted_numpy(self):
+        tensor = core.LoDTensor()
+        # not C contiguous, so it is shared after being converted
+        array = numpy.arange(24, dtype='int64').reshape((4, 6))[:, ::2]
+        tensor._share_data_with_numpy(array)
+        self.assertEqual(core.VarDesc.VarType.INT64, tensor._dtype())
+        self.assertTrue(numpy.array_equal(array, numpy.array(tensor)))
+
+        # read only, so it is copied
+        array = numpy.ones((3, 2), dtype='int32')
+        array.flags.writeable = False
+        tensor._share_data_with_numpy(array)
+        self.assertEqual(core.VarDesc.VarType.INT32, tensor._dtype())
+        self.assertTrue(numpy.array_equal(array, numpy.array(tensor)))
+
+        array = numpy.random.random((2, 3)).astype('float16')
+        tensor._share_data_with_numpy(array.view(numpy.uint16))
+        self.assertEqual(core.VarDesc.VarType.FP16, tensor._dtype())
+
 
 if __name__ == '__main__':
     unittest.main()